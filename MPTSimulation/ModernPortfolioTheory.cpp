@@ -0,0 +1,150 @@
+#include "ModernPortfolioTheory.hpp"
+#include "gemm.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Checked before anything is factored, so a bad covariance never reaches the Cholesky
+static const ConstMatrixView& checkedCovariance(const std::vector<double>& meanReturns, const ConstMatrixView& covariance) {
+    if(meanReturns.empty()) {
+        throw std::invalid_argument("A portfolio needs at least one asset");
+    }
+    if(covariance.rows != meanReturns.size() || covariance.columns != meanReturns.size()) {
+        throw std::invalid_argument("Covariance matrix does not match the number of assets");
+    }
+    return covariance;
+}
+
+ModernPortfolioTheory::ModernPortfolioTheory(const ConstMatrixView& returns, double _riskFree)
+    : ModernPortfolioTheory(sampleMean(returns), sampleCovariance(returns), _riskFree) {}
+
+ModernPortfolioTheory::ModernPortfolioTheory(const std::vector<double>& _meanReturns, const ConstMatrixView& _covariance, double _riskFree)
+    : assets(_meanReturns.size()), meanReturns(_meanReturns), covariance(checkedCovariance(_meanReturns, _covariance)), riskFree(_riskFree),
+      factorization(covariance) {
+    prepare();
+}
+
+std::vector<double> ModernPortfolioTheory::sampleMean(const ConstMatrixView& returns) {
+    if(returns.rows == 0) {
+        throw std::invalid_argument("Returns panel has no observations");
+    }
+    std::vector<double> mean(returns.columns, 0.0);
+    for(size_t t{}; t < returns.rows; t++) {
+        for(size_t i{}; i < returns.columns; i++) {
+            mean[i] += returns.unchecked(t, i);
+        }
+    }
+    for(double& m : mean) {
+        m /= double(returns.rows);
+    }
+    return mean;
+}
+
+Matrix ModernPortfolioTheory::sampleCovariance(const ConstMatrixView& returns) {
+    if(returns.rows < 2) {
+        throw std::invalid_argument("Need at least two observations for a sample covariance");
+    }
+    size_t T = returns.rows, n = returns.columns;
+    std::vector<double> mean = sampleMean(returns);
+    Matrix centred = returns;
+    for(size_t t{}; t < T; t++) {
+        double* row = &centred.unchecked(t, 0);
+        for(size_t i{}; i < n; i++) {
+            row[i] -= mean[i];
+        }
+    }
+    // X^T X: the transpose is read through strides, no copy
+    Matrix cov(n, n, MatrixInit::Uninitialized);
+    gemm(n, n, T, 1.0 / double(T - 1),
+         centred.data.data(), 1, n,
+         centred.data.data(), n, 1,
+         0.0, cov.data.data(), n);
+    return cov;
+}
+
+void ModernPortfolioTheory::prepare() {
+    Matrix rhs(assets, 2);
+    for(size_t i{}; i < assets; i++) {
+        rhs.unchecked(i, 0) = 1.0;
+        rhs.unchecked(i, 1) = meanReturns[i];
+    }
+    // Both right hand sides against the single factorization
+    Matrix solved = factorization.solve(rhs);
+    inverseOnes.resize(assets);
+    inverseMean.resize(assets);
+    a = b = c = 0.0;
+    for(size_t i{}; i < assets; i++) {
+        inverseOnes[i] = solved.unchecked(i, 0);
+        inverseMean[i] = solved.unchecked(i, 1);
+        a += inverseOnes[i];
+        b += inverseMean[i];
+        c += meanReturns[i] * inverseMean[i];
+    }
+    d = a * c - b * b;
+}
+
+// w = onesWeight * Sigma^-1 1 + meanWeight * Sigma^-1 mu. Its moments follow from a, b, c
+// without touching the covariance again.
+Portfolio ModernPortfolioTheory::combine(double onesWeight, double meanWeight) const {
+    Portfolio p;
+    p.weights.resize(assets);
+    for(size_t i{}; i < assets; i++) {
+        p.weights[i] = onesWeight * inverseOnes[i] + meanWeight * inverseMean[i];
+    }
+    p.expectedReturn = onesWeight * b + meanWeight * c;
+    double variance = onesWeight * onesWeight * a + 2.0 * onesWeight * meanWeight * b + meanWeight * meanWeight * c;
+    p.volatility = std::sqrt(std::max(variance, 0.0));
+    p.sharpe = p.volatility > 0.0 ? (p.expectedReturn - riskFree) / p.volatility : 0.0;
+    return p;
+}
+
+Portfolio ModernPortfolioTheory::minimumVariance() const {
+    return combine(1.0 / a, 0.0);
+}
+
+Portfolio ModernPortfolioTheory::tangency() const {
+    double scale = b - riskFree * a;
+    if(std::fabs(scale) < 1e-300) {
+        throw std::runtime_error("Tangency portfolio does not exist for this risk free rate");
+    }
+    return combine(-riskFree / scale, 1.0 / scale);
+}
+
+Portfolio ModernPortfolioTheory::targetReturn(double target) const {
+    if(std::fabs(d) < 1e-300) {
+        throw std::runtime_error("Efficient frontier is degenerate because all assets have the same mean");
+    }
+    return combine((c - b * target) / d, (a * target - b) / d);
+}
+
+std::vector<Portfolio> ModernPortfolioTheory::efficientFrontier(size_t points, double minReturn, double maxReturn) const {
+    std::vector<Portfolio> frontier;
+    frontier.reserve(points);
+    for(size_t k{}; k < points; k++) {
+        double t = points > 1 ? double(k) / double(points - 1) : 0.0;
+        frontier.push_back(targetReturn(minReturn + t * (maxReturn - minReturn)));
+    }
+    return frontier;
+}
+
+std::vector<Portfolio> ModernPortfolioTheory::efficientFrontier(size_t points) const {
+    double lowest = b / a;
+    double highest = *std::max_element(meanReturns.begin(), meanReturns.end());
+    return efficientFrontier(points, lowest, std::max(lowest, highest));
+}
+
+double ModernPortfolioTheory::portfolioVariance(const std::vector<double>& weights) const {
+    if(weights.size() != assets) {
+        throw std::invalid_argument("Weights do not match the number of assets");
+    }
+    double variance = 0.0;
+    for(size_t i{}; i < assets; i++) {
+        const double* row = &covariance.unchecked(i, 0);
+        double inner = 0.0;
+        for(size_t j{}; j < assets; j++) {
+            inner += row[j] * weights[j];
+        }
+        variance += weights[i] * inner;
+    }
+    return variance;
+}
@@ -0,0 +1,56 @@
+#ifndef MODERNPORTFOLIOTHEORY_HPP
+#define MODERNPORTFOLIOTHEORY_HPP
+
+#include "matrix.hpp"
+#include "luFactorization.hpp"
+#include <vector>
+
+/*
+Mean-variance (Markowitz) portfolio engine, short sales allowed.
+The covariance matrix is factored once on construction and the two solves
+Sigma^-1 * 1 and Sigma^-1 * mu are kept. Every frontier portfolio is a linear combination
+of those two vectors, so each extra frontier point costs O(n) instead of a new solve.
+*/
+struct Portfolio {
+    double expectedReturn;
+    double volatility;
+    double sharpe;
+    std::vector<double> weights;
+};
+
+struct ModernPortfolioTheory {
+public:
+    size_t assets;
+    std::vector<double> meanReturns;
+    Matrix covariance;
+    double riskFree;
+
+    // returns is observations x assets, one row per period; a block() of a larger panel selects dates and assets without a copy
+    explicit ModernPortfolioTheory(const ConstMatrixView& returns, double _riskFree = 0.0);
+    ModernPortfolioTheory(const std::vector<double>& _meanReturns, const ConstMatrixView& _covariance, double _riskFree = 0.0);
+
+    static std::vector<double> sampleMean(const ConstMatrixView& returns);
+    // Unbiased (T - 1) sample covariance, computed as one X^T X product on the centred panel
+    static Matrix sampleCovariance(const ConstMatrixView& returns);
+
+    Portfolio minimumVariance() const;
+    Portfolio tangency() const;
+    Portfolio targetReturn(double target) const;
+    // points portfolios evenly spaced in expected return over [minReturn, maxReturn]
+    std::vector<Portfolio> efficientFrontier(size_t points, double minReturn, double maxReturn) const;
+    // From the minimum-variance portfolio up to the best single-asset mean
+    std::vector<Portfolio> efficientFrontier(size_t points) const;
+
+    double portfolioVariance(const std::vector<double>& weights) const;
+
+private:
+    LUFactorization factorization;
+    std::vector<double> inverseOnes;  // Sigma^-1 * 1
+    std::vector<double> inverseMean;  // Sigma^-1 * mu
+    double a, b, c, d;                // 1'Sigma^-1 1, 1'Sigma^-1 mu, mu'Sigma^-1 mu, ac - b^2
+
+    void prepare();
+    Portfolio combine(double onesWeight, double meanWeight) const;
+};
+
+#endif
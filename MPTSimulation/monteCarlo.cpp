@@ -0,0 +1,192 @@
+#include "monteCarlo.hpp"
+#include "gemm.hpp"
+#include "philox.hpp"
+#include "threadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Scenario streams live in the top half of the stream space so they never collide with per-sample weight streams
+static constexpr uint64_t SCENARIO_STREAM = uint64_t(1) << 63;
+
+namespace {
+struct Sample {
+    size_t index = 0;
+    double expectedReturn = 0.0;
+    double volatility = INFINITY;
+    double sharpe = -INFINITY;
+};
+
+struct BatchPartial {
+    double sumReturn = 0.0;
+    double sumVolatility = 0.0;
+    double sumSharpe = 0.0;
+    Sample bestSharpe;
+    Sample minimumVolatility;
+};
+
+struct BatchScratch {
+    std::vector<double> normals, scenarios, weights, paths, returns, volatilities, sharpes;
+};
+}
+
+PortfolioMonteCarlo::PortfolioMonteCarlo(const ModernPortfolioTheory& model)
+    : PortfolioMonteCarlo(model.meanReturns, model.covariance, model.riskFree) {}
+
+PortfolioMonteCarlo::PortfolioMonteCarlo(const std::vector<double>& _meanReturns, const ConstMatrixView& covariance, double _riskFree)
+    : assets(_meanReturns.size()), meanReturns(_meanReturns), factor(covariance), riskFree(_riskFree) {
+    if(covariance.rows != assets) {
+        throw std::invalid_argument("Covariance matrix does not match the number of assets");
+    }
+}
+
+static void drawWeights(Philox4x32& rng, double* weights, size_t assets) {
+    double total = 0.0;
+    for(size_t i{}; i < assets; i += 2) {
+        double u0, u1;
+        rng.uniform2(u0, u1);
+        weights[i] = u0;
+        total += u0;
+        if(i + 1 < assets) {
+            weights[i + 1] = u1;
+            total += u1;
+        }
+    }
+    double inverse = 1.0 / total;
+    for(size_t i{}; i < assets; i++) {
+        weights[i] *= inverse;
+    }
+}
+
+std::vector<double> PortfolioMonteCarlo::sampleWeights(uint64_t seed, size_t index) const {
+    std::vector<double> weights(assets);
+    Philox4x32 rng(seed, index);
+    drawWeights(rng, weights.data(), assets);
+    return weights;
+}
+
+MonteCarloSummary PortfolioMonteCarlo::run(const MonteCarloConfig& config, const std::function<void(const MonteCarloBatch&)>& onBatch) const {
+    if(config.portfolios == 0 || config.batchSize == 0 || config.horizon < 2) {
+        throw std::invalid_argument("Monte Carlo needs at least one portfolio, a batch size and two periods");
+    }
+    const size_t n = assets, H = config.horizon, batchSize = config.batchSize;
+    const size_t batches = (config.portfolios + batchSize - 1) / batchSize;
+    std::vector<BatchPartial> partials(batches);
+
+    auto runBatch = [&](size_t batch) {
+        thread_local BatchScratch scratch;
+        size_t first = batch * batchSize;
+        size_t count = std::min(batchSize, config.portfolios - first);
+        scratch.normals.resize(H * n);
+        scratch.scenarios.resize(H * n);
+        scratch.weights.resize(count * n);
+        scratch.paths.resize(H * count);
+        scratch.returns.resize(count);
+        scratch.volatilities.resize(count);
+        scratch.sharpes.resize(count);
+
+        Philox4x32 scenarioRng(config.seed, SCENARIO_STREAM | batch);
+        for(size_t i{}; i < H * n; i += 2) {
+            double z0, z1;
+            scenarioRng.normal2(z0, z1);
+            scratch.normals[i] = z0;
+            if(i + 1 < H * n) {
+                scratch.normals[i + 1] = z1;
+            }
+        }
+        // scenarios = Z * L^T, then shift by the mean: every row is one correlated return vector
+        gemm(H, n, n, 1.0, scratch.normals.data(), n, 1, factor.L.data.data(), 1, n, 0.0, scratch.scenarios.data(), n);
+        for(size_t t{}; t < H; t++) {
+            double* row = scratch.scenarios.data() + t * n;
+            for(size_t i{}; i < n; i++) {
+                row[i] += meanReturns[i];
+            }
+        }
+        for(size_t p{}; p < count; p++) {
+            Philox4x32 weightRng(config.seed, first + p);
+            drawWeights(weightRng, scratch.weights.data() + p * n, n);
+        }
+        // paths(t, p) = scenario t applied to portfolio p
+        gemm(H, count, n, 1.0, scratch.scenarios.data(), n, 1, scratch.weights.data(), 1, n, 0.0, scratch.paths.data(), count);
+
+        // Two row-wise passes over the paths so the inner loops run across portfolios and vectorize
+        double* means = scratch.returns.data();
+        double* squares = scratch.volatilities.data();
+        std::fill(means, means + count, 0.0);
+        std::fill(squares, squares + count, 0.0);
+        for(size_t t{}; t < H; t++) {
+            const double* row = scratch.paths.data() + t * count;
+            for(size_t p{}; p < count; p++) {
+                means[p] += row[p];
+            }
+        }
+        for(size_t p{}; p < count; p++) {
+            means[p] /= double(H);
+        }
+        for(size_t t{}; t < H; t++) {
+            const double* row = scratch.paths.data() + t * count;
+            for(size_t p{}; p < count; p++) {
+                double deviation = row[p] - means[p];
+                squares[p] += deviation * deviation;
+            }
+        }
+
+        BatchPartial& partial = partials[batch];
+        for(size_t p{}; p < count; p++) {
+            double mean = means[p];
+            double volatility = std::sqrt(squares[p] / double(H - 1));
+            double sharpe = volatility > 0.0 ? (mean - riskFree) / volatility : 0.0;
+            scratch.volatilities[p] = volatility;
+            scratch.sharpes[p] = sharpe;
+
+            partial.sumReturn += mean;
+            partial.sumVolatility += volatility;
+            partial.sumSharpe += sharpe;
+            if(sharpe > partial.bestSharpe.sharpe) {
+                partial.bestSharpe = Sample{first + p, mean, volatility, sharpe};
+            }
+            if(volatility < partial.minimumVolatility.volatility) {
+                partial.minimumVolatility = Sample{first + p, mean, volatility, sharpe};
+            }
+        }
+        if(onBatch) {
+            onBatch(MonteCarloBatch{first, count, scratch.returns.data(), scratch.volatilities.data(), scratch.sharpes.data()});
+        }
+    };
+
+    ThreadPool::global().parallelFor(0, batches, 1, [&](size_t begin, size_t end) {
+        for(size_t batch{begin}; batch < end; batch++) {
+            runBatch(batch);
+        }
+    });
+
+    // Fixed batch order, so the floating point sums do not depend on scheduling
+    BatchPartial total;
+    for(const BatchPartial& partial : partials) {
+        total.sumReturn += partial.sumReturn;
+        total.sumVolatility += partial.sumVolatility;
+        total.sumSharpe += partial.sumSharpe;
+        if(partial.bestSharpe.sharpe > total.bestSharpe.sharpe) {
+            total.bestSharpe = partial.bestSharpe;
+        }
+        if(partial.minimumVolatility.volatility < total.minimumVolatility.volatility) {
+            total.minimumVolatility = partial.minimumVolatility;
+        }
+    }
+
+    MonteCarloSummary summary;
+    summary.count = config.portfolios;
+    summary.meanReturn = total.sumReturn / double(config.portfolios);
+    summary.meanVolatility = total.sumVolatility / double(config.portfolios);
+    summary.meanSharpe = total.sumSharpe / double(config.portfolios);
+    summary.bestSharpeIndex = total.bestSharpe.index;
+    summary.minimumVolatilityIndex = total.minimumVolatility.index;
+
+    // Only the two winners need weights, and the counter-based streams give them back from the index alone
+    auto rebuild = [&](const Sample& sample) {
+        return Portfolio{sample.expectedReturn, sample.volatility, sample.sharpe, sampleWeights(config.seed, sample.index)};
+    };
+    summary.bestSharpe = rebuild(total.bestSharpe);
+    summary.minimumVolatility = rebuild(total.minimumVolatility);
+    return summary;
+}
@@ -0,0 +1,65 @@
+#ifndef MONTECARLO_HPP
+#define MONTECARLO_HPP
+
+#include "ModernPortfolioTheory.hpp"
+#include "cholesky.hpp"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/*
+Random-weight portfolio search against simulated correlated return paths.
+
+Work is split into batches of batchSize long-only portfolios. Each batch draws horizon return scenarios
+r = mu + L z (L the Cholesky factor of the covariance) and scores all of its portfolios on those same
+paths with one GEMM, then reduces to a small partial summary. Nothing per-sample is kept.
+
+Randomness comes from Philox streams keyed on the seed: sample i's weights use stream i and batch b's
+scenarios use its own stream, and partials are combined in batch order. The result is therefore
+bit-identical for any thread count, and the weights of any sample can be regenerated from its index.
+*/
+struct MonteCarloConfig {
+    size_t portfolios = 1000000;
+    size_t horizon = 252;    // simulated return periods per batch
+    size_t batchSize = 256;  // path returns for a batch stay around L2 size at the default horizon
+    uint64_t seed = 42;
+};
+
+struct MonteCarloSummary {
+    size_t count;
+    double meanReturn;
+    double meanVolatility;
+    double meanSharpe;
+    size_t bestSharpeIndex;
+    size_t minimumVolatilityIndex;
+    Portfolio bestSharpe;
+    Portfolio minimumVolatility;
+};
+
+// Realised per-period statistics for the portfolios first .. first + count - 1.
+// Callbacks arrive from worker threads in no particular batch order.
+struct MonteCarloBatch {
+    size_t first;
+    size_t count;
+    const double* returns;
+    const double* volatilities;
+    const double* sharpes;
+};
+
+struct PortfolioMonteCarlo {
+public:
+    size_t assets;
+    std::vector<double> meanReturns;
+    CholeskyFactorization factor;
+    double riskFree;
+
+    explicit PortfolioMonteCarlo(const ModernPortfolioTheory& model);
+    PortfolioMonteCarlo(const std::vector<double>& _meanReturns, const ConstMatrixView& covariance, double _riskFree = 0.0);
+
+    MonteCarloSummary run(const MonteCarloConfig& config, const std::function<void(const MonteCarloBatch&)>& onBatch = {}) const;
+
+    // Long-only weights of sample index under seed, exactly as run() drew them
+    std::vector<double> sampleWeights(uint64_t seed, size_t index) const;
+};
+
+#endif
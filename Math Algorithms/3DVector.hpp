@@ -2,45 +2,124 @@
 #define VEC3D_HPP
 
 #include <array>
+#include <cmath>
 #include <iostream>
+#include <stdexcept>
 
-struct Vec3D {
-    std::array<double, 3> vec;
-
-    
-    Vec3D(const double& _x, const double& _y, const double& _z);
-    Vec3D();
-
-    
-    const double& x() const;
-    const double& y() const;
-    const double& z() const;
-    double& x();
-    double& y();
-    double& z();
-
-    
-    Vec3D operator+(const Vec3D& Addend) const;
-    Vec3D& operator+=(const Vec3D& Addend);
-    Vec3D operator-(const Vec3D& Subtrahend) const;
-    Vec3D& operator-=(const Vec3D& Subtrahend);
-    Vec3D operator*(const double& Factor) const;
-    Vec3D& operator*=(const double& Factor);
-    double operator*(const Vec3D& factor) const; // dot product
-    bool operator==(const Vec3D& other) const;
-    bool operator!=(const Vec3D& other) const;
-
-    
-    friend Vec3D operator*(const double& scalar, const Vec3D& vector);
-
-    // Methods
-    double magnitude() const;
-    Vec3D normal() const;
-    Vec3D cross(const Vec3D& Factor) const;
-    Vec3D proj(const Vec3D& B) const;
-    Vec3D reflect(const Vec3D& NormalVec) const;
-    double angleBetween(const Vec3D& B) const;
-    void print() const;
+/*
+Header-only 3D vector, generic over float and double.
+Everything is inline and constexpr where the math allows, so camera updates and
+geometry generation inline across translation units. Vec3D keeps the double version
+under its old name; Vec3F is the float version used on the GPU side.
+*/
+template<typename T>
+struct Vec3 {
+    std::array<T, 3> vec;
+
+    constexpr Vec3(T _x, T _y, T _z) : vec{_x, _y, _z} {}
+    constexpr Vec3() : vec{T(0), T(0), T(0)} {}
+    // Precision changes are explicit so float pipelines never widen by accident
+    template<typename U>
+    constexpr explicit Vec3(const Vec3<U>& other) : vec{T(other.vec[0]), T(other.vec[1]), T(other.vec[2])} {}
+
+    constexpr const T& x() const { return vec[0]; }
+    constexpr const T& y() const { return vec[1]; }
+    constexpr const T& z() const { return vec[2]; }
+    constexpr T& x() { return vec[0]; }
+    constexpr T& y() { return vec[1]; }
+    constexpr T& z() { return vec[2]; }
+
+    constexpr Vec3 operator+(const Vec3& Addend) const {
+        return Vec3(vec[0] + Addend.vec[0], vec[1] + Addend.vec[1], vec[2] + Addend.vec[2]);
+    }
+
+    constexpr Vec3& operator+=(const Vec3& Addend) {
+        vec[0] += Addend.vec[0];
+        vec[1] += Addend.vec[1];
+        vec[2] += Addend.vec[2];
+        return *this;
+    }
+
+    constexpr Vec3 operator-(const Vec3& Subtrahend) const {
+        return Vec3(vec[0] - Subtrahend.vec[0], vec[1] - Subtrahend.vec[1], vec[2] - Subtrahend.vec[2]);
+    }
+
+    constexpr Vec3& operator-=(const Vec3& Subtrahend) {
+        vec[0] -= Subtrahend.vec[0];
+        vec[1] -= Subtrahend.vec[1];
+        vec[2] -= Subtrahend.vec[2];
+        return *this;
+    }
+
+    constexpr Vec3 operator*(T Factor) const {
+        return Vec3(vec[0] * Factor, vec[1] * Factor, vec[2] * Factor);
+    }
+
+    constexpr Vec3& operator*=(T Factor) {
+        vec[0] *= Factor;
+        vec[1] *= Factor;
+        vec[2] *= Factor;
+        return *this;
+    }
+
+    // dot product
+    constexpr T operator*(const Vec3& factor) const {
+        return vec[0] * factor.vec[0] + vec[1] * factor.vec[1] + vec[2] * factor.vec[2];
+    }
+
+    // Hidden friend, so 2 * v converts the int instead of failing template deduction
+    friend constexpr Vec3 operator*(T scalar, const Vec3& vector) {
+        return vector * scalar;
+    }
+
+    constexpr bool operator==(const Vec3& other) const {
+        return vec[0] == other.vec[0] && vec[1] == other.vec[1] && vec[2] == other.vec[2];
+    }
+
+    constexpr bool operator!=(const Vec3& other) const {
+        return !(*this == other);
+    }
+
+    T magnitude() const {
+        return std::sqrt(vec[0]*vec[0] + vec[1]*vec[1] + vec[2]*vec[2]);
+    }
+
+    Vec3 normal() const {
+        T mag = magnitude();
+        if(mag < T(1e-10)) throw std::runtime_error("Cannot normalize zero vector (Division by 0)");
+        return (*this) * (T(1) / mag);
+    }
+
+    constexpr Vec3 cross(const Vec3& Factor) const {
+        return Vec3(
+            vec[1]*Factor.vec[2] - vec[2]*Factor.vec[1],
+            vec[2]*Factor.vec[0] - vec[0]*Factor.vec[2],
+            vec[0]*Factor.vec[1] - vec[1]*Factor.vec[0]
+        );
+    }
+
+    constexpr Vec3 proj(const Vec3& B) const {
+        T bSquared = B * B;
+        if(bSquared < T(1e-10)) throw std::runtime_error("Cannot proj onto zero vector (Division by 0)");
+        return ((*this * B) / bSquared) * B;
+    }
+
+    constexpr Vec3 reflect(const Vec3& NormalVec) const {
+        return *this - 2 * proj(NormalVec);
+    }
+
+    T angleBetween(const Vec3& B) const {
+        T mags = magnitude() * B.magnitude();
+        if(mags < T(1e-20)) throw std::runtime_error("Cannot compute angle with zero vector");
+        return std::acos((*this * B) / mags);
+    }
+
+    void print() const {
+        std::cout << "(" << vec[0] << ", " << vec[1] << ", " << vec[2] << ")" << std::endl;
+    }
 };
 
+using Vec3D = Vec3<double>;
+using Vec3F = Vec3<float>;
+
 #endif
@@ -0,0 +1,445 @@
+#include "bvh.hpp"
+#include "simdPack.hpp"
+#include "threadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+constexpr size_t BINS = 16;
+// Leaves exceed this only at MAX_DEPTH, and are made below it whenever SAH says splitting does not pay
+constexpr size_t MAX_LEAF = 8;
+// Bounds the traversal stacks; a branch this deep ends in one leaf holding whatever is left, however many
+constexpr size_t MAX_DEPTH = 64;
+constexpr uint32_t NO_HIT = std::numeric_limits<uint32_t>::max();
+// Rays or points per chunk once a batch is worth splitting across threads
+constexpr size_t QUERY_GRAIN = 1 << 10;
+
+struct TraceScene {
+    const BVH::Node* nodes;
+    const double *sx, *sy, *sz, *ex, *ey, *ez, *radius;
+};
+
+struct RayLanes {
+    const double *ox, *oy, *oz, *dx, *dy, *dz;
+};
+
+struct Box {
+    double lower[3] = {INFINITY, INFINITY, INFINITY};
+    double upper[3] = {-INFINITY, -INFINITY, -INFINITY};
+
+    void grow(const Box& other) {
+        for(size_t axis{}; axis < 3; axis++) {
+            lower[axis] = std::min(lower[axis], other.lower[axis]);
+            upper[axis] = std::max(upper[axis], other.upper[axis]);
+        }
+    }
+
+    void grow(const double* point) {
+        for(size_t axis{}; axis < 3; axis++) {
+            lower[axis] = std::min(lower[axis], point[axis]);
+            upper[axis] = std::max(upper[axis], point[axis]);
+        }
+    }
+
+    // Half the surface area, which is all SAH needs
+    double area() const {
+        double x = upper[0] - lower[0], y = upper[1] - lower[1], z = upper[2] - lower[2];
+        return x < 0 ? 0 : x * y + y * z + z * x;
+    }
+};
+
+Box capsuleBox(const Vec3D& start, const Vec3D& end, double radius) {
+    Box box;
+    for(size_t axis{}; axis < 3; axis++) {
+        box.lower[axis] = std::min(start.vec[axis], end.vec[axis]) - radius;
+        box.upper[axis] = std::max(start.vec[axis], end.vec[axis]) + radius;
+    }
+    return box;
+}
+
+// Ray parameter at which origin + t * direction comes closest to the segment from a to b (t >= 0),
+// or infinity when that closest approach is farther than the radius
+inline double rayCapsule(const Vec3D& origin, const Vec3D& direction, const Vec3D& a, const Vec3D& b, double radius) {
+    Vec3D segment = b - a, offset = origin - a;
+    double dd = direction * direction, ss = segment * segment, ds = direction * segment;
+    double od = direction * offset, os = segment * offset;
+    double t = 0, u = 0;
+    if(ss <= 0) {
+        t = std::max(0.0, -od / dd);
+    } else {
+        double denominator = dd * ss - ds * ds;
+        t = denominator > 0 ? std::max(0.0, (ds * os - od * ss) / denominator) : 0.0;
+        u = (ds * t + os) / ss;
+        if(u < 0) {
+            u = 0;
+            t = std::max(0.0, -od / dd);
+        } else if(u > 1) {
+            u = 1;
+            t = std::max(0.0, (ds - od) / dd);
+        }
+    }
+    Vec3D gap = origin + direction * t - (a + segment * u);
+    return gap * gap <= radius * radius ? t : INFINITY;
+}
+
+// Distance from a point to the capsule's surface, 0 inside it
+double pointCapsule(const Vec3D& point, const Vec3D& a, const Vec3D& b, double radius) {
+    Vec3D segment = b - a;
+    double ss = segment * segment;
+    double u = ss > 0 ? std::clamp(((point - a) * segment) / ss, 0.0, 1.0) : 0.0;
+    return std::max((point - (a + segment * u)).magnitude() - radius, 0.0);
+}
+
+double boxDistance(const BVH::Node& node, const Vec3D& point) {
+    double sum = 0;
+    for(size_t axis{}; axis < 3; axis++) {
+        double gap = std::max({node.lower[axis] - point.vec[axis], point.vec[axis] - node.upper[axis], 0.0});
+        sum += gap * gap;
+    }
+    return std::sqrt(sum);
+}
+
+void setBounds(BVH::Node& node, const Box& box) {
+    for(size_t axis{}; axis < 3; axis++) {
+        node.lower[axis] = box.lower[axis];
+        node.upper[axis] = box.upper[axis];
+    }
+}
+
+// A primitive as the builder sees it; the builder partitions these directly rather than indices
+// into separate arrays, so every pass over a range reads contiguous memory
+struct Reference {
+    Box box;
+    double centroid[3];
+    uint32_t primitive;
+};
+
+struct Builder {
+    std::vector<BVH::Node>& nodes;
+    std::vector<Reference>& references;
+
+    static size_t bin(double centroid, double lower, double scale) {
+        return std::min(BINS - 1, size_t((centroid - lower) * scale));
+    }
+
+    void build(size_t begin, size_t end, size_t depth) {
+        const size_t index = nodes.size();
+        nodes.emplace_back();
+        Box bounds, centroidBounds;
+        for(size_t k{begin}; k < end; k++) {
+            bounds.grow(references[k].box);
+            centroidBounds.grow(references[k].centroid);
+        }
+        setBounds(nodes[index], bounds);
+        const size_t count = end - begin;
+        auto makeLeaf = [&] {
+            nodes[index].offset = uint32_t(begin);
+            nodes[index].count = uint32_t(count);
+            nodes[index].axis = 0;
+        };
+        if(count <= 2 || depth + 1 >= MAX_DEPTH) {
+            makeLeaf();
+            return;
+        }
+
+        // Binned SAH over all three axes in one pass: cost of a split is area * count summed over both sides
+        double scale[3];
+        for(size_t axis{}; axis < 3; axis++) {
+            double extent = centroidBounds.upper[axis] - centroidBounds.lower[axis];
+            scale[axis] = extent > 0 ? double(BINS) / extent : 0.0;
+        }
+        Box binBounds[3][BINS];
+        size_t binCount[3][BINS] = {};
+        for(size_t k{begin}; k < end; k++) {
+            const Reference& reference = references[k];
+            for(size_t axis{}; axis < 3; axis++) {
+                size_t b = bin(reference.centroid[axis], centroidBounds.lower[axis], scale[axis]);
+                binBounds[axis][b].grow(reference.box);
+                binCount[axis][b]++;
+            }
+        }
+        double bestCost = INFINITY;
+        size_t bestAxis = 0, bestSplit = 0;
+        for(size_t axis{}; axis < 3; axis++) {
+            if(scale[axis] == 0) {
+                continue;
+            }
+            // Costs of the right-hand sides, swept from the top
+            double rightCost[BINS] = {};
+            Box right;
+            size_t rightCount = 0;
+            for(size_t split{BINS - 1}; split > 0; split--) {
+                right.grow(binBounds[axis][split]);
+                rightCount += binCount[axis][split];
+                rightCost[split] = rightCount ? right.area() * double(rightCount) : INFINITY;
+            }
+            Box left;
+            size_t leftCount = 0;
+            for(size_t split{1}; split < BINS; split++) {
+                left.grow(binBounds[axis][split - 1]);
+                leftCount += binCount[axis][split - 1];
+                double cost = leftCount ? left.area() * double(leftCount) + rightCost[split] : INFINITY;
+                if(cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = split;
+                }
+            }
+        }
+
+        size_t middle;
+        if(bestCost == INFINITY) {
+            // Every centroid coincides; any halving is as good as another
+            if(count <= MAX_LEAF) {
+                makeLeaf();
+                return;
+            }
+            middle = begin + count / 2;
+        } else {
+            // Splitting costs one box test per ray on top of the children's work
+            if(count <= MAX_LEAF && bestCost >= bounds.area() * (double(count) - 1.0)) {
+                makeLeaf();
+                return;
+            }
+            double lower = centroidBounds.lower[bestAxis];
+            middle = size_t(std::partition(references.begin() + begin, references.begin() + end,
+                                           [&](const Reference& reference) {
+                                               return bin(reference.centroid[bestAxis], lower, scale[bestAxis]) < bestSplit;
+                                           }) -
+                            references.begin());
+        }
+        nodes[index].axis = uint32_t(bestAxis);
+        nodes[index].count = 0;
+        build(begin, middle, depth + 1);
+        nodes[index].offset = uint32_t(nodes.size());
+        build(middle, end, depth + 1);
+    }
+};
+
+namespace scalarKernels {
+using Pack = simd::Scalar;
+#include "bvhKernels.inl"
+}
+
+#if QUANT_X86_DISPATCH
+QUANT_BEGIN_TARGET_AVX2
+namespace avx2Kernels {
+using Pack = simd::AVX2;
+#include "bvhKernels.inl"
+}
+QUANT_END_TARGET
+
+QUANT_BEGIN_TARGET_AVX512
+namespace avx512Kernels {
+using Pack = simd::AVX512;
+#include "bvhKernels.inl"
+}
+QUANT_END_TARGET
+
+#define DISPATCH(KERNEL, ...) \
+    (activeSimdLevel() == SimdLevel::AVX512 ? avx512Kernels::KERNEL(__VA_ARGS__) \
+     : activeSimdLevel() == SimdLevel::AVX2 ? avx2Kernels::KERNEL(__VA_ARGS__) \
+     : scalarKernels::KERNEL(__VA_ARGS__))
+#else
+#define DISPATCH(KERNEL, ...) scalarKernels::KERNEL(__VA_ARGS__)
+#endif
+
+} // namespace
+
+size_t BVH::addPoint(const Vec3D& point, double _radius) {
+    return addSegment(point, point, _radius);
+}
+
+size_t BVH::addSegment(const Vec3D& _start, const Vec3D& _end, double _radius) {
+    if(!(_radius >= 0)) {
+        throw std::invalid_argument("BVH primitive radius must not be negative");
+    }
+    if(size() >= NO_HIT) {
+        throw std::length_error("BVH supports at most 2^32 - 1 primitives");
+    }
+    start.push_back(_start);
+    end.push_back(_end);
+    radius.push_back(_radius);
+    built = false;
+    return size() - 1;
+}
+
+void BVH::setPoint(size_t index, const Vec3D& point) {
+    setSegment(index, point, point);
+}
+
+void BVH::setSegment(size_t index, const Vec3D& _start, const Vec3D& _end) {
+    start.set(index, _start);
+    end.set(index, _end);
+}
+
+void BVH::checkBuilt() const {
+    if(!built) {
+        throw std::logic_error("BVH must be built after primitives are added");
+    }
+}
+
+void BVH::gatherOrdered() {
+    const size_t n = size();
+    orderedStart.resize(n);
+    orderedEnd.resize(n);
+    orderedRadius.resize(n);
+    parallelChunks(n, QUERY_GRAIN * 16, [&](size_t begin, size_t stop) {
+        for(size_t k{begin}; k < stop; k++) {
+            uint32_t i = order[k];
+            orderedStart.x[k] = start.x[i];
+            orderedStart.y[k] = start.y[i];
+            orderedStart.z[k] = start.z[i];
+            orderedEnd.x[k] = end.x[i];
+            orderedEnd.y[k] = end.y[i];
+            orderedEnd.z[k] = end.z[i];
+            orderedRadius[k] = radius[i];
+        }
+    });
+}
+
+void BVH::build() {
+    const size_t n = size();
+    nodes.clear();
+    order.resize(n);
+    if(n > 0) {
+        std::vector<Reference> references(n);
+        parallelChunks(n, QUERY_GRAIN * 16, [&](size_t begin, size_t stop) {
+            for(size_t i{begin}; i < stop; i++) {
+                Reference& reference = references[i];
+                reference.box = capsuleBox(start.get(i), end.get(i), radius[i]);
+                for(size_t axis{}; axis < 3; axis++) {
+                    reference.centroid[axis] = 0.5 * (reference.box.lower[axis] + reference.box.upper[axis]);
+                }
+                reference.primitive = uint32_t(i);
+            }
+        });
+        nodes.reserve(2 * n);
+        Builder{nodes, references}.build(0, n, 0);
+        for(size_t k{}; k < n; k++) {
+            order[k] = references[k].primitive;
+        }
+    }
+    gatherOrdered();
+    built = true;
+}
+
+void BVH::refit() {
+    checkBuilt();
+    gatherOrdered();
+    // Children always follow their parent, so a reverse sweep sees them first
+    for(size_t index{nodes.size()}; index-- > 0;) {
+        Node& node = nodes[index];
+        Box box;
+        if(node.count > 0) {
+            for(size_t k{node.offset}; k < node.offset + node.count; k++) {
+                box.grow(capsuleBox(orderedStart.get(k), orderedEnd.get(k), orderedRadius[k]));
+            }
+        } else {
+            for(const Node* child : {&nodes[index + 1], &nodes[node.offset]}) {
+                for(size_t axis{}; axis < 3; axis++) {
+                    box.lower[axis] = std::min(box.lower[axis], child->lower[axis]);
+                    box.upper[axis] = std::max(box.upper[axis], child->upper[axis]);
+                }
+            }
+        }
+        setBounds(node, box);
+    }
+}
+
+BVHHit BVH::intersect(const Vec3D& origin, const Vec3D& direction, double maxDistance) const {
+    checkBuilt();
+    if(direction * direction == 0) {
+        throw std::invalid_argument("Ray direction must not be zero");
+    }
+    TraceScene scene{nodes.empty() ? nullptr : nodes.data(),
+                     orderedStart.x.data(), orderedStart.y.data(), orderedStart.z.data(),
+                     orderedEnd.x.data(), orderedEnd.y.data(), orderedEnd.z.data(), orderedRadius.data()};
+    RayLanes ray{&origin.vec[0], &origin.vec[1], &origin.vec[2], &direction.vec[0], &direction.vec[1], &direction.vec[2]};
+    double best = maxDistance;
+    uint32_t hit = NO_HIT;
+    scalarKernels::trace(scene, ray, 1, &best, &hit);
+    return hit == NO_HIT ? BVHHit() : BVHHit{order[hit], best};
+}
+
+void BVH::intersect(const Vec3DBatch& origins, const Vec3DBatch& directions, std::vector<BVHHit>& hits, double maxDistance) const {
+    checkBuilt();
+    if(origins.size() != directions.size()) {
+        throw std::invalid_argument("Ray origins and directions do not have the same size");
+    }
+    const size_t n = origins.size();
+    for(size_t k{}; k < n; k++) {
+        if(directions.x[k] == 0 && directions.y[k] == 0 && directions.z[k] == 0) {
+            throw std::invalid_argument("Ray direction must not be zero");
+        }
+    }
+    hits.resize(n);
+    TraceScene scene{nodes.empty() ? nullptr : nodes.data(),
+                     orderedStart.x.data(), orderedStart.y.data(), orderedStart.z.data(),
+                     orderedEnd.x.data(), orderedEnd.y.data(), orderedEnd.z.data(), orderedRadius.data()};
+    parallelChunks(n, QUERY_GRAIN, [&](size_t begin, size_t stop) {
+        std::vector<double> best(stop - begin, maxDistance);
+        std::vector<uint32_t> hit(stop - begin, NO_HIT);
+        RayLanes rays{origins.x.data() + begin, origins.y.data() + begin, origins.z.data() + begin,
+                      directions.x.data() + begin, directions.y.data() + begin, directions.z.data() + begin};
+        DISPATCH(trace, scene, rays, stop - begin, best.data(), hit.data());
+        for(size_t k{}; k < stop - begin; k++) {
+            hits[begin + k] = hit[k] == NO_HIT ? BVHHit() : BVHHit{order[hit[k]], best[k]};
+        }
+    });
+}
+
+bool BVH::occluded(const Vec3D& from, const Vec3D& to) const {
+    if(from == to) {
+        return false;
+    }
+    return intersect(from, to - from, 1.0).hit();
+}
+
+BVHHit BVH::nearest(const Vec3D& point, double maxDistance) const {
+    checkBuilt();
+    BVHHit best;
+    best.distance = maxDistance;
+    if(nodes.empty()) {
+        return best;
+    }
+    uint32_t stack[MAX_DEPTH + 2];
+    size_t depth = 0;
+    stack[depth++] = 0;
+    while(depth > 0) {
+        const Node& node = nodes[stack[--depth]];
+        if(boxDistance(node, point) >= best.distance) {
+            continue;
+        }
+        if(node.count > 0) {
+            for(size_t k{node.offset}; k < node.offset + node.count; k++) {
+                double distance = pointCapsule(point, orderedStart.get(k), orderedEnd.get(k), orderedRadius[k]);
+                if(distance < best.distance) {
+                    best = BVHHit{order[k], distance};
+                }
+            }
+            continue;
+        }
+        // Push the farther child first so the nearer one is searched first and tightens the bound
+        uint32_t closer = uint32_t(&node - nodes.data()) + 1, farther = node.offset;
+        if(boxDistance(nodes[closer], point) > boxDistance(nodes[farther], point)) {
+            std::swap(closer, farther);
+        }
+        stack[depth++] = farther;
+        stack[depth++] = closer;
+    }
+    return best;
+}
+
+void BVH::nearest(const Vec3DBatch& points, std::vector<BVHHit>& hits, double maxDistance) const {
+    checkBuilt();
+    hits.resize(points.size());
+    parallelChunks(points.size(), QUERY_GRAIN, [&](size_t begin, size_t stop) {
+        for(size_t i{begin}; i < stop; i++) {
+            hits[i] = nearest(points.get(i), maxDistance);
+        }
+    });
+}
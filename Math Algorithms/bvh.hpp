@@ -0,0 +1,88 @@
+#ifndef BVH_HPP
+#define BVH_HPP
+
+#include "vec3DBatch.hpp"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/*
+Bounding volume hierarchy over points and segments, for ray casts and nearest-neighbour queries.
+
+Every primitive is a segment from start to end with a radius (a point is a segment of zero length),
+so it is really a capsule, and its box is the segment's box grown by the radius. A ray hits a
+primitive when it passes within the radius, and the hit is reported at the ray parameter t of
+closest approach (the hit point is origin + t * direction). That is the test for picking thin
+geometry like drawn vectors; give points and segments a pick radius or rays will miss them.
+
+build() splits with the surface area heuristic, evaluated over 16 centroid bins per axis. Nodes are
+64 bytes, one cache line, and stored depth first so a left child directly follows its parent; leaf
+primitives are copied into leaf order so a leaf reads one contiguous run. Leaves hold at most 8
+primitives, except that the tree stops at depth 64: a branch that deep, which takes primitives
+bunched ever more tightly toward one spot, ends in a single larger leaf and queries scan all of it.
+
+Moving primitives with setPoint/setSegment and calling refit() updates the boxes bottom up without
+changing the tree, which is O(n) and fine while objects move locally; call build() again once the
+motion has scrambled the scene, as a refitted tree only gets looser.
+
+The batched ray query traces packets of 4 (AVX2) or 8 (AVX-512) rays through the tree together,
+testing one node box against the whole packet per step. Packets work best when neighbouring rays
+are coherent, such as a camera's pixel grid. Batches are split across the thread pool.
+*/
+struct BVHHit {
+public:
+    static constexpr size_t NONE = std::numeric_limits<size_t>::max();
+    // Index of the primitive as returned by addPoint/addSegment, or NONE
+    size_t primitive = NONE;
+    // Ray parameter for ray queries, distance for nearest queries
+    double distance = std::numeric_limits<double>::infinity();
+
+    bool hit() const { return primitive != NONE; }
+};
+
+struct BVH {
+public:
+    size_t addPoint(const Vec3D& point, double radius = 0);
+    size_t addSegment(const Vec3D& start, const Vec3D& end, double radius = 0);
+    void setPoint(size_t index, const Vec3D& point);
+    void setSegment(size_t index, const Vec3D& start, const Vec3D& end);
+    size_t size() const { return radius.size(); }
+
+    void build();
+    void refit();
+    size_t nodeCount() const { return nodes.size(); }
+
+    BVHHit intersect(const Vec3D& origin, const Vec3D& direction, double maxDistance = std::numeric_limits<double>::infinity()) const;
+    void intersect(const Vec3DBatch& origins, const Vec3DBatch& directions, std::vector<BVHHit>& hits,
+                   double maxDistance = std::numeric_limits<double>::infinity()) const;
+    // Whether any primitive lies on the segment between the two points
+    bool occluded(const Vec3D& from, const Vec3D& to) const;
+
+    BVHHit nearest(const Vec3D& point, double maxDistance = std::numeric_limits<double>::infinity()) const;
+    void nearest(const Vec3DBatch& points, std::vector<BVHHit>& hits, double maxDistance = std::numeric_limits<double>::infinity()) const;
+
+    // Packed node: interior when count is 0, with the right child at offset (the left child is next);
+    // a leaf otherwise, holding count primitives from offset in leaf order
+    struct alignas(64) Node {
+    public:
+        double lower[3], upper[3];
+        uint32_t offset, count;
+        // Split axis, so traversal can visit the nearer child first
+        uint32_t axis;
+    };
+
+private:
+    Vec3DBatch start, end;
+    std::vector<double> radius;
+    std::vector<Node> nodes;
+    // Primitives in leaf order, and the original index of each
+    Vec3DBatch orderedStart, orderedEnd;
+    std::vector<double> orderedRadius;
+    std::vector<uint32_t> order;
+    bool built = false;
+
+    void gatherOrdered();
+    void checkBuilt() const;
+};
+
+#endif
@@ -0,0 +1,85 @@
+// Packet ray traversal, included by bvh.cpp once per instruction set with Pack bound to a
+// simd:: register type. A packet of Pack::width rays walks the tree together: each node box is
+// slab-tested against every ray in one pass, and leaves test their primitives ray by ray.
+
+template<typename P>
+static void tracePacket(const TraceScene& scene, RayLanes rays, size_t first, double* best, uint32_t* hit) {
+    using Reg = typename P::Reg;
+    constexpr size_t W = P::width;
+    Reg origin[3] = {P::load(rays.ox + first), P::load(rays.oy + first), P::load(rays.oz + first)};
+    // Parallel rays get a huge finite slope instead of infinity, which would turn 0 * inf into NaN
+    double inverse[3][W];
+    const double* direction[3] = {rays.dx + first, rays.dy + first, rays.dz + first};
+    for(size_t axis{}; axis < 3; axis++) {
+        for(size_t lane{}; lane < W; lane++) {
+            double d = direction[axis][lane];
+            inverse[axis][lane] = d == 0 ? 1e300 : 1.0 / d;
+        }
+    }
+    Reg slope[3] = {P::load(inverse[0]), P::load(inverse[1]), P::load(inverse[2])};
+    Reg limit = P::load(best + first);
+    const Reg zero = P::set1(0.0);
+
+    uint32_t stack[MAX_DEPTH + 2];
+    size_t depth = 0;
+    uint32_t current = 0;
+    double entries[W], exits[W];
+    while(true) {
+        const BVH::Node& node = scene.nodes[current];
+        Reg tNear = zero, tFar = limit;
+        for(size_t axis{}; axis < 3; axis++) {
+            Reg t0 = P::mul(P::sub(P::set1(node.lower[axis]), origin[axis]), slope[axis]);
+            Reg t1 = P::mul(P::sub(P::set1(node.upper[axis]), origin[axis]), slope[axis]);
+            tNear = P::max(tNear, P::min(t0, t1));
+            tFar = P::min(tFar, P::max(t0, t1));
+        }
+        if(P::anyLess(tNear, tFar)) {
+            if(node.count == 0) {
+                // Nearer child first, judged by the packet's first ray
+                uint32_t left = current + 1, right = node.offset;
+                if(direction[node.axis][0] < 0) {
+                    std::swap(left, right);
+                }
+                stack[depth++] = right;
+                current = left;
+                continue;
+            }
+            P::store(entries, tNear);
+            P::store(exits, tFar);
+            for(size_t lane{}; lane < W; lane++) {
+                if(!(entries[lane] < exits[lane])) {
+                    continue;
+                }
+                size_t ray = first + lane;
+                Vec3D o(rays.ox[ray], rays.oy[ray], rays.oz[ray]);
+                Vec3D d(rays.dx[ray], rays.dy[ray], rays.dz[ray]);
+                for(size_t k{node.offset}; k < node.offset + node.count; k++) {
+                    double t = rayCapsule(o, d, Vec3D(scene.sx[k], scene.sy[k], scene.sz[k]),
+                                          Vec3D(scene.ex[k], scene.ey[k], scene.ez[k]), scene.radius[k]);
+                    if(t < best[ray]) {
+                        best[ray] = t;
+                        hit[ray] = uint32_t(k);
+                    }
+                }
+            }
+            limit = P::load(best + first);
+        }
+        if(depth == 0) {
+            break;
+        }
+        current = stack[--depth];
+    }
+}
+
+static void trace(const TraceScene& scene, RayLanes rays, size_t count, double* best, uint32_t* hit) {
+    if(scene.nodes == nullptr) {
+        return;
+    }
+    size_t i = 0;
+    for(; i + Pack::width <= count; i += Pack::width) {
+        tracePacket<Pack>(scene, rays, i, best, hit);
+    }
+    for(; i < count; i++) {
+        tracePacket<simd::Scalar>(scene, rays, i, best, hit);
+    }
+}
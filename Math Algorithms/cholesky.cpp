@@ -0,0 +1,207 @@
+#include "cholesky.hpp"
+#include "gemm.hpp"
+#include "threadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+static constexpr size_t BLOCK = 64;
+static constexpr size_t PARALLEL_GRAIN = 1 << 14;
+
+CholeskyFactorization::CholeskyFactorization(const ConstMatrixView& A) : n(A.rows), L(A) {
+    if(A.rows != A.columns) {
+        throw std::invalid_argument("You need a square matrix for Cholesky factorization");
+    }
+    factor();
+}
+
+CholeskyFactorization::CholeskyFactorization(Matrix&& A) : n(A.rows), L(std::move(A)) {
+    if(L.rows != L.columns) {
+        throw std::invalid_argument("You need a square matrix for Cholesky factorization");
+    }
+    factor();
+}
+
+void CholeskyFactorization::factor() {
+    double* l = L.data.data();
+    for(size_t k0{}; k0 < n; k0 += BLOCK) {
+        size_t kb = std::min(BLOCK, n - k0);
+        size_t panelEnd = k0 + kb;
+
+        // Diagonal block, row-oriented (Cholesky-Banachiewicz) so each row only reads the rows above it
+        for(size_t i{k0}; i < panelEnd; i++) {
+            double* rowI = l + i * n;
+            for(size_t j{k0}; j < i; j++) {
+                const double* rowJ = l + j * n;
+                double sum = rowI[j];
+                for(size_t k{k0}; k < j; k++) {
+                    sum -= rowI[k] * rowJ[k];
+                }
+                rowI[j] = sum / rowJ[j];
+            }
+            double diagonal = rowI[i];
+            for(size_t k{k0}; k < i; k++) {
+                diagonal -= rowI[k] * rowI[k];
+            }
+            if(!(diagonal > 0.0)) {
+                throw std::runtime_error("Matrix is not positive definite");
+            }
+            rowI[i] = std::sqrt(diagonal);
+        }
+        if(panelEnd == n) {
+            break;
+        }
+
+        // L21 = A21 * L11^-T: every row below the block is an independent forward substitution
+        size_t trailing = n - panelEnd;
+        parallelChunks(trailing, std::max<size_t>(1, PARALLEL_GRAIN / (kb * kb)), [&](size_t begin, size_t end) {
+            for(size_t i{panelEnd + begin}; i < panelEnd + end; i++) {
+                double* row = l + i * n;
+                for(size_t j{k0}; j < panelEnd; j++) {
+                    const double* rowJ = l + j * n;
+                    double sum = row[j];
+                    for(size_t k{k0}; k < j; k++) {
+                        sum -= row[k] * rowJ[k];
+                    }
+                    row[j] = sum / rowJ[j];
+                }
+            }
+        });
+
+        // A22 -= L21 * L21^T on the lower triangle only, one block row per task
+        size_t blockRows = (trailing + BLOCK - 1) / BLOCK;
+        parallelChunks(blockRows, 1, [&](size_t first, size_t last) {
+            for(size_t block{first}; block < last; block++) {
+                size_t r0 = panelEnd + block * BLOCK;
+                size_t rows = std::min(BLOCK, n - r0);
+                size_t cols = r0 + rows - panelEnd;
+                gemm(rows, cols, kb, -1.0,
+                     l + r0 * n + k0, n, 1,
+                     l + panelEnd * n + k0, 1, n,
+                     1.0, l + r0 * n + panelEnd, n);
+            }
+        });
+    }
+    // The blocked updates leave junk above the diagonal; L is lower triangular
+    for(size_t i{}; i < n; i++) {
+        std::fill(l + i * n + i + 1, l + i * n + n, 0.0);
+    }
+}
+
+std::vector<double> CholeskyFactorization::solve(const std::vector<double>& b) const {
+    if(b.size() != n) {
+        throw std::invalid_argument("Right hand side does not match the matrix size");
+    }
+    std::vector<double> x = b;
+    for(size_t i{}; i < n; i++) {
+        const double* row = &L.unchecked(i, 0);
+        double sum = x[i];
+        for(size_t k{}; k < i; k++) {
+            sum -= row[k] * x[k];
+        }
+        x[i] = sum / row[i];
+    }
+    for(size_t i = n; i-- > 0;) {
+        double sum = x[i];
+        for(size_t k{i + 1}; k < n; k++) {
+            sum -= L.unchecked(k, i) * x[k];
+        }
+        x[i] = sum / L.unchecked(i, i);
+    }
+    return x;
+}
+
+Matrix CholeskyFactorization::solve(const ConstMatrixView& B) const {
+    if(B.rows != n) {
+        throw std::invalid_argument("Right hand side does not have the same number of rows as the system");
+    }
+    Matrix X = B;
+    size_t m = X.columns;
+    double* x = X.data.data();
+    const double* l = L.data.data();
+    parallelChunks(m, std::max<size_t>(1, PARALLEL_GRAIN / std::max<size_t>(n, 1)), [&](size_t c0, size_t c1) {
+        // L Y = B, then L^T X = Y; L^T's rows are L's columns, so the back sweep scatters instead of gathering
+        for(size_t i{}; i < n; i++) {
+            double* row = x + i * m;
+            for(size_t j{}; j < i; j++) {
+                double factor = l[i * n + j];
+                const double* source = x + j * m;
+                for(size_t c{c0}; c < c1; c++) {
+                    row[c] -= factor * source[c];
+                }
+            }
+            double inverse = 1.0 / l[i * n + i];
+            for(size_t c{c0}; c < c1; c++) {
+                row[c] *= inverse;
+            }
+        }
+        for(size_t i{n}; i-- > 0;) {
+            double* row = x + i * m;
+            double inverse = 1.0 / l[i * n + i];
+            for(size_t c{c0}; c < c1; c++) {
+                row[c] *= inverse;
+            }
+            for(size_t j{}; j < i; j++) {
+                double factor = l[i * n + j];
+                double* target = x + j * m;
+                for(size_t c{c0}; c < c1; c++) {
+                    target[c] -= factor * row[c];
+                }
+            }
+        }
+    });
+    return X;
+}
+
+double CholeskyFactorization::det() const {
+    double product = 1.0;
+    for(size_t i{}; i < n; i++) {
+        product *= L.unchecked(i, i);
+    }
+    return product * product;
+}
+
+// Givens-style sweep down the columns: each step folds x_k into the diagonal and carries the rest of x along
+void CholeskyFactorization::rankOneUpdate(std::vector<double> x) {
+    if(x.size() != n) {
+        throw std::invalid_argument("Update vector does not match the matrix size");
+    }
+    double* l = L.data.data();
+    for(size_t k{}; k < n; k++) {
+        double diagonal = l[k * n + k];
+        double r = std::hypot(diagonal, x[k]);
+        double c = r / diagonal, s = x[k] / diagonal;
+        l[k * n + k] = r;
+        for(size_t i{k + 1}; i < n; i++) {
+            double& entry = l[i * n + k];
+            entry = (entry + s * x[i]) / c;
+            x[i] = c * x[i] - s * entry;
+        }
+    }
+}
+
+void CholeskyFactorization::rankOneDowndate(std::vector<double> x) {
+    if(x.size() != n) {
+        throw std::invalid_argument("Downdate vector does not match the matrix size");
+    }
+    // Work on a copy of L so a failed downdate does not leave a half-modified factor behind
+    Matrix updated = L;
+    double* l = updated.data.data();
+    for(size_t k{}; k < n; k++) {
+        double diagonal = l[k * n + k];
+        double squared = (diagonal - x[k]) * (diagonal + x[k]);
+        if(!(squared > 0.0)) {
+            throw std::runtime_error("Matrix is not positive definite");
+        }
+        double r = std::sqrt(squared);
+        double c = r / diagonal, s = x[k] / diagonal;
+        l[k * n + k] = r;
+        for(size_t i{k + 1}; i < n; i++) {
+            double& entry = l[i * n + k];
+            entry = (entry - s * x[i]) / c;
+            x[i] = c * x[i] - s * entry;
+        }
+    }
+    L = std::move(updated);
+}
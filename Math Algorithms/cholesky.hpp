@@ -0,0 +1,38 @@
+#ifndef CHOLESKY_HPP
+#define CHOLESKY_HPP
+
+#include "matrix.hpp"
+#include <vector>
+
+/*
+A = L * L^T for symmetric positive definite A. Only the lower triangle of A is read.
+L is stored as a full matrix with zeros above the diagonal so it can be used directly in products.
+Throws if A is not positive definite.
+
+Right-looking and blocked like LUFactorization: a 64-wide diagonal block is factored directly,
+the panel under it is a row-parallel triangular solve, and the trailing lower triangle is updated
+one block row at a time with GEMM.
+*/
+struct CholeskyFactorization {
+public:
+    size_t n;
+    Matrix L;
+
+    explicit CholeskyFactorization(const ConstMatrixView& A);
+    // Factors in A's own storage, no copy
+    explicit CholeskyFactorization(Matrix&& A);
+
+    std::vector<double> solve(const std::vector<double>& b) const;
+    Matrix solve(const ConstMatrixView& B) const;
+    double det() const;
+
+    // Refactor A + x x^T or A - x x^T in O(n^2) from the current L. A downdate that would leave
+    // the matrix indefinite throws and leaves L unchanged.
+    void rankOneUpdate(std::vector<double> x);
+    void rankOneDowndate(std::vector<double> x);
+
+private:
+    void factor();
+};
+
+#endif
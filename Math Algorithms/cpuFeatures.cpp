@@ -0,0 +1,40 @@
+#include "cpuFeatures.hpp"
+#include <atomic>
+
+SimdLevel detectSimdLevel() {
+#if QUANT_X86_DISPATCH
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) {
+        return SimdLevel::AVX512;
+    }
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return SimdLevel::AVX2;
+    }
+#endif
+    return SimdLevel::Scalar;
+}
+
+static std::atomic<int>& simdLevelStorage() {
+    static std::atomic<int> level{static_cast<int>(detectSimdLevel())};
+    return level;
+}
+
+SimdLevel activeSimdLevel() {
+    return static_cast<SimdLevel>(simdLevelStorage().load(std::memory_order_relaxed));
+}
+
+void setSimdLevel(SimdLevel level) {
+    SimdLevel supported = detectSimdLevel();
+    if(static_cast<int>(level) > static_cast<int>(supported)) {
+        level = supported;
+    }
+    simdLevelStorage().store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch(level) {
+        case SimdLevel::AVX512: return "AVX-512";
+        case SimdLevel::AVX2: return "AVX2";
+        default: return "Scalar";
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef CPUFEATURES_HPP
+#define CPUFEATURES_HPP
+
+/*
+Runtime CPU feature detection.
+Kernels are compiled for every instruction set in one binary and the widest one
+the running CPU supports is picked the first time it is needed.
+*/
+
+enum class SimdLevel {
+    Scalar,
+    AVX2,
+    AVX512
+};
+
+SimdLevel detectSimdLevel();
+
+// Level used by the dispatched kernels. Defaults to detectSimdLevel(), can be
+// lowered (never raised above what the CPU supports) for testing and benchmarking.
+SimdLevel activeSimdLevel();
+void setSimdLevel(SimdLevel level);
+
+const char* simdLevelName(SimdLevel level);
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define QUANT_X86_DISPATCH 1
+#define QUANT_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define QUANT_TARGET_AVX512 __attribute__((target("avx512f,avx512dq,avx2,fma")))
+#else
+#define QUANT_X86_DISPATCH 0
+#endif
+
+#define QUANT_ALWAYS_INLINE inline __attribute__((always_inline))
+
+// Every function defined between BEGIN and END is compiled for that instruction set.
+// Used to build one shared kernel source (an .inl) once per ISA in the same translation unit.
+#if QUANT_X86_DISPATCH && defined(__clang__)
+#define QUANT_BEGIN_TARGET_AVX2 _Pragma("clang attribute push(__attribute__((target(\"avx2,fma\"))), apply_to = function)")
+#define QUANT_BEGIN_TARGET_AVX512 _Pragma("clang attribute push(__attribute__((target(\"avx512f,avx512dq,avx2,fma\"))), apply_to = function)")
+#define QUANT_END_TARGET _Pragma("clang attribute pop")
+#elif QUANT_X86_DISPATCH
+#define QUANT_BEGIN_TARGET_AVX2 _Pragma("GCC push_options") _Pragma("GCC target(\"avx2,fma\")")
+#define QUANT_BEGIN_TARGET_AVX512 _Pragma("GCC push_options") _Pragma("GCC target(\"avx512f,avx512dq,avx2,fma\")")
+#define QUANT_END_TARGET _Pragma("GCC pop_options")
+#endif
+
+#endif
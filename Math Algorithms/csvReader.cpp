@@ -0,0 +1,452 @@
+#include "csvReader.hpp"
+#include "mappedFile.hpp"
+#include "threadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+static constexpr size_t CHUNK_BYTES = 4 << 20;
+static constexpr double NOT_A_NUMBER = std::numeric_limits<double>::quiet_NaN();
+
+namespace {
+// Bit i of each mask set when p[i] is the delimiter, a newline or a double quote; p must have 64 readable bytes
+struct ByteClasses {
+    uint64_t separators = 0, newlines = 0, quotes = 0;
+};
+
+inline ByteClasses classify(const char* p, char delimiter) {
+    ByteClasses classes;
+#ifdef __SSE2__
+    const __m128i delim = _mm_set1_epi8(delimiter);
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i quote = _mm_set1_epi8('"');
+    for(int block{}; block < 4; block++) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * block));
+        classes.separators |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, delim)))) << (16 * block);
+        classes.newlines |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)))) << (16 * block);
+        classes.quotes |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, quote)))) << (16 * block);
+    }
+#else
+    for(int i{}; i < 64; i++) {
+        classes.separators |= uint64_t(p[i] == delimiter) << i;
+        classes.newlines |= uint64_t(p[i] == '\n') << i;
+        classes.quotes |= uint64_t(p[i] == '"') << i;
+    }
+#endif
+    return classes;
+}
+
+// Bit i becomes the parity of the bits at or below i: set from an opening quote up to its closing one
+inline uint64_t prefixXor(uint64_t bits) {
+    for(int shift{1}; shift < 64; shift *= 2) {
+        bits ^= bits << shift;
+    }
+    return bits;
+}
+
+// Calls onStructural(offset, quoted) for every newline and every delimiter outside double quotes in
+// [begin, end), in order; quoted is true for a newline inside an unclosed quote. Returns whether the
+// range ends inside quotes.
+template<typename F>
+bool scanStructural(const char* begin, const char* end, char delimiter, F&& onStructural) {
+    size_t length = size_t(end - begin);
+    uint64_t carry = 0;
+    auto block = [&](const char* p, size_t offset) {
+        ByteClasses classes = classify(p, delimiter);
+        uint64_t quoted = prefixXor(classes.quotes) ^ carry;
+        carry = uint64_t(0) - (quoted >> 63);
+        uint64_t mask = (classes.separators & ~quoted) | classes.newlines;
+        while(mask) {
+            int bit = __builtin_ctzll(mask);
+            onStructural(offset + size_t(bit), ((quoted >> bit) & 1) != 0);
+            mask &= mask - 1;
+        }
+    };
+    size_t offset = 0;
+    for(; offset + 64 <= length; offset += 64) {
+        block(begin + offset, offset);
+    }
+    if(offset < length) {
+        // Pad the tail so the last block can use the same 64-byte compare; the zeros hold no quotes
+        char tail[64];
+        std::memset(tail, 0, sizeof(tail));
+        std::memcpy(tail, begin + offset, length - offset);
+        block(tail, offset);
+    }
+    return carry != 0;
+}
+
+const double POWERS_OF_TEN[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Decimal to double. Mantissas up to 2^53 with |exponent| <= 22 are exact in one multiply or divide
+// (Clinger's fast path), which covers every price a feed produces; anything else goes to strtod.
+bool parseNumber(const char* p, const char* end, double& out) {
+    const char* start = p;
+    bool negative = false;
+    if(p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    uint64_t mantissa = 0;
+    int significant = 0, exponent = 0;
+    bool digits = false, overflow = false;
+    for(; p < end && unsigned(*p - '0') < 10; p++) {
+        digits = true;
+        if(significant < 19) {
+            mantissa = mantissa * 10 + unsigned(*p - '0');
+            significant += mantissa != 0;
+        } else {
+            overflow = true;
+            exponent++;
+        }
+    }
+    if(p < end && *p == '.') {
+        p++;
+        for(; p < end && unsigned(*p - '0') < 10; p++) {
+            digits = true;
+            if(significant < 19) {
+                mantissa = mantissa * 10 + unsigned(*p - '0');
+                significant += mantissa != 0;
+                exponent--;
+            } else {
+                overflow = true;
+            }
+        }
+    }
+    if(!digits) {
+        return false;
+    }
+    if(p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negativeExponent = false;
+        if(p < end && (*p == '-' || *p == '+')) {
+            negativeExponent = *p == '-';
+            p++;
+        }
+        if(p == end || unsigned(*p - '0') >= 10) {
+            return false;
+        }
+        int value = 0;
+        for(; p < end && unsigned(*p - '0') < 10; p++) {
+            value = std::min(value * 10 + (*p - '0'), 100000);
+        }
+        exponent += negativeExponent ? -value : value;
+    }
+    if(p != end) {
+        return false;
+    }
+    if(!overflow && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+        double value = double(mantissa);
+        value = exponent < 0 ? value / POWERS_OF_TEN[-exponent] : value * POWERS_OF_TEN[exponent];
+        out = negative ? -value : value;
+        return true;
+    }
+    char buffer[128];
+    size_t length = size_t(end - start);
+    if(length >= sizeof(buffer)) {
+        return false;
+    }
+    std::memcpy(buffer, start, length);
+    buffer[length] = '\0';
+    char* parsedEnd;
+    out = std::strtod(buffer, &parsedEnd);
+    return parsedEnd == buffer + length;
+}
+
+bool isMissing(const char* p, const char* end) {
+    size_t length = size_t(end - p);
+    if(length == 0) {
+        return true;
+    }
+    auto equals = [&](const char* word) {
+        size_t n = std::strlen(word);
+        if(n != length) {
+            return false;
+        }
+        for(size_t i{}; i < n; i++) {
+            if((p[i] | 0x20) != word[i]) {
+                return false;
+            }
+        }
+        return true;
+    };
+    return equals("na") || equals("nan") || equals("null") || equals("n/a");
+}
+
+struct Chunk {
+    const char* begin;
+    const char* end;
+    size_t rows = 0;
+    size_t firstRow = 0;
+    size_t missing = 0;
+};
+
+// Splits [begin, end) into line-aligned pieces of roughly CHUNK_BYTES
+std::vector<Chunk> splitLines(const char* begin, const char* end) {
+    std::vector<Chunk> chunks;
+    const char* cursor = begin;
+    while(cursor < end) {
+        const char* stop = end;
+        if(size_t(end - cursor) > CHUNK_BYTES) {
+            const void* newline = std::memchr(cursor + CHUNK_BYTES, '\n', size_t(end - cursor - CHUNK_BYTES));
+            stop = newline ? static_cast<const char*>(newline) + 1 : end;
+        }
+        chunks.push_back(Chunk{cursor, stop});
+        cursor = stop;
+    }
+    return chunks;
+}
+
+void trim(const char*& p, const char*& end) {
+    while(p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+    while(end > p && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) {
+        end--;
+    }
+}
+
+// Blank lines (only whitespace or a carriage return) are ignored in both passes
+bool blankLine(const char* p, const char* end) {
+    trim(p, end);
+    return p == end;
+}
+
+size_t countRows(const Chunk& chunk) {
+    size_t rows = 0;
+    const char* line = chunk.begin;
+    const char* p = chunk.begin;
+    while(p < chunk.end) {
+        const void* found = std::memchr(p, '\n', size_t(chunk.end - p));
+        const char* newline = found ? static_cast<const char*>(found) : chunk.end;
+        rows += !blankLine(line, newline);
+        p = newline + 1;
+        line = p;
+    }
+    return rows;
+}
+
+// Drops the quotes around a trimmed field
+void unquote(const char*& p, const char*& end) {
+    if(end - p >= 2 && *p == '"' && end[-1] == '"') {
+        p++;
+        end--;
+    }
+}
+
+std::vector<std::string> parseHeader(const char* p, const char* end, char delimiter) {
+    std::vector<std::string> names;
+    size_t fieldStart = 0;
+    auto field = [&](size_t stop) {
+        const char* a = p + fieldStart;
+        const char* b = p + stop;
+        trim(a, b);
+        unquote(a, b);
+        // A doubled quote inside a quoted name stands for one quote
+        std::string name;
+        for(; a < b; a++) {
+            name += *a;
+            if(*a == '"' && a + 1 < b && a[1] == '"') {
+                a++;
+            }
+        }
+        names.push_back(std::move(name));
+        fieldStart = stop + 1;
+    };
+    bool open = scanStructural(p, end, delimiter, [&](size_t offset, bool) { field(offset); });
+    if(open) {
+        throw std::runtime_error("Unterminated quote in the CSV header");
+    }
+    field(size_t(end - p));
+    return names;
+}
+
+[[noreturn]] void fieldError(const char* what, size_t row, size_t column) {
+    throw std::runtime_error(std::string(what) + " at data row " + std::to_string(row + 1) + ", column " + std::to_string(column + 1));
+}
+}
+
+CsvPanel loadCsvPanel(const std::string& path, const CsvOptions& options) {
+    MappedFile file(path);
+    file.adviseSequential();
+    const char* begin = file.data();
+    const char* end = begin + file.size();
+
+    CsvPanel panel{{}, Matrix(0, 0), 0};
+    size_t fieldCount = 0;
+    if(begin == end) {
+        return panel;
+    }
+    const void* firstNewline = std::memchr(begin, '\n', file.size());
+    const char* firstLineEnd = firstNewline ? static_cast<const char*>(firstNewline) : end;
+    std::vector<std::string> header = parseHeader(begin, firstLineEnd, options.delimiter);
+    fieldCount = header.size();
+    if(fieldCount <= options.indexColumns) {
+        throw std::invalid_argument("CSV has no numeric columns after the index columns");
+    }
+    const size_t assets = fieldCount - options.indexColumns;
+    if(options.header) {
+        panel.assets.assign(header.begin() + ptrdiff_t(options.indexColumns), header.end());
+        begin = firstNewline ? firstLineEnd + 1 : end;
+    } else {
+        for(size_t j{}; j < assets; j++) {
+            panel.assets.push_back("column " + std::to_string(j + options.indexColumns + 1));
+        }
+    }
+
+    std::vector<Chunk> chunks = splitLines(begin, end);
+    ThreadPool& pool = ThreadPool::global();
+    pool.parallelFor(0, chunks.size(), 1, [&](size_t first, size_t last) {
+        for(size_t c{first}; c < last; c++) {
+            chunks[c].rows = countRows(chunks[c]);
+        }
+    });
+    size_t rows = 0;
+    for(Chunk& chunk : chunks) {
+        chunk.firstRow = rows;
+        rows += chunk.rows;
+    }
+
+    // Column buffers: every asset's prices are contiguous for the fill and return passes
+    std::vector<double> prices(rows * assets);
+    pool.parallelFor(0, chunks.size(), 1, [&](size_t first, size_t last) {
+        for(size_t c{first}; c < last; c++) {
+            Chunk& chunk = chunks[c];
+            size_t row = chunk.firstRow;
+            size_t column = 0;
+            size_t fieldStart = 0;
+            const char* base = chunk.begin;
+            auto field = [&](size_t stop) {
+                const char* a = base + fieldStart;
+                const char* b = base + stop;
+                trim(a, b);
+                unquote(a, b);
+                if(column >= fieldCount) {
+                    fieldError("Too many fields", row, column);
+                }
+                if(column >= options.indexColumns) {
+                    double value;
+                    if(isMissing(a, b)) {
+                        value = NOT_A_NUMBER;
+                        chunk.missing++;
+                    } else if(!parseNumber(a, b, value)) {
+                        fieldError("Cannot parse number", row, column);
+                    }
+                    prices[(column - options.indexColumns) * rows + row] = value;
+                }
+                column++;
+                fieldStart = stop + 1;
+            };
+            auto lineEnd = [&](size_t stop) {
+                if(column == 0 && blankLine(base + fieldStart, base + stop)) {
+                    fieldStart = stop + 1;
+                    return;
+                }
+                field(stop);
+                if(column != fieldCount) {
+                    fieldError("Too few fields", row, column);
+                }
+                row++;
+                column = 0;
+            };
+            bool open = scanStructural(chunk.begin, chunk.end, options.delimiter, [&](size_t offset, bool quoted) {
+                if(base[offset] != '\n') {
+                    field(offset);
+                } else if(quoted) {
+                    fieldError("Unterminated quote", row, column);
+                } else {
+                    lineEnd(offset);
+                }
+            });
+            size_t length = size_t(chunk.end - chunk.begin);
+            if(open) {
+                fieldError("Unterminated quote", row, column);
+            }
+            if(fieldStart < length || column > 0) {
+                lineEnd(length);
+            }
+        }
+    });
+    for(const Chunk& chunk : chunks) {
+        panel.missingFields += chunk.missing;
+    }
+
+    std::vector<size_t> kept;
+    if(panel.missingFields > 0) {
+        if(options.missing == MissingValues::Throw) {
+            throw std::runtime_error("CSV has " + std::to_string(panel.missingFields) + " missing values");
+        }
+        if(options.missing == MissingValues::ForwardFill) {
+            parallelChunks(assets, 1, [&](size_t first, size_t last) {
+                for(size_t j{first}; j < last; j++) {
+                    double* column = prices.data() + j * rows;
+                    size_t firstValid = 0;
+                    while(firstValid < rows && std::isnan(column[firstValid])) {
+                        firstValid++;
+                    }
+                    if(firstValid == rows) {
+                        throw std::runtime_error("CSV column " + panel.assets[j] + " has no values");
+                    }
+                    std::fill(column, column + firstValid, column[firstValid]);
+                    for(size_t t{firstValid + 1}; t < rows; t++) {
+                        if(std::isnan(column[t])) {
+                            column[t] = column[t - 1];
+                        }
+                    }
+                }
+            });
+        } else {
+            for(size_t t{}; t < rows; t++) {
+                bool complete = true;
+                for(size_t j{}; j < assets && complete; j++) {
+                    complete = !std::isnan(prices[j * rows + t]);
+                }
+                if(complete) {
+                    kept.push_back(t);
+                }
+            }
+        }
+    }
+    const bool dropping = options.missing == MissingValues::DropRow && panel.missingFields > 0;
+    const size_t usable = dropping ? kept.size() : rows;
+    auto source = [&](size_t t) { return dropping ? kept[t] : t; };
+
+    if(!options.logReturns) {
+        panel.values = Matrix(usable, assets, MatrixInit::Uninitialized);
+        double* out = panel.values.data.data();
+        parallelChunks(usable, 1024, [&](size_t first, size_t last) {
+            for(size_t t{first}; t < last; t++) {
+                size_t from = source(t);
+                for(size_t j{}; j < assets; j++) {
+                    out[t * assets + j] = prices[j * rows + from];
+                }
+            }
+        });
+        return panel;
+    }
+
+    const size_t periods = usable > 0 ? usable - 1 : 0;
+    panel.values = Matrix(periods, assets, MatrixInit::Uninitialized);
+    double* out = panel.values.data.data();
+    parallelChunks(periods, 1024, [&](size_t first, size_t last) {
+        for(size_t t{first}; t < last; t++) {
+            size_t previous = source(t), current = source(t + 1);
+            for(size_t j{}; j < assets; j++) {
+                double before = prices[j * rows + previous], after = prices[j * rows + current];
+                if(!(before > 0.0) || !(after > 0.0)) {
+                    throw std::runtime_error("Log returns need positive prices, column " + panel.assets[j]);
+                }
+                out[t * assets + j] = std::log(after / before);
+            }
+        }
+    });
+    return panel;
+}
@@ -0,0 +1,44 @@
+#ifndef CSVREADER_HPP
+#define CSVREADER_HPP
+
+#include "matrix.hpp"
+#include <string>
+#include <vector>
+
+/*
+Chunked, multithreaded loader for numeric CSV panels such as daily closes, one row per date and one column per asset.
+
+The file is memory mapped and split at line boundaries into one chunk per task. A first parallel
+pass counts rows so every chunk knows where its rows land; a second pass parses fields straight
+into per-asset column buffers. Delimiters, newlines and quotes are found 64 bytes at a time with
+SSE2 compares and bit scans, a prefix XOR of the quote bits masks out delimiters between quotes,
+numbers go through a Clinger fast path with strtod as the fallback, and no field is ever copied
+into a string.
+
+Fields may be wrapped in double quotes, in the header and in the body alike, and then contain the
+delimiter; a quote inside a quoted name is written twice. Quoted fields cannot span lines. Numbers
+use '.' as the decimal separator.
+*/
+enum class MissingValues {
+    ForwardFill,  // carry the last price forward; leading gaps take the first observed price
+    DropRow,      // discard any date with a missing asset
+    Throw
+};
+
+struct CsvOptions {
+    char delimiter = ',';
+    bool header = true;
+    size_t indexColumns = 1;  // leading non-numeric columns such as the date, skipped
+    bool logReturns = true;   // values become log(p_t / p_t-1), one row shorter than the prices
+    MissingValues missing = MissingValues::ForwardFill;
+};
+
+struct CsvPanel {
+    std::vector<std::string> assets;
+    Matrix values;         // observations x assets, the panel layout ModernPortfolioTheory expects
+    size_t missingFields;  // empty, NA, NaN or null entries seen before the policy was applied
+};
+
+CsvPanel loadCsvPanel(const std::string& path, const CsvOptions& options = CsvOptions());
+
+#endif
@@ -0,0 +1,210 @@
+#ifndef FIXEDMATRIX_HPP
+#define FIXEDMATRIX_HPP
+
+#include "3DVector.hpp"
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+
+/*
+Compile-time sized matrix for the rendering and camera path.
+Lives on the stack, never allocates, and stores its elements column-major so
+ptr() can go straight to glUniformMatrix4fv / glUniformMatrix3fv with transpose = GL_FALSE.
+Columns are aligned so a Mat4f column is one SSE/NEON register.
+*/
+template<size_t R, size_t C, typename Scalar = float>
+struct alignas(R * sizeof(Scalar) >= 32 ? 32 : 16) FixedMatrix {
+    std::array<Scalar, R * C> data{};
+
+    static constexpr size_t rows = R;
+    static constexpr size_t columns = C;
+
+    constexpr Scalar& operator()(size_t row, size_t col) { return data[col * R + row]; }
+    constexpr const Scalar& operator()(size_t row, size_t col) const { return data[col * R + row]; }
+
+    const Scalar* ptr() const { return data.data(); }
+
+    static constexpr FixedMatrix identity() {
+        static_assert(R == C, "Identity needs a square matrix");
+        FixedMatrix ans;
+        for(size_t i{}; i < R; i++) {
+            ans(i, i) = Scalar(1);
+        }
+        return ans;
+    }
+
+    constexpr FixedMatrix operator+(const FixedMatrix& Addend) const {
+        FixedMatrix ans;
+        for(size_t i{}; i < R * C; i++) {
+            ans.data[i] = data[i] + Addend.data[i];
+        }
+        return ans;
+    }
+
+    constexpr FixedMatrix operator-(const FixedMatrix& Subtrahend) const {
+        FixedMatrix ans;
+        for(size_t i{}; i < R * C; i++) {
+            ans.data[i] = data[i] - Subtrahend.data[i];
+        }
+        return ans;
+    }
+
+    constexpr FixedMatrix operator*(Scalar scalar) const {
+        FixedMatrix ans;
+        for(size_t i{}; i < R * C; i++) {
+            ans.data[i] = data[i] * scalar;
+        }
+        return ans;
+    }
+
+    // Column-major product: each output column is a linear combination of our columns
+    template<size_t K>
+    constexpr FixedMatrix<R, K, Scalar> operator*(const FixedMatrix<C, K, Scalar>& Factor) const {
+        FixedMatrix<R, K, Scalar> ans;
+        for(size_t col{}; col < K; col++) {
+            for(size_t inner{}; inner < C; inner++) {
+                Scalar f = Factor(inner, col);
+                for(size_t row{}; row < R; row++) {
+                    ans(row, col) += (*this)(row, inner) * f;
+                }
+            }
+        }
+        return ans;
+    }
+
+    constexpr FixedMatrix<C, R, Scalar> T() const {
+        FixedMatrix<C, R, Scalar> ans;
+        for(size_t row{}; row < R; row++) {
+            for(size_t col{}; col < C; col++) {
+                ans(col, row) = (*this)(row, col);
+            }
+        }
+        return ans;
+    }
+
+    constexpr Scalar det() const {
+        static_assert(R == C && (R == 3 || R == 4), "det is specialized for 3x3 and 4x4");
+        const FixedMatrix& m = *this;
+        if constexpr(R == 3) {
+            return m(0, 0) * (m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1))
+                 - m(0, 1) * (m(1, 0) * m(2, 2) - m(1, 2) * m(2, 0))
+                 + m(0, 2) * (m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0));
+        } else {
+            return cofactors4().det;
+        }
+    }
+
+    // Closed-form adjugate / determinant, no pivoting or loops over minors
+    constexpr FixedMatrix inv() const {
+        static_assert(R == C && (R == 3 || R == 4), "inv is specialized for 3x3 and 4x4");
+        const FixedMatrix& m = *this;
+        if constexpr(R == 3) {
+            FixedMatrix adj;
+            adj(0, 0) = m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1);
+            adj(0, 1) = m(0, 2) * m(2, 1) - m(0, 1) * m(2, 2);
+            adj(0, 2) = m(0, 1) * m(1, 2) - m(0, 2) * m(1, 1);
+            adj(1, 0) = m(1, 2) * m(2, 0) - m(1, 0) * m(2, 2);
+            adj(1, 1) = m(0, 0) * m(2, 2) - m(0, 2) * m(2, 0);
+            adj(1, 2) = m(0, 2) * m(1, 0) - m(0, 0) * m(1, 2);
+            adj(2, 0) = m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0);
+            adj(2, 1) = m(0, 1) * m(2, 0) - m(0, 0) * m(2, 1);
+            adj(2, 2) = m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0);
+            Scalar determinant = m(0, 0) * adj(0, 0) + m(0, 1) * adj(1, 0) + m(0, 2) * adj(2, 0);
+            if(determinant == Scalar(0)) {
+                throw std::runtime_error("Matrix is not invertible as determinant is zero");
+            }
+            return adj * (Scalar(1) / determinant);
+        } else {
+            Cofactors4 c = cofactors4();
+            if(c.det == Scalar(0)) {
+                throw std::runtime_error("Matrix is not invertible as determinant is zero");
+            }
+            return c.adj * (Scalar(1) / c.det);
+        }
+    }
+
+    // Right-handed view matrix, same convention as Matrix::lookAt
+    template<typename V>
+    static FixedMatrix lookAt(const V& eye, const V& focus, const V& up) {
+        static_assert(R == 4 && C == 4, "lookAt builds a 4x4 matrix");
+        V F = (focus - eye).normal();
+        V s = F.cross(up.normal()).normal();
+        V u = s.cross(F);
+        FixedMatrix ans;
+        ans(0, 0) = Scalar(s.x()); ans(0, 1) = Scalar(s.y()); ans(0, 2) = Scalar(s.z()); ans(0, 3) = Scalar(-(s * eye));
+        ans(1, 0) = Scalar(u.x()); ans(1, 1) = Scalar(u.y()); ans(1, 2) = Scalar(u.z()); ans(1, 3) = Scalar(-(u * eye));
+        ans(2, 0) = Scalar(-F.x()); ans(2, 1) = Scalar(-F.y()); ans(2, 2) = Scalar(-F.z()); ans(2, 3) = Scalar(F * eye);
+        ans(3, 3) = Scalar(1);
+        return ans;
+    }
+
+    // OpenGL clip-space projection, fov is the vertical field of view in radians
+    static FixedMatrix perspective(Scalar fov, Scalar aspect, Scalar near, Scalar far) {
+        static_assert(R == 4 && C == 4, "perspective builds a 4x4 matrix");
+        Scalar tanHalfFov = std::tan(fov / Scalar(2));
+        FixedMatrix ans;
+        ans(0, 0) = Scalar(1) / (aspect * tanHalfFov);
+        ans(1, 1) = Scalar(1) / tanHalfFov;
+        ans(2, 2) = -(far + near) / (far - near);
+        ans(2, 3) = -(Scalar(2) * far * near) / (far - near);
+        ans(3, 2) = Scalar(-1);
+        return ans;
+    }
+
+private:
+    struct Cofactors4 {
+        FixedMatrix adj;
+        Scalar det;
+    };
+
+    // 2x2 sub-determinants of the top and bottom row pairs, shared by all 16 cofactors
+    constexpr Cofactors4 cofactors4() const {
+        const FixedMatrix& m = *this;
+        Scalar s0 = m(0, 0) * m(1, 1) - m(1, 0) * m(0, 1);
+        Scalar s1 = m(0, 0) * m(1, 2) - m(1, 0) * m(0, 2);
+        Scalar s2 = m(0, 0) * m(1, 3) - m(1, 0) * m(0, 3);
+        Scalar s3 = m(0, 1) * m(1, 2) - m(1, 1) * m(0, 2);
+        Scalar s4 = m(0, 1) * m(1, 3) - m(1, 1) * m(0, 3);
+        Scalar s5 = m(0, 2) * m(1, 3) - m(1, 2) * m(0, 3);
+        Scalar c5 = m(2, 2) * m(3, 3) - m(3, 2) * m(2, 3);
+        Scalar c4 = m(2, 1) * m(3, 3) - m(3, 1) * m(2, 3);
+        Scalar c3 = m(2, 1) * m(3, 2) - m(3, 1) * m(2, 2);
+        Scalar c2 = m(2, 0) * m(3, 3) - m(3, 0) * m(2, 3);
+        Scalar c1 = m(2, 0) * m(3, 2) - m(3, 0) * m(2, 2);
+        Scalar c0 = m(2, 0) * m(3, 1) - m(3, 0) * m(2, 1);
+
+        Cofactors4 ans{};
+        FixedMatrix& a = ans.adj;
+        a(0, 0) =  m(1, 1) * c5 - m(1, 2) * c4 + m(1, 3) * c3;
+        a(0, 1) = -m(0, 1) * c5 + m(0, 2) * c4 - m(0, 3) * c3;
+        a(0, 2) =  m(3, 1) * s5 - m(3, 2) * s4 + m(3, 3) * s3;
+        a(0, 3) = -m(2, 1) * s5 + m(2, 2) * s4 - m(2, 3) * s3;
+        a(1, 0) = -m(1, 0) * c5 + m(1, 2) * c2 - m(1, 3) * c1;
+        a(1, 1) =  m(0, 0) * c5 - m(0, 2) * c2 + m(0, 3) * c1;
+        a(1, 2) = -m(3, 0) * s5 + m(3, 2) * s2 - m(3, 3) * s1;
+        a(1, 3) =  m(2, 0) * s5 - m(2, 2) * s2 + m(2, 3) * s1;
+        a(2, 0) =  m(1, 0) * c4 - m(1, 1) * c2 + m(1, 3) * c0;
+        a(2, 1) = -m(0, 0) * c4 + m(0, 1) * c2 - m(0, 3) * c0;
+        a(2, 2) =  m(3, 0) * s4 - m(3, 1) * s2 + m(3, 3) * s0;
+        a(2, 3) = -m(2, 0) * s4 + m(2, 1) * s2 - m(2, 3) * s0;
+        a(3, 0) = -m(1, 0) * c3 + m(1, 1) * c1 - m(1, 2) * c0;
+        a(3, 1) =  m(0, 0) * c3 - m(0, 1) * c1 + m(0, 2) * c0;
+        a(3, 2) = -m(3, 0) * s3 + m(3, 1) * s1 - m(3, 2) * s0;
+        a(3, 3) =  m(2, 0) * s3 - m(2, 1) * s1 + m(2, 2) * s0;
+        ans.det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        return ans;
+    }
+};
+
+template<size_t R, size_t C, typename Scalar>
+constexpr FixedMatrix<R, C, Scalar> operator*(Scalar scalar, const FixedMatrix<R, C, Scalar>& mat) {
+    return mat * scalar;
+}
+
+using Mat3f = FixedMatrix<3, 3, float>;
+using Mat4f = FixedMatrix<4, 4, float>;
+using Mat3d = FixedMatrix<3, 3, double>;
+using Mat4d = FixedMatrix<4, 4, double>;
+
+#endif
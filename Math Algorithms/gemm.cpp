@@ -0,0 +1,459 @@
+#include "gemm.hpp"
+#include "cpuFeatures.hpp"
+#include "threadPool.hpp"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#if QUANT_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// C[MR x NR] += alpha * Ap * Bp, where Ap is an MR-wide sliver and Bp an NR-wide sliver of length kc.
+template<typename Real>
+using MicroKernel = void (*)(size_t kc, Real alpha, const Real* Ap, const Real* Bp, Real* C, size_t ldc);
+
+template<typename Real>
+struct KernelConfig {
+    size_t mr, nr;      // register tile
+    size_t mc, kc, nc;  // cache blocks: A panel mc x kc stays in L2, B panel kc x nc in L3
+    MicroKernel<Real> kernel;
+};
+
+constexpr size_t MAX_MR = 8;
+constexpr size_t MAX_NR = 32;
+
+template<typename Real>
+void kernelScalar(size_t kc, Real alpha, const Real* Ap, const Real* Bp, Real* C, size_t ldc) {
+    Real acc[4][4] = {};
+    for(size_t p{}; p < kc; p++) {
+        for(size_t i{}; i < 4; i++) {
+            Real a = Ap[p * 4 + i];
+            for(size_t j{}; j < 4; j++) {
+                acc[i][j] += a * Bp[p * 4 + j];
+            }
+        }
+    }
+    for(size_t i{}; i < 4; i++) {
+        for(size_t j{}; j < 4; j++) {
+            C[i * ldc + j] += alpha * acc[i][j];
+        }
+    }
+}
+
+#if QUANT_X86_DISPATCH
+// 6 x 8 tile: 12 ymm accumulators, 2 for the B row, 1 broadcast.
+QUANT_TARGET_AVX2
+void kernelAVX2(size_t kc, double alpha, const double* Ap, const double* Bp, double* C, size_t ldc) {
+    __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+    __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+    __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+    __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+    __m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd();
+    __m256d c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+    for(size_t p{}; p < kc; p++) {
+        __m256d b0 = _mm256_loadu_pd(Bp);
+        __m256d b1 = _mm256_loadu_pd(Bp + 4);
+        __m256d a;
+        a = _mm256_broadcast_sd(Ap + 0); c00 = _mm256_fmadd_pd(a, b0, c00); c01 = _mm256_fmadd_pd(a, b1, c01);
+        a = _mm256_broadcast_sd(Ap + 1); c10 = _mm256_fmadd_pd(a, b0, c10); c11 = _mm256_fmadd_pd(a, b1, c11);
+        a = _mm256_broadcast_sd(Ap + 2); c20 = _mm256_fmadd_pd(a, b0, c20); c21 = _mm256_fmadd_pd(a, b1, c21);
+        a = _mm256_broadcast_sd(Ap + 3); c30 = _mm256_fmadd_pd(a, b0, c30); c31 = _mm256_fmadd_pd(a, b1, c31);
+        a = _mm256_broadcast_sd(Ap + 4); c40 = _mm256_fmadd_pd(a, b0, c40); c41 = _mm256_fmadd_pd(a, b1, c41);
+        a = _mm256_broadcast_sd(Ap + 5); c50 = _mm256_fmadd_pd(a, b0, c50); c51 = _mm256_fmadd_pd(a, b1, c51);
+        Ap += 6;
+        Bp += 8;
+    }
+    __m256d al = _mm256_set1_pd(alpha);
+#define STORE_ROW(i, lo, hi) \
+    _mm256_storeu_pd(C + (i) * ldc, _mm256_fmadd_pd(al, lo, _mm256_loadu_pd(C + (i) * ldc))); \
+    _mm256_storeu_pd(C + (i) * ldc + 4, _mm256_fmadd_pd(al, hi, _mm256_loadu_pd(C + (i) * ldc + 4)));
+    STORE_ROW(0, c00, c01) STORE_ROW(1, c10, c11) STORE_ROW(2, c20, c21)
+    STORE_ROW(3, c30, c31) STORE_ROW(4, c40, c41) STORE_ROW(5, c50, c51)
+#undef STORE_ROW
+}
+
+// 8 x 16 tile: 16 zmm accumulators, 2 for the B row, 1 broadcast.
+// Accumulators are named so they stay in registers, an array spills to the stack.
+QUANT_TARGET_AVX512
+void kernelAVX512(size_t kc, double alpha, const double* Ap, const double* Bp, double* C, size_t ldc) {
+    __m512d c00 = _mm512_setzero_pd(), c01 = _mm512_setzero_pd();
+    __m512d c10 = _mm512_setzero_pd(), c11 = _mm512_setzero_pd();
+    __m512d c20 = _mm512_setzero_pd(), c21 = _mm512_setzero_pd();
+    __m512d c30 = _mm512_setzero_pd(), c31 = _mm512_setzero_pd();
+    __m512d c40 = _mm512_setzero_pd(), c41 = _mm512_setzero_pd();
+    __m512d c50 = _mm512_setzero_pd(), c51 = _mm512_setzero_pd();
+    __m512d c60 = _mm512_setzero_pd(), c61 = _mm512_setzero_pd();
+    __m512d c70 = _mm512_setzero_pd(), c71 = _mm512_setzero_pd();
+    for(size_t p{}; p < kc; p++) {
+        __m512d b0 = _mm512_loadu_pd(Bp);
+        __m512d b1 = _mm512_loadu_pd(Bp + 8);
+        __m512d a;
+        a = _mm512_set1_pd(Ap[0]); c00 = _mm512_fmadd_pd(a, b0, c00); c01 = _mm512_fmadd_pd(a, b1, c01);
+        a = _mm512_set1_pd(Ap[1]); c10 = _mm512_fmadd_pd(a, b0, c10); c11 = _mm512_fmadd_pd(a, b1, c11);
+        a = _mm512_set1_pd(Ap[2]); c20 = _mm512_fmadd_pd(a, b0, c20); c21 = _mm512_fmadd_pd(a, b1, c21);
+        a = _mm512_set1_pd(Ap[3]); c30 = _mm512_fmadd_pd(a, b0, c30); c31 = _mm512_fmadd_pd(a, b1, c31);
+        a = _mm512_set1_pd(Ap[4]); c40 = _mm512_fmadd_pd(a, b0, c40); c41 = _mm512_fmadd_pd(a, b1, c41);
+        a = _mm512_set1_pd(Ap[5]); c50 = _mm512_fmadd_pd(a, b0, c50); c51 = _mm512_fmadd_pd(a, b1, c51);
+        a = _mm512_set1_pd(Ap[6]); c60 = _mm512_fmadd_pd(a, b0, c60); c61 = _mm512_fmadd_pd(a, b1, c61);
+        a = _mm512_set1_pd(Ap[7]); c70 = _mm512_fmadd_pd(a, b0, c70); c71 = _mm512_fmadd_pd(a, b1, c71);
+        Ap += 8;
+        Bp += 16;
+    }
+    __m512d al = _mm512_set1_pd(alpha);
+#define STORE_ROW(i, lo, hi) \
+    _mm512_storeu_pd(C + (i) * ldc, _mm512_fmadd_pd(al, lo, _mm512_loadu_pd(C + (i) * ldc))); \
+    _mm512_storeu_pd(C + (i) * ldc + 8, _mm512_fmadd_pd(al, hi, _mm512_loadu_pd(C + (i) * ldc + 8)));
+    STORE_ROW(0, c00, c01) STORE_ROW(1, c10, c11) STORE_ROW(2, c20, c21) STORE_ROW(3, c30, c31)
+    STORE_ROW(4, c40, c41) STORE_ROW(5, c50, c51) STORE_ROW(6, c60, c61) STORE_ROW(7, c70, c71)
+#undef STORE_ROW
+}
+
+// float: the same register tiles hold twice the columns, 6 x 16 and 8 x 32
+QUANT_TARGET_AVX2
+void kernelAVX2Float(size_t kc, float alpha, const float* Ap, const float* Bp, float* C, size_t ldc) {
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+    __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+    __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+    __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+    __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+    __m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+    for(size_t p{}; p < kc; p++) {
+        __m256 b0 = _mm256_loadu_ps(Bp);
+        __m256 b1 = _mm256_loadu_ps(Bp + 8);
+        __m256 a;
+        a = _mm256_broadcast_ss(Ap + 0); c00 = _mm256_fmadd_ps(a, b0, c00); c01 = _mm256_fmadd_ps(a, b1, c01);
+        a = _mm256_broadcast_ss(Ap + 1); c10 = _mm256_fmadd_ps(a, b0, c10); c11 = _mm256_fmadd_ps(a, b1, c11);
+        a = _mm256_broadcast_ss(Ap + 2); c20 = _mm256_fmadd_ps(a, b0, c20); c21 = _mm256_fmadd_ps(a, b1, c21);
+        a = _mm256_broadcast_ss(Ap + 3); c30 = _mm256_fmadd_ps(a, b0, c30); c31 = _mm256_fmadd_ps(a, b1, c31);
+        a = _mm256_broadcast_ss(Ap + 4); c40 = _mm256_fmadd_ps(a, b0, c40); c41 = _mm256_fmadd_ps(a, b1, c41);
+        a = _mm256_broadcast_ss(Ap + 5); c50 = _mm256_fmadd_ps(a, b0, c50); c51 = _mm256_fmadd_ps(a, b1, c51);
+        Ap += 6;
+        Bp += 16;
+    }
+    __m256 al = _mm256_set1_ps(alpha);
+#define STORE_ROW(i, lo, hi) \
+    _mm256_storeu_ps(C + (i) * ldc, _mm256_fmadd_ps(al, lo, _mm256_loadu_ps(C + (i) * ldc))); \
+    _mm256_storeu_ps(C + (i) * ldc + 8, _mm256_fmadd_ps(al, hi, _mm256_loadu_ps(C + (i) * ldc + 8)));
+    STORE_ROW(0, c00, c01) STORE_ROW(1, c10, c11) STORE_ROW(2, c20, c21)
+    STORE_ROW(3, c30, c31) STORE_ROW(4, c40, c41) STORE_ROW(5, c50, c51)
+#undef STORE_ROW
+}
+
+QUANT_TARGET_AVX512
+void kernelAVX512Float(size_t kc, float alpha, const float* Ap, const float* Bp, float* C, size_t ldc) {
+    __m512 c00 = _mm512_setzero_ps(), c01 = _mm512_setzero_ps();
+    __m512 c10 = _mm512_setzero_ps(), c11 = _mm512_setzero_ps();
+    __m512 c20 = _mm512_setzero_ps(), c21 = _mm512_setzero_ps();
+    __m512 c30 = _mm512_setzero_ps(), c31 = _mm512_setzero_ps();
+    __m512 c40 = _mm512_setzero_ps(), c41 = _mm512_setzero_ps();
+    __m512 c50 = _mm512_setzero_ps(), c51 = _mm512_setzero_ps();
+    __m512 c60 = _mm512_setzero_ps(), c61 = _mm512_setzero_ps();
+    __m512 c70 = _mm512_setzero_ps(), c71 = _mm512_setzero_ps();
+    for(size_t p{}; p < kc; p++) {
+        __m512 b0 = _mm512_loadu_ps(Bp);
+        __m512 b1 = _mm512_loadu_ps(Bp + 16);
+        __m512 a;
+        a = _mm512_set1_ps(Ap[0]); c00 = _mm512_fmadd_ps(a, b0, c00); c01 = _mm512_fmadd_ps(a, b1, c01);
+        a = _mm512_set1_ps(Ap[1]); c10 = _mm512_fmadd_ps(a, b0, c10); c11 = _mm512_fmadd_ps(a, b1, c11);
+        a = _mm512_set1_ps(Ap[2]); c20 = _mm512_fmadd_ps(a, b0, c20); c21 = _mm512_fmadd_ps(a, b1, c21);
+        a = _mm512_set1_ps(Ap[3]); c30 = _mm512_fmadd_ps(a, b0, c30); c31 = _mm512_fmadd_ps(a, b1, c31);
+        a = _mm512_set1_ps(Ap[4]); c40 = _mm512_fmadd_ps(a, b0, c40); c41 = _mm512_fmadd_ps(a, b1, c41);
+        a = _mm512_set1_ps(Ap[5]); c50 = _mm512_fmadd_ps(a, b0, c50); c51 = _mm512_fmadd_ps(a, b1, c51);
+        a = _mm512_set1_ps(Ap[6]); c60 = _mm512_fmadd_ps(a, b0, c60); c61 = _mm512_fmadd_ps(a, b1, c61);
+        a = _mm512_set1_ps(Ap[7]); c70 = _mm512_fmadd_ps(a, b0, c70); c71 = _mm512_fmadd_ps(a, b1, c71);
+        Ap += 8;
+        Bp += 32;
+    }
+    __m512 al = _mm512_set1_ps(alpha);
+#define STORE_ROW(i, lo, hi) \
+    _mm512_storeu_ps(C + (i) * ldc, _mm512_fmadd_ps(al, lo, _mm512_loadu_ps(C + (i) * ldc))); \
+    _mm512_storeu_ps(C + (i) * ldc + 16, _mm512_fmadd_ps(al, hi, _mm512_loadu_ps(C + (i) * ldc + 16)));
+    STORE_ROW(0, c00, c01) STORE_ROW(1, c10, c11) STORE_ROW(2, c20, c21) STORE_ROW(3, c30, c31)
+    STORE_ROW(4, c40, c41) STORE_ROW(5, c50, c51) STORE_ROW(6, c60, c61) STORE_ROW(7, c70, c71)
+#undef STORE_ROW
+}
+#endif
+
+template<typename Real>
+KernelConfig<Real> selectKernel();
+
+template<>
+KernelConfig<double> selectKernel<double>() {
+    switch(activeSimdLevel()) {
+#if QUANT_X86_DISPATCH
+        case SimdLevel::AVX512: return {8, 16, 128, 256, 4096, kernelAVX512};
+        case SimdLevel::AVX2: return {6, 8, 72, 256, 4096, kernelAVX2};
+#endif
+        default: return {4, 4, 64, 256, 4096, kernelScalar<double>};
+    }
+}
+
+// Twice the k depth keeps the packed panels at the same byte size as for double
+template<>
+KernelConfig<float> selectKernel<float>() {
+    switch(activeSimdLevel()) {
+#if QUANT_X86_DISPATCH
+        case SimdLevel::AVX512: return {8, 32, 128, 512, 4096, kernelAVX512Float};
+        case SimdLevel::AVX2: return {6, 16, 72, 512, 4096, kernelAVX2Float};
+#endif
+        default: return {4, 4, 64, 512, 4096, kernelScalar<float>};
+    }
+}
+
+// 64-byte aligned scratch that only grows, so steady-state multiplies never allocate.
+template<typename Real>
+struct PackBuffer {
+    Real* ptr = nullptr;
+    size_t capacity = 0;
+
+    Real* reserve(size_t count) {
+        if(count > capacity) {
+            release();
+            ptr = static_cast<Real*>(::operator new(count * sizeof(Real), std::align_val_t(64)));
+            capacity = count;
+        }
+        return ptr;
+    }
+    void release() {
+        if(ptr) {
+            ::operator delete(ptr, std::align_val_t(64));
+        }
+        ptr = nullptr;
+        capacity = 0;
+    }
+    ~PackBuffer() { release(); }
+};
+
+// Ap holds ceil(mc / mr) slivers, each laid out p-major: Ap[p * mr + i]. Rows past mc are zero.
+template<typename Real>
+void packA(size_t mc, size_t kc, const Real* A, size_t rsA, size_t csA, size_t mr, Real* Ap) {
+    for(size_t i0{}; i0 < mc; i0 += mr) {
+        size_t rows = std::min(mr, mc - i0);
+        for(size_t p{}; p < kc; p++) {
+            const Real* src = A + i0 * rsA + p * csA;
+            for(size_t i{}; i < rows; i++) {
+                Ap[i] = src[i * rsA];
+            }
+            for(size_t i{rows}; i < mr; i++) {
+                Ap[i] = 0;
+            }
+            Ap += mr;
+        }
+    }
+}
+
+// Bp holds ceil(nc / nr) slivers, each laid out p-major: Bp[p * nr + j]. Columns past nc are zero.
+template<typename Real>
+void packB(size_t kc, size_t nc, const Real* B, size_t rsB, size_t csB, size_t nr, Real* Bp) {
+    for(size_t j0{}; j0 < nc; j0 += nr) {
+        size_t cols = std::min(nr, nc - j0);
+        for(size_t p{}; p < kc; p++) {
+            const Real* src = B + p * rsB + j0 * csB;
+            if(csB == 1) {
+                std::memcpy(Bp, src, cols * sizeof(Real));
+            } else {
+                for(size_t j{}; j < cols; j++) {
+                    Bp[j] = src[j * csB];
+                }
+            }
+            for(size_t j{cols}; j < nr; j++) {
+                Bp[j] = 0;
+            }
+            Bp += nr;
+        }
+    }
+}
+
+template<typename Real>
+void macroKernel(const KernelConfig<Real>& cfg, size_t mc, size_t nc, size_t kc, Real alpha,
+                 const Real* Ap, const Real* Bp, Real* C, size_t ldc) {
+    Real edge[MAX_MR * MAX_NR];
+    for(size_t j0{}; j0 < nc; j0 += cfg.nr) {
+        size_t cols = std::min(cfg.nr, nc - j0);
+        const Real* Bs = Bp + j0 * kc;
+        for(size_t i0{}; i0 < mc; i0 += cfg.mr) {
+            size_t rows = std::min(cfg.mr, mc - i0);
+            const Real* As = Ap + i0 * kc;
+            Real* Ct = C + i0 * ldc + j0;
+            if(rows == cfg.mr && cols == cfg.nr) {
+                cfg.kernel(kc, alpha, As, Bs, Ct, ldc);
+            } else {
+                // Edge tiles carry C through the kernel too, so alpha * AB meets C in the same fused
+                // update as in a full tile and no element depends on where the tile boundaries fall
+                std::fill(edge, edge + cfg.mr * cfg.nr, Real(0));
+                for(size_t i{}; i < rows; i++) {
+                    std::copy(Ct + i * ldc, Ct + i * ldc + cols, edge + i * cfg.nr);
+                }
+                cfg.kernel(kc, alpha, As, Bs, edge, cfg.nr);
+                for(size_t i{}; i < rows; i++) {
+                    std::copy(edge + i * cfg.nr, edge + i * cfg.nr + cols, Ct + i * ldc);
+                }
+            }
+        }
+    }
+}
+
+template<typename Real>
+void scaleC(size_t m, size_t n, Real beta, Real* C, size_t ldc) {
+    if(beta == 1) {
+        return;
+    }
+    for(size_t i{}; i < m; i++) {
+        Real* row = C + i * ldc;
+        if(beta == 0) {
+            std::fill(row, row + n, Real(0));
+        } else {
+            for(size_t j{}; j < n; j++) {
+                row[j] *= beta;
+            }
+        }
+    }
+}
+
+template<typename Real>
+void gemmBlocked(size_t m, size_t n, size_t k, Real alpha,
+                 const Real* A, size_t rsA, size_t csA,
+                 const Real* B, size_t rsB, size_t csB,
+                 Real beta, Real* C, size_t ldc) {
+    if(m == 0 || n == 0) {
+        return;
+    }
+    scaleC(m, n, beta, C, ldc);
+    if(k == 0 || alpha == 0) {
+        return;
+    }
+
+    const KernelConfig<Real> cfg = selectKernel<Real>();
+    // Below roughly 100^3 flops the fan-out costs more than it saves
+    const bool parallel = double(m) * double(n) * double(k) >= 1e6 && !ThreadPool::insideParallelRegion();
+    ThreadPool* pool = parallel ? &ThreadPool::global() : nullptr;
+    size_t threads = pool ? pool->threadCount() : 1;
+
+    // With several threads shrink the A block so every thread gets at least one. Blocks stay whole
+    // multiples of mr, so the register tiles, and with them every rounding, are the same for any count
+    size_t mcBlock = cfg.mc;
+    if(threads > 1) {
+        size_t share = (m + threads - 1) / threads;
+        mcBlock = std::min(cfg.mc, std::max(cfg.mr, (share + cfg.mr - 1) / cfg.mr * cfg.mr));
+    }
+
+    thread_local PackBuffer<Real> bufferB;
+    size_t ncMax = std::min(cfg.nc, n);
+    size_t kcMax = std::min(cfg.kc, k);
+    Real* Bp = bufferB.reserve(kcMax * ((ncMax + cfg.nr - 1) / cfg.nr) * cfg.nr);
+
+    for(size_t jc{}; jc < n; jc += cfg.nc) {
+        size_t nc = std::min(cfg.nc, n - jc);
+        size_t slivers = (nc + cfg.nr - 1) / cfg.nr;
+        for(size_t pc{}; pc < k; pc += cfg.kc) {
+            size_t kc = std::min(cfg.kc, k - pc);
+            const Real* Bsrc = B + pc * rsB + jc * csB;
+            auto packSlivers = [&](size_t first, size_t last) {
+                size_t j0 = first * cfg.nr;
+                size_t j1 = std::min(nc, last * cfg.nr);
+                packB(kc, j1 - j0, Bsrc + j0 * csB, rsB, csB, cfg.nr, Bp + j0 * kc);
+            };
+            // Every A block of this k slice shares the packed B panel
+            auto multiplyBlocks = [&](size_t first, size_t last) {
+                thread_local PackBuffer<Real> bufferA;
+                Real* Ap = bufferA.reserve(kc * ((mcBlock + cfg.mr - 1) / cfg.mr) * cfg.mr);
+                for(size_t block{first}; block < last; block++) {
+                    size_t ic = block * mcBlock;
+                    size_t mc = std::min(mcBlock, m - ic);
+                    packA(mc, kc, A + ic * rsA + pc * csA, rsA, csA, cfg.mr, Ap);
+                    macroKernel(cfg, mc, nc, kc, alpha, Ap, Bp, C + ic * ldc + jc, ldc);
+                }
+            };
+            size_t blocks = (m + mcBlock - 1) / mcBlock;
+            if(pool) {
+                pool->parallelFor(0, slivers, 1, packSlivers);
+                pool->parallelFor(0, blocks, 1, multiplyBlocks);
+            } else {
+                packSlivers(0, slivers);
+                multiplyBlocks(0, blocks);
+            }
+        }
+    }
+}
+
+template<typename Real>
+void gemmViews(Real alpha, const BasicConstMatrixView<Real>& A, const BasicConstMatrixView<Real>& B, Real beta, const BasicMatrixView<Real>& C) {
+    if(A.columns != B.rows || C.rows != A.rows || C.columns != B.columns) {
+        throw std::invalid_argument("Matrix dimensions do not agree for multiplication");
+    }
+    size_t m = A.rows, n = B.columns, k = A.columns;
+    if(C.colStride == 1) {
+        gemmBlocked(m, n, k, alpha, A.data, A.rowStride, A.colStride, B.data, B.rowStride, B.colStride, beta, C.data, C.rowStride);
+    } else if(C.rowStride == 1) {
+        // Column-major C: compute C^T = B^T * A^T, which is row-major in the same storage
+        gemmBlocked(n, m, k, alpha, B.data, B.colStride, B.rowStride, A.data, A.colStride, A.rowStride, beta, C.data, C.colStride);
+    } else {
+        std::vector<Real> product(m * n);
+        gemmBlocked(m, n, k, Real(1), A.data, A.rowStride, A.colStride, B.data, B.rowStride, B.colStride, Real(0), product.data(), n);
+        for(size_t i{}; i < m; i++) {
+            for(size_t j{}; j < n; j++) {
+                Real& out = C.unchecked(i, j);
+                out = alpha * product[i * n + j] + (beta == 0 ? Real(0) : beta * out);
+            }
+        }
+    }
+}
+
+template<typename Real>
+void gemmReference(size_t m, size_t n, size_t k, Real alpha,
+                   const Real* A, size_t rsA, size_t csA,
+                   const Real* B, size_t rsB, size_t csB,
+                   Real beta, Real* C, size_t ldc) {
+    for(size_t i{}; i < m; i++) {
+        for(size_t j{}; j < n; j++) {
+            Real ans = 0;
+            for(size_t p{}; p < k; p++) {
+                ans += A[i * rsA + p * csA] * B[p * rsB + j * csB];
+            }
+            C[i * ldc + j] = alpha * ans + (beta == 0 ? Real(0) : beta * C[i * ldc + j]);
+        }
+    }
+}
+
+} // namespace
+
+void gemm(size_t m, size_t n, size_t k, double alpha,
+          const double* A, size_t rsA, size_t csA,
+          const double* B, size_t rsB, size_t csB,
+          double beta, double* C, size_t ldc) {
+    gemmBlocked(m, n, k, alpha, A, rsA, csA, B, rsB, csB, beta, C, ldc);
+}
+
+void gemm(size_t m, size_t n, size_t k, float alpha,
+          const float* A, size_t rsA, size_t csA,
+          const float* B, size_t rsB, size_t csB,
+          float beta, float* C, size_t ldc) {
+    gemmBlocked(m, n, k, alpha, A, rsA, csA, B, rsB, csB, beta, C, ldc);
+}
+
+void gemm(double alpha, const ConstMatrixView& A, const ConstMatrixView& B, double beta, const MatrixView& C) {
+    gemmViews(alpha, A, B, beta, C);
+}
+
+void gemm(float alpha, const ConstMatrixViewF& A, const ConstMatrixViewF& B, float beta, const MatrixViewF& C) {
+    gemmViews(alpha, A, B, beta, C);
+}
+
+void gemmNaive(size_t m, size_t n, size_t k, double alpha,
+               const double* A, size_t rsA, size_t csA,
+               const double* B, size_t rsB, size_t csB,
+               double beta, double* C, size_t ldc) {
+    gemmReference(m, n, k, alpha, A, rsA, csA, B, rsB, csB, beta, C, ldc);
+}
+
+void gemmNaive(size_t m, size_t n, size_t k, float alpha,
+               const float* A, size_t rsA, size_t csA,
+               const float* B, size_t rsB, size_t csB,
+               float beta, float* C, size_t ldc) {
+    gemmReference(m, n, k, alpha, A, rsA, csA, B, rsB, csB, beta, C, ldc);
+}
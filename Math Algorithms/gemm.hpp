@@ -0,0 +1,42 @@
+#ifndef GEMM_HPP
+#define GEMM_HPP
+
+#include "matrixView.hpp"
+#include <cstddef>
+
+/*
+Packed, register-tiled matrix multiply:  C = alpha * A * B + beta * C
+
+A is m x k and is read as A[i * rsA + p * csA], B is k x n and is read as
+B[p * rsB + j * csB], so transposed or strided operands need no copy.
+C is m x n, row-major, with leading dimension ldc.
+
+Operands are packed into cache-sized panels and fed to an MR x NR micro-kernel.
+The micro-kernel (scalar, AVX2 or AVX-512) is picked at runtime from activeSimdLevel().
+The float overloads run the same blocking with kernels twice as wide.
+*/
+void gemm(size_t m, size_t n, size_t k, double alpha,
+          const double* A, size_t rsA, size_t csA,
+          const double* B, size_t rsB, size_t csB,
+          double beta, double* C, size_t ldc);
+void gemm(size_t m, size_t n, size_t k, float alpha,
+          const float* A, size_t rsA, size_t csA,
+          const float* B, size_t rsB, size_t csB,
+          float beta, float* C, size_t ldc);
+
+// C = alpha * A * B + beta * C on views. C may be row-major or transposed (a column-major window);
+// any other C layout goes through a temporary.
+void gemm(double alpha, const ConstMatrixView& A, const ConstMatrixView& B, double beta, const MatrixView& C);
+void gemm(float alpha, const ConstMatrixViewF& A, const ConstMatrixViewF& B, float beta, const MatrixViewF& C);
+
+// Reference triple loop, used by the tests to check the blocked kernel.
+void gemmNaive(size_t m, size_t n, size_t k, double alpha,
+               const double* A, size_t rsA, size_t csA,
+               const double* B, size_t rsB, size_t csB,
+               double beta, double* C, size_t ldc);
+void gemmNaive(size_t m, size_t n, size_t k, float alpha,
+               const float* A, size_t rsA, size_t csA,
+               const float* B, size_t rsB, size_t csB,
+               float beta, float* C, size_t ldc);
+
+#endif
@@ -0,0 +1,234 @@
+#include "luFactorization.hpp"
+#include "gemm.hpp"
+#include "threadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+// Panel width: the panel is factored with row operations, everything right of it with GEMM
+static constexpr size_t BLOCK = 64;
+static constexpr size_t PARALLEL_GRAIN = 1 << 14;
+
+template<typename Real>
+BasicLUFactorization<Real>::BasicLUFactorization(const BasicConstMatrixView<Real>& A) : n(A.rows), LU(A), pivots(A.rows), pivotSign(1), singular(false) {
+    if(A.rows != A.columns) {
+        throw std::invalid_argument("You need a square matrix for LU factorization");
+    }
+    factor();
+}
+
+template<typename Real>
+BasicLUFactorization<Real>::BasicLUFactorization(BasicMatrix<Real>&& A) : n(A.rows), LU(std::move(A)), pivots(n), pivotSign(1), singular(false) {
+    if(LU.rows != LU.columns) {
+        throw std::invalid_argument("You need a square matrix for LU factorization");
+    }
+    factor();
+}
+
+template<typename Real>
+void BasicLUFactorization<Real>::factor() {
+    Real* a = LU.data.data();
+    // Pivots at rounding-noise level count as zero, otherwise exactly singular inputs come out with a
+    // determinant of 1e-16. Noise is measured against the pivot's own row and column rather than the
+    // whole matrix, so a well-conditioned matrix with widely spread scales such as diag(1e20, 1) stays regular.
+    ResourceVector<Real> rowScale(n, Real(0)), columnScale(n, Real(0));
+    for(size_t i{}; i < n; i++) {
+        for(size_t j{}; j < n; j++) {
+            Real value = std::fabs(a[i * n + j]);
+            rowScale[i] = std::max(rowScale[i], value);
+            columnScale[j] = std::max(columnScale[j], value);
+        }
+    }
+    const Real noise = Real(n) * std::numeric_limits<Real>::epsilon();
+    for(size_t k0{}; k0 < n; k0 += BLOCK) {
+        size_t kb = std::min(BLOCK, n - k0);
+        size_t panelEnd = k0 + kb;
+
+        for(size_t j{k0}; j < panelEnd; j++) {
+            size_t pivot = j;
+            Real best = std::fabs(a[j * n + j]);
+            for(size_t i{j + 1}; i < n; i++) {
+                Real candidate = std::fabs(a[i * n + j]);
+                if(candidate > best) {
+                    best = candidate;
+                    pivot = i;
+                }
+            }
+            pivots[j] = pivot;
+            if(best <= noise * std::min(rowScale[pivot], columnScale[j])) {
+                singular = true;
+                continue;
+            }
+            if(pivot != j) {
+                std::swap_ranges(a + j * n, a + j * n + n, a + pivot * n);
+                std::swap(rowScale[j], rowScale[pivot]);
+                pivotSign = -pivotSign;
+            }
+            const Real* pivotRow = a + j * n;
+            Real inverse = Real(1) / pivotRow[j];
+            parallelChunks(n - j - 1, std::max<size_t>(1, PARALLEL_GRAIN / kb), [&](size_t begin, size_t end) {
+                for(size_t i{j + 1 + begin}; i < j + 1 + end; i++) {
+                    Real* row = a + i * n;
+                    Real factor = row[j] * inverse;
+                    row[j] = factor;
+                    for(size_t c{j + 1}; c < panelEnd; c++) {
+                        row[c] -= factor * pivotRow[c];
+                    }
+                }
+            });
+        }
+
+        if(panelEnd == n) {
+            break;
+        }
+        // U12 = L11^-1 * A12, a row-oriented forward substitution inside the block row
+        size_t trailing = n - panelEnd;
+        for(size_t i{k0 + 1}; i < panelEnd; i++) {
+            Real* row = a + i * n + panelEnd;
+            for(size_t j{k0}; j < i; j++) {
+                Real factor = a[i * n + j];
+                const Real* source = a + j * n + panelEnd;
+                for(size_t c{}; c < trailing; c++) {
+                    row[c] -= factor * source[c];
+                }
+            }
+        }
+        // A22 -= L21 * U12
+        gemm(trailing, trailing, kb, Real(-1),
+             a + panelEnd * n + k0, n, 1,
+             a + k0 * n + panelEnd, n, 1,
+             Real(1), a + panelEnd * n + panelEnd, n);
+    }
+}
+
+// Four partial sums break the add-latency chain of a single right hand side
+template<typename Real>
+static Real dot(const Real* a, const Real* x, size_t count) {
+    Real s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t j{};
+    for(; j + 4 <= count; j += 4) {
+        s0 += a[j] * x[j];
+        s1 += a[j + 1] * x[j + 1];
+        s2 += a[j + 2] * x[j + 2];
+        s3 += a[j + 3] * x[j + 3];
+    }
+    for(; j < count; j++) {
+        s0 += a[j] * x[j];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+template<typename Real>
+void BasicLUFactorization<Real>::solveInPlace(BasicMatrix<Real>& X) const {
+    if(singular) {
+        throw std::runtime_error("Matrix is not invertible as determinant is zero");
+    }
+    if(X.rows != n) {
+        throw std::invalid_argument("Right hand side does not have the same number of rows as the system");
+    }
+    size_t m = X.columns;
+    Real* x = X.data.data();
+    const Real* a = LU.data.data();
+    for(size_t i{}; i < n; i++) {
+        if(pivots[i] != i) {
+            std::swap_ranges(x + i * m, x + i * m + m, x + pivots[i] * m);
+        }
+    }
+    if(m == 1) {
+        for(size_t i{}; i < n; i++) {
+            x[i] -= dot(a + i * n, x, i);
+        }
+        for(size_t i{n}; i-- > 0;) {
+            x[i] = (x[i] - dot(a + i * n + i + 1, x + i + 1, n - i - 1)) / a[i * n + i];
+        }
+        return;
+    }
+    // Blocked like the factorization: the part of each substitution that reaches outside the
+    // current block of rows is one GEMM, only the triangle inside the block is done row by row.
+    // Columns of X are independent systems, so that triangle splits by column.
+    const size_t grain = std::max<size_t>(1, PARALLEL_GRAIN / BLOCK);
+    for(size_t k0{}; k0 < n; k0 += BLOCK) {
+        size_t kb = std::min(BLOCK, n - k0);
+        if(k0 > 0) {
+            gemm(kb, m, k0, Real(-1), a + k0 * n, n, 1, x, m, 1, Real(1), x + k0 * m, m);
+        }
+        parallelChunks(m, grain, [&](size_t c0, size_t c1) {
+            for(size_t i{k0 + 1}; i < k0 + kb; i++) {
+                Real* row = x + i * m;
+                for(size_t j{k0}; j < i; j++) {
+                    Real factor = a[i * n + j];
+                    const Real* source = x + j * m;
+                    for(size_t c{c0}; c < c1; c++) {
+                        row[c] -= factor * source[c];
+                    }
+                }
+            }
+        });
+    }
+    for(size_t k1{n}; k1 > 0;) {
+        size_t kb = std::min(BLOCK, k1);
+        size_t k0 = k1 - kb;
+        if(k1 < n) {
+            gemm(kb, m, n - k1, Real(-1), a + k0 * n + k1, n, 1, x + k1 * m, m, 1, Real(1), x + k0 * m, m);
+        }
+        parallelChunks(m, grain, [&](size_t c0, size_t c1) {
+            for(size_t i{k1}; i-- > k0;) {
+                Real* row = x + i * m;
+                for(size_t j{i + 1}; j < k1; j++) {
+                    Real factor = a[i * n + j];
+                    const Real* source = x + j * m;
+                    for(size_t c{c0}; c < c1; c++) {
+                        row[c] -= factor * source[c];
+                    }
+                }
+                Real inverse = Real(1) / a[i * n + i];
+                for(size_t c{c0}; c < c1; c++) {
+                    row[c] *= inverse;
+                }
+            }
+        });
+        k1 = k0;
+    }
+}
+
+template<typename Real>
+std::vector<Real> BasicLUFactorization<Real>::solve(const std::vector<Real>& b) const {
+    BasicMatrix<Real> X(b.size(), 1, MatrixInit::Uninitialized);
+    X.data.assign(b.begin(), b.end());
+    solveInPlace(X);
+    return std::vector<Real>(X.data.begin(), X.data.end());
+}
+
+template<typename Real>
+BasicMatrix<Real> BasicLUFactorization<Real>::solve(const BasicConstMatrixView<Real>& B) const {
+    BasicMatrix<Real> X = B;
+    solveInPlace(X);
+    return X;
+}
+
+template<typename Real>
+BasicMatrix<Real> BasicLUFactorization<Real>::inverse() const {
+    BasicMatrix<Real> X(n, n);
+    for(size_t i{}; i < n; i++) {
+        X.unchecked(i, i) = 1.0;
+    }
+    solveInPlace(X);
+    return X;
+}
+
+template<typename Real>
+double BasicLUFactorization<Real>::det() const {
+    if(singular) {
+        return 0.0;
+    }
+    double determinant = pivotSign;
+    for(size_t i{}; i < n; i++) {
+        determinant *= LU.unchecked(i, i);
+    }
+    return determinant;
+}
+
+template struct BasicLUFactorization<double>;
+template struct BasicLUFactorization<float>;
@@ -0,0 +1,47 @@
+#ifndef LUFACTORIZATION_HPP
+#define LUFACTORIZATION_HPP
+
+#include "matrix.hpp"
+#include <vector>
+
+/*
+PA = LU with partial (row) pivoting, factored once in O(n^3) and reused.
+LU holds the unit lower triangle L below the diagonal and U on and above it.
+pivots[i] is the row swapped with row i at step i, in the LAPACK getrf convention.
+
+A pivot that is zero up to rounding, relative to the largest entries of its own row and column,
+marks the factorization singular: det() is then 0 and the solvers throw instead of dividing by zero.
+Badly scaled but regular matrices factor normally; judging ill-conditioning is left to the caller.
+
+Instantiated for double (LUFactorization) and float (LUFactorizationF).
+*/
+template<typename Real>
+struct BasicLUFactorization {
+public:
+    size_t n;
+    BasicMatrix<Real> LU;
+    ResourceVector<size_t> pivots;
+    int pivotSign;
+    bool singular;
+
+    explicit BasicLUFactorization(const BasicConstMatrixView<Real>& A);
+    // Factors in A's own storage, no copy
+    explicit BasicLUFactorization(BasicMatrix<Real>&& A);
+
+    std::vector<Real> solve(const std::vector<Real>& b) const;
+    BasicMatrix<Real> solve(const BasicConstMatrixView<Real>& B) const;
+    BasicMatrix<Real> inverse() const;
+    double det() const;
+
+private:
+    void factor();
+    void solveInPlace(BasicMatrix<Real>& X) const;
+};
+
+extern template struct BasicLUFactorization<double>;
+extern template struct BasicLUFactorization<float>;
+
+using LUFactorization = BasicLUFactorization<double>;
+using LUFactorizationF = BasicLUFactorization<float>;
+
+#endif
@@ -0,0 +1,67 @@
+#include "mappedFile.hpp"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static std::runtime_error ioError(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+MappedFile::MappedFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) {
+        throw ioError("Cannot open", path);
+    }
+    struct stat info;
+    if(::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw ioError("Cannot stat", path);
+    }
+    length = size_t(info.st_size);
+    if(length == 0) {
+        ::close(fd);
+        return;
+    }
+    void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(mapping == MAP_FAILED) {
+        length = 0;
+        throw ioError("Cannot map", path);
+    }
+    bytes = static_cast<const char*>(mapping);
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : bytes(std::exchange(other.bytes, nullptr)), length(std::exchange(other.length, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if(this != &other) {
+        release();
+        bytes = std::exchange(other.bytes, nullptr);
+        length = std::exchange(other.length, 0);
+    }
+    return *this;
+}
+
+void MappedFile::release() {
+    if(bytes) {
+        ::munmap(const_cast<char*>(bytes), length);
+        bytes = nullptr;
+        length = 0;
+    }
+}
+
+void MappedFile::adviseSequential() const {
+    if(bytes) {
+        ::madvise(const_cast<char*>(bytes), length, MADV_SEQUENTIAL);
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <string>
+
+// Whole file mapped read-only and shared, unmapped when the object goes away. Empty files map to size 0.
+struct MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+    // Hint that the file will be read front to back once
+    void adviseSequential() const;
+
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+
+    void release();
+};
+
+#endif
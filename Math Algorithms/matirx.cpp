@@ -1,146 +1,162 @@
 #include "matrix.hpp"
+#include "gemm.hpp"
+#include "luFactorization.hpp"
+#include "threadPool.hpp"
 #include <stdexcept>
-#include <float.h>
+#include <limits>
 #include <cmath>
+#include <algorithm>
 
-Matrix::Matrix(const size_t& _rows, const size_t& _columns) : rows(_rows), columns(_columns){
-    data.resize(rows * columns);
+template<typename Real>
+BasicMatrix<Real>::BasicMatrix(const size_t& _rows, const size_t& _columns, MatrixInit init) : rows(_rows), columns(_columns){
+    if(init == MatrixInit::Zero) {
+        data.resize(rows * columns, Real(0));
+    } else {
+        data.resize(rows * columns);
+    }
 }
 
-void Matrix::append(size_t row, size_t col, double value) {
+template<typename Real>
+void BasicMatrix<Real>::append(size_t row, size_t col, Real value) {
     if(row >= rows || col >= columns) {
         throw std::out_of_range("You are trying to insert an element that doesn't exist");
     }
     data[row * columns + col] = value;
 }
 
-double Matrix::get(size_t row, size_t col) {
+template<typename Real>
+Real BasicMatrix<Real>::get(size_t row, size_t col) {
     if(row >= rows || col >= columns) {
         throw std::out_of_range("Matrix indices out of range");
     }
     return data[row * columns + col];
 }
 
-double Matrix::get(size_t row, size_t col) const {
+template<typename Real>
+Real BasicMatrix<Real>::get(size_t row, size_t col) const {
     if(row >= rows || col >= columns) {
         throw std::out_of_range("Matrix indices out of range");
     }
     return data[row * columns + col];
 }
 
-double& Matrix::operator()(size_t row, size_t col) {
+template<typename Real>
+Real& BasicMatrix<Real>::operator()(size_t row, size_t col) {
     if(row >= rows || col >= columns) {
         throw std::out_of_range("Matrix indices out of range");
     }
     return data[row * columns + col];
 }
 
-const double& Matrix::operator()(size_t row, size_t col) const {
+template<typename Real>
+const Real& BasicMatrix<Real>::operator()(size_t row, size_t col) const {
     if(row >= rows || col >= columns) {
         throw std::out_of_range("Matrix indices out of range");
     }
     return data[row * columns + col];
 }
 
-Matrix Matrix::operator+(const Matrix& Addend) const {
-    if(Addend.rows != rows || Addend.columns != columns) {
-        throw std::invalid_argument("Addend Matrix does not have the same dimensions");
-    }
-    Matrix temp(rows, columns);
-    for(size_t index{}; index < rows * columns; index++) {
-        temp.data[index] = data[index] + Addend.data[index];
-    }
-    return temp;
-}
-
-Matrix& Matrix::operator+=(const Matrix& Addend) {
+template<typename Real>
+BasicMatrix<Real>& BasicMatrix<Real>::operator+=(const BasicMatrix& Addend) {
     if(Addend.rows != rows || Addend.columns != columns) {
         throw std::invalid_argument("Addend Matrix does not have the same dimensions");
     }
-    for(size_t index{}; index < rows * columns; index++) {
-        data[index] += Addend.data[index];
-    }
-    return *this;
-}
-
-Matrix Matrix::operator*(const double& scalar) const {
-    Matrix temp(rows, columns);
-    for(size_t index{}; index < rows * columns; index++) {
-        if(data[index] > (DBL_MAX / scalar)) {
-            throw std::overflow_error("Overflow Error when attempting scalar multiplication");
+    parallelChunks(rows * columns, MATRIX_PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+        for(size_t index{begin}; index < end; index++) {
+            data[index] += Addend.data[index];
         }
-        temp.data[index] = data[index] * scalar;
-    }
-    return temp;
+    });
+    return *this;
 }
 
-Matrix& Matrix::operator*=(const double& scalar) {
-    for(size_t index{}; index < rows * columns; index++) {
-        if(data[index] > DBL_MAX / scalar) {
-            throw std::overflow_error("Overflow Error when attempting scalar multiplication");
+template<typename Real>
+BasicMatrix<Real>& BasicMatrix<Real>::operator*=(const double& scalar) {
+    parallelChunks(rows * columns, MATRIX_PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+        for(size_t index{begin}; index < end; index++) {
+            if(std::fabs(data[index]) > std::numeric_limits<Real>::max() / std::fabs(scalar)) {
+                throw std::overflow_error("Overflow Error when attempting scalar multiplication");
+            }
+            data[index] = static_cast<Real>(data[index] * scalar);
         }
-        data[index] *= scalar;
-    }
+    });
     return *this;
 }
 
-Matrix operator*(double scalar, const Matrix& mat) {
-    return mat * scalar;
-}
-
-Matrix Matrix::operator-(const Matrix& Subtrahend) const {
+template<typename Real>
+BasicMatrix<Real>& BasicMatrix<Real>::operator-=(const BasicMatrix& Subtrahend) {
     if(Subtrahend.rows != rows || Subtrahend.columns != columns) {
         throw std::invalid_argument("Subtrahend Matrix does not have the same dimensions");
     }
-    return (*this + (Subtrahend * -1.0));
+    parallelChunks(rows * columns, MATRIX_PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+        for(size_t index{begin}; index < end; index++) {
+            data[index] -= Subtrahend.data[index];
+        }
+    });
+    return *this;
 }
 
-Matrix& Matrix::operator-=(const Matrix& Subtrahend) {
-    if(Subtrahend.rows != rows || Subtrahend.columns != columns) {
-        throw std::invalid_argument("Subtrahend Matrix does not have the same dimensions");
-    }
-    return *this += (Subtrahend * -1.0);
+template<typename Real>
+BasicMatrix<Real> BasicMatrix<Real>::operator*(const BasicMatrix& Factor) const {
+    return multiply(view(), Factor.view());
 }
 
-Matrix Matrix::operator*(const Matrix& Factor) const {
-    if(columns != Factor.rows) {
+template<typename Real>
+static BasicMatrix<Real> multiplyViews(const BasicConstMatrixView<Real>& A, const BasicConstMatrixView<Real>& B) {
+    if(A.columns != B.rows) {
         throw std::invalid_argument("You can not multiply matrixes where first matrix rows != second matrix columns");
     }
-    Matrix temp(rows, Factor.columns);
-    for(size_t index{}; index < rows; index++) {
-        for(size_t index2{}; index2 < Factor.columns; index2++) {
-            double ans = 0;
-            for(size_t index3{}; index3 < columns; index3++) {
-                // Use const get() method here
-                ans += (this->get(index, index3) * Factor.get(index3, index2));
-            }
-            temp.append(index, index2, ans);
-        }
-    }
+    // beta = 0 makes gemm overwrite every element
+    BasicMatrix<Real> temp(A.rows, B.columns, MatrixInit::Uninitialized);
+    gemm(A.rows, B.columns, A.columns, Real(1),
+         A.data, A.rowStride, A.colStride,
+         B.data, B.rowStride, B.colStride,
+         Real(0), temp.data.data(), temp.columns);
     return temp;
 }
 
-Matrix& Matrix::operator*=(const Matrix& Factor) {
+Matrix multiply(const ConstMatrixView& A, const ConstMatrixView& B) {
+    return multiplyViews(A, B);
+}
+
+MatrixF multiply(const ConstMatrixViewF& A, const ConstMatrixViewF& B) {
+    return multiplyViews(A, B);
+}
+
+template<typename Real>
+BasicMatrix<Real>& BasicMatrix<Real>::operator*=(const BasicMatrix& Factor) {
     *this = *this * Factor;
     return *this;
 }
 
-Matrix Matrix::T() const {
-    Matrix answer(columns, rows);
-    for(size_t row{}; row < rows; row++) {
-        for(size_t col{}; col < columns; col++) {
-            answer.append(col, row, data[row * columns + col]);
+template<typename Real>
+BasicMatrix<Real> BasicMatrix<Real>::T() const {
+    // Tiled so both the reads and the strided writes stay inside a few cache lines
+    constexpr size_t TILE = 32;
+    BasicMatrix answer(columns, rows, MatrixInit::Uninitialized);
+    size_t rowTiles = (rows + TILE - 1) / TILE;
+    parallelChunks(rowTiles, std::max<size_t>(1, MATRIX_PARALLEL_GRAIN / (TILE * std::max<size_t>(columns, 1))), [&](size_t first, size_t last) {
+        for(size_t r0{first * TILE}; r0 < std::min(rows, last * TILE); r0 += TILE) {
+            for(size_t c0{}; c0 < columns; c0 += TILE) {
+                size_t rEnd = std::min(rows, r0 + TILE);
+                size_t cEnd = std::min(columns, c0 + TILE);
+                for(size_t row{r0}; row < rEnd; row++) {
+                    for(size_t col{c0}; col < cEnd; col++) {
+                        answer.data[col * rows + row] = data[row * columns + col];
+                    }
+                }
+            }
         }
-    }
+    });
     return answer;
 }
 
-std::pair<Matrix, Matrix> Matrix::LU_Decomposition() const {
+template<typename Real>
+std::pair<BasicMatrix<Real>, BasicMatrix<Real>> BasicMatrix<Real>::LU_Decomposition() const {
     if(rows != columns) {
         throw std::invalid_argument("You need a square matrix for LU decomposition");
     }
-    Matrix L(rows, columns);
-    Matrix U = *this;
+    BasicMatrix L(rows, columns);
+    BasicMatrix U = *this;
     
     for(size_t i{}; i < rows; i++) {
         L.append(i, i, 1);
@@ -150,40 +166,41 @@ std::pair<Matrix, Matrix> Matrix::LU_Decomposition() const {
         if(U.get(col, col) == 0) {
             throw std::runtime_error("LU decomposition failed because matrix is singular");
         }
-        for(size_t row{col+1}; row < rows; row++) {
-            L.append(row, col, (U.get(row, col) / U.get(col, col)));
-            for(size_t U_COL{col}; U_COL < columns; U_COL++) {
-                U.append(row, U_COL, (U.get(row, U_COL) - L.get(row, col) * U.get(col, U_COL)));
+        // Rows below the pivot are independent, split them once the trailing block is large
+        size_t trailing = columns - col;
+        size_t grain = std::max<size_t>(1, MATRIX_PARALLEL_GRAIN / trailing);
+        parallelChunks(rows - col - 1, grain, [&](size_t begin, size_t end) {
+            const Real* pivotRow = &U.unchecked(col, 0);
+            for(size_t row{col + 1 + begin}; row < col + 1 + end; row++) {
+                Real factor = U.unchecked(row, col) / pivotRow[col];
+                L.unchecked(row, col) = factor;
+                Real* target = &U.unchecked(row, 0);
+                for(size_t U_COL{col}; U_COL < columns; U_COL++) {
+                    target[U_COL] -= factor * pivotRow[U_COL];
+                }
             }
-        }
+        });
     }
     return {L, U};
 }
 
-double Matrix::det() const {
+template<typename Real>
+double BasicMatrix<Real>::det() const {
     if(rows != columns) {
         throw std::invalid_argument("You need a square matrix to take a determinant");
     }
-    try {
-        Matrix U = LU_Decomposition().second;
-        double determinant = 1;
-        for(size_t i{}; i < rows; i++) {
-            determinant *= U.get(i, i);
-        }
-        return determinant;
-    } catch(const std::runtime_error& e) {
-        return 0.0;
-    }
+    return BasicLUFactorization<Real>(*this).det();
 }
 
-Matrix Matrix::minor(size_t remove_row, size_t remove_col) const {
+template<typename Real>
+BasicMatrix<Real> BasicMatrix<Real>::minor(size_t remove_row, size_t remove_col) const {
     if(remove_row >= rows) {
         throw std::invalid_argument("The row is greater than total rows");
     }
     if(remove_col >= columns) {
         throw std::invalid_argument("The column is greater than total columns");
     }
-    Matrix temp(rows - 1, columns - 1);
+    BasicMatrix temp(rows - 1, columns - 1);
     for(size_t row{}; row < rows; row++) {
         for(size_t col{}; col < columns; col++) {
             if(row == remove_row || col == remove_col) {
@@ -197,35 +214,50 @@ Matrix Matrix::minor(size_t remove_row, size_t remove_col) const {
     return temp;
 }
 
-Matrix Matrix::cof() const {
-    Matrix cofactor(rows, columns);
+template<typename Real>
+BasicMatrix<Real> BasicMatrix<Real>::cof() const {
+    if(rows != columns) {
+        throw std::invalid_argument("You need a square matrix to take cofactors");
+    }
+    // cof(A) = det(A) * inv(A)^T whenever A is invertible, one factorization instead of n^2
+    BasicLUFactorization<Real> lu(*this);
+    if(!lu.singular) {
+        return lu.inverse().T() * lu.det();
+    }
+    BasicMatrix cofactor(rows, columns);
     for(size_t row{}; row < rows; row++) {
         for(size_t col{}; col < columns; col++) {
             double sign = pow(-1.0, (row & 1) + (col & 1));
             double determinant = minor(row, col).det();
-            cofactor.append(row, col, sign * determinant);
+            cofactor.append(row, col, static_cast<Real>(sign * determinant));
         }
     }
     return cofactor;
 }
 
-Matrix Matrix::adj() const {
-    Matrix temp = cof();
+template<typename Real>
+BasicMatrix<Real> BasicMatrix<Real>::adj() const {
+    if(rows != columns) {
+        throw std::invalid_argument("You need a square matrix to take an adjugate");
+    }
+    BasicLUFactorization<Real> lu(*this);
+    if(!lu.singular) {
+        return lu.inverse() * lu.det();
+    }
+    BasicMatrix temp = cof();
     return temp.T();
 }
 
-Matrix Matrix::inv() const {
+template<typename Real>
+BasicMatrix<Real> BasicMatrix<Real>::inv() const {
     if(rows != columns) {
         throw std::invalid_argument("You need a square matrix to have an inverse");
     }
-    double determinant = det();
-    if(determinant == 0) {
-        throw std::runtime_error("Matrix is not invertible as determinant is zero");
-    }
-    return ((1 / determinant) * adj());
+    return BasicLUFactorization<Real>(*this).inverse();
 }
 
-void Matrix::print() const {
+template<typename Real>
+void BasicMatrix<Real>::print() const {
     for(size_t i = 0; i < rows; i++) {
         for(size_t j = 0; j < columns; j++) {
             std::cout << this->get(i, j) << " ";
@@ -234,14 +266,15 @@ void Matrix::print() const {
     }
 }
 
-Matrix Matrix::lookAt(const Vec3D& eye, const Vec3D& focus, const Vec3D& up) {
+template<typename Real>
+BasicMatrix<Real> BasicMatrix<Real>::lookAt(const Vec3D& eye, const Vec3D& focus, const Vec3D& up) {
     Vec3D F = focus - eye;
     F = F.normal();
     Vec3D normalUP = up.normal();
     Vec3D s = F.cross(normalUP);
     Vec3D u = s.normal().cross(F);
     
-    Matrix ans(4, 4);
+    BasicMatrix ans(4, 4);
     ans.append(0, 0, s.x());
     ans.append(0, 1, s.y());
     ans.append(0, 2, s.z());
@@ -259,4 +292,7 @@ Matrix Matrix::lookAt(const Vec3D& eye, const Vec3D& focus, const Vec3D& up) {
     ans.append(3, 2, 0);
     ans.append(3, 3, 1);
     return ans;
-}
\ No newline at end of file
+}
+
+template struct BasicMatrix<double>;
+template struct BasicMatrix<float>;
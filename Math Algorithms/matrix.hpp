@@ -1,47 +1,229 @@
 #ifndef MATRIX_HPP
 #define MATRIX_HPP
 
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <utility>
 #include <cmath>
+#include <type_traits>
 #include "3DVector.hpp"
+#include "matrixExpr.hpp"
+#include "matrixView.hpp"
+#include "memoryResource.hpp"
+#include "threadPool.hpp"
 
-struct Matrix {
+// Uninitialized skips the zero fill for buffers that are about to be completely overwritten
+enum class MatrixInit { Zero, Uninitialized };
+
+/*
+Dense row-major matrix of Real, which is double (Matrix) or float (MatrixF).
+Member functions are compiled once per scalar type in matirx.cpp. float halves the memory
+traffic and doubles the SIMD width of the GEMM and LU kernels; see mixedPrecision.hpp for
+solving in float and refining to double accuracy.
+*/
+template<typename Real>
+struct BasicMatrix : MatrixExpr<BasicMatrix<Real>> {
 public:
+    using Scalar = Real;
     size_t rows, columns;
-    std::vector<double> data;
+    // Drawn from the thread's current memory resource, see memoryResource.hpp
+    ResourceVector<Real> data;
 
-    Matrix(const size_t& _rows, const size_t& _columns);
-    
-    void append(size_t row, size_t col, double value);
-    double get(size_t row, size_t col);
-    double get(size_t row, size_t col) const;
-    double& operator()(size_t row, size_t col);
-    const double& operator()(size_t row, size_t col) const;
+    BasicMatrix(const size_t& _rows, const size_t& _columns, MatrixInit init = MatrixInit::Zero);
+    // Evaluates an elementwise expression in one pass, e.g. Matrix C = A + B * 2.0;
+    // also converts between float and double matrices.
+    template<typename E>
+    BasicMatrix(const MatrixExpr<E>& expr);
+    template<typename E>
+    BasicMatrix& operator=(const MatrixExpr<E>& expr);
     
-    Matrix operator+(const Matrix& Addend) const;
-    Matrix& operator+=(const Matrix& Addend);
-    Matrix operator*(const double& scalar) const;
-    friend Matrix operator*(double scalar, const Matrix& mat);
-    Matrix& operator*=(const double& scalar);
-    Matrix operator-(const Matrix& Subtrahend) const;
-    Matrix& operator-=(const Matrix& Subtrahend);
-    Matrix operator*(const Matrix& Factor) const;
-    Matrix& operator*=(const Matrix& Factor);
+    void append(size_t row, size_t col, Real value);
+    Real get(size_t row, size_t col);
+    Real get(size_t row, size_t col) const;
+    Real& operator()(size_t row, size_t col);
+    const Real& operator()(size_t row, size_t col) const;
+
+    // Unchecked access for hot loops, caller guarantees row < rows and col < columns
+    Real& unchecked(size_t row, size_t col) { return data[row * columns + col]; }
+    const Real& unchecked(size_t row, size_t col) const { return data[row * columns + col]; }
+    // Expression leaf access by flat row-major index
+    Real coeff(size_t index) const { return data[index]; }
+    // Only the element being written is read from a matrix leaf, so it never counts as overlapping
+    bool overlaps(const void*, const void*) const { return false; }
+
+    // Non-owning windows, see matrixView.hpp
+    BasicConstMatrixView<Real> view() const { return BasicConstMatrixView<Real>(data.data(), rows, columns, columns, 1); }
+    BasicMatrixView<Real> view() { return BasicMatrixView<Real>(data.data(), rows, columns, columns, 1); }
+    BasicConstMatrixView<Real> block(size_t row, size_t col, size_t blockRows, size_t blockColumns) const { return view().block(row, col, blockRows, blockColumns); }
+    BasicMatrixView<Real> block(size_t row, size_t col, size_t blockRows, size_t blockColumns) { return view().block(row, col, blockRows, blockColumns); }
+
+    // +, - and scalar * build lazy expressions, see matrixExpr.hpp
+    BasicMatrix& operator+=(const BasicMatrix& Addend);
+    template<typename E>
+    BasicMatrix& operator+=(const MatrixExpr<E>& Addend);
+    BasicMatrix& operator*=(const double& scalar);
+    BasicMatrix& operator-=(const BasicMatrix& Subtrahend);
+    template<typename E>
+    BasicMatrix& operator-=(const MatrixExpr<E>& Subtrahend);
+    BasicMatrix operator*(const BasicMatrix& Factor) const;
+    // Matrix * view, otherwise ambiguous between the member above and the expression operator*
+    template<typename E>
+    ProductMatrix<BasicMatrix, E> operator*(const MatrixExpr<E>& Factor) const;
+    BasicMatrix& operator*=(const BasicMatrix& Factor);
     
-    Matrix T() const;
-    std::pair<Matrix, Matrix> LU_Decomposition() const;
+    BasicMatrix T() const;
+    std::pair<BasicMatrix, BasicMatrix> LU_Decomposition() const;
     double det() const;
-    Matrix minor(size_t remove_row, size_t remove_col) const;
-    Matrix cof() const;
-    Matrix adj() const;
-    Matrix inv() const;
+    BasicMatrix minor(size_t remove_row, size_t remove_col) const;
+    BasicMatrix cof() const;
+    BasicMatrix adj() const;
+    BasicMatrix inv() const;
 
     void print() const;
-    static Matrix lookAt(const Vec3D& eye, const Vec3D& focus, const Vec3D& up);
+    static BasicMatrix lookAt(const Vec3D& eye, const Vec3D& focus, const Vec3D& up);
+
+private:
+    template<typename E>
+    void assign(const E& expr);
 };
 
+extern template struct BasicMatrix<double>;
+extern template struct BasicMatrix<float>;
+
+template<typename Real>
+inline BasicConstMatrixView<Real>::BasicConstMatrixView(const BasicMatrix<Real>& mat) : BasicConstMatrixView(mat.view()) {}
+template<typename Real>
+inline BasicMatrixView<Real>::BasicMatrixView(BasicMatrix<Real>& mat) : BasicMatrixView(mat.view()) {}
+
+// A * B for any pair of strided operands, transposes and blocks included, without copying them
+Matrix multiply(const ConstMatrixView& A, const ConstMatrixView& B);
+MatrixF multiply(const ConstMatrixViewF& A, const ConstMatrixViewF& B);
+
+template<typename E>
+constexpr bool IS_MATRIX_VIEW = false;
+template<typename Real>
+constexpr bool IS_MATRIX_VIEW<BasicConstMatrixView<Real>> = true;
+template<typename Real>
+constexpr bool IS_MATRIX_VIEW<BasicMatrixView<Real>> = true;
+
+template<typename E>
+constexpr bool IS_STRIDED_OPERAND = IS_OWNING_MATRIX<E> || IS_MATRIX_VIEW<E>;
+
+// Element count above which expression evaluation is split across the thread pool
+constexpr size_t MATRIX_PARALLEL_GRAIN = 1 << 15;
+
+// Matrix leaves are read only at the index being written, so A = B + A is safe in place. A view leaf
+// may read the destination at other positions (C = C.view().T()) and would dangle once the storage is
+// resized, so an expression with a view into the destination is evaluated into new storage first.
+template<typename Real>
+template<typename E>
+void BasicMatrix<Real>::assign(const E& expr) {
+    if(!data.empty() && expr.overlaps(data.data(), data.data() + data.size())) {
+        BasicMatrix result(expr.rows, expr.columns, MatrixInit::Uninitialized);
+        result.assign(expr);
+        rows = result.rows;
+        columns = result.columns;
+        data = std::move(result.data);
+        return;
+    }
+    if(rows != expr.rows || columns != expr.columns) {
+        rows = expr.rows;
+        columns = expr.columns;
+        data.resize(rows * columns);
+    }
+    Real* out = data.data();
+    if constexpr(IS_MATRIX_VIEW<E>) {
+        // Copy row by row instead of splitting every flat index back into (row, col)
+        parallelChunks(rows, std::max<size_t>(1, MATRIX_PARALLEL_GRAIN / std::max<size_t>(columns, 1)), [&](size_t begin, size_t end) {
+            for(size_t row{begin}; row < end; row++) {
+                for(size_t col{}; col < columns; col++) {
+                    out[row * columns + col] = static_cast<Real>(expr.unchecked(row, col));
+                }
+            }
+        });
+        return;
+    }
+    parallelChunks(rows * columns, MATRIX_PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+        for(size_t index{begin}; index < end; index++) {
+            out[index] = static_cast<Real>(expr.coeff(index));
+        }
+    });
+}
+
+template<typename Real>
+template<typename E>
+BasicMatrix<Real>::BasicMatrix(const MatrixExpr<E>& expr) : rows(expr.self().rows), columns(expr.self().columns) {
+    data.resize(rows * columns);
+    assign(expr.self());
+}
+
+template<typename Real>
+template<typename E>
+BasicMatrix<Real>& BasicMatrix<Real>::operator=(const MatrixExpr<E>& expr) {
+    assign(expr.self());
+    return *this;
+}
+
+template<typename Real>
+template<typename E>
+BasicMatrix<Real>& BasicMatrix<Real>::operator+=(const MatrixExpr<E>& Addend) {
+    assign(*this + Addend);
+    return *this;
+}
+
+template<typename Real>
+template<typename E>
+BasicMatrix<Real>& BasicMatrix<Real>::operator-=(const MatrixExpr<E>& Subtrahend) {
+    assign(*this - Subtrahend);
+    return *this;
+}
+
+// Strided operands of the product's scalar type are passed through as views, anything else
+// (expressions, or a double operand in a float product) is evaluated first
+template<typename S, typename E>
+auto productOperand(const E& operand) {
+    if constexpr(IS_STRIDED_OPERAND<E> && std::is_same<typename ExprScalar<E>::type, S>::value) {
+        return BasicConstMatrixView<S>(operand);
+    } else {
+        return BasicMatrix<S>(operand);
+    }
+}
+
+template<typename L, typename R>
+ProductMatrix<L, R> operator*(const MatrixExpr<L>& lhs, const MatrixExpr<R>& rhs) {
+    using S = typename ProductMatrix<L, R>::Scalar;
+    auto left = productOperand<S>(lhs.self());
+    auto right = productOperand<S>(rhs.self());
+    return multiply(BasicConstMatrixView<S>(left), BasicConstMatrixView<S>(right));
+}
+
+template<typename Real>
+template<typename E>
+ProductMatrix<BasicMatrix<Real>, E> BasicMatrix<Real>::operator*(const MatrixExpr<E>& Factor) const {
+    return static_cast<const MatrixExpr<BasicMatrix>&>(*this) * Factor;
+}
 
+template<typename E>
+auto MatrixExpr<E>::eval() const { return BasicMatrix<typename ExprScalar<E>::type>(*this); }
+template<typename E>
+double MatrixExpr<E>::get(size_t row, size_t col) const {
+    if(row >= self().rows || col >= self().columns) {
+        throw std::out_of_range("Matrix indices out of range");
+    }
+    return self().coeff(row * self().columns + col);
+}
+template<typename E>
+auto MatrixExpr<E>::T() const { return eval().T(); }
+template<typename E>
+double MatrixExpr<E>::det() const { return eval().det(); }
+template<typename E>
+auto MatrixExpr<E>::inv() const { return eval().inv(); }
+template<typename E>
+auto MatrixExpr<E>::adj() const { return eval().adj(); }
+template<typename E>
+auto MatrixExpr<E>::cof() const { return eval().cof(); }
+template<typename E>
+void MatrixExpr<E>::print() const { eval().print(); }
 
 #endif
\ No newline at end of file
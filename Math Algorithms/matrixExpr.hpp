@@ -0,0 +1,157 @@
+#ifndef MATRIXEXPR_HPP
+#define MATRIXEXPR_HPP
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+template<typename T>
+struct BasicMatrix;
+template<typename T>
+struct BasicConstMatrixView;
+template<typename T>
+struct BasicMatrixView;
+using Matrix = BasicMatrix<double>;
+using MatrixF = BasicMatrix<float>;
+
+/*
+Lazy elementwise Matrix expressions.
+A + B * 2.0 - C builds a small tree of nodes instead of three temporary matrices.
+The tree is walked once per element when it is assigned to a Matrix, so the whole
+expression becomes one fused loop with a single output buffer.
+
+Nodes hold Matrix operands by reference: assign an expression to a Matrix rather
+than keeping it in an auto variable past the lifetime of its operands.
+
+Leaves may be float or double. A node computes in float when all its leaves are float, so float
+expressions keep float's bandwidth and SIMD width and eval(), T(), inv() and friends hand back a
+MatrixF; as soon as one leaf is double the node computes in double.
+*/
+
+template<typename E>
+struct MatrixExpr {
+    const E& self() const { return static_cast<const E&>(*this); }
+
+    // A BasicMatrix of the expression's scalar type; defined in matrix.hpp
+    auto eval() const;
+
+    // Forwarders so code that used to get a Matrix back from +, - and * still compiles
+    double get(size_t row, size_t col) const;
+    auto T() const;
+    double det() const;
+    auto inv() const;
+    auto adj() const;
+    auto cof() const;
+    void print() const;
+};
+
+template<typename E>
+constexpr bool IS_OWNING_MATRIX = false;
+template<typename T>
+constexpr bool IS_OWNING_MATRIX<BasicMatrix<T>> = true;
+
+// Matrix leaves are referenced, nested expression nodes are small and copied by value
+template<typename E>
+using ExprOperand = std::conditional_t<IS_OWNING_MATRIX<E>, const E&, const E>;
+
+// Type a leaf stores or a node computes in
+template<typename E>
+struct ExprScalar {
+    using type = typename E::Scalar;
+};
+template<typename T>
+struct ExprScalar<BasicMatrix<T>> {
+    using type = T;
+};
+template<typename T>
+struct ExprScalar<BasicConstMatrixView<T>> {
+    using type = T;
+};
+template<typename T>
+struct ExprScalar<BasicMatrixView<T>> {
+    using type = T;
+};
+
+// Float only when both operands are float
+template<typename L, typename R>
+using CommonScalar = std::conditional_t<std::is_same<typename ExprScalar<L>::type, float>::value &&
+                                        std::is_same<typename ExprScalar<R>::type, float>::value, float, double>;
+
+template<typename L, typename R>
+using ProductMatrix = BasicMatrix<CommonScalar<L, R>>;
+
+struct AddOp {
+    template<typename S>
+    static S apply(S a, S b) { return a + b; }
+};
+
+struct SubtractOp {
+    template<typename S>
+    static S apply(S a, S b) { return a - b; }
+};
+
+template<typename L, typename R, typename Op>
+struct MatrixBinaryExpr : MatrixExpr<MatrixBinaryExpr<L, R, Op>> {
+    using Scalar = CommonScalar<L, R>;
+    ExprOperand<L> lhs;
+    ExprOperand<R> rhs;
+    size_t rows, columns;
+
+    MatrixBinaryExpr(const L& _lhs, const R& _rhs) : lhs(_lhs), rhs(_rhs), rows(_lhs.rows), columns(_lhs.columns) {}
+
+    Scalar coeff(size_t index) const { return Op::apply(Scalar(lhs.coeff(index)), Scalar(rhs.coeff(index))); }
+    bool overlaps(const void* begin, const void* end) const { return lhs.overlaps(begin, end) || rhs.overlaps(begin, end); }
+};
+
+template<typename E>
+struct MatrixScaledExpr : MatrixExpr<MatrixScaledExpr<E>> {
+    using Scalar = typename ExprScalar<E>::type;
+    ExprOperand<E> operand;
+    double scalar;
+    size_t rows, columns;
+
+    MatrixScaledExpr(const E& _operand, double _scalar) : operand(_operand), scalar(_scalar), rows(_operand.rows), columns(_operand.columns) {}
+
+    Scalar coeff(size_t index) const {
+        Scalar value = operand.coeff(index);
+        if(std::fabs(double(value)) > double(std::numeric_limits<Scalar>::max()) / std::fabs(scalar)) {
+            throw std::overflow_error("Overflow Error when attempting scalar multiplication");
+        }
+        return value * Scalar(scalar);
+    }
+    bool overlaps(const void* begin, const void* end) const { return operand.overlaps(begin, end); }
+};
+
+template<typename L, typename R>
+MatrixBinaryExpr<L, R, AddOp> operator+(const MatrixExpr<L>& Augend, const MatrixExpr<R>& Addend) {
+    if(Addend.self().rows != Augend.self().rows || Addend.self().columns != Augend.self().columns) {
+        throw std::invalid_argument("Addend Matrix does not have the same dimensions");
+    }
+    return MatrixBinaryExpr<L, R, AddOp>(Augend.self(), Addend.self());
+}
+
+template<typename L, typename R>
+MatrixBinaryExpr<L, R, SubtractOp> operator-(const MatrixExpr<L>& Minuend, const MatrixExpr<R>& Subtrahend) {
+    if(Subtrahend.self().rows != Minuend.self().rows || Subtrahend.self().columns != Minuend.self().columns) {
+        throw std::invalid_argument("Subtrahend Matrix does not have the same dimensions");
+    }
+    return MatrixBinaryExpr<L, R, SubtractOp>(Minuend.self(), Subtrahend.self());
+}
+
+template<typename E>
+MatrixScaledExpr<E> operator*(const MatrixExpr<E>& mat, double scalar) {
+    return MatrixScaledExpr<E>(mat.self(), scalar);
+}
+
+template<typename E>
+MatrixScaledExpr<E> operator*(double scalar, const MatrixExpr<E>& mat) {
+    return MatrixScaledExpr<E>(mat.self(), scalar);
+}
+
+// Products are not elementwise, so any expression operand is materialized and handed to GEMM
+template<typename L, typename R>
+ProductMatrix<L, R> operator*(const MatrixExpr<L>& lhs, const MatrixExpr<R>& rhs);
+
+#endif
@@ -0,0 +1,191 @@
+#include "matrixFile.hpp"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+static const char MAGIC[8] = {'Q', 'M', 'A', 'T', 'R', 'I', 'X', '\0'};
+static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+static size_t elementSize(MatrixDType dtype) {
+    return dtype == MatrixDType::Float64 ? sizeof(double) : sizeof(float);
+}
+
+static MatrixFileHeader makeHeader(size_t rows, size_t columns, MatrixDType dtype, MatrixLayout layout) {
+    MatrixFileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = MATRIX_FILE_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.dtype = uint32_t(dtype);
+    header.layout = uint32_t(layout);
+    header.rows = rows;
+    header.columns = columns;
+    header.alignment = MATRIX_FILE_ALIGNMENT;
+    header.dataOffset = MATRIX_FILE_ALIGNMENT;
+    return header;
+}
+
+static std::runtime_error ioError(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+MappedMatrix::MappedMatrix(const std::string& path) : file(path) {
+    if(file.size() < sizeof(MatrixFileHeader)) {
+        throw std::invalid_argument("File is too small to be a matrix file: " + path);
+    }
+    MatrixFileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    const char* problem = nullptr;
+    if(std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        problem = "Not a matrix file: ";
+    } else if(header.version != MATRIX_FILE_VERSION) {
+        problem = "Unsupported matrix file version: ";
+    } else if(header.byteOrder != BYTE_ORDER_MARK) {
+        problem = "Matrix file was written with a different byte order: ";
+    } else if(header.dtype > uint32_t(MatrixDType::Float32) || header.layout > uint32_t(MatrixLayout::ColumnMajor)) {
+        problem = "Unknown dtype or layout in matrix file: ";
+    } else if(header.dataOffset < sizeof(header) || header.dataOffset > file.size()
+              || (header.columns != 0 && (file.size() - header.dataOffset) / elementSize(MatrixDType(header.dtype)) / header.columns < header.rows)) {
+        problem = "Matrix file is truncated: ";
+    } else if(header.dataOffset % elementSize(MatrixDType(header.dtype)) != 0) {
+        // The mapping starts on a page, so an offset that is a whole number of elements keeps every element aligned
+        problem = "Matrix file data is misaligned: ";
+    }
+    if(problem) {
+        throw std::invalid_argument(problem + path);
+    }
+    rows = header.rows;
+    columns = header.columns;
+    dtype = MatrixDType(header.dtype);
+    layout = MatrixLayout(header.layout);
+    elements = reinterpret_cast<const unsigned char*>(file.data()) + header.dataOffset;
+}
+
+double MappedMatrix::operator()(size_t row, size_t col) const {
+    if(row >= rows || col >= columns) {
+        throw std::out_of_range("Index out of bounds");
+    }
+    size_t index = row * rowStride() + col * colStride();
+    if(dtype == MatrixDType::Float64) {
+        return reinterpret_cast<const double*>(elements)[index];
+    }
+    return reinterpret_cast<const float*>(elements)[index];
+}
+
+const double* MappedMatrix::doubles() const {
+    if(dtype != MatrixDType::Float64) {
+        throw std::logic_error("Matrix file does not hold float64 data");
+    }
+    return reinterpret_cast<const double*>(elements);
+}
+
+const float* MappedMatrix::floats() const {
+    if(dtype != MatrixDType::Float32) {
+        throw std::logic_error("Matrix file does not hold float32 data");
+    }
+    return reinterpret_cast<const float*>(elements);
+}
+
+ConstMatrixView MappedMatrix::view() const {
+    return ConstMatrixView(doubles(), rows, columns, rowStride(), colStride());
+}
+
+Matrix MappedMatrix::toMatrix() const {
+    Matrix result(rows, columns);
+    double* out = result.data.data();
+    if(dtype == MatrixDType::Float64 && layout == MatrixLayout::RowMajor) {
+        std::memcpy(out, elements, rows * columns * sizeof(double));
+        return result;
+    }
+    size_t rs = rowStride(), cs = colStride();
+    for(size_t i{}; i < rows; i++) {
+        for(size_t j{}; j < columns; j++) {
+            out[i * columns + j] = (dtype == MatrixDType::Float64)
+                ? reinterpret_cast<const double*>(elements)[i * rs + j * cs]
+                : reinterpret_cast<const float*>(elements)[i * rs + j * cs];
+        }
+    }
+    return result;
+}
+
+MatrixFileWriter::MatrixFileWriter(const std::string& path, size_t _columns, MatrixDType _dtype)
+    : file(std::fopen(path.c_str(), "wb")), columns(_columns), dtype(_dtype) {
+    if(!file) {
+        throw ioError("Cannot create matrix file", path);
+    }
+    // Large buffer: rows arrive one at a time but should reach the disk in big writes
+    std::setvbuf(file, nullptr, _IOFBF, 1 << 20);
+    MatrixFileHeader header = makeHeader(0, columns, dtype, MatrixLayout::RowMajor);
+    std::fwrite(&header, sizeof(header), 1, file);
+    if(dtype == MatrixDType::Float32) {
+        narrow.resize(columns);
+    }
+}
+
+MatrixFileWriter::~MatrixFileWriter() {
+    try {
+        close();
+    } catch(...) {}
+}
+
+void MatrixFileWriter::appendRow(const double* values) {
+    if(!file) {
+        throw std::logic_error("Matrix file writer is already closed");
+    }
+    size_t written;
+    if(dtype == MatrixDType::Float64) {
+        written = std::fwrite(values, sizeof(double), columns, file);
+    } else {
+        for(size_t j{}; j < columns; j++) {
+            narrow[j] = float(values[j]);
+        }
+        written = std::fwrite(narrow.data(), sizeof(float), columns, file);
+    }
+    if(written != columns) {
+        throw std::runtime_error("Short write to matrix file");
+    }
+    rows++;
+}
+
+void MatrixFileWriter::appendRows(const ConstMatrixView& block) {
+    if(block.columns != columns) {
+        throw std::invalid_argument("Block columns do not match the matrix file");
+    }
+    if(dtype == MatrixDType::Float64 && file && block.contiguous()) {
+        size_t count = block.rows * block.columns;
+        if(std::fwrite(block.data, sizeof(double), count, file) != count) {
+            throw std::runtime_error("Short write to matrix file");
+        }
+        rows += block.rows;
+        return;
+    }
+    std::vector<double> row(columns);
+    for(size_t i{}; i < block.rows; i++) {
+        for(size_t j{}; j < columns; j++) {
+            row[j] = block.unchecked(i, j);
+        }
+        appendRow(row.data());
+    }
+}
+
+void MatrixFileWriter::close() {
+    if(!file) {
+        return;
+    }
+    MatrixFileHeader header = makeHeader(rows, columns, dtype, MatrixLayout::RowMajor);
+    bool ok = std::fseek(file, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = std::fclose(file) == 0 && ok;
+    file = nullptr;
+    if(!ok) {
+        throw std::runtime_error("Failed to finish matrix file");
+    }
+}
+
+void writeMatrixFile(const std::string& path, const ConstMatrixView& matrix, MatrixDType dtype) {
+    MatrixFileWriter writer(path, matrix.columns, dtype);
+    writer.appendRows(matrix);
+    writer.close();
+}
+
+Matrix readMatrixFile(const std::string& path) {
+    return MappedMatrix(path).toMatrix();
+}
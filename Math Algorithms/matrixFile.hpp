@@ -0,0 +1,100 @@
+#ifndef MATRIXFILE_HPP
+#define MATRIXFILE_HPP
+
+#include "mappedFile.hpp"
+#include "matrix.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/*
+Binary matrix file (.qmat), version 1.
+
+    offset  0  char[8]   magic "QMATRIX\0"
+            8  uint32    version
+           12  uint32    byte order mark 0x01020304, written natively
+           16  uint32    dtype   (MatrixDType)
+           20  uint32    layout  (MatrixLayout)
+           24  uint64    rows
+           32  uint64    columns
+           40  uint64    alignment of the data block
+           48  uint64    offset of the data block from the start of the file
+           56  uint64    reserved, zero
+
+The element block starts on an alignment boundary and is stored densely with no padding between rows.
+Files are read back with mmap, so opening one costs nothing per element and several processes
+mapping the same file share its pages through the page cache.
+*/
+enum class MatrixDType : uint32_t { Float64 = 0, Float32 = 1 };
+enum class MatrixLayout : uint32_t { RowMajor = 0, ColumnMajor = 1 };
+
+struct MatrixFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t dtype;
+    uint32_t layout;
+    uint64_t rows;
+    uint64_t columns;
+    uint64_t alignment;
+    uint64_t dataOffset;
+    uint64_t reserved;
+};
+static_assert(sizeof(MatrixFileHeader) == 64, "Matrix file header must stay 64 bytes");
+
+constexpr uint32_t MATRIX_FILE_VERSION = 1;
+constexpr uint64_t MATRIX_FILE_ALIGNMENT = 64;
+
+// Read-only view of a matrix file. The mapping lives as long as the view; nothing is parsed or copied.
+struct MappedMatrix {
+public:
+    size_t rows, columns;
+    MatrixDType dtype;
+    MatrixLayout layout;
+
+    explicit MappedMatrix(const std::string& path);
+
+    double operator()(size_t row, size_t col) const;
+    // Raw element block; only valid for the matching dtype, throws otherwise
+    const double* doubles() const;
+    const float* floats() const;
+    // Distance between consecutive rows and columns in elements, for layout-agnostic loops
+    size_t rowStride() const { return layout == MatrixLayout::RowMajor ? columns : 1; }
+    size_t colStride() const { return layout == MatrixLayout::RowMajor ? 1 : rows; }
+
+    // Zero-copy view of float64 data in either layout; throws for float32 files
+    ConstMatrixView view() const;
+    // Copies into an owning row-major double Matrix
+    Matrix toMatrix() const;
+
+private:
+    MappedFile file;
+    const unsigned char* elements;
+};
+
+// Appends rows to a matrix file without holding the matrix in memory. The row count is
+// patched into the header by close(), which the destructor also calls.
+struct MatrixFileWriter {
+public:
+    MatrixFileWriter(const std::string& path, size_t _columns, MatrixDType _dtype = MatrixDType::Float64);
+    ~MatrixFileWriter();
+    MatrixFileWriter(const MatrixFileWriter&) = delete;
+    MatrixFileWriter& operator=(const MatrixFileWriter&) = delete;
+
+    void appendRow(const double* values);
+    void appendRows(const ConstMatrixView& block);
+    size_t rowsWritten() const { return rows; }
+    void close();
+
+private:
+    std::FILE* file;
+    size_t columns;
+    size_t rows = 0;
+    MatrixDType dtype;
+    std::vector<float> narrow;
+};
+
+void writeMatrixFile(const std::string& path, const ConstMatrixView& matrix, MatrixDType dtype = MatrixDType::Float64);
+Matrix readMatrixFile(const std::string& path);
+
+#endif
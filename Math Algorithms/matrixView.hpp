@@ -0,0 +1,135 @@
+#ifndef MATRIXVIEW_HPP
+#define MATRIXVIEW_HPP
+
+#include "matrixExpr.hpp"
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+
+/*
+Non-owning strided windows onto matrix storage.
+Element (row, col) lives at data[row * rowStride + col * colStride], so blocks, single rows,
+single columns and transposes are all just a different pointer and pair of strides; nothing is
+copied. A view does not keep its matrix alive and is invalidated by anything that reallocates it.
+
+Both views are expression leaves, so A.block(0, 0, 4, 4) + B.view() * 2.0 evaluates in one pass,
+and products of views go straight to GEMM with the strides intact.
+Real is double (ConstMatrixView, MatrixView) or float (ConstMatrixViewF, MatrixViewF).
+*/
+// Whether the storage from a view's first to its last element meets [begin, end)
+template<typename Real>
+bool spanOverlaps(const Real* data, size_t rows, size_t columns, size_t rowStride, size_t colStride, const void* begin, const void* end) {
+    if(rows == 0 || columns == 0) {
+        return false;
+    }
+    const void* last = data + (rows - 1) * rowStride + (columns - 1) * colStride + 1;
+    return std::less<const void*>()(data, end) && std::less<const void*>()(begin, last);
+}
+
+template<typename Real>
+struct BasicConstMatrixView : MatrixExpr<BasicConstMatrixView<Real>> {
+public:
+    using Scalar = Real;
+    const Real* data;
+    size_t rows, columns;
+    size_t rowStride, colStride;
+
+    BasicConstMatrixView(const Real* _data, size_t _rows, size_t _columns, size_t _rowStride, size_t _colStride)
+        : data(_data), rows(_rows), columns(_columns), rowStride(_rowStride), colStride(_colStride) {}
+    // Whole matrix, defined in matrix.hpp once BasicMatrix is complete
+    BasicConstMatrixView(const BasicMatrix<Real>& mat);
+
+    const Real& operator()(size_t row, size_t col) const {
+        if(row >= rows || col >= columns) {
+            throw std::out_of_range("Matrix indices out of range");
+        }
+        return data[row * rowStride + col * colStride];
+    }
+    const Real& unchecked(size_t row, size_t col) const { return data[row * rowStride + col * colStride]; }
+    Real coeff(size_t index) const { return unchecked(index / columns, index % columns); }
+
+    BasicConstMatrixView block(size_t row, size_t col, size_t blockRows, size_t blockColumns) const {
+        if(row + blockRows > rows || col + blockColumns > columns) {
+            throw std::out_of_range("Block exceeds the matrix");
+        }
+        return BasicConstMatrixView(data + row * rowStride + col * colStride, blockRows, blockColumns, rowStride, colStride);
+    }
+    BasicConstMatrixView row(size_t index) const { return block(index, 0, 1, columns); }
+    BasicConstMatrixView col(size_t index) const { return block(0, index, rows, 1); }
+    // Lazy transpose: same storage, strides swapped
+    BasicConstMatrixView T() const { return BasicConstMatrixView(data, columns, rows, colStride, rowStride); }
+
+    // Rows are dense and back to back, so the whole view is one flat array
+    bool contiguous() const { return colStride == 1 && (rowStride == columns || rows <= 1); }
+    // Whether the view's span of storage meets [begin, end)
+    bool overlaps(const void* begin, const void* end) const { return spanOverlaps(data, rows, columns, rowStride, colStride, begin, end); }
+};
+
+template<typename Real>
+struct BasicMatrixView : MatrixExpr<BasicMatrixView<Real>> {
+public:
+    using Scalar = Real;
+    Real* data;
+    size_t rows, columns;
+    size_t rowStride, colStride;
+
+    BasicMatrixView(Real* _data, size_t _rows, size_t _columns, size_t _rowStride, size_t _colStride)
+        : data(_data), rows(_rows), columns(_columns), rowStride(_rowStride), colStride(_colStride) {}
+    BasicMatrixView(BasicMatrix<Real>& mat);
+    BasicMatrixView(const BasicMatrixView&) = default;
+
+    operator BasicConstMatrixView<Real>() const { return BasicConstMatrixView<Real>(data, rows, columns, rowStride, colStride); }
+
+    Real& operator()(size_t row, size_t col) const {
+        if(row >= rows || col >= columns) {
+            throw std::out_of_range("Matrix indices out of range");
+        }
+        return data[row * rowStride + col * colStride];
+    }
+    Real& unchecked(size_t row, size_t col) const { return data[row * rowStride + col * colStride]; }
+    Real coeff(size_t index) const { return unchecked(index / columns, index % columns); }
+
+    BasicMatrixView block(size_t row, size_t col, size_t blockRows, size_t blockColumns) const {
+        if(row + blockRows > rows || col + blockColumns > columns) {
+            throw std::out_of_range("Block exceeds the matrix");
+        }
+        return BasicMatrixView(data + row * rowStride + col * colStride, blockRows, blockColumns, rowStride, colStride);
+    }
+    BasicMatrixView row(size_t index) const { return block(index, 0, 1, columns); }
+    BasicMatrixView col(size_t index) const { return block(0, index, rows, 1); }
+    BasicMatrixView T() const { return BasicMatrixView(data, columns, rows, colStride, rowStride); }
+
+    bool contiguous() const { return colStride == 1 && (rowStride == columns || rows <= 1); }
+    bool overlaps(const void* begin, const void* end) const { return spanOverlaps(data, rows, columns, rowStride, colStride, begin, end); }
+
+    // Writes through the view. The expression must not read the elements it overwrites
+    // at a different position, e.g. v = v.T() on a square block is undefined.
+    template<typename E>
+    const BasicMatrixView& operator=(const MatrixExpr<E>& expr) const {
+        const E& source = expr.self();
+        if(source.rows != rows || source.columns != columns) {
+            throw std::invalid_argument("Expression does not have the dimensions of the view");
+        }
+        for(size_t row{}; row < rows; row++) {
+            for(size_t col{}; col < columns; col++) {
+                unchecked(row, col) = static_cast<Real>(source.coeff(row * columns + col));
+            }
+        }
+        return *this;
+    }
+    const BasicMatrixView& operator=(const BasicMatrixView& other) const { return *this = static_cast<const MatrixExpr<BasicMatrixView>&>(other); }
+    void fill(Real value) const {
+        for(size_t row{}; row < rows; row++) {
+            for(size_t col{}; col < columns; col++) {
+                unchecked(row, col) = value;
+            }
+        }
+    }
+};
+
+using ConstMatrixView = BasicConstMatrixView<double>;
+using MatrixView = BasicMatrixView<double>;
+using ConstMatrixViewF = BasicConstMatrixView<float>;
+using MatrixViewF = BasicMatrixView<float>;
+
+#endif
@@ -0,0 +1,236 @@
+#include "mean.hpp"
+#include "gemm.hpp"
+#include <cmath>
+#include <stdexcept>
+
+void KahanSum::add(double value) {
+    double total = sum + value;
+    if(std::fabs(sum) >= std::fabs(value)) {
+        compensation += (sum - total) + value;
+    } else {
+        compensation += (value - total) + sum;
+    }
+    sum = total;
+}
+
+void KahanSum::merge(const KahanSum& other) {
+    add(other.sum);
+    add(other.compensation);
+}
+
+void RunningMoments::add(double value) {
+    size_t previous = count;
+    count++;
+    double n = double(count);
+    double delta = value - mean;
+    double deltaN = delta / n;
+    double deltaN2 = deltaN * deltaN;
+    double term = delta * deltaN * double(previous);
+    mean += deltaN;
+    m4 += term * deltaN2 * (n * n - 3.0 * n + 3.0) + 6.0 * deltaN2 * m2 - 4.0 * deltaN * m3;
+    m3 += term * deltaN * (n - 2.0) - 3.0 * deltaN * m2;
+    m2 += term;
+}
+
+void RunningMoments::add(const double* values, size_t length) {
+    if(length == 0) {
+        return;
+    }
+    RunningMoments chunk;
+    chunk.count = length;
+    // Compensated, so a chunk mixing large and small values keeps the small ones in its mean
+    KahanSum sum;
+    for(size_t i{}; i < length; i++) {
+        sum.add(values[i]);
+    }
+    chunk.mean = sum.value() / double(length);
+    for(size_t i{}; i < length; i++) {
+        double d = values[i] - chunk.mean;
+        double d2 = d * d;
+        chunk.m2 += d2;
+        chunk.m3 += d2 * d;
+        chunk.m4 += d2 * d2;
+    }
+    merge(chunk);
+}
+
+void RunningMoments::merge(const RunningMoments& other) {
+    if(other.count == 0) {
+        return;
+    }
+    if(count == 0) {
+        *this = other;
+        return;
+    }
+    double na = double(count), nb = double(other.count);
+    double n = na + nb;
+    double delta = other.mean - mean;
+    double delta2 = delta * delta;
+    double m2Merged = m2 + other.m2 + delta2 * na * nb / n;
+    double m3Merged = m3 + other.m3 + delta2 * delta * na * nb * (na - nb) / (n * n)
+                      + 3.0 * delta * (na * other.m2 - nb * m2) / n;
+    double m4Merged = m4 + other.m4 + delta2 * delta2 * na * nb * (na * na - na * nb + nb * nb) / (n * n * n)
+                      + 6.0 * delta2 * (na * na * other.m2 + nb * nb * m2) / (n * n)
+                      + 4.0 * delta * (na * other.m3 - nb * m3) / n;
+    mean += delta * nb / n;
+    m2 = m2Merged;
+    m3 = m3Merged;
+    m4 = m4Merged;
+    count += other.count;
+}
+
+double RunningMoments::variance() const {
+    return count > 1 ? m2 / double(count - 1) : 0.0;
+}
+
+double RunningMoments::populationVariance() const {
+    return count > 0 ? m2 / double(count) : 0.0;
+}
+
+double RunningMoments::stdDev() const {
+    return std::sqrt(variance());
+}
+
+double RunningMoments::skewness() const {
+    if(count == 0 || m2 == 0.0) {
+        return 0.0;
+    }
+    return std::sqrt(double(count)) * m3 / std::pow(m2, 1.5);
+}
+
+double RunningMoments::kurtosis() const {
+    if(count == 0 || m2 == 0.0) {
+        return 0.0;
+    }
+    return double(count) * m4 / (m2 * m2) - 3.0;
+}
+
+RunningCovariance::RunningCovariance(size_t _dimension)
+    : dimension(_dimension), mean(_dimension, 0.0), comoment(_dimension * _dimension, 0.0) {}
+
+void RunningCovariance::add(const double* observation) {
+    count++;
+    double n = double(count);
+    thread_local std::vector<double> delta;
+    delta.resize(dimension);
+    for(size_t i{}; i < dimension; i++) {
+        delta[i] = observation[i] - mean[i];
+        mean[i] += delta[i] / n;
+    }
+    // C += (x - mean_old)(x - mean_new)^T, which is symmetric, so the upper triangle is enough
+    for(size_t i{}; i < dimension; i++) {
+        double* row = comoment.data() + i * dimension;
+        double scale = delta[i] * (n - 1.0) / n;
+        for(size_t j{i}; j < dimension; j++) {
+            row[j] += scale * delta[j];
+        }
+    }
+}
+
+void RunningCovariance::add(const std::vector<double>& observation) {
+    if(observation.size() != dimension) {
+        throw std::invalid_argument("Observation does not match the covariance dimension");
+    }
+    add(observation.data());
+}
+
+void RunningCovariance::add(const ConstMatrixView& chunk) {
+    if(chunk.columns != dimension) {
+        throw std::invalid_argument("Chunk columns do not match the covariance dimension");
+    }
+    if(chunk.rows == 0) {
+        return;
+    }
+    RunningCovariance local(dimension);
+    local.count = chunk.rows;
+    std::vector<KahanSum> sums(dimension);
+    for(size_t t{}; t < chunk.rows; t++) {
+        for(size_t i{}; i < dimension; i++) {
+            sums[i].add(chunk.unchecked(t, i));
+        }
+    }
+    for(size_t i{}; i < dimension; i++) {
+        local.mean[i] = sums[i].value() / double(chunk.rows);
+    }
+    Matrix centred = chunk;
+    for(size_t t{}; t < chunk.rows; t++) {
+        double* row = &centred.unchecked(t, 0);
+        for(size_t i{}; i < dimension; i++) {
+            row[i] -= local.mean[i];
+        }
+    }
+    gemm(dimension, dimension, chunk.rows, 1.0,
+         centred.data.data(), 1, dimension,
+         centred.data.data(), dimension, 1,
+         0.0, local.comoment.data(), dimension);
+    merge(local);
+}
+
+void RunningCovariance::merge(const RunningCovariance& other) {
+    if(other.dimension != dimension) {
+        throw std::invalid_argument("Cannot merge covariances of different dimension");
+    }
+    if(other.count == 0) {
+        return;
+    }
+    if(count == 0) {
+        count = other.count;
+        mean = other.mean;
+        comoment = other.comoment;
+        return;
+    }
+    double na = double(count), nb = double(other.count);
+    double n = na + nb;
+    double weight = na * nb / n;
+    thread_local std::vector<double> delta;
+    delta.resize(dimension);
+    for(size_t i{}; i < dimension; i++) {
+        delta[i] = other.mean[i] - mean[i];
+        mean[i] += delta[i] * nb / n;
+    }
+    for(size_t i{}; i < dimension; i++) {
+        double* row = comoment.data() + i * dimension;
+        const double* otherRow = other.comoment.data() + i * dimension;
+        double scale = weight * delta[i];
+        for(size_t j{i}; j < dimension; j++) {
+            row[j] += otherRow[j] + scale * delta[j];
+        }
+    }
+    count += other.count;
+}
+
+Matrix RunningCovariance::scaled(double divisor) const {
+    Matrix result(dimension, dimension);
+    double inverse = divisor > 0.0 ? 1.0 / divisor : 0.0;
+    for(size_t i{}; i < dimension; i++) {
+        for(size_t j{i}; j < dimension; j++) {
+            double value = comoment[i * dimension + j] * inverse;
+            result.unchecked(i, j) = value;
+            result.unchecked(j, i) = value;
+        }
+    }
+    return result;
+}
+
+Matrix RunningCovariance::covariance() const {
+    return scaled(count > 1 ? double(count - 1) : 0.0);
+}
+
+Matrix RunningCovariance::populationCovariance() const {
+    return scaled(double(count));
+}
+
+Matrix RunningCovariance::correlation() const {
+    Matrix result = scaled(1.0);
+    std::vector<double> inverseDeviation(dimension);
+    for(size_t i{}; i < dimension; i++) {
+        double diagonal = result.unchecked(i, i);
+        inverseDeviation[i] = diagonal > 0.0 ? 1.0 / std::sqrt(diagonal) : 0.0;
+    }
+    for(size_t i{}; i < dimension; i++) {
+        for(size_t j{}; j < dimension; j++) {
+            result.unchecked(i, j) *= inverseDeviation[i] * inverseDeviation[j];
+        }
+    }
+    return result;
+}
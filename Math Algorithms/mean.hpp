@@ -0,0 +1,72 @@
+#ifndef MEAN_HPP
+#define MEAN_HPP
+
+#include "matrix.hpp"
+#include <cstddef>
+#include <vector>
+
+/*
+One-pass streaming statistics. Every accumulator takes data a value (or a chunk) at a time,
+keeps a fixed amount of state, and can be merged with another accumulator of the same kind
+built on a disjoint part of the data (another thread, another file shard).
+Merging follows Chan et al. / Pebay's pairwise formulas, so shards combine to the
+same moments a single pass would give, up to rounding.
+*/
+
+// Neumaier's variant of Kahan summation: the running compensation also catches
+// terms larger than the current sum.
+struct KahanSum {
+public:
+    double sum = 0.0;
+    double compensation = 0.0;
+
+    void add(double value);
+    void merge(const KahanSum& other);
+    double value() const { return sum + compensation; }
+};
+
+// Mean, variance, skewness and kurtosis of a scalar stream (Welford updates of the central moments M2..M4).
+struct RunningMoments {
+public:
+    size_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0, m3 = 0.0, m4 = 0.0;
+
+    void add(double value);
+    // Moments of the chunk in two local passes, then one merge: fewer divisions than per-tick updates
+    void add(const double* values, size_t length);
+    void merge(const RunningMoments& other);
+
+    double variance() const;            // sample, divides by count - 1
+    double populationVariance() const;  // divides by count
+    double stdDev() const;
+    double skewness() const;            // population skewness g1
+    double kurtosis() const;            // excess kurtosis g2
+};
+
+// Mean vector and co-moment matrix of a d-dimensional stream, d^2 state regardless of the number of observations.
+struct RunningCovariance {
+public:
+    size_t dimension;
+    size_t count = 0;
+    std::vector<double> mean;
+    // Sum of (x - mean)(x - mean)^T; only the upper triangle is maintained
+    std::vector<double> comoment;
+
+    explicit RunningCovariance(size_t _dimension);
+
+    void add(const double* observation);
+    void add(const std::vector<double>& observation);
+    // Rows of the chunk are observations; the chunk's co-moment is a single GEMM
+    void add(const ConstMatrixView& chunk);
+    void merge(const RunningCovariance& other);
+
+    Matrix covariance() const;            // sample, divides by count - 1
+    Matrix populationCovariance() const;  // divides by count
+    Matrix correlation() const;
+
+private:
+    Matrix scaled(double divisor) const;
+};
+
+#endif
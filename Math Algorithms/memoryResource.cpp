@@ -0,0 +1,123 @@
+#include "memoryResource.hpp"
+#include <algorithm>
+#include <cstdint>
+
+static std::pmr::memory_resource*& resourceSlot() {
+    thread_local std::pmr::memory_resource* resource = std::pmr::new_delete_resource();
+    return resource;
+}
+
+std::pmr::memory_resource* currentMatrixResource() {
+    return resourceSlot();
+}
+
+std::pmr::memory_resource* setMatrixResource(std::pmr::memory_resource* resource) {
+    std::pmr::memory_resource* previous = resourceSlot();
+    resourceSlot() = resource ? resource : std::pmr::new_delete_resource();
+    return previous;
+}
+
+ArenaResource::ArenaResource(size_t initialBytes, std::pmr::memory_resource* _upstream) : upstream(_upstream) {
+    if(initialBytes > 0) {
+        grow(initialBytes, MATRIX_ALIGNMENT);
+    }
+}
+
+ArenaResource::~ArenaResource() {
+    for(const Block& block : blocks) {
+        upstream->deallocate(block.begin, block.size, MATRIX_ALIGNMENT);
+    }
+}
+
+void ArenaResource::grow(size_t bytes, size_t alignment) {
+    size_t size = std::max(bytes + alignment, blocks.empty() ? bytes : 2 * blocks.back().size);
+    char* begin = static_cast<char*>(upstream->allocate(size, MATRIX_ALIGNMENT));
+    blocks.push_back(Block{begin, size});
+    cursor = begin;
+    limit = begin + size;
+}
+
+void* ArenaResource::do_allocate(size_t bytes, size_t alignment) {
+    uintptr_t address = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~uintptr_t(alignment - 1);
+    if(!cursor || address + bytes > reinterpret_cast<uintptr_t>(limit)) {
+        grow(bytes, alignment);
+        address = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~uintptr_t(alignment - 1);
+    }
+    char* result = reinterpret_cast<char*>(address);
+    cursor = result + bytes;
+    used += bytes;
+    return result;
+}
+
+void ArenaResource::reset() {
+    if(blocks.size() > 1) {
+        size_t total = bytesReserved();
+        for(const Block& block : blocks) {
+            upstream->deallocate(block.begin, block.size, MATRIX_ALIGNMENT);
+        }
+        blocks.clear();
+        grow(total, MATRIX_ALIGNMENT);
+    } else if(!blocks.empty()) {
+        cursor = blocks.front().begin;
+    }
+    used = 0;
+}
+
+size_t ArenaResource::bytesReserved() const {
+    size_t total = 0;
+    for(const Block& block : blocks) {
+        total += block.size;
+    }
+    return total;
+}
+
+PoolResource::PoolResource(size_t _maxPooledBytes, std::pmr::memory_resource* _upstream)
+    : upstream(_upstream), maxPooledBytes(_maxPooledBytes), freeLists(classOf(std::max<size_t>(_maxPooledBytes, 1)) + 1, nullptr) {}
+
+PoolResource::~PoolResource() {
+    release();
+}
+
+size_t PoolResource::classOf(size_t bytes) {
+    size_t shift = MIN_CLASS_SHIFT;
+    while((size_t(1) << shift) < bytes) {
+        shift++;
+    }
+    return shift - MIN_CLASS_SHIFT;
+}
+
+void* PoolResource::do_allocate(size_t bytes, size_t alignment) {
+    if(bytes > maxPooledBytes || alignment > MATRIX_ALIGNMENT) {
+        upstreamCalls++;
+        return upstream->allocate(bytes, alignment);
+    }
+    size_t sizeClass = classOf(bytes);
+    if(FreeNode* node = freeLists[sizeClass]) {
+        freeLists[sizeClass] = node->next;
+        return node;
+    }
+    size_t classBytes = size_t(1) << (sizeClass + MIN_CLASS_SHIFT);
+    void* block = upstream->allocate(classBytes, MATRIX_ALIGNMENT);
+    upstreamCalls++;
+    owned.push_back(Owned{block, classBytes, MATRIX_ALIGNMENT});
+    return block;
+}
+
+void PoolResource::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
+    if(bytes > maxPooledBytes || alignment > MATRIX_ALIGNMENT) {
+        upstream->deallocate(ptr, bytes, alignment);
+        return;
+    }
+    size_t sizeClass = classOf(bytes);
+    FreeNode* node = static_cast<FreeNode*>(ptr);
+    node->next = freeLists[sizeClass];
+    freeLists[sizeClass] = node;
+}
+
+void PoolResource::release() {
+    for(const Owned& block : owned) {
+        upstream->deallocate(block.ptr, block.bytes, block.alignment);
+    }
+    owned.clear();
+    std::fill(freeLists.begin(), freeLists.end(), nullptr);
+}
@@ -0,0 +1,150 @@
+#ifndef MEMORYRESOURCE_HPP
+#define MEMORYRESOURCE_HPP
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <utility>
+#include <vector>
+
+/*
+Pluggable storage for Matrix and the factorizations.
+
+Containers built on ResourceAllocator draw from whatever std::pmr::memory_resource is current on
+the constructing thread (the heap unless a MatrixResourceScope says otherwise), always 64-byte
+aligned for the SIMD kernels. Default construction of elements is a no-op, so resize() leaves
+doubles uninitialized; Matrix zero-fills explicitly unless asked not to.
+
+A matrix keeps the resource it was built with. Copies and move-assignments into an existing
+matrix use the destination's resource, so results assigned to long-lived matrices never point
+into an arena. A matrix created inside a scope must not outlive that scope's resource.
+*/
+
+std::pmr::memory_resource* currentMatrixResource();
+// Returns the previous resource
+std::pmr::memory_resource* setMatrixResource(std::pmr::memory_resource* resource);
+
+struct MatrixResourceScope {
+public:
+    explicit MatrixResourceScope(std::pmr::memory_resource* resource) : previous(setMatrixResource(resource)) {}
+    ~MatrixResourceScope() { setMatrixResource(previous); }
+    MatrixResourceScope(const MatrixResourceScope&) = delete;
+    MatrixResourceScope& operator=(const MatrixResourceScope&) = delete;
+
+private:
+    std::pmr::memory_resource* previous;
+};
+
+constexpr size_t MATRIX_ALIGNMENT = 64;
+
+template<typename T>
+struct ResourceAllocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap = std::true_type;
+
+    std::pmr::memory_resource* resource;
+
+    ResourceAllocator() noexcept : resource(currentMatrixResource()) {}
+    explicit ResourceAllocator(std::pmr::memory_resource* _resource) noexcept : resource(_resource) {}
+    template<typename U>
+    ResourceAllocator(const ResourceAllocator<U>& other) noexcept : resource(other.resource) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(resource->allocate(count * sizeof(T), alignof(T) > MATRIX_ALIGNMENT ? alignof(T) : MATRIX_ALIGNMENT));
+    }
+    void deallocate(T* ptr, size_t count) noexcept {
+        resource->deallocate(ptr, count * sizeof(T), alignof(T) > MATRIX_ALIGNMENT ? alignof(T) : MATRIX_ALIGNMENT);
+    }
+
+    // Default-initialize instead of value-initialize: resize() on doubles does not write memory
+    template<typename U>
+    void construct(U* ptr) noexcept(noexcept(::new(static_cast<void*>(ptr)) U)) {
+        ::new(static_cast<void*>(ptr)) U;
+    }
+    template<typename U, typename... Args>
+    void construct(U* ptr, Args&&... args) {
+        ::new(static_cast<void*>(ptr)) U(std::forward<Args>(args)...);
+    }
+
+    // A copy lands in the copying thread's current resource, not the source's
+    ResourceAllocator select_on_container_copy_construction() const { return ResourceAllocator(); }
+
+    template<typename U>
+    bool operator==(const ResourceAllocator<U>& other) const { return resource == other.resource || resource->is_equal(*other.resource); }
+    template<typename U>
+    bool operator!=(const ResourceAllocator<U>& other) const { return !(*this == other); }
+};
+
+template<typename T>
+using ResourceVector = std::vector<T, ResourceAllocator<T>>;
+
+// Bump allocator: allocation is a pointer increment, deallocation is free, reset() rewinds everything.
+// Made for per-iteration temporaries. Not thread safe.
+struct ArenaResource : std::pmr::memory_resource {
+public:
+    explicit ArenaResource(size_t initialBytes = 1 << 20, std::pmr::memory_resource* _upstream = std::pmr::new_delete_resource());
+    ~ArenaResource() override;
+    ArenaResource(const ArenaResource&) = delete;
+    ArenaResource& operator=(const ArenaResource&) = delete;
+
+    // Invalidates everything handed out. Blocks are merged into one so the next cycle needs no upstream calls.
+    void reset();
+    size_t bytesUsed() const { return used; }
+    size_t bytesReserved() const;
+
+private:
+    struct Block {
+        char* begin;
+        size_t size;
+    };
+    std::pmr::memory_resource* upstream;
+    std::vector<Block> blocks;
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    size_t used = 0;
+
+    void grow(size_t bytes, size_t alignment);
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+// Power-of-two size classes from 64 bytes up to maxPooledBytes with a free list each. Freed blocks
+// are kept for reuse, so a loop that allocates the same shapes every iteration stops touching the
+// upstream resource after the first one. Larger requests go straight upstream. Not thread safe.
+struct PoolResource : std::pmr::memory_resource {
+public:
+    explicit PoolResource(size_t _maxPooledBytes = 1 << 24, std::pmr::memory_resource* _upstream = std::pmr::new_delete_resource());
+    ~PoolResource() override;
+    PoolResource(const PoolResource&) = delete;
+    PoolResource& operator=(const PoolResource&) = delete;
+
+    // Returns every pooled block to upstream; outstanding allocations must already be freed
+    void release();
+    size_t upstreamAllocations() const { return upstreamCalls; }
+
+private:
+    static constexpr size_t MIN_CLASS_SHIFT = 6;
+    struct FreeNode {
+        FreeNode* next;
+    };
+    struct Owned {
+        void* ptr;
+        size_t bytes;
+        size_t alignment;
+    };
+    std::pmr::memory_resource* upstream;
+    size_t maxPooledBytes;
+    std::vector<FreeNode*> freeLists;
+    std::vector<Owned> owned;
+    size_t upstreamCalls = 0;
+
+    static size_t classOf(size_t bytes);
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "mixedPrecision.hpp"
+#include "gemm.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+// Nonzero entries below FLT_MIN would round to float denormals or to zero and lose their digits
+static bool fitsInFloat(const ConstMatrixView& M) {
+    for(size_t i{}; i < M.rows; i++) {
+        for(size_t j{}; j < M.columns; j++) {
+            double magnitude = std::fabs(M.unchecked(i, j));
+            if(magnitude > std::numeric_limits<float>::max() || (magnitude != 0.0 && magnitude < std::numeric_limits<float>::min())) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+MixedPrecisionSolver::MixedPrecisionSolver(const ConstMatrixView& input) : n(input.rows), A(input), normA(0) {
+    if(input.rows != input.columns) {
+        throw std::invalid_argument("You need a square matrix for a mixed-precision solve");
+    }
+    for(size_t i{}; i < n; i++) {
+        double rowSum = 0;
+        for(size_t j{}; j < n; j++) {
+            rowSum += std::fabs(A.unchecked(i, j));
+        }
+        normA = std::max(normA, rowSum);
+    }
+    if(fitsInFloat(A)) {
+        lowPrecision = std::make_unique<LUFactorizationF>(MatrixF(A));
+        if(lowPrecision->singular) {
+            lowPrecision.reset();
+        }
+    }
+    if(!lowPrecision) {
+        highPrecision = std::make_unique<LUFactorization>(A);
+    }
+}
+
+bool MixedPrecisionSolver::converged(const Matrix& X, const Matrix& R, double& backwardError) const {
+    const double threshold = normA * std::numeric_limits<double>::epsilon() * std::sqrt(double(n));
+    std::vector<double> normX(X.columns, 0.0), normR(X.columns, 0.0);
+    for(size_t i{}; i < X.rows; i++) {
+        for(size_t j{}; j < X.columns; j++) {
+            normX[j] = std::max(normX[j], std::fabs(X.unchecked(i, j)));
+            normR[j] = std::max(normR[j], std::fabs(R.unchecked(i, j)));
+        }
+    }
+    bool done = true;
+    backwardError = 0;
+    for(size_t j{}; j < X.columns; j++) {
+        // Written so that a NaN residual never counts as converged
+        if(!(normR[j] <= normX[j] * threshold)) {
+            done = false;
+        }
+        if(normR[j] != 0.0) {
+            backwardError = std::max(backwardError, normR[j] / (normA * normX[j]));
+        }
+    }
+    return done;
+}
+
+RefinedSolution MixedPrecisionSolver::solveHigh(const ConstMatrixView& B, size_t iterations) const {
+    RefinedSolution result{highPrecision ? highPrecision->solve(B) : LUFactorization(A).solve(B), iterations, 0.0, true};
+    Matrix R(B);
+    gemm(-1.0, A, result.X, 1.0, R);
+    converged(result.X, R, result.backwardError);
+    return result;
+}
+
+RefinedSolution MixedPrecisionSolver::solve(const ConstMatrixView& B) const {
+    if(B.rows != n) {
+        throw std::invalid_argument("Right-hand side does not match the matrix size");
+    }
+    if(!lowPrecision || !fitsInFloat(B)) {
+        return solveHigh(B, 0);
+    }
+
+    MatrixF residualF(B);
+    Matrix X(lowPrecision->solve(residualF));
+    Matrix R(B);
+    gemm(-1.0, A, X, 1.0, R);
+    double backwardError = 0;
+    size_t iteration{};
+    for(; iteration <= MAX_ITERATIONS; iteration++) {
+        if(converged(X, R, backwardError)) {
+            return {std::move(X), iteration, backwardError, false};
+        }
+        if(iteration == MAX_ITERATIONS || !std::isfinite(backwardError)) {
+            break;
+        }
+        // The correction only needs float accuracy, the residual it corrects is exact to double
+        residualF = R;
+        X += lowPrecision->solve(residualF);
+        R = B;
+        gemm(-1.0, A, X, 1.0, R);
+    }
+    return solveHigh(B, iteration);
+}
+
+RefinedSolution MixedPrecisionSolver::solve(const std::vector<double>& b) const {
+    return solve(ConstMatrixView(b.data(), b.size(), 1, 1, 1));
+}
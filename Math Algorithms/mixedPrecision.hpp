@@ -0,0 +1,52 @@
+#ifndef MIXEDPRECISION_HPP
+#define MIXEDPRECISION_HPP
+
+#include "luFactorization.hpp"
+#include <memory>
+#include <vector>
+
+/*
+Solves A X = B to double accuracy with the O(n^3) factorization done in float, like LAPACK dsgesv.
+A is rounded to float and factored once; each solve takes the float solution and refines it with
+residuals R = B - A X computed in double against the stored double copy of A, so every refinement
+step costs O(n^2).
+
+A column has converged once ||r||_inf <= ||x||_inf * ||A||_inf * eps * sqrt(n). Refinement that has not
+converged after MAX_ITERATIONS steps falls back to a double LU, as do inputs with nonzero entries
+outside the normal float range [FLT_MIN, FLT_MAX] and matrices whose float factorization is singular. Refinement only pays off while
+cond(A) is well below 1 / FLT_EPSILON (about 1e7).
+*/
+struct RefinedSolution {
+public:
+    Matrix X;
+    size_t iterations;
+    // max over columns of ||b - A x||_inf / (||A||_inf * ||x||_inf)
+    double backwardError;
+    bool usedDoublePrecision;
+};
+
+struct MixedPrecisionSolver {
+public:
+    static constexpr size_t MAX_ITERATIONS = 30;
+
+    size_t n;
+    Matrix A;
+    double normA;
+
+    explicit MixedPrecisionSolver(const ConstMatrixView& A);
+
+    RefinedSolution solve(const ConstMatrixView& B) const;
+    // The solution comes back as an n x 1 X
+    RefinedSolution solve(const std::vector<double>& b) const;
+
+    bool lowPrecisionUsable() const { return lowPrecision != nullptr; }
+
+private:
+    std::unique_ptr<LUFactorizationF> lowPrecision;
+    std::unique_ptr<LUFactorization> highPrecision;
+
+    RefinedSolution solveHigh(const ConstMatrixView& B, size_t iterations) const;
+    bool converged(const Matrix& X, const Matrix& R, double& backwardError) const;
+};
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef PHILOX_HPP
+#define PHILOX_HPP
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+/*
+Philox4x32-10 counter-based generator (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3").
+The output is a pure function of (key, counter), so any stream can be jumped to directly:
+give each unit of work its own counter and the numbers it draws never depend on which thread runs it.
+*/
+struct Philox4x32 {
+public:
+    using Block = std::array<uint32_t, 4>;
+
+    // stream picks an independent sequence under the same seed, e.g. a batch index
+    constexpr Philox4x32(uint64_t seed, uint64_t stream)
+        : key{uint32_t(seed), uint32_t(seed >> 32)}, counter{0, 0, uint32_t(stream), uint32_t(stream >> 32)} {}
+
+    static constexpr Block generate(Block ctr, std::array<uint32_t, 2> k) {
+        for(int round{}; round < 10; round++) {
+            uint64_t p0 = uint64_t(0xD2511F53u) * ctr[0];
+            uint64_t p1 = uint64_t(0xCD9E8D57u) * ctr[2];
+            ctr = {uint32_t(p1 >> 32) ^ ctr[1] ^ k[0], uint32_t(p1),
+                   uint32_t(p0 >> 32) ^ ctr[3] ^ k[1], uint32_t(p0)};
+            k[0] += 0x9E3779B9u;
+            k[1] += 0xBB67AE85u;
+        }
+        return ctr;
+    }
+
+    // Next four 32-bit words; the low 64 bits of the counter advance, the stream half stays fixed
+    Block next() {
+        Block out = generate(counter, key);
+        if(++counter[0] == 0) {
+            ++counter[1];
+        }
+        return out;
+    }
+
+    // 53-bit uniforms in (0, 1]; never zero so they are safe to log
+    void uniform2(double& u0, double& u1) {
+        Block b = next();
+        u0 = (double((uint64_t(b[0]) << 21) ^ (b[1] >> 11)) + 1.0) * 0x1.0p-53;
+        u1 = (double((uint64_t(b[2]) << 21) ^ (b[3] >> 11)) + 1.0) * 0x1.0p-53;
+    }
+
+    double uniform() {
+        double u0, u1;
+        uniform2(u0, u1);
+        return u0;
+    }
+
+    // Two independent standard normals per block via Box-Muller
+    void normal2(double& z0, double& z1) {
+        double u0, u1;
+        uniform2(u0, u1);
+        double radius = std::sqrt(-2.0 * std::log(u0));
+        double angle = 6.283185307179586 * u1;
+        z0 = radius * std::cos(angle);
+        z1 = radius * std::sin(angle);
+    }
+
+private:
+    std::array<uint32_t, 2> key;
+    Block counter;
+};
+
+#endif
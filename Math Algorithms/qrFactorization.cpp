@@ -0,0 +1,243 @@
+#include "qrFactorization.hpp"
+#include "gemm.hpp"
+#include "threadPool.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+static constexpr size_t BLOCK = 32;
+static constexpr size_t PARALLEL_GRAIN = 1 << 14;
+
+QRFactorization::QRFactorization(const ConstMatrixView& A) : rows(A.rows), columns(A.columns), QR(A) {
+    factor();
+}
+
+QRFactorization::QRFactorization(Matrix&& A) : rows(A.rows), columns(A.columns), QR(std::move(A)) {
+    factor();
+}
+
+void QRFactorization::factor() {
+    if(rows < columns) {
+        throw std::invalid_argument("QR factorization needs at least as many rows as columns");
+    }
+    const size_t m = rows, n = columns;
+    double* a = QR.data.data();
+    tau.assign(n, 0.0);
+    std::vector<double> V, T, W, column;
+
+    for(size_t k0{}; k0 < n; k0 += BLOCK) {
+        size_t kb = std::min(BLOCK, n - k0);
+        size_t panelEnd = k0 + kb;
+
+        // Panel: one reflector per column, each applied to the rest of the panel only
+        for(size_t j{k0}; j < panelEnd; j++) {
+            double norm = 0.0;
+            for(size_t i{j + 1}; i < m; i++) {
+                norm += a[i * n + j] * a[i * n + j];
+            }
+            double alpha = a[j * n + j];
+            if(norm == 0.0) {
+                tau[j] = 0.0;
+                continue;
+            }
+            double beta = -std::copysign(std::sqrt(alpha * alpha + norm), alpha);
+            tau[j] = (beta - alpha) / beta;
+            double scale = 1.0 / (alpha - beta);
+            for(size_t i{j + 1}; i < m; i++) {
+                a[i * n + j] *= scale;
+            }
+            a[j * n + j] = beta;
+            // w = v^T A[j:, j+1:panelEnd], then A -= tau v w
+            column.assign(panelEnd - j - 1, 0.0);
+            for(size_t c{j + 1}; c < panelEnd; c++) {
+                column[c - j - 1] = a[j * n + c];
+            }
+            for(size_t i{j + 1}; i < m; i++) {
+                double v = a[i * n + j];
+                const double* row = a + i * n;
+                for(size_t c{j + 1}; c < panelEnd; c++) {
+                    column[c - j - 1] += v * row[c];
+                }
+            }
+            for(size_t c{j + 1}; c < panelEnd; c++) {
+                a[j * n + c] -= tau[j] * column[c - j - 1];
+            }
+            for(size_t i{j + 1}; i < m; i++) {
+                double v = tau[j] * a[i * n + j];
+                double* row = a + i * n;
+                for(size_t c{j + 1}; c < panelEnd; c++) {
+                    row[c] -= v * column[c - j - 1];
+                }
+            }
+        }
+        if(panelEnd == n) {
+            break;
+        }
+
+        // V: the panel's reflectors as an explicit (m - k0) x kb unit lower trapezoid
+        size_t mk = m - k0;
+        V.assign(mk * kb, 0.0);
+        for(size_t i{}; i < mk; i++) {
+            for(size_t j{}; j < kb; j++) {
+                V[i * kb + j] = i == j ? 1.0 : (i > j ? a[(k0 + i) * n + k0 + j] : 0.0);
+            }
+        }
+        // T upper triangular with H_0 ... H_kb-1 = I - V T V^T (LAPACK larft, forward columnwise)
+        T.assign(kb * kb, 0.0);
+        for(size_t j{}; j < kb; j++) {
+            double t = tau[k0 + j];
+            T[j * kb + j] = t;
+            // z = V(:, 0:j)^T v_j, then T(0:j, j) = -t * T(0:j, 0:j) z
+            std::vector<double> z(j, 0.0);
+            for(size_t i{j}; i < mk; i++) {
+                double vj = V[i * kb + j];
+                for(size_t c{}; c < j; c++) {
+                    z[c] += V[i * kb + c] * vj;
+                }
+            }
+            for(size_t r{}; r < j; r++) {
+                double sum = 0.0;
+                for(size_t c{r}; c < j; c++) {
+                    sum += T[r * kb + c] * z[c];
+                }
+                T[r * kb + j] = -t * sum;
+            }
+        }
+        // Trailing A2 <- (I - V T V^T)^T A2 = A2 - V (T^T (V^T A2))
+        size_t trailing = n - panelEnd;
+        double* a2 = a + k0 * n + panelEnd;
+        W.assign(kb * trailing, 0.0);
+        gemm(kb, trailing, mk, 1.0, V.data(), 1, kb, a2, n, 1, 0.0, W.data(), trailing);
+        std::vector<double> TW(kb * trailing);
+        gemm(kb, trailing, kb, 1.0, T.data(), 1, kb, W.data(), trailing, 1, 0.0, TW.data(), trailing);
+        gemm(mk, trailing, kb, -1.0, V.data(), kb, 1, TW.data(), trailing, 1, 1.0, a2, n);
+    }
+}
+
+void QRFactorization::applyQT(Matrix& B) const {
+    if(B.rows != rows) {
+        throw std::invalid_argument("Right hand side does not have the same number of rows as the system");
+    }
+    const size_t m = rows, n = columns, k = B.columns;
+    const double* a = QR.data.data();
+    double* b = B.data.data();
+    // Right hand side columns are independent, so wide B splits by column
+    parallelChunks(k, std::max<size_t>(1, PARALLEL_GRAIN / std::max<size_t>(m, 1)), [&](size_t c0, size_t c1) {
+        std::vector<double> w(c1 - c0);
+        for(size_t j{}; j < n; j++) {
+            if(tau[j] == 0.0) {
+                continue;
+            }
+            for(size_t c{c0}; c < c1; c++) {
+                w[c - c0] = b[j * k + c];
+            }
+            for(size_t i{j + 1}; i < m; i++) {
+                double v = a[i * n + j];
+                const double* row = b + i * k;
+                for(size_t c{c0}; c < c1; c++) {
+                    w[c - c0] += v * row[c];
+                }
+            }
+            for(size_t c{c0}; c < c1; c++) {
+                w[c - c0] *= tau[j];
+                b[j * k + c] -= w[c - c0];
+            }
+            for(size_t i{j + 1}; i < m; i++) {
+                double v = a[i * n + j];
+                double* row = b + i * k;
+                for(size_t c{c0}; c < c1; c++) {
+                    row[c] -= v * w[c - c0];
+                }
+            }
+        }
+    });
+}
+
+Matrix QRFactorization::solve(const ConstMatrixView& B) const {
+    const size_t n = columns;
+    double largest = 0.0;
+    for(size_t i{}; i < n; i++) {
+        largest = std::max(largest, std::fabs(QR.unchecked(i, i)));
+    }
+    for(size_t i{}; i < n; i++) {
+        if(std::fabs(QR.unchecked(i, i)) <= double(rows) * DBL_EPSILON * largest) {
+            throw std::runtime_error("Matrix is rank deficient, least squares solution is not unique");
+        }
+    }
+    Matrix work = B;
+    applyQT(work);
+    size_t k = work.columns;
+    Matrix X(n, k, MatrixInit::Uninitialized);
+    std::copy(work.data.begin(), work.data.begin() + ptrdiff_t(n * k), X.data.begin());
+    double* x = X.data.data();
+    for(size_t i{n}; i-- > 0;) {
+        double* row = x + i * k;
+        for(size_t j{i + 1}; j < n; j++) {
+            double factor = QR.unchecked(i, j);
+            const double* source = x + j * k;
+            for(size_t c{}; c < k; c++) {
+                row[c] -= factor * source[c];
+            }
+        }
+        double inverse = 1.0 / QR.unchecked(i, i);
+        for(size_t c{}; c < k; c++) {
+            row[c] *= inverse;
+        }
+    }
+    return X;
+}
+
+std::vector<double> QRFactorization::solve(const std::vector<double>& b) const {
+    if(b.size() != rows) {
+        throw std::invalid_argument("Right hand side does not have the same number of rows as the system");
+    }
+    Matrix B(rows, 1, MatrixInit::Uninitialized);
+    B.data.assign(b.begin(), b.end());
+    Matrix X = solve(B);
+    return std::vector<double>(X.data.begin(), X.data.end());
+}
+
+Matrix QRFactorization::Q() const {
+    Matrix result(rows, columns);
+    for(size_t i{}; i < columns; i++) {
+        result.unchecked(i, i) = 1.0;
+    }
+    // Q = H_0 ... H_n-1 applied to the first columns of the identity, last reflector first
+    const double* a = QR.data.data();
+    double* q = result.data.data();
+    const size_t m = rows, n = columns;
+    std::vector<double> w(n);
+    for(size_t j{n}; j-- > 0;) {
+        if(tau[j] == 0.0) {
+            continue;
+        }
+        std::fill(w.begin(), w.end(), 0.0);
+        for(size_t i{j}; i < m; i++) {
+            double v = i == j ? 1.0 : a[i * n + j];
+            const double* row = q + i * n;
+            for(size_t c{j}; c < n; c++) {
+                w[c] += v * row[c];
+            }
+        }
+        for(size_t i{j}; i < m; i++) {
+            double v = tau[j] * (i == j ? 1.0 : a[i * n + j]);
+            double* row = q + i * n;
+            for(size_t c{j}; c < n; c++) {
+                row[c] -= v * w[c];
+            }
+        }
+    }
+    return result;
+}
+
+Matrix QRFactorization::R() const {
+    Matrix result(columns, columns);
+    for(size_t i{}; i < columns; i++) {
+        for(size_t j{i}; j < columns; j++) {
+            result.unchecked(i, j) = QR.unchecked(i, j);
+        }
+    }
+    return result;
+}
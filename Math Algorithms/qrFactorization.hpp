@@ -0,0 +1,41 @@
+#ifndef QRFACTORIZATION_HPP
+#define QRFACTORIZATION_HPP
+
+#include "matrix.hpp"
+#include <vector>
+
+/*
+A = Q * R by Householder reflections, for A with rows >= columns.
+QR holds R on and above the diagonal and the Householder vectors below it (their leading 1 is
+implicit), with the scalar factors in tau, the LAPACK geqrf layout.
+
+Blocked with the compact WY form: a 32-column panel is reduced one reflector at a time, its
+reflectors are combined into I - V T V^T, and the rest of the matrix is updated with two GEMMs.
+
+solve() returns the least squares solution of min ||A x - b||, the standard route for factor
+regressions; it throws when R has a zero pivot up to rounding (A is rank deficient).
+*/
+struct QRFactorization {
+public:
+    size_t rows, columns;
+    Matrix QR;
+    std::vector<double> tau;
+
+    explicit QRFactorization(const ConstMatrixView& A);
+    explicit QRFactorization(Matrix&& A);
+
+    std::vector<double> solve(const std::vector<double>& b) const;
+    Matrix solve(const ConstMatrixView& B) const;
+
+    // Thin factors: Q is rows x columns with orthonormal columns, R is columns x columns
+    Matrix Q() const;
+    Matrix R() const;
+
+    // B <- Q^T B, in place on a rows x k right hand side
+    void applyQT(Matrix& B) const;
+
+private:
+    void factor();
+};
+
+#endif
@@ -0,0 +1,179 @@
+#include "rollingCovariance.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+RollingCovariance::RollingCovariance(size_t _dimension, size_t _window, bool trackCholesky)
+    : dimension(_dimension), window(_window), tracking(trackCholesky), history(_window, _dimension),
+      average(_dimension, 0.0), comoment(_dimension, _dimension), cov(_dimension, _dimension), corr(_dimension, _dimension) {
+    if(window < 2) {
+        throw std::invalid_argument("Rolling window needs at least two observations");
+    }
+}
+
+// n -> n + 1: C += n / (n + 1) * d d^T with d = x - mean
+void RollingCovariance::addObservation(const double* x) {
+    thread_local std::vector<double> delta;
+    delta.resize(dimension);
+    double n = double(filled);
+    for(size_t i{}; i < dimension; i++) {
+        delta[i] = x[i] - average[i];
+        average[i] += delta[i] / (n + 1.0);
+    }
+    double weight = n / (n + 1.0);
+    double* c = comoment.data.data();
+    for(size_t i{}; i < dimension; i++) {
+        double scale = weight * delta[i];
+        double* row = c + i * dimension;
+        for(size_t j{}; j < dimension; j++) {
+            row[j] += scale * delta[j];
+        }
+    }
+    filled++;
+    if(factor) {
+        double root = std::sqrt(weight);
+        for(double& d : delta) {
+            d *= root;
+        }
+        factor->rankOneUpdate(delta);
+    }
+}
+
+// n -> n - 1: C -= n / (n - 1) * d d^T with d = x - mean taken before the removal
+void RollingCovariance::removeObservation(const double* x) {
+    thread_local std::vector<double> delta;
+    delta.resize(dimension);
+    double n = double(filled);
+    for(size_t i{}; i < dimension; i++) {
+        delta[i] = x[i] - average[i];
+        average[i] -= delta[i] / (n - 1.0);
+    }
+    double weight = n / (n - 1.0);
+    double* c = comoment.data.data();
+    for(size_t i{}; i < dimension; i++) {
+        double scale = weight * delta[i];
+        double* row = c + i * dimension;
+        for(size_t j{}; j < dimension; j++) {
+            row[j] -= scale * delta[j];
+        }
+    }
+    filled--;
+    if(factor) {
+        double root = std::sqrt(weight);
+        for(double& d : delta) {
+            d *= root;
+        }
+        try {
+            factor->rankOneDowndate(delta);
+        } catch(const std::runtime_error&) {
+            // Downdates are the ill-conditioned direction; fall back to a clean factorization
+            refactor();
+        }
+    }
+}
+
+void RollingCovariance::push(const double* observation) {
+    // Add before remove so the co-moment never drops to window - 1 observations,
+    // which keeps the tracked factor positive definite through the swap
+    addObservation(observation);
+    if(filled > window) {
+        removeObservation(&history.unchecked(head, 0));
+    }
+    std::copy(observation, observation + dimension, &history.unchecked(head, 0));
+    head = (head + 1) % window;
+    covDirty = corrDirty = true;
+    if(tracking && !factor && filled > dimension) {
+        refactor();
+    }
+}
+
+void RollingCovariance::push(const std::vector<double>& observation) {
+    if(observation.size() != dimension) {
+        throw std::invalid_argument("Observation does not match the covariance dimension");
+    }
+    push(observation.data());
+}
+
+void RollingCovariance::refactor() {
+    try {
+        factor = std::make_unique<CholeskyFactorization>(comoment);
+    } catch(const std::runtime_error&) {
+        factor.reset();
+    }
+}
+
+const Matrix& RollingCovariance::covariance() {
+    if(covDirty) {
+        double inverse = filled > 1 ? 1.0 / double(filled - 1) : 0.0;
+        for(size_t i{}; i < cov.data.size(); i++) {
+            cov.data[i] = comoment.data[i] * inverse;
+        }
+        covDirty = false;
+    }
+    return cov;
+}
+
+const Matrix& RollingCovariance::correlation() {
+    if(corrDirty) {
+        std::vector<double> inverseDeviation(dimension);
+        for(size_t i{}; i < dimension; i++) {
+            double diagonal = comoment.unchecked(i, i);
+            inverseDeviation[i] = diagonal > 0.0 ? 1.0 / std::sqrt(diagonal) : 0.0;
+        }
+        for(size_t i{}; i < dimension; i++) {
+            for(size_t j{}; j < dimension; j++) {
+                corr.unchecked(i, j) = comoment.unchecked(i, j) * inverseDeviation[i] * inverseDeviation[j];
+            }
+        }
+        corrDirty = false;
+    }
+    return corr;
+}
+
+std::vector<double> RollingCovariance::solve(const std::vector<double>& b) const {
+    if(!factor) {
+        throw std::runtime_error("No Cholesky factor is being tracked for this window");
+    }
+    // covariance = comoment / (count - 1), so its inverse is (count - 1) * comoment^-1
+    std::vector<double> x = factor->solve(b);
+    double scale = double(filled - 1);
+    for(double& v : x) {
+        v *= scale;
+    }
+    return x;
+}
+
+void RollingCovariance::recompute() {
+    std::fill(average.begin(), average.end(), 0.0);
+    std::fill(comoment.data.begin(), comoment.data.end(), 0.0);
+    size_t stored = filled;
+    covDirty = corrDirty = true;
+    // Nothing to average; dividing by zero would leave NaN means for later pushes to carry forward
+    if(stored == 0) {
+        return;
+    }
+    // Oldest first: when the ring is full that is the slot about to be overwritten
+    size_t start = stored == window ? head : 0;
+    for(size_t k{}; k < stored; k++) {
+        const double* row = &history.unchecked((start + k) % window, 0);
+        for(size_t i{}; i < dimension; i++) {
+            average[i] += row[i];
+        }
+    }
+    for(double& m : average) {
+        m /= double(stored);
+    }
+    for(size_t k{}; k < stored; k++) {
+        const double* row = &history.unchecked((start + k) % window, 0);
+        for(size_t i{}; i < dimension; i++) {
+            double di = row[i] - average[i];
+            double* out = &comoment.unchecked(i, 0);
+            for(size_t j{}; j < dimension; j++) {
+                out[j] += di * (row[j] - average[j]);
+            }
+        }
+    }
+    if(tracking && filled > dimension) {
+        refactor();
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef ROLLINGCOVARIANCE_HPP
+#define ROLLINGCOVARIANCE_HPP
+
+#include "cholesky.hpp"
+#include "matrix.hpp"
+#include <memory>
+#include <vector>
+
+/*
+Covariance and correlation over the last window observations, updated in O(n^2) per tick.
+A new observation is a rank-one add on the co-moment matrix and the one leaving the window
+a rank-one remove, so nothing is ever recomputed from the whole window.
+
+covariance() and correlation() return references to matrices owned by this object; they are
+brought up to date on access and stay valid until the next push. With trackCholesky the
+Cholesky factor of the co-moment is updated and downdated alongside, so solve() costs two
+triangular sweeps instead of a fresh factorization.
+
+Long runs accumulate rounding from the add/remove pairs; recompute() rebuilds everything
+from the buffered window.
+*/
+struct RollingCovariance {
+public:
+    size_t dimension;
+    size_t window;
+
+    RollingCovariance(size_t _dimension, size_t _window, bool trackCholesky = false);
+
+    void push(const double* observation);
+    void push(const std::vector<double>& observation);
+
+    size_t count() const { return filled; }
+    bool full() const { return filled == window; }
+    const std::vector<double>& mean() const { return average; }
+
+    const Matrix& covariance();   // sample, divides by count - 1
+    const Matrix& correlation();
+
+    // True once the window holds more observations than dimensions and the co-moment is positive definite
+    bool hasCholesky() const { return factor != nullptr; }
+    // covariance^-1 * b from the tracked factor
+    std::vector<double> solve(const std::vector<double>& b) const;
+
+    void recompute();
+
+private:
+    bool tracking;
+    size_t filled = 0;
+    size_t head = 0;      // ring slot the next observation goes into
+    Matrix history;       // window x dimension ring buffer
+    std::vector<double> average;
+    Matrix comoment;      // sum of (x - mean)(x - mean)^T over the window, kept symmetric
+    Matrix cov, corr;
+    bool covDirty = true, corrDirty = true;
+    std::unique_ptr<CholeskyFactorization> factor;
+
+    void addObservation(const double* x);
+    void removeObservation(const double* x);
+    void refactor();
+};
+
+#endif
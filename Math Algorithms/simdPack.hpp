@@ -0,0 +1,103 @@
+#ifndef SIMDPACK_HPP
+#define SIMDPACK_HPP
+
+#include "cpuFeatures.hpp"
+#include <cmath>
+#include <cstddef>
+
+#if QUANT_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+/*
+Thin wrappers over one SIMD register of doubles, with the same interface per ISA.
+Kernel sources written against "Pack" are included once per ISA inside the matching
+QUANT_BEGIN_TARGET_* region, and the dispatcher picks the instance at runtime.
+*/
+namespace simd {
+
+struct Scalar {
+    using Reg = double;
+    static constexpr size_t width = 1;
+
+    static QUANT_ALWAYS_INLINE Reg load(const double* p) { return *p; }
+    static QUANT_ALWAYS_INLINE void store(double* p, Reg r) { *p = r; }
+    static QUANT_ALWAYS_INLINE Reg set1(double v) { return v; }
+    static QUANT_ALWAYS_INLINE Reg add(Reg a, Reg b) { return a + b; }
+    static QUANT_ALWAYS_INLINE Reg sub(Reg a, Reg b) { return a - b; }
+    static QUANT_ALWAYS_INLINE Reg mul(Reg a, Reg b) { return a * b; }
+    static QUANT_ALWAYS_INLINE Reg div(Reg a, Reg b) { return a / b; }
+    static QUANT_ALWAYS_INLINE Reg fmadd(Reg a, Reg b, Reg c) { return a * b + c; }
+    static QUANT_ALWAYS_INLINE Reg fnmadd(Reg a, Reg b, Reg c) { return c - a * b; }
+    static QUANT_ALWAYS_INLINE Reg sqrt(Reg a) { return std::sqrt(a); }
+    static QUANT_ALWAYS_INLINE Reg rsqrt(Reg a) { return 1.0 / std::sqrt(a); }
+    static QUANT_ALWAYS_INLINE Reg min(Reg a, Reg b) { return a < b ? a : b; }
+    static QUANT_ALWAYS_INLINE Reg max(Reg a, Reg b) { return a > b ? a : b; }
+    static QUANT_ALWAYS_INLINE bool anyLess(Reg a, Reg b) { return a < b; }
+    // Bit per lane where a < b
+    static QUANT_ALWAYS_INLINE unsigned lessMask(Reg a, Reg b) { return a < b; }
+};
+
+#if QUANT_X86_DISPATCH
+struct AVX2 {
+    using Reg = __m256d;
+    static constexpr size_t width = 4;
+
+    QUANT_TARGET_AVX2 static QUANT_ALWAYS_INLINE Reg load(const double* p) { return _mm256_loadu_pd(p); }
+    QUANT_TARGET_AVX2 static QUANT_ALWAYS_INLINE void store(double* p, Reg r) { _mm256_storeu_pd(p, r); }
+    QUANT_TARGET_AVX2 static QUANT_ALWAYS_INLINE Reg set1(double v) { return _mm256_set1_pd(v); }
+    QUANT_TARGET_AVX2 static QUANT_ALWAYS_INLINE Reg add(Reg a, Reg b) { return _mm256_add_pd(a, b); }
+    QUANT_TARGET_AVX2 static QUANT_ALWAYS_INLINE Reg sub(Reg a, Reg b) { return _mm256_sub_pd(a, b); }
+    QUANT_TARGET_AVX2 static QUANT_ALWAYS_INLINE Reg mul(Reg a, Reg b) { return _mm256_mul_pd(a, b); }
+    QUANT_TARGET_AVX2 static QUANT_ALWAYS_INLINE Reg div(Reg a, Reg b) { return _mm256_div_pd(a, b); }
+    QUANT_TARGET_AVX2 static QUANT_ALWAYS_INLINE Reg fmadd(Reg a, Reg b, Reg c) { return _mm256_fmadd_pd(a, b, c); }
+    QUANT_TARGET_AVX2 static QUANT_ALWAYS_INLINE Reg fnmadd(Reg a, Reg b, Reg c) { return _mm256_fnmadd_pd(a, b, c); }
+    QUANT_TARGET_AVX2 static QUANT_ALWAYS_INLINE Reg sqrt(Reg a) { return _mm256_sqrt_pd(a); }
+    QUANT_TARGET_AVX2 static QUANT_ALWAYS_INLINE Reg rsqrt(Reg a) { return _mm256_div_pd(_mm256_set1_pd(1.0), _mm256_sqrt_pd(a)); }
+    QUANT_TARGET_AVX2 static QUANT_ALWAYS_INLINE Reg min(Reg a, Reg b) { return _mm256_min_pd(a, b); }
+    QUANT_TARGET_AVX2 static QUANT_ALWAYS_INLINE Reg max(Reg a, Reg b) { return _mm256_max_pd(a, b); }
+    QUANT_TARGET_AVX2 static QUANT_ALWAYS_INLINE bool anyLess(Reg a, Reg b) {
+        return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_LT_OQ)) != 0;
+    }
+    QUANT_TARGET_AVX2 static QUANT_ALWAYS_INLINE unsigned lessMask(Reg a, Reg b) {
+        return unsigned(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_LT_OQ)));
+    }
+};
+
+struct AVX512 {
+    using Reg = __m512d;
+    static constexpr size_t width = 8;
+
+    QUANT_TARGET_AVX512 static QUANT_ALWAYS_INLINE Reg load(const double* p) { return _mm512_loadu_pd(p); }
+    QUANT_TARGET_AVX512 static QUANT_ALWAYS_INLINE void store(double* p, Reg r) { _mm512_storeu_pd(p, r); }
+    QUANT_TARGET_AVX512 static QUANT_ALWAYS_INLINE Reg set1(double v) { return _mm512_set1_pd(v); }
+    QUANT_TARGET_AVX512 static QUANT_ALWAYS_INLINE Reg add(Reg a, Reg b) { return _mm512_add_pd(a, b); }
+    QUANT_TARGET_AVX512 static QUANT_ALWAYS_INLINE Reg sub(Reg a, Reg b) { return _mm512_sub_pd(a, b); }
+    QUANT_TARGET_AVX512 static QUANT_ALWAYS_INLINE Reg mul(Reg a, Reg b) { return _mm512_mul_pd(a, b); }
+    QUANT_TARGET_AVX512 static QUANT_ALWAYS_INLINE Reg div(Reg a, Reg b) { return _mm512_div_pd(a, b); }
+    QUANT_TARGET_AVX512 static QUANT_ALWAYS_INLINE Reg fmadd(Reg a, Reg b, Reg c) { return _mm512_fmadd_pd(a, b, c); }
+    QUANT_TARGET_AVX512 static QUANT_ALWAYS_INLINE Reg fnmadd(Reg a, Reg b, Reg c) { return _mm512_fnmadd_pd(a, b, c); }
+    // Full-mask forms, the plain intrinsics trip a GCC 12 -Wmaybe-uninitialized false positive
+    QUANT_TARGET_AVX512 static QUANT_ALWAYS_INLINE Reg sqrt(Reg a) { return _mm512_mask_sqrt_pd(a, 0xFF, a); }
+    // 14-bit estimate refined by two Newton steps, which is within a few ulp of 1 / sqrt(a) and much
+    // cheaper than a square root and a division; 0 gives NaN rather than infinity
+    QUANT_TARGET_AVX512 static QUANT_ALWAYS_INLINE Reg rsqrt(Reg a) {
+        Reg y = _mm512_mask_rsqrt14_pd(a, 0xFF, a);
+        Reg half = _mm512_mul_pd(a, _mm512_set1_pd(0.5)), threeHalves = _mm512_set1_pd(1.5);
+        y = _mm512_mul_pd(y, _mm512_fnmadd_pd(half, _mm512_mul_pd(y, y), threeHalves));
+        return _mm512_mul_pd(y, _mm512_fnmadd_pd(half, _mm512_mul_pd(y, y), threeHalves));
+    }
+    QUANT_TARGET_AVX512 static QUANT_ALWAYS_INLINE Reg min(Reg a, Reg b) { return _mm512_mask_min_pd(a, 0xFF, a, b); }
+    QUANT_TARGET_AVX512 static QUANT_ALWAYS_INLINE Reg max(Reg a, Reg b) { return _mm512_mask_max_pd(a, 0xFF, a, b); }
+    QUANT_TARGET_AVX512 static QUANT_ALWAYS_INLINE bool anyLess(Reg a, Reg b) {
+        return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ) != 0;
+    }
+    QUANT_TARGET_AVX512 static QUANT_ALWAYS_INLINE unsigned lessMask(Reg a, Reg b) {
+        return unsigned(_mm512_cmp_pd_mask(a, b, _CMP_LT_OQ));
+    }
+};
+#endif
+
+} // namespace simd
+
+#endif
@@ -0,0 +1,298 @@
+#include "sparseCholesky.hpp"
+#include "threadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+static constexpr size_t NONE = static_cast<size_t>(-1);
+
+std::vector<size_t> minimumDegreeOrdering(const SparseMatrix& A) {
+    if(A.rows != A.columns) {
+        throw std::invalid_argument("You need a square matrix for a fill-reducing ordering");
+    }
+    size_t n = A.rows;
+    // Quotient graph: a live variable keeps the variables it still touches directly and the elements
+    // (eliminated variables standing for their cliques) it belongs to; an element keeps its live members
+    std::vector<std::vector<size_t>> variables(n), elements(n), members(n);
+    for(size_t i{}; i < n; i++) {
+        for(size_t p{A.rowStart[i]}; p < A.rowStart[i + 1]; p++) {
+            size_t j = A.columnIndex[p];
+            if(i != j) {
+                variables[i].push_back(j);
+                variables[j].push_back(i);
+            }
+        }
+    }
+    std::vector<size_t> degree(n);
+    for(size_t v{}; v < n; v++) {
+        std::sort(variables[v].begin(), variables[v].end());
+        variables[v].erase(std::unique(variables[v].begin(), variables[v].end()), variables[v].end());
+        degree[v] = variables[v].size();
+    }
+
+    // Live variables in doubly linked lists by degree: a degree change relinks one vertex, where a heap
+    // would pile up a stale entry for every update
+    std::vector<size_t> head(n, NONE), next(n, NONE), previous(n, NONE);
+    auto link = [&](size_t v) {
+        size_t d = degree[v];
+        previous[v] = NONE;
+        next[v] = head[d];
+        if(head[d] != NONE) {
+            previous[head[d]] = v;
+        }
+        head[d] = v;
+    };
+    auto unlink = [&](size_t v) {
+        if(previous[v] != NONE) {
+            next[previous[v]] = next[v];
+        } else {
+            head[degree[v]] = next[v];
+        }
+        if(next[v] != NONE) {
+            previous[next[v]] = previous[v];
+        }
+    };
+    for(size_t v{n}; v-- > 0;) {
+        link(v);
+    }
+    size_t lowest = 0;
+    std::vector<bool> eliminated(n, false), absorbed(n, false);
+    // mark[v] == p while v is in the new element p; outside[e] is |members of e not in p|, valid while seen[e] == p
+    std::vector<size_t> mark(n, NONE), seen(n, NONE), outside(n);
+    std::vector<size_t> order;
+    order.reserve(n);
+    while(order.size() < n) {
+        while(head[lowest] == NONE) {
+            lowest++;
+        }
+        size_t p = head[lowest];
+        unlink(p);
+        eliminated[p] = true;
+        order.push_back(p);
+
+        // The new element: p's variables and the members of every element p belonged to, which it absorbs
+        std::vector<size_t>& clique = members[p];
+        mark[p] = p;
+        for(size_t v : variables[p]) {
+            if(mark[v] != p) {
+                mark[v] = p;
+                clique.push_back(v);
+            }
+        }
+        for(size_t e : elements[p]) {
+            for(size_t v : members[e]) {
+                if(mark[v] != p) {
+                    mark[v] = p;
+                    clique.push_back(v);
+                }
+            }
+            absorbed[e] = true;
+            std::vector<size_t>().swap(members[e]);
+        }
+        std::vector<size_t>().swap(variables[p]);
+        std::vector<size_t>().swap(elements[p]);
+
+        // Drop what p now covers: absorbed elements and direct edges inside the clique
+        for(size_t i : clique) {
+            std::vector<size_t>& own = elements[i];
+            own.erase(std::remove_if(own.begin(), own.end(), [&](size_t e) { return absorbed[e]; }), own.end());
+            std::vector<size_t>& direct = variables[i];
+            direct.erase(std::remove_if(direct.begin(), direct.end(), [&](size_t v) { return mark[v] == p; }), direct.end());
+            for(size_t e : own) {
+                if(seen[e] != p) {
+                    seen[e] = p;
+                    outside[e] = members[e].size();
+                }
+                outside[e]--;
+            }
+        }
+
+        // Approximate external degrees as in AMD: counting each element's members outside p separately
+        // bounds the true degree from above, and is exact unless two elements share outside members
+        size_t remaining = n - order.size();
+        for(size_t i : clique) {
+            std::vector<size_t>& own = elements[i];
+            size_t bound = clique.size() - 1 + variables[i].size();
+            size_t kept = 0;
+            for(size_t e : own) {
+                // An element left with no members outside p lies inside it and is absorbed as well
+                if(outside[e] == 0) {
+                    absorbed[e] = true;
+                    std::vector<size_t>().swap(members[e]);
+                    continue;
+                }
+                bound += outside[e];
+                own[kept++] = e;
+            }
+            own.resize(kept);
+            own.push_back(p);
+            unlink(i);
+            degree[i] = std::min({remaining - 1, degree[i] + clique.size() - 1, bound});
+            link(i);
+            lowest = std::min(lowest, degree[i]);
+        }
+    }
+    return order;
+}
+
+SparseCholesky::SparseCholesky(const SparseMatrix& A, SparseOrdering ordering) : n(A.rows) {
+    if(A.rows != A.columns) {
+        throw std::invalid_argument("You need a square matrix for Cholesky factorization");
+    }
+    if(ordering == SparseOrdering::MinimumDegree) {
+        permutation = minimumDegreeOrdering(A);
+    } else {
+        permutation.resize(n);
+        std::iota(permutation.begin(), permutation.end(), size_t{0});
+    }
+    std::vector<size_t> inverse(n);
+    for(size_t k{}; k < n; k++) {
+        inverse[permutation[k]] = k;
+    }
+    // C = lower triangle of P A P^T, built from the lower triangle of A
+    std::vector<SparseEntry> entries;
+    entries.reserve(A.nonZeros());
+    for(size_t i{}; i < n; i++) {
+        for(size_t p{A.rowStart[i]}; p < A.rowStart[i + 1]; p++) {
+            size_t j = A.columnIndex[p];
+            if(j <= i) {
+                size_t ci = inverse[i], cj = inverse[j];
+                entries.push_back({std::max(ci, cj), std::min(ci, cj), A.values[p]});
+            }
+        }
+    }
+    SparseMatrix C = SparseMatrix::fromEntries(n, n, std::move(entries));
+    auto forEachLower = [&](size_t k, auto&& body) {
+        for(size_t p{C.rowStart[k]}; p < C.rowStart[k + 1]; p++) {
+            body(C.columnIndex[p], C.values[p]);
+        }
+    };
+
+    // Elimination tree with path compression through ancestor
+    std::vector<size_t> parent(n, NONE), ancestor(n, NONE);
+    for(size_t k{}; k < n; k++) {
+        forEachLower(k, [&](size_t i, double) {
+            while(i != NONE && i < k) {
+                size_t next = ancestor[i];
+                ancestor[i] = k;
+                if(next == NONE) {
+                    parent[i] = k;
+                }
+                i = next;
+            }
+        });
+    }
+
+    // Pattern of row k of L: the nodes reached walking the tree up from each nonzero of C's row k
+    std::vector<size_t> mark(n, NONE), stack(n);
+    auto rowPattern = [&](size_t k) {
+        size_t top = n;
+        mark[k] = k;
+        forEachLower(k, [&](size_t i, double) {
+            size_t length = 0;
+            for(; mark[i] != k; i = parent[i]) {
+                stack[length++] = i;
+                mark[i] = k;
+            }
+            while(length > 0) {
+                stack[--top] = stack[--length];
+            }
+        });
+        return top;
+    };
+
+    // Symbolic pass: column counts from the row patterns, so L is allocated exactly once
+    columnStart.assign(n + 1, 0);
+    for(size_t k{}; k < n; k++) {
+        columnStart[k + 1]++;
+        for(size_t top = rowPattern(k); top < n; top++) {
+            columnStart[stack[top] + 1]++;
+        }
+    }
+    for(size_t k{}; k < n; k++) {
+        columnStart[k + 1] += columnStart[k];
+    }
+    rowIndex.resize(columnStart[n]);
+    values.resize(columnStart[n]);
+    std::fill(mark.begin(), mark.end(), NONE);
+
+    // Up-looking numeric factorization; next[j] is the first free slot of column j
+    std::vector<size_t> next(columnStart.begin(), columnStart.end() - 1);
+    std::vector<double> x(n, 0.0);
+    for(size_t k{}; k < n; k++) {
+        size_t top = rowPattern(k);
+        forEachLower(k, [&](size_t i, double value) { x[i] += value; });
+        double diagonal = x[k];
+        x[k] = 0.0;
+        for(; top < n; top++) {
+            size_t i = stack[top];
+            double lki = x[i] / values[columnStart[i]];
+            x[i] = 0.0;
+            for(size_t p{columnStart[i] + 1}; p < next[i]; p++) {
+                x[rowIndex[p]] -= values[p] * lki;
+            }
+            diagonal -= lki * lki;
+            size_t slot = next[i]++;
+            rowIndex[slot] = k;
+            values[slot] = lki;
+        }
+        if(!(diagonal > 0.0)) {
+            throw std::runtime_error("Matrix is not positive definite");
+        }
+        size_t slot = next[k]++;
+        rowIndex[slot] = k;
+        values[slot] = std::sqrt(diagonal);
+    }
+}
+
+void SparseCholesky::solveInPlace(double* x) const {
+    for(size_t j{}; j < n; j++) {
+        x[j] /= values[columnStart[j]];
+        for(size_t p{columnStart[j] + 1}; p < columnStart[j + 1]; p++) {
+            x[rowIndex[p]] -= values[p] * x[j];
+        }
+    }
+    for(size_t j{n}; j-- > 0;) {
+        for(size_t p{columnStart[j] + 1}; p < columnStart[j + 1]; p++) {
+            x[j] -= values[p] * x[rowIndex[p]];
+        }
+        x[j] /= values[columnStart[j]];
+    }
+}
+
+std::vector<double> SparseCholesky::solve(const std::vector<double>& b) const {
+    if(b.size() != n) {
+        throw std::invalid_argument("Right hand side length does not match the matrix");
+    }
+    std::vector<double> y(n), x(n);
+    for(size_t k{}; k < n; k++) {
+        y[k] = b[permutation[k]];
+    }
+    solveInPlace(y.data());
+    for(size_t k{}; k < n; k++) {
+        x[permutation[k]] = y[k];
+    }
+    return x;
+}
+
+Matrix SparseCholesky::solve(const ConstMatrixView& B) const {
+    if(B.rows != n) {
+        throw std::invalid_argument("Right hand side rows do not match the matrix");
+    }
+    Matrix X(n, B.columns, MatrixInit::Uninitialized);
+    parallelChunks(B.columns, 1, [&](size_t begin, size_t end) {
+        std::vector<double> y(n);
+        for(size_t c{begin}; c < end; c++) {
+            for(size_t k{}; k < n; k++) {
+                y[k] = B.unchecked(permutation[k], c);
+            }
+            solveInPlace(y.data());
+            for(size_t k{}; k < n; k++) {
+                X.unchecked(permutation[k], c) = y[k];
+            }
+        }
+    });
+    return X;
+}
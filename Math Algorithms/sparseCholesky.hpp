@@ -0,0 +1,48 @@
+#ifndef SPARSECHOLESKY_HPP
+#define SPARSECHOLESKY_HPP
+
+#include "sparseMatrix.hpp"
+#include <vector>
+
+enum class SparseOrdering {
+    Natural,
+    MinimumDegree
+};
+
+/*
+P A P^T = L L^T for sparse symmetric positive definite A, only the lower triangle of A is read.
+
+The minimum degree ordering eliminates the vertex with the fewest neighbours first, which keeps
+the fill in L close to the nonzeros of A for the block and arrow structures of constraint systems.
+It works on the quotient graph, as AMD does: an eliminated vertex becomes an element listing its
+neighbours instead of joining them into a clique, elements it touches are absorbed into it, and
+degrees are AMD's approximate external degrees, so the graph never outgrows the pattern of A.
+The elimination tree gives the pattern of every row of L before any arithmetic, and the numeric
+factorization is up-looking: row k of L is one sparse triangular solve against rows 0..k-1.
+
+L is stored by columns, diagonal first, so both triangular solves stream it in order.
+permutation[k] is the row of A that became row k of P A P^T.
+*/
+struct SparseCholesky {
+public:
+    size_t n;
+    std::vector<size_t> permutation;
+    ResourceVector<size_t> columnStart;
+    ResourceVector<size_t> rowIndex;
+    ResourceVector<double> values;
+
+    explicit SparseCholesky(const SparseMatrix& A, SparseOrdering ordering = SparseOrdering::MinimumDegree);
+
+    std::vector<double> solve(const std::vector<double>& b) const;
+    // Columns of B are solved independently across the global thread pool
+    Matrix solve(const ConstMatrixView& B) const;
+    size_t nonZeros() const { return values.size(); }
+
+private:
+    void solveInPlace(double* x) const;
+};
+
+// Fill-reducing order for the symmetric pattern of A, from either or both triangles
+std::vector<size_t> minimumDegreeOrdering(const SparseMatrix& A);
+
+#endif
@@ -0,0 +1,150 @@
+#include "sparseMatrix.hpp"
+#include "threadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+static constexpr size_t PARALLEL_GRAIN = 1 << 14;
+
+SparseMatrix::SparseMatrix(size_t _rows, size_t _columns) : rows(_rows), columns(_columns), rowStart(_rows + 1, 0) {}
+
+SparseMatrix::SparseMatrix(const ConstMatrixView& dense, double dropTolerance) : SparseMatrix(dense.rows, dense.columns) {
+    for(size_t i{}; i < rows; i++) {
+        for(size_t j{}; j < columns; j++) {
+            double value = dense.unchecked(i, j);
+            if(std::fabs(value) > dropTolerance) {
+                columnIndex.push_back(j);
+                values.push_back(value);
+            }
+        }
+        rowStart[i + 1] = values.size();
+    }
+}
+
+SparseMatrix SparseMatrix::fromEntries(size_t rows, size_t columns, std::vector<SparseEntry> entries) {
+    for(const SparseEntry& entry : entries) {
+        if(entry.row >= rows || entry.column >= columns) {
+            throw std::out_of_range("Sparse entry indices out of range");
+        }
+    }
+    std::sort(entries.begin(), entries.end(), [](const SparseEntry& a, const SparseEntry& b) {
+        return a.row != b.row ? a.row < b.row : a.column < b.column;
+    });
+    SparseMatrix result(rows, columns);
+    result.columnIndex.reserve(entries.size());
+    result.values.reserve(entries.size());
+    size_t index = 0;
+    for(size_t i{}; i < rows; i++) {
+        while(index < entries.size() && entries[index].row == i) {
+            size_t col = entries[index].column;
+            double sum = 0.0;
+            for(; index < entries.size() && entries[index].row == i && entries[index].column == col; index++) {
+                sum += entries[index].value;
+            }
+            result.columnIndex.push_back(col);
+            result.values.push_back(sum);
+        }
+        result.rowStart[i + 1] = result.values.size();
+    }
+    return result;
+}
+
+double SparseMatrix::get(size_t row, size_t col) const {
+    if(row >= rows || col >= columns) {
+        throw std::out_of_range("Matrix indices out of range");
+    }
+    auto begin = columnIndex.begin() + rowStart[row];
+    auto end = columnIndex.begin() + rowStart[row + 1];
+    auto found = std::lower_bound(begin, end, col);
+    return found != end && *found == col ? values[found - columnIndex.begin()] : 0.0;
+}
+
+Matrix SparseMatrix::toDense() const {
+    Matrix dense(rows, columns);
+    for(size_t i{}; i < rows; i++) {
+        for(size_t p{rowStart[i]}; p < rowStart[i + 1]; p++) {
+            dense.unchecked(i, columnIndex[p]) = values[p];
+        }
+    }
+    return dense;
+}
+
+SparseMatrix SparseMatrix::transpose() const {
+    SparseMatrix result(columns, rows);
+    for(size_t col : columnIndex) {
+        result.rowStart[col + 1]++;
+    }
+    for(size_t j{}; j < columns; j++) {
+        result.rowStart[j + 1] += result.rowStart[j];
+    }
+    result.columnIndex.resize(nonZeros());
+    result.values.resize(nonZeros());
+    // Rows are visited in order, so every transposed row comes out sorted
+    ResourceVector<size_t> next(result.rowStart.begin(), result.rowStart.end() - 1);
+    for(size_t i{}; i < rows; i++) {
+        for(size_t p{rowStart[i]}; p < rowStart[i + 1]; p++) {
+            size_t q = next[columnIndex[p]]++;
+            result.columnIndex[q] = i;
+            result.values[q] = values[p];
+        }
+    }
+    return result;
+}
+
+// Rows per task so each task covers about PARALLEL_GRAIN multiply-adds
+static size_t rowGrain(const SparseMatrix& A, size_t width) {
+    size_t perRow = std::max<size_t>(1, A.nonZeros() * width / std::max<size_t>(1, A.rows));
+    return std::max<size_t>(1, PARALLEL_GRAIN / perRow);
+}
+
+void SparseMatrix::multiply(const std::vector<double>& x, std::vector<double>& y) const {
+    if(x.size() != columns) {
+        throw std::invalid_argument("Vector length does not match the matrix columns");
+    }
+    y.resize(rows);
+    parallelChunks(rows, rowGrain(*this, 1), [&](size_t begin, size_t end) {
+        for(size_t i{begin}; i < end; i++) {
+            double sum = 0.0;
+            for(size_t p{rowStart[i]}; p < rowStart[i + 1]; p++) {
+                sum += values[p] * x[columnIndex[p]];
+            }
+            y[i] = sum;
+        }
+    });
+}
+
+std::vector<double> SparseMatrix::operator*(const std::vector<double>& x) const {
+    std::vector<double> y;
+    multiply(x, y);
+    return y;
+}
+
+Matrix SparseMatrix::operator*(const ConstMatrixView& B) const {
+    if(B.rows != columns) {
+        throw std::invalid_argument("Matrix dimensions are not compatible for multiplication");
+    }
+    Matrix C(rows, B.columns);
+    size_t width = B.columns;
+    if(width == 0) {
+        return C;
+    }
+    parallelChunks(rows, rowGrain(*this, width), [&](size_t begin, size_t end) {
+        for(size_t i{begin}; i < end; i++) {
+            double* out = &C.unchecked(i, 0);
+            for(size_t p{rowStart[i]}; p < rowStart[i + 1]; p++) {
+                double a = values[p];
+                const double* in = &B.unchecked(columnIndex[p], 0);
+                if(B.colStride == 1) {
+                    for(size_t j{}; j < width; j++) {
+                        out[j] += a * in[j];
+                    }
+                } else {
+                    for(size_t j{}; j < width; j++) {
+                        out[j] += a * in[j * B.colStride];
+                    }
+                }
+            }
+        }
+    });
+    return C;
+}
@@ -0,0 +1,44 @@
+#ifndef SPARSEMATRIX_HPP
+#define SPARSEMATRIX_HPP
+
+#include "matrix.hpp"
+#include <vector>
+
+/*
+Compressed sparse row matrix for exposure and constraint matrices that are mostly zeros.
+Row i holds columnIndex/values in [rowStart[i], rowStart[i + 1]), columns strictly increasing,
+so memory and the products scale with nonZeros() instead of rows * columns.
+
+transpose() gives the CSR form of A^T, which is the CSC form of A.
+*/
+struct SparseEntry {
+public:
+    size_t row, column;
+    double value;
+};
+
+struct SparseMatrix {
+public:
+    size_t rows, columns;
+    ResourceVector<size_t> rowStart;
+    ResourceVector<size_t> columnIndex;
+    ResourceVector<double> values;
+
+    SparseMatrix(size_t _rows, size_t _columns);
+    // Keeps the entries with |value| > dropTolerance
+    explicit SparseMatrix(const ConstMatrixView& dense, double dropTolerance = 0.0);
+    // Duplicate (row, column) entries are summed, in any order
+    static SparseMatrix fromEntries(size_t rows, size_t columns, std::vector<SparseEntry> entries);
+
+    size_t nonZeros() const { return values.size(); }
+    double get(size_t row, size_t col) const;
+    Matrix toDense() const;
+    SparseMatrix transpose() const;
+
+    // y = A x and C = A B, split over rows on the global thread pool
+    std::vector<double> operator*(const std::vector<double>& x) const;
+    void multiply(const std::vector<double>& x, std::vector<double>& y) const;
+    Matrix operator*(const ConstMatrixView& B) const;
+};
+
+#endif
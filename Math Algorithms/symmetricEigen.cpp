@@ -0,0 +1,337 @@
+#include "symmetricEigen.hpp"
+#include "gemm.hpp"
+#include "simdPack.hpp"
+#include "threadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+static constexpr size_t BLOCK = 32;
+static constexpr size_t PARALLEL_GRAIN = 1 << 14;
+static constexpr int MAX_SWEEPS = 60;
+// Columns of Z per cache tile and rotations queued between passes over Z
+static constexpr size_t COLUMN_TILE = 32;
+static constexpr size_t ROTATION_BATCH = 1 << 15;
+
+namespace {
+
+struct Rotation {
+    size_t row;
+    double c, s;
+};
+
+namespace scalarKernels {
+using Pack = simd::Scalar;
+#include "symmetricEigenKernels.inl"
+}
+
+#if QUANT_X86_DISPATCH
+QUANT_BEGIN_TARGET_AVX2
+namespace avx2Kernels {
+using Pack = simd::AVX2;
+#include "symmetricEigenKernels.inl"
+}
+QUANT_END_TARGET
+
+QUANT_BEGIN_TARGET_AVX512
+namespace avx512Kernels {
+using Pack = simd::AVX512;
+#include "symmetricEigenKernels.inl"
+}
+QUANT_END_TARGET
+#endif
+
+struct Kernels {
+    void (*rotateColumns)(const Rotation*, size_t, double*, size_t, size_t, size_t);
+    void (*multiplyRows)(const double*, size_t, size_t, const double*, double*, size_t, size_t);
+};
+
+Kernels selectKernels() {
+    switch(activeSimdLevel()) {
+#if QUANT_X86_DISPATCH
+        case SimdLevel::AVX512: return {avx512Kernels::rotateColumns, avx512Kernels::multiplyRows};
+        case SimdLevel::AVX2: return {avx2Kernels::rotateColumns, avx2Kernels::multiplyRows};
+#endif
+        default: return {scalarKernels::rotateColumns, scalarKernels::multiplyRows};
+    }
+}
+
+} // namespace
+
+SymmetricEigen::SymmetricEigen(const ConstMatrixView& A, bool computeVectors) : n(A.rows), vectors(0, 0) {
+    Matrix work = A;
+    decompose(work, computeVectors);
+}
+
+SymmetricEigen::SymmetricEigen(Matrix&& A, bool computeVectors) : n(A.rows), vectors(0, 0) {
+    decompose(A, computeVectors);
+}
+
+// Reduces A to tridiagonal (d, e) with Householder reflectors H_k = I - beta_k v_k v_k^T acting
+// on indices k+1..n-1. v_k is left in row k right of the subdiagonal, its leading 1 implicit.
+// Panels of BLOCK reflectors are formed against the unmodified trailing matrix plus the
+// corrections V W^T + W V^T, which are applied to the rest of A in two GEMMs per panel.
+static void tridiagonalize(double* a, size_t n, std::vector<double>& d, std::vector<double>& e, std::vector<double>& beta) {
+    Kernels kernels = selectKernels();
+    std::vector<double> y(n), vw(BLOCK), ww(BLOCK);
+    for(size_t k0{}; k0 + 2 < n; k0 += BLOCK) {
+        size_t kb = std::min(BLOCK, n - 2 - k0);
+        size_t base = k0 + 1;
+        size_t m = n - base;
+        // Row r is index base + r: V in columns [0, kb), W in [kb, 2kb)
+        Matrix panel(m, 2 * kb);
+        double* P = panel.data.data();
+        size_t ldp = 2 * kb;
+
+        for(size_t j{}; j < kb; j++) {
+            size_t k = k0 + j;
+            double* row = a + k * n;
+            if(j > 0) {
+                const double* pk = P + (k - base) * ldp;
+                for(size_t c{k}; c < n; c++) {
+                    const double* pc = P + (c - base) * ldp;
+                    double sum = 0.0;
+                    for(size_t p{}; p < j; p++) {
+                        sum += pk[p] * pc[kb + p] + pk[kb + p] * pc[p];
+                    }
+                    row[c] -= sum;
+                }
+            }
+            d[k] = row[k];
+            double* x = row + k + 1;
+            size_t len = n - k - 1;
+            double norm = 0.0;
+            for(size_t i{1}; i < len; i++) {
+                norm += x[i] * x[i];
+            }
+            if(norm == 0.0) {
+                e[k] = x[0];
+                beta[k] = 0.0;
+                continue;
+            }
+            double alpha = x[0];
+            double mu = -std::copysign(std::sqrt(alpha * alpha + norm), alpha);
+            double scale = 1.0 / (alpha - mu);
+            x[0] = 1.0;
+            for(size_t i{1}; i < len; i++) {
+                x[i] *= scale;
+            }
+            double b = (mu - alpha) / mu;
+            beta[k] = b;
+            e[k] = mu;
+
+            // y = (A - V W^T - W V^T) v over the trailing rows, with A as it was at the panel start
+            const double* a22 = a + (k + 1) * n + k + 1;
+            parallelChunks(len, std::max<size_t>(1, PARALLEL_GRAIN / len), [&](size_t begin, size_t end) {
+                kernels.multiplyRows(a22, n, len, x, y.data(), begin, end);
+            });
+            const double* pv = P + (k + 1 - base) * ldp;
+            std::fill(vw.begin(), vw.begin() + j, 0.0);
+            std::fill(ww.begin(), ww.begin() + j, 0.0);
+            for(size_t i{}; i < len; i++) {
+                const double* pr = pv + i * ldp;
+                for(size_t p{}; p < j; p++) {
+                    ww[p] += pr[kb + p] * x[i];
+                    vw[p] += pr[p] * x[i];
+                }
+            }
+            double yv = 0.0;
+            for(size_t i{}; i < len; i++) {
+                const double* pr = pv + i * ldp;
+                double correction = 0.0;
+                for(size_t p{}; p < j; p++) {
+                    correction += pr[p] * ww[p] + pr[kb + p] * vw[p];
+                }
+                y[i] = b * (y[i] - correction);
+                yv += y[i] * x[i];
+            }
+            // w = beta y - (beta / 2)(beta y^T v) v makes H A H = A - v w^T - w v^T
+            double half = 0.5 * b * yv;
+            double* pw = P + (k + 1 - base) * ldp;
+            for(size_t i{}; i < len; i++) {
+                pw[i * ldp + j] = x[i];
+                pw[i * ldp + kb + j] = y[i] - half * x[i];
+            }
+        }
+
+        size_t t = k0 + kb;
+        size_t rest = n - t;
+        const double* V = P + (t - base) * ldp;
+        const double* W = V + kb;
+        double* trailing = a + t * n + t;
+        gemm(rest, rest, kb, -1.0, V, ldp, 1, W, 1, ldp, 1.0, trailing, n);
+        gemm(rest, rest, kb, -1.0, W, ldp, 1, V, 1, ldp, 1.0, trailing, n);
+    }
+    if(n >= 2) {
+        d[n - 2] = a[(n - 2) * n + n - 2];
+        e[n - 2] = a[(n - 1) * n + n - 2];
+    }
+    if(n >= 1) {
+        d[n - 1] = a[(n - 1) * n + n - 1];
+    }
+}
+
+// Z = Q^T = H_n-3 ... H_0, built backwards one panel at a time so each panel only touches the
+// trailing block: Z <- Z (I - V T V^T)^T with T the forward triangular factor of the panel.
+static void accumulate(const double* a, size_t n, const std::vector<double>& beta, double* z) {
+    for(size_t i{}; i < n; i++) {
+        z[i * n + i] = 1.0;
+    }
+    if(n < 3) {
+        return;
+    }
+    size_t panels = (n - 2 + BLOCK - 1) / BLOCK;
+    for(size_t block = panels; block-- > 0;) {
+        size_t k0 = block * BLOCK;
+        size_t kb = std::min(BLOCK, n - 2 - k0);
+        size_t base = k0 + 1;
+        size_t m = n - base;
+
+        Matrix V(m, kb), T(kb, kb), Y(m, kb, MatrixInit::Uninitialized), YT(m, kb, MatrixInit::Uninitialized);
+        for(size_t p{}; p < kb; p++) {
+            const double* x = a + (k0 + p) * n + k0 + p + 1;
+            V.unchecked(p, p) = 1.0;
+            for(size_t r{p + 1}; r < m; r++) {
+                V.unchecked(r, p) = x[r - p];
+            }
+        }
+        for(size_t j{}; j < kb; j++) {
+            double b = beta[k0 + j];
+            T.unchecked(j, j) = b;
+            if(b == 0.0) {
+                continue;
+            }
+            for(size_t p{}; p < j; p++) {
+                double dot = 0.0;
+                for(size_t r{j}; r < m; r++) {
+                    dot += V.unchecked(r, p) * V.unchecked(r, j);
+                }
+                T.unchecked(p, j) = -b * dot;
+            }
+            for(size_t p{}; p < j; p++) {
+                double sum = 0.0;
+                for(size_t q{p}; q < j; q++) {
+                    sum += T.unchecked(p, q) * T.unchecked(q, j);
+                }
+                T.unchecked(p, j) = sum;
+            }
+        }
+
+        double* zs = z + base * n + base;
+        gemm(m, kb, m, 1.0, zs, n, 1, V.data.data(), kb, 1, 0.0, Y.data.data(), kb);
+        gemm(m, kb, kb, 1.0, Y.data.data(), kb, 1, T.data.data(), 1, kb, 0.0, YT.data.data(), kb);
+        gemm(m, m, kb, -1.0, YT.data.data(), kb, 1, V.data.data(), 1, kb, 1.0, zs, n);
+    }
+}
+
+void SymmetricEigen::decompose(Matrix& A, bool computeVectors) {
+    if(A.rows != A.columns) {
+        throw std::invalid_argument("You need a square matrix for an eigen decomposition");
+    }
+    double* a = A.data.data();
+    std::vector<double> d(n), e(n, 0.0), beta(n, 0.0);
+
+    // Mirror the lower triangle so the reduction can work on full rows
+    for(size_t i{}; i < n; i++) {
+        for(size_t j{i + 1}; j < n; j++) {
+            a[i * n + j] = a[j * n + i];
+        }
+    }
+    tridiagonalize(a, n, d, e, beta);
+
+    Matrix Z(computeVectors ? n : 0, computeVectors ? n : 0);
+    double* z = Z.data.data();
+    if(computeVectors) {
+        accumulate(a, n, beta, z);
+    }
+
+    // Implicit QL on (d, e): e[i] couples d[i] and d[i + 1]. The iteration never reads Z, so the
+    // rotations on its rows are queued and applied in batches one column tile at a time; a tile of
+    // all n rows stays in cache across many sweeps instead of streaming Z once per sweep.
+    std::vector<Rotation> queued;
+    Kernels kernels = selectKernels();
+    auto flush = [&]() {
+        parallelChunks(n, COLUMN_TILE, [&](size_t begin, size_t end) {
+            for(size_t j0{begin}; j0 < end; j0 += COLUMN_TILE) {
+                kernels.rotateColumns(queued.data(), queued.size(), z, n, j0, std::min(end, j0 + COLUMN_TILE));
+            }
+        });
+        queued.clear();
+    };
+    for(size_t l{}; l < n; l++) {
+        int sweeps = 0;
+        while(true) {
+            size_t m = l;
+            for(; m + 1 < n; m++) {
+                double dd = std::fabs(d[m]) + std::fabs(d[m + 1]);
+                if(std::fabs(e[m]) <= std::numeric_limits<double>::min() + std::numeric_limits<double>::epsilon() * dd) {
+                    break;
+                }
+            }
+            if(m == l) {
+                break;
+            }
+            if(++sweeps > MAX_SWEEPS) {
+                throw std::runtime_error("Eigenvalue iteration did not converge");
+            }
+            double g = (d[l + 1] - d[l]) / (2.0 * e[l]);
+            double r = std::hypot(g, 1.0);
+            g = d[m] - d[l] + e[l] / (g + std::copysign(r, g));
+            double s = 1.0, c = 1.0, shift = 0.0;
+            bool underflow = false;
+            for(size_t i{m}; i-- > l;) {
+                double f = s * e[i];
+                double bb = c * e[i];
+                r = std::hypot(f, g);
+                e[i + 1] = r;
+                if(r == 0.0) {
+                    d[i + 1] -= shift;
+                    e[m] = 0.0;
+                    underflow = true;
+                    break;
+                }
+                s = f / r;
+                c = g / r;
+                g = d[i + 1] - shift;
+                r = (d[i] - g) * s + 2.0 * c * bb;
+                shift = s * r;
+                d[i + 1] = g + shift;
+                g = c * r - bb;
+                if(computeVectors) {
+                    queued.push_back({i, c, s});
+                }
+            }
+            if(queued.size() >= ROTATION_BATCH) {
+                flush();
+            }
+            if(underflow) {
+                continue;
+            }
+            d[l] -= shift;
+            e[l] = g;
+            e[m] = 0.0;
+        }
+    }
+    if(!queued.empty()) {
+        flush();
+    }
+
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::sort(order.begin(), order.end(), [&](size_t i, size_t j) { return d[i] < d[j]; });
+    values.resize(n);
+    for(size_t i{}; i < n; i++) {
+        values[i] = d[order[i]];
+    }
+    if(computeVectors) {
+        vectors = Matrix(n, n, MatrixInit::Uninitialized);
+        for(size_t col{}; col < n; col++) {
+            const double* source = z + order[col] * n;
+            for(size_t row{}; row < n; row++) {
+                vectors.unchecked(row, col) = source[row];
+            }
+        }
+    }
+}
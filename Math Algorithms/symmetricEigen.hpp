@@ -0,0 +1,47 @@
+#ifndef SYMMETRICEIGEN_HPP
+#define SYMMETRICEIGEN_HPP
+
+#include "matrix.hpp"
+#include <vector>
+
+/*
+A = V * diag(values) * V^T for symmetric A, e.g. a covariance matrix for PCA or shrinkage.
+Only the lower triangle of A is read.
+
+Blocked Householder reduction to tridiagonal form (panels of reflectors applied with GEMM),
+then implicit QL iterations with Wilkinson shifts on the tridiagonal matrix. The QL rotations
+are queued and applied to the rows of V^T in cache-sized column tiles across threads.
+The Matrix&& constructor reduces in A's storage instead of copying it.
+
+values are ascending; column i of vectors is the unit eigenvector for values[i].
+*/
+struct SymmetricEigen {
+public:
+    size_t n;
+    std::vector<double> values;
+    Matrix vectors;
+
+    explicit SymmetricEigen(const ConstMatrixView& A, bool computeVectors = true);
+    explicit SymmetricEigen(Matrix&& A, bool computeVectors = true);
+
+    // V * diag(f(values)) * V^T, e.g. clipping negative eigenvalues or shrinking a covariance spectrum
+    template<typename F>
+    Matrix reconstruct(F&& f) const;
+
+private:
+    void decompose(Matrix& A, bool computeVectors);
+};
+
+template<typename F>
+Matrix SymmetricEigen::reconstruct(F&& f) const {
+    Matrix scaled = vectors;
+    for(size_t i{}; i < n; i++) {
+        double* row = &scaled.unchecked(i, 0);
+        for(size_t j{}; j < n; j++) {
+            row[j] *= f(values[j]);
+        }
+    }
+    return scaled * vectors.view().T();
+}
+
+#endif
@@ -0,0 +1,46 @@
+// Givens rotation kernel for SymmetricEigen, included by symmetricEigen.cpp once per instruction
+// set with Pack bound to a simd:: register type.
+
+// Applies the queued rotations in order to columns [begin, end) of rows (row, row + 1) of Z
+void rotateColumns(const Rotation* rotations, size_t count, double* z, size_t n, size_t begin, size_t end) {
+    for(size_t r{}; r < count; r++) {
+        double* zi = z + rotations[r].row * n;
+        double* zi1 = zi + n;
+        double c = rotations[r].c, s = rotations[r].s;
+        typename Pack::Reg cr = Pack::set1(c), sr = Pack::set1(s);
+        size_t j = begin;
+        for(; j + Pack::width <= end; j += Pack::width) {
+            typename Pack::Reg lower = Pack::load(zi + j), upper = Pack::load(zi1 + j);
+            Pack::store(zi1 + j, Pack::fmadd(sr, lower, Pack::mul(cr, upper)));
+            Pack::store(zi + j, Pack::fnmadd(sr, upper, Pack::mul(cr, lower)));
+        }
+        for(; j < end; j++) {
+            double t = zi1[j];
+            zi1[j] = s * zi[j] + c * t;
+            zi[j] = c * zi[j] - s * t;
+        }
+    }
+}
+
+// y[i] = a[i * lda + 0 .. len) . x for i in [begin, end), the symmetric product in the reduction
+void multiplyRows(const double* a, size_t lda, size_t len, const double* x, double* y, size_t begin, size_t end) {
+    for(size_t i{begin}; i < end; i++) {
+        const double* row = a + i * lda;
+        typename Pack::Reg acc0 = Pack::set1(0.0), acc1 = Pack::set1(0.0);
+        size_t j = 0;
+        for(; j + 2 * Pack::width <= len; j += 2 * Pack::width) {
+            acc0 = Pack::fmadd(Pack::load(row + j), Pack::load(x + j), acc0);
+            acc1 = Pack::fmadd(Pack::load(row + j + Pack::width), Pack::load(x + j + Pack::width), acc1);
+        }
+        alignas(64) double lanes[Pack::width];
+        Pack::store(lanes, Pack::add(acc0, acc1));
+        double sum = 0.0;
+        for(size_t l{}; l < Pack::width; l++) {
+            sum += lanes[l];
+        }
+        for(; j < len; j++) {
+            sum += row[j] * x[j];
+        }
+        y[i] = sum;
+    }
+}
@@ -0,0 +1,170 @@
+#include "threadPool.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+static thread_local bool inRegion = false;
+
+namespace {
+struct RegionGuard {
+    bool previous;
+    RegionGuard() : previous(inRegion) { inRegion = true; }
+    ~RegionGuard() { inRegion = previous; }
+};
+}
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    size_t workerCount = threadCount > 1 ? threadCount - 1 : 0;
+    for(size_t i{}; i < workerCount; i++) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for(size_t i{}; i < workerCount; i++) {
+        workers[i]->thread = std::thread(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for(auto& worker : workers) {
+        worker->thread.join();
+    }
+}
+
+bool ThreadPool::insideParallelRegion() {
+    return inRegion;
+}
+
+size_t ThreadPool::defaultThreadCount() {
+    if(const char* env = std::getenv("QUANT_THREADS")) {
+        long requested = std::strtol(env, nullptr, 10);
+        if(requested > 0) {
+            return static_cast<size_t>(requested);
+        }
+    }
+    size_t hardware = std::thread::hardware_concurrency();
+    return hardware ? hardware : 1;
+}
+
+static std::unique_ptr<ThreadPool>& globalPool() {
+    static std::unique_ptr<ThreadPool> pool = std::make_unique<ThreadPool>(ThreadPool::defaultThreadCount());
+    return pool;
+}
+
+ThreadPool& ThreadPool::global() {
+    return *globalPool();
+}
+
+void ThreadPool::setGlobalThreadCount(size_t threadCount) {
+    if(threadCount == 0) {
+        threadCount = defaultThreadCount();
+    }
+    auto& pool = globalPool();
+    if(pool->threadCount() != threadCount) {
+        pool.reset();
+        pool = std::make_unique<ThreadPool>(threadCount);
+    }
+}
+
+void ThreadPool::execute(const Task& task) {
+    Job* job = task.job;
+    {
+        RegionGuard guard;
+        try {
+            job->fn(job->ctx, task.begin, task.end);
+        } catch(...) {
+            std::lock_guard<std::mutex> lock(job->errorMutex);
+            if(!job->error) {
+                job->error = std::current_exception();
+            }
+        }
+    }
+    job->pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+bool ThreadPool::popOwn(size_t index, Task& task) {
+    Worker& worker = *workers[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if(worker.tasks.empty()) {
+        return false;
+    }
+    task = worker.tasks.back();
+    worker.tasks.pop_back();
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+// Takes the oldest task from another deque. When only is set, only tasks of that job are taken,
+// which keeps a waiting caller from picking up unrelated work while its own buffers are live.
+bool ThreadPool::steal(size_t thief, Task& task, const Job* only) {
+    size_t count = workers.size();
+    for(size_t offset{1}; offset <= count; offset++) {
+        Worker& victim = *workers[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        for(auto it = victim.tasks.begin(); it != victim.tasks.end(); ++it) {
+            if(only && it->job != only) {
+                continue;
+            }
+            task = *it;
+            victim.tasks.erase(it);
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    for(;;) {
+        Task task;
+        if(popOwn(index, task) || steal(index, task, nullptr)) {
+            execute(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this] { return stopping || queued.load(std::memory_order_relaxed) > 0; });
+        if(stopping && queued.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::run(size_t begin, size_t end, size_t grain, RangeFn fn, void* ctx) {
+    size_t total = end - begin;
+    // A few chunks per thread so stealing can even out uneven chunks
+    size_t chunk = std::max(grain, (total + threadCount() * 4 - 1) / (threadCount() * 4));
+    size_t chunks = (total + chunk - 1) / chunk;
+
+    Job job;
+    job.fn = fn;
+    job.ctx = ctx;
+    job.pending.store(chunks, std::memory_order_relaxed);
+
+    // The first chunk stays with the caller, the rest are dealt round-robin across the workers
+    size_t start = nextQueue.fetch_add(1, std::memory_order_relaxed);
+    for(size_t c{1}; c < chunks; c++) {
+        Worker& worker = *workers[(start + c) % workers.size()];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back({&job, begin + c * chunk, std::min(end, begin + (c + 1) * chunk)});
+        queued.fetch_add(1, std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wake.notify_all();
+
+    execute({&job, begin, std::min(end, begin + chunk)});
+    while(job.pending.load(std::memory_order_acquire) != 0) {
+        Task task;
+        if(steal(start, task, &job)) {
+            execute(task);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    if(job.error) {
+        std::rethrow_exception(job.error);
+    }
+}
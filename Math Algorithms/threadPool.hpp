@@ -0,0 +1,110 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+Persistent work-stealing thread pool.
+Every worker owns a deque of range tasks; it pops from the back of its own deque
+and steals from the front of the others when it runs dry. The calling thread
+takes part in its own parallelFor instead of blocking.
+
+A parallelFor issued from inside a running task executes inline on that thread,
+so kernels can call each other freely without nested fan-out.
+*/
+struct ThreadPool {
+public:
+    // threadCount includes the calling thread, so ThreadPool(1) never starts a worker
+    explicit ThreadPool(size_t threadCount);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t threadCount() const { return workers.size() + 1; }
+
+    // Calls body(chunkBegin, chunkEnd) over [begin, end) in chunks of at least grain.
+    // Runs serially when the range fits in one grain, the pool has one thread, or we are
+    // already inside a parallel region. The first exception thrown by body is rethrown here.
+    template<typename Body>
+    void parallelFor(size_t begin, size_t end, size_t grain, Body&& body) {
+        if(end <= begin) {
+            return;
+        }
+        if(grain == 0) {
+            grain = 1;
+        }
+        if(workers.empty() || insideParallelRegion() || end - begin <= grain) {
+            body(begin, end);
+            return;
+        }
+        auto trampoline = [](void* ctx, size_t chunkBegin, size_t chunkEnd) {
+            (*static_cast<std::remove_reference_t<Body>*>(ctx))(chunkBegin, chunkEnd);
+        };
+        run(begin, end, grain, trampoline, static_cast<void*>(&body));
+    }
+
+    // Pool shared by the library kernels. Sized from QUANT_THREADS or the hardware.
+    static ThreadPool& global();
+    // Replaces the global pool. Must not be called while kernels are running on it.
+    static void setGlobalThreadCount(size_t threadCount);
+    static size_t defaultThreadCount();
+    static bool insideParallelRegion();
+
+private:
+    using RangeFn = void (*)(void*, size_t, size_t);
+
+    struct Job {
+        RangeFn fn;
+        void* ctx;
+        std::atomic<size_t> pending{0};
+        std::exception_ptr error;
+        std::mutex errorMutex;
+    };
+
+    struct Task {
+        Job* job;
+        size_t begin, end;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<size_t> queued{0};
+    std::atomic<size_t> nextQueue{0};
+    bool stopping = false;
+
+    void run(size_t begin, size_t end, size_t grain, RangeFn fn, void* ctx);
+    void workerLoop(size_t index);
+    bool popOwn(size_t index, Task& task);
+    bool steal(size_t thief, Task& task, const Job* only);
+    static void execute(const Task& task);
+};
+
+// Runs body over [0, count) on the global pool, or inline when there are fewer than two grains of work.
+// Small inputs never touch the pool, so they pay nothing for threading.
+template<typename Body>
+void parallelChunks(size_t count, size_t grain, Body&& body) {
+    if(count < 2 * grain) {
+        body(size_t{0}, count);
+        return;
+    }
+    ThreadPool::global().parallelFor(0, count, grain, body);
+}
+
+#endif
@@ -0,0 +1,270 @@
+#include "vec3DBatch.hpp"
+#include "simdPack.hpp"
+#include "threadPool.hpp"
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+struct ConstLanes {
+    const double* x;
+    const double* y;
+    const double* z;
+};
+
+struct Lanes {
+    double* x;
+    double* y;
+    double* z;
+};
+
+namespace scalarKernels {
+using Pack = simd::Scalar;
+#include "vec3DBatchKernels.inl"
+}
+
+#if QUANT_X86_DISPATCH
+QUANT_BEGIN_TARGET_AVX2
+namespace avx2Kernels {
+using Pack = simd::AVX2;
+#include "vec3DBatchKernels.inl"
+}
+QUANT_END_TARGET
+
+QUANT_BEGIN_TARGET_AVX512
+namespace avx512Kernels {
+using Pack = simd::AVX512;
+#include "vec3DBatchKernels.inl"
+}
+QUANT_END_TARGET
+
+#define DISPATCH(KERNEL, ...) \
+    (activeSimdLevel() == SimdLevel::AVX512 ? avx512Kernels::KERNEL(__VA_ARGS__) \
+     : activeSimdLevel() == SimdLevel::AVX2 ? avx2Kernels::KERNEL(__VA_ARGS__) \
+     : scalarKernels::KERNEL(__VA_ARGS__))
+#else
+#define DISPATCH(KERNEL, ...) scalarKernels::KERNEL(__VA_ARGS__)
+#endif
+
+// Per-chunk element count once a batch is worth splitting across threads
+constexpr size_t BATCH_GRAIN = 1 << 14;
+
+ConstLanes lanes(const Vec3DBatch& batch, size_t offset) {
+    return {batch.x.data() + offset, batch.y.data() + offset, batch.z.data() + offset};
+}
+
+Lanes lanes(Vec3DBatch& batch, size_t offset) {
+    return {batch.x.data() + offset, batch.y.data() + offset, batch.z.data() + offset};
+}
+
+void checkSize(const Vec3DBatch& a, const Vec3DBatch& b) {
+    if(a.size() != b.size()) {
+        throw std::invalid_argument("Vec3DBatch operands do not have the same size");
+    }
+}
+
+// Only resizes when out is not already the right size, so in-place calls never reallocate an input
+void prepare(Vec3DBatch& out, size_t count) {
+    if(out.size() != count) {
+        out.resize(count);
+    }
+}
+
+// Runs kernel(begin, count) over chunks; checked kernels report failure through the flag
+template<typename Kernel>
+bool forChunks(size_t count, Kernel&& kernel) {
+    std::atomic<bool> ok{true};
+    parallelChunks(count, BATCH_GRAIN, [&](size_t begin, size_t end) {
+        if(!kernel(begin, end - begin)) {
+            ok.store(false, std::memory_order_relaxed);
+        }
+    });
+    return ok.load();
+}
+
+} // namespace
+
+Vec3DBatch::Vec3DBatch(size_t count) : x(count), y(count), z(count) {}
+
+Vec3DBatch::Vec3DBatch(const std::vector<Vec3D>& vectors) {
+    gather(vectors);
+}
+
+void Vec3DBatch::resize(size_t count) {
+    x.resize(count);
+    y.resize(count);
+    z.resize(count);
+}
+
+void Vec3DBatch::reserve(size_t count) {
+    x.reserve(count);
+    y.reserve(count);
+    z.reserve(count);
+}
+
+void Vec3DBatch::push_back(const Vec3D& vector) {
+    x.push_back(vector.x());
+    y.push_back(vector.y());
+    z.push_back(vector.z());
+}
+
+Vec3D Vec3DBatch::get(size_t index) const {
+    if(index >= size()) {
+        throw std::out_of_range("Vec3DBatch index out of range");
+    }
+    return Vec3D(x[index], y[index], z[index]);
+}
+
+void Vec3DBatch::set(size_t index, const Vec3D& vector) {
+    if(index >= size()) {
+        throw std::out_of_range("Vec3DBatch index out of range");
+    }
+    x[index] = vector.x();
+    y[index] = vector.y();
+    z[index] = vector.z();
+}
+
+void Vec3DBatch::gather(const std::vector<Vec3D>& vectors) {
+    resize(vectors.size());
+    for(size_t i{}; i < vectors.size(); i++) {
+        x[i] = vectors[i].vec[0];
+        y[i] = vectors[i].vec[1];
+        z[i] = vectors[i].vec[2];
+    }
+}
+
+void Vec3DBatch::scatter(std::vector<Vec3D>& vectors) const {
+    vectors.resize(size());
+    for(size_t i{}; i < size(); i++) {
+        vectors[i].vec = {x[i], y[i], z[i]};
+    }
+}
+
+std::vector<Vec3D> Vec3DBatch::toVectors() const {
+    std::vector<Vec3D> vectors;
+    scatter(vectors);
+    return vectors;
+}
+
+void Vec3DBatch::add(const Vec3DBatch& a, const Vec3DBatch& b, Vec3DBatch& out) {
+    checkSize(a, b);
+    prepare(out, a.size());
+    forChunks(a.size(), [&](size_t begin, size_t count) {
+        DISPATCH(add, count, lanes(a, begin), lanes(b, begin), lanes(out, begin));
+        return true;
+    });
+}
+
+void Vec3DBatch::sub(const Vec3DBatch& a, const Vec3DBatch& b, Vec3DBatch& out) {
+    checkSize(a, b);
+    prepare(out, a.size());
+    forChunks(a.size(), [&](size_t begin, size_t count) {
+        DISPATCH(sub, count, lanes(a, begin), lanes(b, begin), lanes(out, begin));
+        return true;
+    });
+}
+
+void Vec3DBatch::scale(const Vec3DBatch& a, double factor, Vec3DBatch& out) {
+    prepare(out, a.size());
+    forChunks(a.size(), [&](size_t begin, size_t count) {
+        DISPATCH(scale, count, lanes(a, begin), factor, lanes(out, begin));
+        return true;
+    });
+}
+
+void Vec3DBatch::addScaled(const Vec3DBatch& a, const Vec3DBatch& b, double factor, Vec3DBatch& out) {
+    checkSize(a, b);
+    prepare(out, a.size());
+    forChunks(a.size(), [&](size_t begin, size_t count) {
+        DISPATCH(addScaled, count, lanes(a, begin), lanes(b, begin), factor, lanes(out, begin));
+        return true;
+    });
+}
+
+void Vec3DBatch::dot(const Vec3DBatch& a, const Vec3DBatch& b, std::vector<double>& out) {
+    checkSize(a, b);
+    out.resize(a.size());
+    forChunks(a.size(), [&](size_t begin, size_t count) {
+        DISPATCH(dot, count, lanes(a, begin), lanes(b, begin), out.data() + begin);
+        return true;
+    });
+}
+
+void Vec3DBatch::magnitude(const Vec3DBatch& a, std::vector<double>& out) {
+    out.resize(a.size());
+    forChunks(a.size(), [&](size_t begin, size_t count) {
+        DISPATCH(magnitude, count, lanes(a, begin), out.data() + begin);
+        return true;
+    });
+}
+
+void Vec3DBatch::normal(const Vec3DBatch& a, Vec3DBatch& out) {
+    prepare(out, a.size());
+    bool ok = forChunks(a.size(), [&](size_t begin, size_t count) {
+        return DISPATCH(normal, count, lanes(a, begin), lanes(out, begin));
+    });
+    if(!ok) {
+        throw std::runtime_error("Cannot normalize zero vector (Division by 0)");
+    }
+}
+
+void Vec3DBatch::cross(const Vec3DBatch& a, const Vec3DBatch& b, Vec3DBatch& out) {
+    checkSize(a, b);
+    prepare(out, a.size());
+    forChunks(a.size(), [&](size_t begin, size_t count) {
+        DISPATCH(cross, count, lanes(a, begin), lanes(b, begin), lanes(out, begin));
+        return true;
+    });
+}
+
+void Vec3DBatch::proj(const Vec3DBatch& a, const Vec3DBatch& b, Vec3DBatch& out) {
+    checkSize(a, b);
+    prepare(out, a.size());
+    bool ok = forChunks(a.size(), [&](size_t begin, size_t count) {
+        return DISPATCH(project, count, lanes(a, begin), lanes(b, begin), 0.0, 1.0, lanes(out, begin));
+    });
+    if(!ok) {
+        throw std::runtime_error("Cannot proj onto zero vector (Division by 0)");
+    }
+}
+
+void Vec3DBatch::reflect(const Vec3DBatch& a, const Vec3DBatch& normals, Vec3DBatch& out) {
+    checkSize(a, normals);
+    prepare(out, a.size());
+    bool ok = forChunks(a.size(), [&](size_t begin, size_t count) {
+        return DISPATCH(project, count, lanes(a, begin), lanes(normals, begin), 1.0, -2.0, lanes(out, begin));
+    });
+    if(!ok) {
+        throw std::runtime_error("Cannot proj onto zero vector (Division by 0)");
+    }
+}
+
+void Vec3DBatch::reflect(const Vec3DBatch& a, const Vec3D& normal, Vec3DBatch& out) {
+    double nSquared = normal * normal;
+    if(nSquared < 1e-10) {
+        throw std::runtime_error("Cannot proj onto zero vector (Division by 0)");
+    }
+    prepare(out, a.size());
+    forChunks(a.size(), [&](size_t begin, size_t count) {
+        DISPATCH(reflectUniform, count, lanes(a, begin), normal.x(), normal.y(), normal.z(), 2.0 / nSquared, lanes(out, begin));
+        return true;
+    });
+}
+
+void Vec3DBatch::angleBetween(const Vec3DBatch& a, const Vec3DBatch& b, std::vector<double>& out) {
+    checkSize(a, b);
+    out.resize(a.size());
+    bool ok = forChunks(a.size(), [&](size_t begin, size_t count) {
+        if(!DISPATCH(cosAngle, count, lanes(a, begin), lanes(b, begin), out.data() + begin)) {
+            return false;
+        }
+        for(size_t i{begin}; i < begin + count; i++) {
+            out[i] = std::acos(out[i]);
+        }
+        return true;
+    });
+    if(!ok) {
+        throw std::runtime_error("Cannot compute angle with zero vector");
+    }
+}
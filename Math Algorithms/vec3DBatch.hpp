@@ -0,0 +1,53 @@
+#ifndef VEC3DBATCH_HPP
+#define VEC3DBATCH_HPP
+
+#include "3DVector.hpp"
+#include "alignedAllocator.hpp"
+#include <vector>
+
+/*
+Structure-of-arrays batch of Vec3D.
+x, y and z live in separate 64-byte aligned arrays, so bulk operations stream three
+contiguous lanes through AVX2/AVX-512 registers (picked at runtime) instead of
+shuffling {x, y, z} triples. Large batches are also split across the thread pool.
+
+Every Vec3D method has a bulk form that writes into a caller-owned output; the
+output may be one of the inputs, and all batch arguments must have the same size.
+*/
+struct Vec3DBatch {
+public:
+    using Lane = std::vector<double, AlignedAllocator<double>>;
+    Lane x, y, z;
+
+    Vec3DBatch() = default;
+    explicit Vec3DBatch(size_t count);
+    explicit Vec3DBatch(const std::vector<Vec3D>& vectors);
+
+    size_t size() const { return x.size(); }
+    void resize(size_t count);
+    void reserve(size_t count);
+    void push_back(const Vec3D& vector);
+    Vec3D get(size_t index) const;
+    void set(size_t index, const Vec3D& vector);
+
+    // AoS <-> SoA conversion
+    void gather(const std::vector<Vec3D>& vectors);
+    void scatter(std::vector<Vec3D>& vectors) const;
+    std::vector<Vec3D> toVectors() const;
+
+    static void add(const Vec3DBatch& a, const Vec3DBatch& b, Vec3DBatch& out);
+    static void sub(const Vec3DBatch& a, const Vec3DBatch& b, Vec3DBatch& out);
+    static void scale(const Vec3DBatch& a, double factor, Vec3DBatch& out);
+    // out = a + b * factor, the integrator update
+    static void addScaled(const Vec3DBatch& a, const Vec3DBatch& b, double factor, Vec3DBatch& out);
+    static void dot(const Vec3DBatch& a, const Vec3DBatch& b, std::vector<double>& out);
+    static void magnitude(const Vec3DBatch& a, std::vector<double>& out);
+    static void normal(const Vec3DBatch& a, Vec3DBatch& out);
+    static void cross(const Vec3DBatch& a, const Vec3DBatch& b, Vec3DBatch& out);
+    static void proj(const Vec3DBatch& a, const Vec3DBatch& b, Vec3DBatch& out);
+    static void reflect(const Vec3DBatch& a, const Vec3DBatch& normals, Vec3DBatch& out);
+    static void reflect(const Vec3DBatch& a, const Vec3D& normal, Vec3DBatch& out);
+    static void angleBetween(const Vec3DBatch& a, const Vec3DBatch& b, std::vector<double>& out);
+};
+
+#endif
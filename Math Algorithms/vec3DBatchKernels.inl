@@ -0,0 +1,132 @@
+// Bulk Vec3D kernels, included by vec3DBatch.cpp once per instruction set with Pack
+// bound to a simd:: register type. Each kernel runs its step over full registers and
+// finishes the tail with the scalar pack, so both paths share one body.
+// Kernels that can fail return false instead of throwing; the caller raises the error.
+
+template<typename P>
+static QUANT_ALWAYS_INLINE void addStep(size_t i, ConstLanes a, ConstLanes b, Lanes out) {
+    P::store(out.x + i, P::add(P::load(a.x + i), P::load(b.x + i)));
+    P::store(out.y + i, P::add(P::load(a.y + i), P::load(b.y + i)));
+    P::store(out.z + i, P::add(P::load(a.z + i), P::load(b.z + i)));
+}
+
+template<typename P>
+static QUANT_ALWAYS_INLINE void subStep(size_t i, ConstLanes a, ConstLanes b, Lanes out) {
+    P::store(out.x + i, P::sub(P::load(a.x + i), P::load(b.x + i)));
+    P::store(out.y + i, P::sub(P::load(a.y + i), P::load(b.y + i)));
+    P::store(out.z + i, P::sub(P::load(a.z + i), P::load(b.z + i)));
+}
+
+// out = a + b * factor
+template<typename P>
+static QUANT_ALWAYS_INLINE void addScaledStep(size_t i, ConstLanes a, ConstLanes b, double factor, Lanes out) {
+    typename P::Reg f = P::set1(factor);
+    P::store(out.x + i, P::fmadd(P::load(b.x + i), f, P::load(a.x + i)));
+    P::store(out.y + i, P::fmadd(P::load(b.y + i), f, P::load(a.y + i)));
+    P::store(out.z + i, P::fmadd(P::load(b.z + i), f, P::load(a.z + i)));
+}
+
+template<typename P>
+static QUANT_ALWAYS_INLINE void scaleStep(size_t i, ConstLanes a, double factor, Lanes out) {
+    typename P::Reg f = P::set1(factor);
+    P::store(out.x + i, P::mul(P::load(a.x + i), f));
+    P::store(out.y + i, P::mul(P::load(a.y + i), f));
+    P::store(out.z + i, P::mul(P::load(a.z + i), f));
+}
+
+template<typename P>
+static QUANT_ALWAYS_INLINE typename P::Reg dotAt(size_t i, ConstLanes a, ConstLanes b) {
+    typename P::Reg sum = P::mul(P::load(a.x + i), P::load(b.x + i));
+    sum = P::fmadd(P::load(a.y + i), P::load(b.y + i), sum);
+    return P::fmadd(P::load(a.z + i), P::load(b.z + i), sum);
+}
+
+template<typename P>
+static QUANT_ALWAYS_INLINE void dotStep(size_t i, ConstLanes a, ConstLanes b, double* out) {
+    P::store(out + i, dotAt<P>(i, a, b));
+}
+
+template<typename P>
+static QUANT_ALWAYS_INLINE void magnitudeStep(size_t i, ConstLanes a, double* out) {
+    P::store(out + i, P::sqrt(dotAt<P>(i, a, a)));
+}
+
+template<typename P>
+static QUANT_ALWAYS_INLINE bool normalStep(size_t i, ConstLanes a, Lanes out) {
+    typename P::Reg mag = P::sqrt(dotAt<P>(i, a, a));
+    bool ok = !P::anyLess(mag, P::set1(1e-10));
+    typename P::Reg inverse = P::div(P::set1(1.0), mag);
+    P::store(out.x + i, P::mul(P::load(a.x + i), inverse));
+    P::store(out.y + i, P::mul(P::load(a.y + i), inverse));
+    P::store(out.z + i, P::mul(P::load(a.z + i), inverse));
+    return ok;
+}
+
+template<typename P>
+static QUANT_ALWAYS_INLINE void crossStep(size_t i, ConstLanes a, ConstLanes b, Lanes out) {
+    typename P::Reg ax = P::load(a.x + i), ay = P::load(a.y + i), az = P::load(a.z + i);
+    typename P::Reg bx = P::load(b.x + i), by = P::load(b.y + i), bz = P::load(b.z + i);
+    P::store(out.x + i, P::fnmadd(az, by, P::mul(ay, bz)));
+    P::store(out.y + i, P::fnmadd(ax, bz, P::mul(az, bx)));
+    P::store(out.z + i, P::fnmadd(ay, bx, P::mul(ax, by)));
+}
+
+// out = keep * a + along * proj_b(a): keep 0, along 1 is proj and keep 1, along -2 is reflect
+template<typename P>
+static QUANT_ALWAYS_INLINE bool projectStep(size_t i, ConstLanes a, ConstLanes b, double keep, double along, Lanes out) {
+    typename P::Reg bSquared = dotAt<P>(i, b, b);
+    bool ok = !P::anyLess(bSquared, P::set1(1e-10));
+    typename P::Reg t = P::mul(P::div(dotAt<P>(i, a, b), bSquared), P::set1(along));
+    typename P::Reg k = P::set1(keep);
+    P::store(out.x + i, P::fmadd(t, P::load(b.x + i), P::mul(k, P::load(a.x + i))));
+    P::store(out.y + i, P::fmadd(t, P::load(b.y + i), P::mul(k, P::load(a.y + i))));
+    P::store(out.z + i, P::fmadd(t, P::load(b.z + i), P::mul(k, P::load(a.z + i))));
+    return ok;
+}
+
+// Reflection against one shared normal, the dot with the normal is a broadcast
+template<typename P>
+static QUANT_ALWAYS_INLINE void reflectUniformStep(size_t i, ConstLanes a, double nx, double ny, double nz, double twoOverNSquared, Lanes out) {
+    typename P::Reg x = P::load(a.x + i), y = P::load(a.y + i), z = P::load(a.z + i);
+    typename P::Reg Nx = P::set1(nx), Ny = P::set1(ny), Nz = P::set1(nz);
+    typename P::Reg t = P::mul(P::fmadd(z, Nz, P::fmadd(y, Ny, P::mul(x, Nx))), P::set1(twoOverNSquared));
+    P::store(out.x + i, P::fnmadd(t, Nx, x));
+    P::store(out.y + i, P::fnmadd(t, Ny, y));
+    P::store(out.z + i, P::fnmadd(t, Nz, z));
+}
+
+// Writes cos(angle); the caller finishes with acos
+template<typename P>
+static QUANT_ALWAYS_INLINE bool cosAngleStep(size_t i, ConstLanes a, ConstLanes b, double* out) {
+    typename P::Reg mags = P::sqrt(P::mul(dotAt<P>(i, a, a), dotAt<P>(i, b, b)));
+    bool ok = !P::anyLess(mags, P::set1(1e-20));
+    P::store(out + i, P::div(dotAt<P>(i, a, b), mags));
+    return ok;
+}
+
+#define QUANT_BATCH_LOOP(STEP, ...) \
+    size_t i{}; \
+    for(; i + Pack::width <= n; i += Pack::width) STEP<Pack>(i, __VA_ARGS__); \
+    for(; i < n; i++) STEP<simd::Scalar>(i, __VA_ARGS__);
+
+#define QUANT_BATCH_CHECKED_LOOP(STEP, ...) \
+    bool ok = true; \
+    size_t i{}; \
+    for(; i + Pack::width <= n; i += Pack::width) ok &= STEP<Pack>(i, __VA_ARGS__); \
+    for(; i < n; i++) ok &= STEP<simd::Scalar>(i, __VA_ARGS__); \
+    return ok;
+
+static void add(size_t n, ConstLanes a, ConstLanes b, Lanes out) { QUANT_BATCH_LOOP(addStep, a, b, out) }
+static void sub(size_t n, ConstLanes a, ConstLanes b, Lanes out) { QUANT_BATCH_LOOP(subStep, a, b, out) }
+static void addScaled(size_t n, ConstLanes a, ConstLanes b, double factor, Lanes out) { QUANT_BATCH_LOOP(addScaledStep, a, b, factor, out) }
+static void scale(size_t n, ConstLanes a, double factor, Lanes out) { QUANT_BATCH_LOOP(scaleStep, a, factor, out) }
+static void dot(size_t n, ConstLanes a, ConstLanes b, double* out) { QUANT_BATCH_LOOP(dotStep, a, b, out) }
+static void magnitude(size_t n, ConstLanes a, double* out) { QUANT_BATCH_LOOP(magnitudeStep, a, out) }
+static bool normal(size_t n, ConstLanes a, Lanes out) { QUANT_BATCH_CHECKED_LOOP(normalStep, a, out) }
+static void cross(size_t n, ConstLanes a, ConstLanes b, Lanes out) { QUANT_BATCH_LOOP(crossStep, a, b, out) }
+static bool project(size_t n, ConstLanes a, ConstLanes b, double keep, double along, Lanes out) { QUANT_BATCH_CHECKED_LOOP(projectStep, a, b, keep, along, out) }
+static void reflectUniform(size_t n, ConstLanes a, double nx, double ny, double nz, double twoOverNSquared, Lanes out) { QUANT_BATCH_LOOP(reflectUniformStep, a, nx, ny, nz, twoOverNSquared, out) }
+static bool cosAngle(size_t n, ConstLanes a, ConstLanes b, double* out) { QUANT_BATCH_CHECKED_LOOP(cosAngleStep, a, b, out) }
+
+#undef QUANT_BATCH_LOOP
+#undef QUANT_BATCH_CHECKED_LOOP
@@ -0,0 +1,93 @@
+#include "bodies.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+void ParticleSet::reserve(size_t count) {
+    position.reserve(count);
+    velocity.reserve(count);
+    acceleration.reserve(count);
+    force.reserve(count);
+    inverseMass.reserve(count);
+    radius.reserve(count);
+}
+
+size_t ParticleSet::add(const Vec3D& _position, const Vec3D& _velocity, double mass, double _radius) {
+    if(!(mass > 0) || !(_radius > 0)) {
+        throw std::invalid_argument("Body mass and radius must be positive");
+    }
+    position.push_back(_position);
+    velocity.push_back(_velocity);
+    acceleration.push_back(Vec3D());
+    force.push_back(Vec3D());
+    inverseMass.push_back(1.0 / mass);
+    radius.push_back(_radius);
+    return size() - 1;
+}
+
+void ParticleSet::applyForce(size_t index, const Vec3D& _force) {
+    force.x[index] += _force.x();
+    force.y[index] += _force.y();
+    force.z[index] += _force.z();
+    forcesApplied = true;
+}
+
+void ParticleSet::clearForces() {
+    if(forcesApplied) {
+        std::fill(force.x.begin(), force.x.end(), 0.0);
+        std::fill(force.y.begin(), force.y.end(), 0.0);
+        std::fill(force.z.begin(), force.z.end(), 0.0);
+        forcesApplied = false;
+    }
+}
+
+void RigidBodySet::reserve(size_t count) {
+    linear.reserve(count);
+    angularVelocity.reserve(count);
+    torque.reserve(count);
+    qw.reserve(count);
+    qx.reserve(count);
+    qy.reserve(count);
+    qz.reserve(count);
+    inverseInertia.reserve(count);
+}
+
+size_t RigidBodySet::add(const Vec3D& position, const Vec3D& velocity, double mass, double radius, const Vec3D& _angularVelocity) {
+    size_t index = linear.add(position, velocity, mass, radius);
+    angularVelocity.push_back(_angularVelocity);
+    torque.push_back(Vec3D());
+    qw.push_back(1.0);
+    qx.push_back(0.0);
+    qy.push_back(0.0);
+    qz.push_back(0.0);
+    // Solid sphere
+    inverseInertia.push_back(1.0 / (0.4 * mass * radius * radius));
+    return index;
+}
+
+void RigidBodySet::applyTorque(size_t index, const Vec3D& _torque) {
+    torque.x[index] += _torque.x();
+    torque.y[index] += _torque.y();
+    torque.z[index] += _torque.z();
+    torquesApplied = true;
+}
+
+void RigidBodySet::applyForceAt(size_t index, const Vec3D& force, const Vec3D& point) {
+    linear.applyForce(index, force);
+    applyTorque(index, (point - linear.position.get(index)).cross(force));
+}
+
+void RigidBodySet::clearTorques() {
+    if(torquesApplied) {
+        std::fill(torque.x.begin(), torque.x.end(), 0.0);
+        std::fill(torque.y.begin(), torque.y.end(), 0.0);
+        std::fill(torque.z.begin(), torque.z.end(), 0.0);
+        torquesApplied = false;
+    }
+}
+
+Vec3D RigidBodySet::toWorld(size_t index, const Vec3D& local) const {
+    // v' = v + 2w (u x v) + 2 u x (u x v) for q = (w, u)
+    Vec3D u(qx[index], qy[index], qz[index]);
+    Vec3D t = u.cross(local) * 2.0;
+    return local + t * qw[index] + u.cross(t);
+}
@@ -0,0 +1,64 @@
+#ifndef BODIES_HPP
+#define BODIES_HPP
+
+#include "vec3DBatch.hpp"
+#include <vector>
+
+/*
+Structure-of-arrays body storage for the physics engine.
+Every per-body quantity is its own contiguous lane, so the integrators stream through memory
+and vectorize instead of hopping between {position, velocity, ...} records.
+
+ParticleSet is the linear state every body has. Particles are spheres that move but never spin;
+RigidBodySet adds orientation and angular velocity for solid spheres, whose inertia is the same
+about every axis (2/5 m r^2), so there is no gyroscopic term to integrate.
+*/
+struct ParticleSet {
+public:
+    Vec3DBatch position, velocity;
+    // Acceleration from the world's field at the current positions; forces are kept apart
+    Vec3DBatch acceleration;
+    // Accumulated since the last step and cleared by it
+    Vec3DBatch force;
+    std::vector<double> inverseMass, radius;
+
+    size_t size() const { return position.size(); }
+    void reserve(size_t count);
+    // Returns the index of the new particle. Mass and radius must be positive.
+    size_t add(const Vec3D& position, const Vec3D& velocity, double mass, double radius);
+
+    void applyForce(size_t index, const Vec3D& force);
+    bool hasForces() const { return forcesApplied; }
+    void clearForces();
+
+private:
+    bool forcesApplied = false;
+};
+
+struct RigidBodySet {
+public:
+    ParticleSet linear;
+    Vec3DBatch angularVelocity;
+    Vec3DBatch torque;
+    // Unit quaternion w + xi + yj + zk per body
+    Vec3DBatch::Lane qw, qx, qy, qz;
+    std::vector<double> inverseInertia;
+
+    size_t size() const { return linear.size(); }
+    void reserve(size_t count);
+    size_t add(const Vec3D& position, const Vec3D& velocity, double mass, double radius, const Vec3D& angularVelocity = Vec3D());
+
+    void applyTorque(size_t index, const Vec3D& torque);
+    // A force applied at a world-space point off the centre also spins the body
+    void applyForceAt(size_t index, const Vec3D& force, const Vec3D& point);
+    bool hasTorques() const { return torquesApplied; }
+    void clearTorques();
+
+    // Rotates a body-space vector into world space
+    Vec3D toWorld(size_t index, const Vec3D& local) const;
+
+private:
+    bool torquesApplied = false;
+};
+
+#endif
@@ -0,0 +1,260 @@
+#include "broadphase.hpp"
+#include "threadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+// Spheres per pair batch. Fixed so the batches do not depend on the thread count.
+static constexpr size_t SLICE = 1 << 12;
+static constexpr size_t GRAIN = 1 << 14;
+// Cells per axis are capped so the packed key of three axes fits in 64 bits
+static constexpr double MAX_CELLS = double((1 << 21) - 8);
+static constexpr size_t DIGIT_BITS = 11;
+
+static void prepareBatches(PairBatches& batches, const Vec3DBatch& position, const std::vector<double>& radius) {
+    size_t n = position.size();
+    if(radius.size() != n) {
+        throw std::invalid_argument("Broadphase needs one radius per position");
+    }
+    if(n > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("Broadphase supports at most 2^32 - 1 spheres");
+    }
+    batches.resize((n + SLICE - 1) / SLICE);
+    for(auto& batch : batches) {
+        batch.clear();
+    }
+}
+
+static size_t countPairs(const PairBatches& batches) {
+    size_t count = 0;
+    for(const auto& batch : batches) {
+        count += batch.size();
+    }
+    return count;
+}
+
+// Copies the spheres into sorted order so the pair search reads them contiguously
+static void gatherSorted(const Vec3DBatch& position, const std::vector<double>& radius, const uint32_t* order,
+                         Vec3DBatch::Lane& x, Vec3DBatch::Lane& y, Vec3DBatch::Lane& z, Vec3DBatch::Lane& r) {
+    size_t n = position.size();
+    x.resize(n);
+    y.resize(n);
+    z.resize(n);
+    r.resize(n);
+    parallelChunks(n, GRAIN, [&](size_t begin, size_t end) {
+        for(size_t k{begin}; k < end; k++) {
+            uint32_t i = order[k];
+            x[k] = position.x[i];
+            y[k] = position.y[i];
+            z[k] = position.z[i];
+            r[k] = radius[i];
+        }
+    });
+}
+
+static bool boxesOverlap(const double* x, const double* y, const double* z, const double* r, size_t s, size_t t) {
+    double reach = r[s] + r[t];
+    return std::fabs(x[s] - x[t]) <= reach && std::fabs(y[s] - y[t]) <= reach && std::fabs(z[s] - z[t]) <= reach;
+}
+
+static CandidatePair orderedPair(uint32_t a, uint32_t b) {
+    return a < b ? CandidatePair{a, b} : CandidatePair{b, a};
+}
+
+void UniformGrid::update(const Vec3DBatch& position, const std::vector<double>& radius) {
+    prepareBatches(pairBatches, position, radius);
+    size_t n = position.size();
+    if(n < 2) {
+        return;
+    }
+    double cell = std::max(cellSize, 2.0 * *std::max_element(radius.begin(), radius.end()));
+    const Vec3DBatch::Lane* lanes[3] = {&position.x, &position.y, &position.z};
+    double lowest[3], extent[3];
+    for(size_t axis{}; axis < 3; axis++) {
+        auto [low, high] = std::minmax_element(lanes[axis]->begin(), lanes[axis]->end());
+        lowest[axis] = *low;
+        extent[axis] = *high - *low;
+        // A very spread out scene gets coarser cells rather than overflowing the key
+        cell = std::max(cell, extent[axis] / MAX_CELLS);
+    }
+    const double inverseCell = 1.0 / cell;
+    // Cells start at 1 and end one short of the row length, so the neighbours either side exist
+    uint64_t cells[3];
+    for(size_t axis{}; axis < 3; axis++) {
+        cells[axis] = uint64_t(extent[axis] * inverseCell) + 3;
+    }
+    const uint64_t rowY = cells[0], rowZ = cells[0] * cells[1];
+
+    keys.resize(n);
+    sortedIndex.resize(n);
+    parallelChunks(n, GRAIN, [&](size_t begin, size_t end) {
+        for(size_t i{begin}; i < end; i++) {
+            // Signed conversions vectorize; the offsets are never negative
+            uint64_t cx = uint64_t(int64_t((position.x[i] - lowest[0]) * inverseCell)) + 1;
+            uint64_t cy = uint64_t(int64_t((position.y[i] - lowest[1]) * inverseCell)) + 1;
+            uint64_t cz = uint64_t(int64_t((position.z[i] - lowest[2]) * inverseCell)) + 1;
+            keys[i] = cz * rowZ + cy * rowY + cx;
+            sortedIndex[i] = uint32_t(i);
+        }
+    });
+
+    // LSD radix sort, one stable counting sort per 11-bit digit of the largest key
+    const uint64_t largestKey = rowZ * cells[2];
+    scratchKeys.resize(n);
+    scratchIndex.resize(n);
+    for(size_t shift{}; shift < 64 && (largestKey >> shift) != 0; shift += DIGIT_BITS) {
+        const uint64_t digitMask = (uint64_t(1) << DIGIT_BITS) - 1;
+        digitCount.assign((size_t(1) << DIGIT_BITS) + 1, 0);
+        for(size_t k{}; k < n; k++) {
+            digitCount[((keys[k] >> shift) & digitMask) + 1]++;
+        }
+        std::partial_sum(digitCount.begin(), digitCount.end(), digitCount.begin());
+        for(size_t k{}; k < n; k++) {
+            uint32_t slot = digitCount[(keys[k] >> shift) & digitMask]++;
+            scratchKeys[slot] = keys[k];
+            scratchIndex[slot] = sortedIndex[k];
+        }
+        keys.swap(scratchKeys);
+        sortedIndex.swap(scratchIndex);
+    }
+    gatherSorted(position, radius, sortedIndex.data(), sortedX, sortedY, sortedZ, sortedRadius);
+
+    // Forward neighbour rows besides the sphere's own, as key offsets of their first cell (x - 1):
+    // (y + 1, z), then (y - 1, z + 1), (y, z + 1) and (y + 1, z + 1)
+    const uint64_t rowOffsets[4] = {rowY - 1, rowZ - rowY - 1, rowZ - 1, rowZ + rowY - 1};
+    parallelChunks(pairBatches.size(), 1, [&](size_t firstSlice, size_t lastSlice) {
+        // Raw pointers, so pushing a pair does not force the arrays to be reloaded
+        const uint64_t* sortedKeys = keys.data();
+        const uint32_t* index = sortedIndex.data();
+        const double *x = sortedX.data(), *y = sortedY.data(), *z = sortedZ.data(), *r = sortedRadius.data();
+        for(size_t slice{firstSlice}; slice < lastSlice; slice++) {
+            std::vector<CandidatePair>& out = pairBatches[slice];
+            const size_t begin = slice * SLICE, end = std::min(n, begin + SLICE);
+            // Row ranges only move forward as the sphere's key grows, so each cursor sweeps once
+            size_t lower[4], upper[4];
+            for(size_t row{}; row < 4; row++) {
+                lower[row] = size_t(std::lower_bound(sortedKeys + begin, sortedKeys + n, sortedKeys[begin] + rowOffsets[row]) - sortedKeys);
+                upper[row] = lower[row];
+            }
+            size_t own = begin;
+            auto test = [&](size_t s, size_t t) {
+                if(boxesOverlap(x, y, z, r, s, t)) {
+                    out.push_back(orderedPair(index[s], index[t]));
+                }
+            };
+            for(size_t s{begin}; s < end; s++) {
+                const uint64_t key = sortedKeys[s];
+                // Later spheres in the same cell and the next cell along x
+                own = std::max(own, s + 1);
+                while(own < n && sortedKeys[own] <= key + 1) {
+                    own++;
+                }
+                for(size_t t{s + 1}; t < own; t++) {
+                    test(s, t);
+                }
+                for(size_t row{}; row < 4; row++) {
+                    const uint64_t first = key + rowOffsets[row];
+                    while(lower[row] < n && sortedKeys[lower[row]] < first) {
+                        lower[row]++;
+                    }
+                    upper[row] = std::max(upper[row], lower[row]);
+                    while(upper[row] < n && sortedKeys[upper[row]] <= first + 2) {
+                        upper[row]++;
+                    }
+                    for(size_t t{lower[row]}; t < upper[row]; t++) {
+                        test(s, t);
+                    }
+                }
+            }
+        }
+    });
+}
+
+size_t UniformGrid::pairCount() const {
+    return countPairs(pairBatches);
+}
+
+void SweepAndPrune::update(const Vec3DBatch& position, const std::vector<double>& radius) {
+    prepareBatches(pairBatches, position, radius);
+    size_t n = position.size();
+    if(n < 2) {
+        order.clear();
+        return;
+    }
+
+    // Sweep along the axis where the spheres are most spread out
+    const Vec3DBatch::Lane* lanes[3] = {&position.x, &position.y, &position.z};
+    size_t best = 0;
+    double bestSpread = -1;
+    for(size_t a{}; a < 3; a++) {
+        double sum = 0, square = 0;
+        for(double c : *lanes[a]) {
+            sum += c;
+            square += c * c;
+        }
+        double spread = square - sum * sum / double(n);
+        if(spread > bestSpread) {
+            bestSpread = spread;
+            best = a;
+        }
+    }
+    bool resort = best != axis || order.size() != n;
+    axis = best;
+    if(resort) {
+        order.resize(n);
+        std::iota(order.begin(), order.end(), uint32_t(0));
+    }
+    const double* key = lanes[axis]->data();
+    keys.resize(n);
+    for(size_t k{}; k < n; k++) {
+        keys[k] = {key[order[k]] - radius[order[k]], order[k]};
+    }
+    if(resort) {
+        std::sort(keys.begin(), keys.end());
+    } else {
+        // Last step's order is nearly sorted; give up on insertion sort if it is not
+        size_t moves = 0;
+        const size_t budget = 8 * n;
+        for(size_t k{1}; k < n && moves <= budget; k++) {
+            auto current = keys[k];
+            size_t j = k;
+            for(; j > 0 && keys[j - 1].first > current.first; j--) {
+                keys[j] = keys[j - 1];
+            }
+            keys[j] = current;
+            moves += k - j;
+        }
+        if(moves > budget) {
+            std::sort(keys.begin(), keys.end());
+        }
+    }
+    for(size_t k{}; k < n; k++) {
+        order[k] = keys[k].second;
+    }
+    gatherSorted(position, radius, order.data(), sortedX, sortedY, sortedZ, sortedRadius);
+
+    const Vec3DBatch::Lane* sortedLanes[3] = {&sortedX, &sortedY, &sortedZ};
+    const double* centre = sortedLanes[axis]->data();
+    parallelChunks(pairBatches.size(), 1, [&](size_t firstSlice, size_t lastSlice) {
+        const double *x = sortedX.data(), *y = sortedY.data(), *z = sortedZ.data(), *r = sortedRadius.data();
+        const std::pair<double, uint32_t>* sortedKeys = keys.data();
+        for(size_t slice{firstSlice}; slice < lastSlice; slice++) {
+            std::vector<CandidatePair>& out = pairBatches[slice];
+            size_t end = std::min(n, (slice + 1) * SLICE);
+            for(size_t s{slice * SLICE}; s < end; s++) {
+                double upper = centre[s] + r[s];
+                for(size_t t{s + 1}; t < n && sortedKeys[t].first <= upper; t++) {
+                    if(boxesOverlap(x, y, z, r, s, t)) {
+                        out.push_back(orderedPair(sortedKeys[s].second, sortedKeys[t].second));
+                    }
+                }
+            }
+        }
+    });
+}
+
+size_t SweepAndPrune::pairCount() const {
+    return countPairs(pairBatches);
+}
@@ -0,0 +1,76 @@
+#ifndef BROADPHASE_HPP
+#define BROADPHASE_HPP
+
+#include "vec3DBatch.hpp"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/*
+Broadphase collision detection: finds the pairs of spheres whose bounding boxes overlap, so the
+narrowphase only tests those instead of all n(n-1)/2 pairs.
+
+UniformGrid bins every sphere into a cell at least one diameter wide and radix sorts the spheres
+by cell each step (counting sort passes over the packed z:y:x cell key), so the members of a cell
+sit next to each other in memory and a row of cells along x is one contiguous range. A sphere can
+only touch spheres in its own or the 26 surrounding cells; each pair is found once by searching the
+forward half of that neighbourhood, five rows, with cursors that only move forward as the sweep
+advances. Cost stays linear in the sphere count while sizes are similar; one huge sphere inflates
+every cell.
+
+SweepAndPrune sorts the spheres' extents along the axis with the most spread and sweeps each one
+against the spheres that start before it ends. The order is kept between steps and insertion
+sorted, which is close to linear when spheres move a little per step. It copes better with mixed
+sizes but slows down when many spheres overlap along the sweep axis.
+
+Both fill batches() with one vector of candidate pairs per fixed slice of spheres, so the pairs and
+their order are the same on any thread count. Indices refer to the arrays given to update(), with
+first < second.
+*/
+enum class BroadphaseKind {
+    None,
+    UniformGrid,
+    SweepAndPrune
+};
+
+struct CandidatePair {
+public:
+    uint32_t first, second;
+};
+
+using PairBatches = std::vector<std::vector<CandidatePair>>;
+
+struct UniformGrid {
+public:
+    // Cell edge; widened to the largest diameter when smaller (0 always uses the largest diameter)
+    double cellSize = 0;
+
+    void update(const Vec3DBatch& position, const std::vector<double>& radius);
+    const PairBatches& batches() const { return pairBatches; }
+    size_t pairCount() const;
+
+private:
+    PairBatches pairBatches;
+    // Cell keys and sphere indices in cell order, with the sort's scratch space
+    std::vector<uint64_t> keys, scratchKeys;
+    std::vector<uint32_t> sortedIndex, scratchIndex, digitCount;
+    Vec3DBatch::Lane sortedX, sortedY, sortedZ, sortedRadius;
+};
+
+struct SweepAndPrune {
+public:
+    void update(const Vec3DBatch& position, const std::vector<double>& radius);
+    const PairBatches& batches() const { return pairBatches; }
+    size_t pairCount() const;
+
+private:
+    PairBatches pairBatches;
+    // Sphere order along the sweep axis, kept from the previous step
+    std::vector<uint32_t> order;
+    size_t axis = 0;
+    // (lower extent along the axis, sphere) in sweep order
+    std::vector<std::pair<double, uint32_t>> keys;
+    Vec3DBatch::Lane sortedX, sortedY, sortedZ, sortedRadius;
+};
+
+#endif
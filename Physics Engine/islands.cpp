@@ -0,0 +1,83 @@
+#include "islands.hpp"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+static constexpr uint32_t NO_ISLAND = UINT32_MAX;
+// A body counted but not yet given its packed place
+static constexpr uint32_t UNPLACED = UINT32_MAX - 1;
+
+uint32_t ContactIslands::find(uint32_t body) {
+    while(parent[body] != body) {
+        parent[body] = parent[parent[body]];
+        body = parent[body];
+    }
+    return body;
+}
+
+void ContactIslands::build(size_t bodyCount, const std::vector<CandidatePair>& pairs) {
+    if(bodyCount >= UNPLACED || pairs.size() >= NO_ISLAND) {
+        throw std::length_error("Contact islands support at most 2^32 - 2 bodies and pairs");
+    }
+    parent.resize(bodyCount);
+    std::iota(parent.begin(), parent.end(), uint32_t{0});
+    for(const CandidatePair& pair : pairs) {
+        if(pair.first >= bodyCount || pair.second >= bodyCount) {
+            throw std::out_of_range("Contact pair refers to a missing body");
+        }
+        uint32_t a = find(pair.first), b = find(pair.second);
+        if(a < b) {
+            parent[b] = a;
+        } else if(b < a) {
+            parent[a] = b;
+        }
+    }
+
+    // Number the islands by their first pair, and count the pairs and bodies of each
+    label.assign(bodyCount, NO_ISLAND);
+    packed.assign(bodyCount, NO_ISLAND);
+    pairIsland.resize(pairs.size());
+    pairStart.assign(1, 0);
+    bodyOffset.assign(1, 0);
+    for(size_t k{}; k < pairs.size(); k++) {
+        uint32_t root = find(pairs[k].first);
+        if(label[root] == NO_ISLAND) {
+            label[root] = uint32_t(pairStart.size() - 1);
+            pairStart.push_back(0);
+            bodyOffset.push_back(0);
+        }
+        uint32_t island = label[root];
+        pairIsland[k] = island;
+        pairStart[island + 1]++;
+        for(uint32_t body : {pairs[k].first, pairs[k].second}) {
+            if(packed[body] == NO_ISLAND) {
+                packed[body] = UNPLACED;
+                bodyOffset[island + 1]++;
+            }
+        }
+    }
+    std::partial_sum(pairStart.begin(), pairStart.end(), pairStart.begin());
+    std::partial_sum(bodyOffset.begin(), bodyOffset.end(), bodyOffset.begin());
+
+    // Stable scatters, so each island lists its pairs in their original order and its bodies as they first appear
+    pairMembers.resize(pairs.size());
+    bodyMembers.resize(bodyOffset.back());
+    std::vector<uint32_t> pairCursor(pairStart.begin(), pairStart.end() - 1), bodyCursor(bodyOffset.begin(), bodyOffset.end() - 1);
+    for(size_t k{}; k < pairs.size(); k++) {
+        uint32_t island = pairIsland[k];
+        pairMembers[pairCursor[island]++] = uint32_t(k);
+        for(uint32_t body : {pairs[k].first, pairs[k].second}) {
+            if(packed[body] == UNPLACED) {
+                packed[body] = bodyCursor[island];
+                bodyMembers[bodyCursor[island]++] = body;
+            }
+        }
+    }
+
+    schedule.resize(size());
+    std::iota(schedule.begin(), schedule.end(), uint32_t{0});
+    std::sort(schedule.begin(), schedule.end(), [&](uint32_t a, uint32_t b) {
+        size_t sizeA = pairCount(a), sizeB = pairCount(b);
+        return sizeA != sizeB ? sizeA > sizeB : a < b;
+    });
+}
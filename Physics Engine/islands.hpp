@@ -0,0 +1,47 @@
+#ifndef ISLANDS_HPP
+#define ISLANDS_HPP
+
+#include "broadphase.hpp"
+#include <cstdint>
+#include <vector>
+
+/*
+Contact islands: the groups of bodies joined, directly or through each other, by touching pairs.
+A contact only moves its own two bodies, so islands share no bodies and can be solved at the same
+time on different threads without changing a single bit of the result.
+
+build() joins the two bodies of every pair with union-find (path halving, the smaller root always
+becoming the parent, so the roots do not depend on anything but the pairs). Islands are numbered in
+the order their first pair appears and keep their pairs in the order given. Their bodies are packed
+island after island in order of first appearance, so a solver can gather each island into a small
+contiguous block; packedIndex() maps a body to its place there. order() lists the islands largest
+first, ties by number: handing out the big ones early keeps a thread from starting a long island
+last, and the order is the same on every run. Bodies without contacts belong to no island.
+*/
+struct ContactIslands {
+public:
+    // Pairs refer to bodies [0, bodyCount)
+    void build(size_t bodyCount, const std::vector<CandidatePair>& pairs);
+
+    size_t size() const { return pairStart.empty() ? 0 : pairStart.size() - 1; }
+    // Indices into the pairs given to build() for island k, from pairsBegin(k) up to pairsEnd(k)
+    const uint32_t* pairsBegin(size_t island) const { return pairMembers.data() + pairStart[island]; }
+    const uint32_t* pairsEnd(size_t island) const { return pairMembers.data() + pairStart[island + 1]; }
+    size_t pairCount(size_t island) const { return pairStart[island + 1] - pairStart[island]; }
+    // Bodies of every island, packed; island k holds bodies [bodyStart(k), bodyStart(k + 1))
+    const std::vector<uint32_t>& packedBodies() const { return bodyMembers; }
+    size_t bodyStart(size_t island) const { return bodyOffset[island]; }
+    // Place of a body in packedBodies(); only meaningful for bodies with contacts
+    uint32_t packedIndex(uint32_t body) const { return packed[body]; }
+    const std::vector<uint32_t>& order() const { return schedule; }
+
+private:
+    std::vector<uint32_t> parent;
+    // Island of each root body, and of each pair
+    std::vector<uint32_t> label, pairIsland;
+    std::vector<uint32_t> pairStart, pairMembers, bodyOffset, bodyMembers, packed, schedule;
+
+    uint32_t find(uint32_t body);
+};
+
+#endif
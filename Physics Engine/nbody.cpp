@@ -0,0 +1,518 @@
+#include "nbody.hpp"
+#include "simdPack.hpp"
+#include "threadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+// Octree levels below the root; Morton keys hold 21 bits per axis
+constexpr size_t LEVELS = 21;
+constexpr size_t DIGIT_BITS = 11;
+// Bodies per radix sort slice, fixed so the sort does not depend on the thread count
+constexpr size_t SORT_SLICE = 1 << 16;
+constexpr size_t BODY_GRAIN = 1 << 14;
+// Ranges this small are built as independent subtrees
+constexpr size_t SUBTREE = 1 << 13;
+constexpr size_t GROUP_GRAIN = 16;
+// Interaction lists are padded to a multiple of the widest pack
+constexpr size_t LIST_PADDING = 8;
+// Cubed, still finite times any sensible strength
+constexpr double MAX_INVERSE_DISTANCE = 1e90;
+// Targets per call of the direct kernel
+constexpr size_t TARGET_BLOCK = 64;
+
+struct SourceLanes {
+    const double *x, *y, *z, *s;
+};
+
+struct WalkScene {
+    const NBodySolver::Octet* octets;
+    const double *x, *y, *z, *s;
+};
+
+// Sources acting on one group, grown as needed and reused from group to group
+struct InteractionList {
+    Vec3DBatch::Lane x, y, z, s;
+    size_t used = 0;
+
+    void reserve(size_t count) {
+        if(count > s.size()) {
+            for(Vec3DBatch::Lane* lane : {&x, &y, &z, &s}) {
+                lane->resize(2 * count);
+            }
+        }
+    }
+
+    void appendBodies(const WalkScene& scene, size_t begin, size_t count) {
+        std::copy_n(scene.x + begin, count, x.data() + used);
+        std::copy_n(scene.y + begin, count, y.data() + used);
+        std::copy_n(scene.z + begin, count, z.data() + used);
+        std::copy_n(scene.s + begin, count, s.data() + used);
+        used += count;
+    }
+
+    // Zero-strength entries up to a multiple of the widest pack
+    void pad() {
+        reserve(used + LIST_PADDING);
+        for(; used % LIST_PADDING != 0; used++) {
+            x[used] = y[used] = z[used] = s[used] = 0;
+        }
+    }
+};
+
+// Spreads the low 21 bits of v so there are two zero bits between each
+uint64_t spreadBits(uint64_t v) {
+    v &= 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffff;
+    v = (v | v << 16) & 0x1f0000ff0000ff;
+    v = (v | v << 8) & 0x100f00f00f00f00f;
+    v = (v | v << 4) & 0x10c30c30c30c30c3;
+    v = (v | v << 2) & 0x1249249249249249;
+    return v;
+}
+
+namespace scalarKernels {
+using Pack = simd::Scalar;
+#include "nbodyKernels.inl"
+}
+
+#if QUANT_X86_DISPATCH
+QUANT_BEGIN_TARGET_AVX2
+namespace avx2Kernels {
+using Pack = simd::AVX2;
+#include "nbodyKernels.inl"
+}
+QUANT_END_TARGET
+
+QUANT_BEGIN_TARGET_AVX512
+namespace avx512Kernels {
+using Pack = simd::AVX512;
+#include "nbodyKernels.inl"
+}
+QUANT_END_TARGET
+
+#define DISPATCH(KERNEL, ...) \
+    (activeSimdLevel() == SimdLevel::AVX512 ? avx512Kernels::KERNEL(__VA_ARGS__) \
+     : activeSimdLevel() == SimdLevel::AVX2 ? avx2Kernels::KERNEL(__VA_ARGS__) \
+     : scalarKernels::KERNEL(__VA_ARGS__))
+#else
+#define DISPATCH(KERNEL, ...) scalarKernels::KERNEL(__VA_ARGS__)
+#endif
+
+// A cube of the octree: the bodies [begin, end) whose keys share the cube's prefix
+struct Range {
+    uint32_t begin, end;
+    size_t level;
+    double corner[3];
+    double width;
+};
+
+struct TreeBuilder {
+    const uint64_t* keys;
+    const double *x, *y, *z, *strength;
+    size_t leafSize;
+    double theta;
+
+    bool isLeaf(const Range& range) const {
+        return range.end - range.begin <= leafSize || range.level == LEVELS;
+    }
+
+    // Splits a range into its non-empty octants, in key order
+    size_t children(const Range& range, Range* out) const {
+        const size_t shift = 3 * (LEVELS - 1 - range.level);
+        const double half = 0.5 * range.width;
+        size_t count = 0;
+        uint32_t first = range.begin;
+        for(uint64_t octant{}; octant < 8; octant++) {
+            uint32_t last = uint32_t(std::partition_point(keys + first, keys + range.end,
+                                                          [&](uint64_t key) { return ((key >> shift) & 7) <= octant; }) -
+                                     keys);
+            if(last > first) {
+                Range& child = out[count++];
+                child.begin = first;
+                child.end = last;
+                child.level = range.level + 1;
+                child.width = half;
+                for(size_t axis{}; axis < 3; axis++) {
+                    child.corner[axis] = range.corner[axis] + ((octant >> axis) & 1 ? half : 0.0);
+                }
+            }
+            first = last;
+        }
+        return count;
+    }
+
+    // Fills in the cell at index once its subtree, if any, follows it in out
+    void finish(const Range& range, std::vector<NBodySolver::Cell>& out, size_t index) const {
+        NBodySolver::Cell& cell = out[index];
+        cell.begin = range.begin;
+        cell.count = range.end - range.begin;
+        cell.next = uint32_t(out.size());
+        cell.leaf = index + 1 == out.size();
+        double weight = 0, total = 0, sum[3] = {};
+        if(cell.leaf) {
+            for(size_t k{range.begin}; k < range.end; k++) {
+                double w = std::fabs(strength[k]);
+                weight += w;
+                total += strength[k];
+                sum[0] += w * x[k];
+                sum[1] += w * y[k];
+                sum[2] += w * z[k];
+            }
+        } else {
+            for(size_t child{index + 1}; child < out.size(); child = out[child].next) {
+                const NBodySolver::Cell& c = out[child];
+                weight += c.weight;
+                total += c.strength;
+                for(size_t axis{}; axis < 3; axis++) {
+                    sum[axis] += c.weight * c.centre[axis];
+                }
+            }
+        }
+        double offset = 0;
+        for(size_t axis{}; axis < 3; axis++) {
+            double middle = range.corner[axis] + 0.5 * range.width;
+            cell.centre[axis] = weight > 0 ? sum[axis] / weight : middle;
+            offset += (cell.centre[axis] - middle) * (cell.centre[axis] - middle);
+        }
+        cell.strength = total;
+        cell.weight = weight;
+        cell.openRadius = theta > 0 ? range.width / theta + std::sqrt(offset) : INFINITY;
+    }
+
+    void build(const Range& range, std::vector<NBodySolver::Cell>& out) const {
+        const size_t index = out.size();
+        out.emplace_back();
+        if(!isLeaf(range)) {
+            Range child[8];
+            size_t count = children(range, child);
+            for(size_t c{}; c < count; c++) {
+                build(child[c], out);
+            }
+        }
+        finish(range, out, index);
+    }
+
+    bool isSubtree(const Range& range) const {
+        return range.end - range.begin <= SUBTREE || isLeaf(range);
+    }
+
+    // Ranges handed to the parallel subtree builds, in depth-first order
+    void collect(const Range& range, std::vector<Range>& subtrees) const {
+        if(isSubtree(range)) {
+            subtrees.push_back(range);
+            return;
+        }
+        Range child[8];
+        size_t count = children(range, child);
+        for(size_t c{}; c < count; c++) {
+            collect(child[c], subtrees);
+        }
+    }
+
+    // Builds the cells above the subtrees and splices the subtrees in, in the same order as collect
+    void assemble(const Range& range, std::vector<NBodySolver::Cell>& out, std::vector<std::vector<NBodySolver::Cell>>& built,
+                  size_t& next) const {
+        if(isSubtree(range)) {
+            const uint32_t base = uint32_t(out.size());
+            for(NBodySolver::Cell cell : built[next]) {
+                cell.next += base;
+                out.push_back(cell);
+            }
+            std::vector<NBodySolver::Cell>().swap(built[next++]);
+            return;
+        }
+        const size_t index = out.size();
+        out.emplace_back();
+        Range child[8];
+        size_t count = children(range, child);
+        for(size_t c{}; c < count; c++) {
+            assemble(child[c], out, built, next);
+        }
+        finish(range, out, index);
+    }
+};
+
+// Direct sums for the given targets, scaled into out[k] for targets[k]
+void directSums(const Vec3DBatch& position, const std::vector<double>& strength, const std::vector<double>& response,
+                const std::vector<size_t>& targets, double coupling, double softening2, Vec3DBatch& out) {
+    InteractionList all;
+    all.reserve(position.size());
+    all.appendBodies(WalkScene{nullptr, position.x.data(), position.y.data(), position.z.data(), strength.data()}, 0, position.size());
+    all.pad();
+    SourceLanes sources{all.x.data(), all.y.data(), all.z.data(), all.s.data()};
+    out.resize(targets.size());
+    const size_t blocks = (targets.size() + TARGET_BLOCK - 1) / TARGET_BLOCK;
+    parallelChunks(blocks, 1, [&](size_t firstBlock, size_t lastBlock) {
+        double tx[TARGET_BLOCK], ty[TARGET_BLOCK], tz[TARGET_BLOCK], ax[TARGET_BLOCK], ay[TARGET_BLOCK], az[TARGET_BLOCK];
+        for(size_t block{firstBlock}; block < lastBlock; block++) {
+            const size_t begin = block * TARGET_BLOCK, count = std::min(TARGET_BLOCK, targets.size() - begin);
+            for(size_t k{}; k < count; k++) {
+                size_t i = targets[begin + k];
+                tx[k] = position.x[i];
+                ty[k] = position.y[i];
+                tz[k] = position.z[i];
+            }
+            DISPATCH(sumSources, sources, all.used, tx, ty, tz, count, softening2, ax, ay, az);
+            for(size_t k{}; k < count; k++) {
+                size_t i = targets[begin + k];
+                double factor = coupling * (response.empty() ? 1.0 : response[i]);
+                out.x[begin + k] = factor * ax[k];
+                out.y[begin + k] = factor * ay[k];
+                out.z[begin + k] = factor * az[k];
+            }
+        }
+    });
+}
+
+} // namespace
+
+void NBodySolver::checkInputs(size_t count) const {
+    if(strength.size() != count) {
+        throw std::invalid_argument("N-body solver needs one strength per body");
+    }
+    if(!response.empty() && response.size() != count) {
+        throw std::invalid_argument("N-body response must be empty or have one entry per body");
+    }
+    if(!(settings.theta >= 0) || !(settings.softening >= 0)) {
+        throw std::invalid_argument("N-body theta and softening must not be negative");
+    }
+    if(settings.leafSize == 0) {
+        throw std::invalid_argument("N-body leaf size must be positive");
+    }
+    if(count >= std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("N-body solver supports at most 2^32 - 2 bodies");
+    }
+}
+
+void NBodySolver::operator()(const Vec3DBatch& position, Vec3DBatch& acceleration) {
+    const size_t n = position.size();
+    checkInputs(n);
+    acceleration.resize(n);
+    if(n == 0) {
+        return;
+    }
+    if(settings.method == NBodyMethod::Direct) {
+        std::vector<size_t> targets(n);
+        for(size_t i{}; i < n; i++) {
+            targets[i] = i;
+        }
+        directSums(position, strength, response, targets, settings.coupling, settings.softening * settings.softening, acceleration);
+        return;
+    }
+    sortBodies(position);
+    buildTree();
+    walkTree(acceleration);
+}
+
+void NBodySolver::direct(const Vec3DBatch& position, const std::vector<size_t>& targets, Vec3DBatch& acceleration) const {
+    checkInputs(position.size());
+    for(size_t i : targets) {
+        if(i >= position.size()) {
+            throw std::out_of_range("N-body target is not a body");
+        }
+    }
+    directSums(position, strength, response, targets, settings.coupling, settings.softening * settings.softening, acceleration);
+}
+
+void NBodySolver::sortBodies(const Vec3DBatch& position) {
+    const size_t n = position.size();
+    const Vec3DBatch::Lane* lanes[3] = {&position.x, &position.y, &position.z};
+    double extent = 0;
+    for(size_t axis{}; axis < 3; axis++) {
+        auto [low, high] = std::minmax_element(lanes[axis]->begin(), lanes[axis]->end());
+        rootCorner[axis] = *low;
+        extent = std::max(extent, *high - *low);
+    }
+    if(!std::isfinite(extent)) {
+        throw std::invalid_argument("N-body positions must be finite");
+    }
+    rootWidth = extent > 0 ? extent : 1.0;
+    const double scale = double(uint64_t(1) << LEVELS) / rootWidth;
+    const uint64_t top = (uint64_t(1) << LEVELS) - 1;
+
+    keys.resize(n);
+    order.resize(n);
+    parallelChunks(n, BODY_GRAIN, [&](size_t begin, size_t end) {
+        for(size_t i{begin}; i < end; i++) {
+            uint64_t qx = std::min(top, uint64_t(int64_t((position.x[i] - rootCorner[0]) * scale)));
+            uint64_t qy = std::min(top, uint64_t(int64_t((position.y[i] - rootCorner[1]) * scale)));
+            uint64_t qz = std::min(top, uint64_t(int64_t((position.z[i] - rootCorner[2]) * scale)));
+            keys[i] = spreadBits(qx) | spreadBits(qy) << 1 | spreadBits(qz) << 2;
+            order[i] = uint32_t(i);
+        }
+    });
+
+    // LSD radix sort. Each slice counts its digits in parallel, then scatters from offsets laid
+    // out digit by digit and slice by slice, which keeps every pass stable.
+    const size_t slices = (n + SORT_SLICE - 1) / SORT_SLICE;
+    const size_t radix = size_t(1) << DIGIT_BITS;
+    const uint64_t digitMask = radix - 1;
+    scratchKeys.resize(n);
+    scratchOrder.resize(n);
+    for(size_t shift{}; shift < 3 * LEVELS; shift += DIGIT_BITS) {
+        digitCount.assign(slices * radix, 0);
+        parallelChunks(slices, 1, [&](size_t firstSlice, size_t lastSlice) {
+            for(size_t slice{firstSlice}; slice < lastSlice; slice++) {
+                uint32_t* count = &digitCount[slice * radix];
+                for(size_t k{slice * SORT_SLICE}; k < std::min(n, (slice + 1) * SORT_SLICE); k++) {
+                    count[(keys[k] >> shift) & digitMask]++;
+                }
+            }
+        });
+        uint32_t offset = 0;
+        bool sorted = false;
+        for(size_t digit{}; digit < radix; digit++) {
+            uint32_t total = 0;
+            for(size_t slice{}; slice < slices; slice++) {
+                uint32_t count = digitCount[slice * radix + digit];
+                digitCount[slice * radix + digit] = offset;
+                offset += count;
+                total += count;
+            }
+            // Every key has the same digit, so this pass would not move anything
+            sorted = sorted || total == n;
+        }
+        if(sorted) {
+            continue;
+        }
+        parallelChunks(slices, 1, [&](size_t firstSlice, size_t lastSlice) {
+            for(size_t slice{firstSlice}; slice < lastSlice; slice++) {
+                uint32_t* slot = &digitCount[slice * radix];
+                for(size_t k{slice * SORT_SLICE}; k < std::min(n, (slice + 1) * SORT_SLICE); k++) {
+                    uint32_t to = slot[(keys[k] >> shift) & digitMask]++;
+                    scratchKeys[to] = keys[k];
+                    scratchOrder[to] = order[k];
+                }
+            }
+        });
+        keys.swap(scratchKeys);
+        order.swap(scratchOrder);
+    }
+
+    sortedX.resize(n);
+    sortedY.resize(n);
+    sortedZ.resize(n);
+    sortedStrength.resize(n);
+    parallelChunks(n, BODY_GRAIN, [&](size_t begin, size_t end) {
+        for(size_t k{begin}; k < end; k++) {
+            uint32_t i = order[k];
+            sortedX[k] = position.x[i];
+            sortedY[k] = position.y[i];
+            sortedZ[k] = position.z[i];
+            sortedStrength[k] = strength[i];
+        }
+    });
+}
+
+void NBodySolver::buildTree() {
+    TreeBuilder builder{keys.data(), sortedX.data(), sortedY.data(), sortedZ.data(), sortedStrength.data(), settings.leafSize,
+                        settings.theta};
+    Range root{0, uint32_t(keys.size()), 0, {rootCorner[0], rootCorner[1], rootCorner[2]}, rootWidth};
+    std::vector<Range> subtrees;
+    builder.collect(root, subtrees);
+    std::vector<std::vector<Cell>> built(subtrees.size());
+    parallelChunks(subtrees.size(), 1, [&](size_t first, size_t last) {
+        for(size_t t{first}; t < last; t++) {
+            builder.build(subtrees[t], built[t]);
+        }
+    });
+    cells.clear();
+    size_t next = 0;
+    builder.assemble(root, cells, built, next);
+
+    // Octets in the depth-first order of their cells, so a walk moves forward through memory
+    octetOf.assign(cells.size(), 0);
+    uint32_t interior = 0;
+    for(size_t c{}; c < cells.size(); c++) {
+        octetOf[c] = interior;
+        interior += !cells[c].leaf;
+    }
+    octets.resize(interior);
+    parallelChunks(cells.size(), BODY_GRAIN, [&](size_t first, size_t last) {
+        for(size_t c{first}; c < last; c++) {
+            if(cells[c].leaf) {
+                continue;
+            }
+            Octet& octet = octets[octetOf[c]];
+            octet = Octet{};
+            uint32_t slot = 0;
+            for(size_t child{c + 1}; child < cells[c].next; child = cells[child].next, slot++) {
+                const Cell& cell = cells[child];
+                octet.x[slot] = cell.centre[0];
+                octet.y[slot] = cell.centre[1];
+                octet.z[slot] = cell.centre[2];
+                octet.openRadius2[slot] = cell.openRadius * cell.openRadius;
+                octet.strength[slot] = cell.strength;
+                octet.index[slot] = cell.leaf ? cell.begin : octetOf[child];
+                octet.count[slot] = cell.count;
+                octet.occupied |= 1u << slot;
+                octet.leaves |= uint32_t(cell.leaf) << slot;
+            }
+        }
+    });
+
+    // Each group is the largest cell of at most groupSize bodies
+    groups.clear();
+    for(size_t c{}; c < cells.size();) {
+        if(cells[c].leaf || cells[c].count <= settings.groupSize) {
+            groups.push_back(uint32_t(c));
+            c = cells[c].next;
+        } else {
+            c++;
+        }
+    }
+}
+
+void NBodySolver::walkTree(Vec3DBatch& acceleration) {
+    const double softening2 = settings.softening * settings.softening;
+    std::vector<size_t> interactions(groups.size());
+    const WalkScene scene{octets.data(), sortedX.data(), sortedY.data(), sortedZ.data(), sortedStrength.data()};
+    parallelChunks(groups.size(), GROUP_GRAIN, [&](size_t firstGroup, size_t lastGroup) {
+        InteractionList list;
+        std::vector<double> ax, ay, az;
+        for(size_t g{firstGroup}; g < lastGroup; g++) {
+            const Cell& group = cells[groups[g]];
+            const size_t begin = group.begin, end = begin + group.count;
+            double lower[3] = {INFINITY, INFINITY, INFINITY}, upper[3] = {-INFINITY, -INFINITY, -INFINITY};
+            for(size_t k{begin}; k < end; k++) {
+                const double p[3] = {sortedX[k], sortedY[k], sortedZ[k]};
+                for(size_t axis{}; axis < 3; axis++) {
+                    lower[axis] = std::min(lower[axis], p[axis]);
+                    upper[axis] = std::max(upper[axis], p[axis]);
+                }
+            }
+            list.used = 0;
+            if(cells[0].leaf) {
+                list.reserve(cells[0].count);
+                list.appendBodies(scene, 0, cells[0].count);
+            } else {
+                DISPATCH(collect, scene, lower, upper, list);
+            }
+            interactions[g] = list.used * group.count;
+            list.pad();
+
+            ax.resize(group.count);
+            ay.resize(group.count);
+            az.resize(group.count);
+            SourceLanes sources{list.x.data(), list.y.data(), list.z.data(), list.s.data()};
+            DISPATCH(sumSources, sources, list.used, sortedX.data() + begin, sortedY.data() + begin, sortedZ.data() + begin,
+                     group.count, softening2, ax.data(), ay.data(), az.data());
+            for(size_t k{}; k < group.count; k++) {
+                uint32_t i = order[begin + k];
+                double factor = settings.coupling * (response.empty() ? 1.0 : response[i]);
+                acceleration.x[i] = factor * ax[k];
+                acceleration.y[i] = factor * ay[k];
+                acceleration.z[i] = factor * az[k];
+            }
+        }
+    });
+    size_t total = 0;
+    for(size_t count : interactions) {
+        total += count;
+    }
+    meanInteractions = double(total) / double(keys.size());
+}
@@ -0,0 +1,116 @@
+#ifndef NBODY_HPP
+#define NBODY_HPP
+
+#include "vec3DBatch.hpp"
+#include <cstdint>
+#include <vector>
+
+/*
+Inverse-square forces between every pair of bodies: gravity, or electrostatics with charges.
+
+Body i is accelerated by
+    a_i = coupling * response_i * sum over j != i of strength_j (x_j - x_i) / (|x_j - x_i|^2 + softening^2)^(3/2)
+With strength = mass and coupling = G this is gravity; with strength = charge, response = charge / mass
+and coupling = -k it is Coulomb's law, where like charges repel. Softening keeps close encounters finite.
+
+Direct sums every pair, O(n^2), and is the reference. BarnesHut sorts the bodies along a Morton
+(Z-order) curve, builds an octree over the sorted order and lets every cell that is far enough
+away act as a single body at its centre. A cell is far enough from a body when the distance to that
+centre exceeds width / theta plus the centre's offset from the middle of the cell, so theta trades
+accuracy for speed: 0.5 gives relative errors around 1e-3, and smaller values approach the direct sum.
+Centres are weighted by |strength|, so for charges of both signs that cancel within a cell the error
+grows and theta should be smaller.
+
+Leaves hold at most leafSize bodies. The bodies are walked in groups, each the largest cell of at
+most groupSize bodies: one walk per group collects the cells and bodies acting on all of it into an
+interaction list, and every body of the group then sums that list with SIMD, a pack of sources per
+register. The walk is vectorized too; the eight children of a cell are stored side by side and tested
+against the group's box together. The sort, the subtrees and the groups are spread over the thread
+pool, and the results do not depend on the thread count.
+
+The solver is an AccelerationField. Pass it with std::ref so the world uses this instance:
+    world.setAccelerationField(std::ref(solver));
+The world evaluates its particles and rigid bodies separately, so the strengths must match the set
+being evaluated and the two sets do not attract each other.
+*/
+enum class NBodyMethod {
+    Direct,
+    BarnesHut
+};
+
+struct NBodySettings {
+public:
+    NBodyMethod method = NBodyMethod::BarnesHut;
+    double coupling = 1.0;
+    double theta = 0.5;
+    double softening = 1e-3;
+    size_t leafSize = 8;
+    size_t groupSize = 64;
+};
+
+struct NBodySolver {
+public:
+    NBodySettings settings;
+    // Mass for gravity, charge for electrostatics, one per body
+    std::vector<double> strength;
+    // Factor on each body's acceleration, such as charge / mass; 1 for every body when empty
+    std::vector<double> response;
+
+    NBodySolver() = default;
+    explicit NBodySolver(const NBodySettings& _settings) : settings(_settings) {}
+
+    void operator()(const Vec3DBatch& position, Vec3DBatch& acceleration);
+    // Direct sums for the listed bodies only, acceleration[k] for body targets[k]; O(n) per target,
+    // for checking the tree against a sample of a large system
+    void direct(const Vec3DBatch& position, const std::vector<size_t>& targets, Vec3DBatch& acceleration) const;
+
+    // Size of the tree and the mean interaction list per body, from the last Barnes-Hut evaluation
+    size_t cellCount() const { return cells.size(); }
+    double interactionsPerBody() const { return meanInteractions; }
+
+    struct Cell {
+    public:
+        // Centre of |strength|
+        double centre[3];
+        double strength;
+        // Sum of |strength|, the weight behind the centre
+        double weight;
+        // Bodies closer to the centre than this see the cell's contents instead
+        double openRadius;
+        // Bodies in sorted order
+        uint32_t begin, count;
+        // First cell after this subtree; the first child, if any, directly follows
+        uint32_t next;
+        bool leaf;
+    };
+
+    // The children of one interior cell side by side, so the walk tests all eight with one pass of SIMD
+    struct Octet {
+    public:
+        double x[8], y[8], z[8], openRadius2[8], strength[8];
+        // Per child: its own octet when it has children, else its first body in sorted order
+        uint32_t index[8], count[8];
+        // A bit per slot that holds a child, and per child that is a leaf
+        uint32_t occupied, leaves;
+    };
+
+private:
+    std::vector<uint64_t> keys, scratchKeys;
+    std::vector<uint32_t> order, scratchOrder;
+    std::vector<uint32_t> digitCount;
+    Vec3DBatch::Lane sortedX, sortedY, sortedZ, sortedStrength;
+    std::vector<Cell> cells;
+    std::vector<Octet> octets;
+    std::vector<uint32_t> octetOf;
+    std::vector<uint32_t> groups;
+    // Cube the Morton keys quantize
+    double rootCorner[3] = {}, rootWidth = 1;
+    double meanInteractions = 0;
+
+    void checkInputs(size_t count) const;
+    void sortBodies(const Vec3DBatch& position);
+    void buildTree();
+    void walkTree(Vec3DBatch& acceleration);
+};
+
+#endif
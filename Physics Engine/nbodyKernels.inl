@@ -0,0 +1,116 @@
+// Tree walk and interaction list sums, included by nbody.cpp once per instruction set with Pack
+// bound to a simd:: register type.
+//
+// The walk opens one octet at a time and tests all eight children against the group's box in
+// 8 / Pack::width register passes. The sums broadcast targets into registers, two at a time so each
+// load of sources serves both, and sweep the sources a pack at a time; the source count is padded
+// to a multiple of every pack width with zero-strength entries.
+
+// Appends the cells and bodies acting on every body in the box from lower to upper
+static void collect(const WalkScene& scene, const double* lower, const double* upper, InteractionList& list) {
+    using P = Pack;
+    using Reg = typename P::Reg;
+    const Reg zero = P::set1(0.0);
+    const Reg low[3] = {P::set1(lower[0]), P::set1(lower[1]), P::set1(lower[2])};
+    const Reg high[3] = {P::set1(upper[0]), P::set1(upper[1]), P::set1(upper[2])};
+    // Every pop pushes at most eight, once per level
+    uint32_t stack[8 * (LEVELS + 1)];
+    size_t depth = 0;
+    stack[depth++] = 0;
+    while(depth > 0) {
+        const NBodySolver::Octet& octet = scene.octets[stack[--depth]];
+        const double* centre[3] = {octet.x, octet.y, octet.z};
+        unsigned far = 0;
+        for(size_t lane{}; lane < 8; lane += P::width) {
+            Reg distance = zero;
+            for(size_t axis{}; axis < 3; axis++) {
+                Reg c = P::load(centre[axis] + lane);
+                Reg gap = P::max(P::max(P::sub(low[axis], c), P::sub(c, high[axis])), zero);
+                distance = P::fmadd(gap, gap, distance);
+            }
+            far |= P::lessMask(P::load(octet.openRadius2 + lane), distance) << lane;
+        }
+        far &= octet.occupied;
+        const unsigned open = octet.occupied & ~far;
+
+        size_t bodies = 0;
+        for(unsigned bits = open & octet.leaves; bits != 0; bits &= bits - 1) {
+            bodies += octet.count[__builtin_ctz(bits)];
+        }
+        list.reserve(list.used + 8 + bodies);
+        for(unsigned bits = far; bits != 0; bits &= bits - 1) {
+            unsigned slot = unsigned(__builtin_ctz(bits));
+            list.x[list.used] = octet.x[slot];
+            list.y[list.used] = octet.y[slot];
+            list.z[list.used] = octet.z[slot];
+            list.s[list.used] = octet.strength[slot];
+            list.used++;
+        }
+        for(unsigned bits = open & octet.leaves; bits != 0; bits &= bits - 1) {
+            unsigned slot = unsigned(__builtin_ctz(bits));
+            list.appendBodies(scene, octet.index[slot], octet.count[slot]);
+        }
+        for(unsigned bits = open & ~octet.leaves; bits != 0; bits &= bits - 1) {
+            stack[depth++] = octet.index[__builtin_ctz(bits)];
+        }
+    }
+}
+
+template<typename P>
+static QUANT_ALWAYS_INLINE void accumulate(typename P::Reg dx, typename P::Reg dy, typename P::Reg dz, typename P::Reg s,
+                                           typename P::Reg epsilon, typename P::Reg cap, typename P::Reg* sum) {
+    using Reg = typename P::Reg;
+    Reg r2 = P::fmadd(dx, dx, P::fmadd(dy, dy, P::fmadd(dz, dz, epsilon)));
+    // A body meets itself at distance 0 when there is no softening; min returns the cap for an
+    // infinite or NaN inverse, and the zero offset then cancels it
+    Reg inverse = P::min(P::rsqrt(r2), cap);
+    Reg weight = P::mul(s, P::mul(inverse, P::mul(inverse, inverse)));
+    sum[0] = P::fmadd(dx, weight, sum[0]);
+    sum[1] = P::fmadd(dy, weight, sum[1]);
+    sum[2] = P::fmadd(dz, weight, sum[2]);
+}
+
+template<typename P>
+static QUANT_ALWAYS_INLINE void reduce(const typename P::Reg* sum, double* ax, double* ay, double* az) {
+    double lanes[3][P::width];
+    double total[3] = {};
+    for(size_t axis{}; axis < 3; axis++) {
+        P::store(lanes[axis], sum[axis]);
+        for(size_t lane{}; lane < P::width; lane++) {
+            total[axis] += lanes[axis][lane];
+        }
+    }
+    *ax = total[0];
+    *ay = total[1];
+    *az = total[2];
+}
+
+static void sumSources(const SourceLanes& sources, size_t count, const double* tx, const double* ty, const double* tz,
+                       size_t targets, double softening2, double* ax, double* ay, double* az) {
+    using P = Pack;
+    using Reg = typename P::Reg;
+    const Reg epsilon = P::set1(softening2), cap = P::set1(MAX_INVERSE_DISTANCE), zero = P::set1(0.0);
+    size_t t = 0;
+    for(; t + 2 <= targets; t += 2) {
+        const Reg px[2] = {P::set1(tx[t]), P::set1(tx[t + 1])};
+        const Reg py[2] = {P::set1(ty[t]), P::set1(ty[t + 1])};
+        const Reg pz[2] = {P::set1(tz[t]), P::set1(tz[t + 1])};
+        Reg first[3] = {zero, zero, zero}, second[3] = {zero, zero, zero};
+        for(size_t j{}; j < count; j += P::width) {
+            Reg x = P::load(sources.x + j), y = P::load(sources.y + j), z = P::load(sources.z + j), s = P::load(sources.s + j);
+            accumulate<P>(P::sub(x, px[0]), P::sub(y, py[0]), P::sub(z, pz[0]), s, epsilon, cap, first);
+            accumulate<P>(P::sub(x, px[1]), P::sub(y, py[1]), P::sub(z, pz[1]), s, epsilon, cap, second);
+        }
+        reduce<P>(first, ax + t, ay + t, az + t);
+        reduce<P>(second, ax + t + 1, ay + t + 1, az + t + 1);
+    }
+    for(; t < targets; t++) {
+        const Reg px = P::set1(tx[t]), py = P::set1(ty[t]), pz = P::set1(tz[t]);
+        Reg sum[3] = {zero, zero, zero};
+        for(size_t j{}; j < count; j += P::width) {
+            accumulate<P>(P::sub(P::load(sources.x + j), px), P::sub(P::load(sources.y + j), py), P::sub(P::load(sources.z + j), pz),
+                          P::load(sources.s + j), epsilon, cap, sum);
+        }
+        reduce<P>(sum, ax + t, ay + t, az + t);
+    }
+}
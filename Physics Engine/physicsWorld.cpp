@@ -0,0 +1,419 @@
+#include "physicsWorld.hpp"
+#include "threadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+// Bodies per chunk once a set is worth splitting across threads
+static constexpr size_t BODY_GRAIN = 1 << 14;
+// Squared distance, relative to touching, within which spheres are treated as in contact
+static constexpr double CONTACT_MARGIN = 1.0001;
+// Contacts per task when solving islands; a larger island is a task of its own
+static constexpr size_t CONTACT_SLICE = 1 << 10;
+
+PhysicsWorld::PhysicsWorld(const WorldSettings& _settings) : settings(_settings) {
+    if(!(settings.timeStep > 0)) {
+        throw std::invalid_argument("Time step must be positive");
+    }
+}
+
+void PhysicsWorld::setAccelerationField(AccelerationField _field) {
+    field = std::move(_field);
+    particlesEvaluated = 0;
+    bodiesEvaluated = 0;
+}
+
+void PhysicsWorld::evaluateField(ParticleSet& set) {
+    if(field) {
+        field(set.position, set.acceleration);
+        return;
+    }
+    std::fill(set.acceleration.x.begin(), set.acceleration.x.end(), settings.gravity.x());
+    std::fill(set.acceleration.y.begin(), set.acceleration.y.end(), settings.gravity.y());
+    std::fill(set.acceleration.z.begin(), set.acceleration.z.end(), settings.gravity.z());
+}
+
+// v += (a + f / m) * h over [begin, end)
+static void kick(ParticleSet& set, double h, size_t begin, size_t end) {
+    double* v[3] = {set.velocity.x.data(), set.velocity.y.data(), set.velocity.z.data()};
+    const double* a[3] = {set.acceleration.x.data(), set.acceleration.y.data(), set.acceleration.z.data()};
+    const double* f[3] = {set.force.x.data(), set.force.y.data(), set.force.z.data()};
+    const double* inverseMass = set.inverseMass.data();
+    for(size_t axis{}; axis < 3; axis++) {
+        double* vel = v[axis];
+        const double* acc = a[axis];
+        if(set.hasForces()) {
+            const double* frc = f[axis];
+            for(size_t i{begin}; i < end; i++) {
+                vel[i] += (acc[i] + frc[i] * inverseMass[i]) * h;
+            }
+        } else {
+            for(size_t i{begin}; i < end; i++) {
+                vel[i] += acc[i] * h;
+            }
+        }
+    }
+}
+
+// x += v * h over [begin, end)
+static void drift(ParticleSet& set, double h, size_t begin, size_t end) {
+    double* x[3] = {set.position.x.data(), set.position.y.data(), set.position.z.data()};
+    const double* v[3] = {set.velocity.x.data(), set.velocity.y.data(), set.velocity.z.data()};
+    for(size_t axis{}; axis < 3; axis++) {
+        double* pos = x[axis];
+        const double* vel = v[axis];
+        for(size_t i{begin}; i < end; i++) {
+            pos[i] += vel[i] * h;
+        }
+    }
+}
+
+void PhysicsWorld::integrate(ParticleSet& set, size_t& evaluated) {
+    size_t n = set.size();
+    if(n == 0) {
+        return;
+    }
+    const double dt = settings.timeStep;
+    // Uniform gravity never goes stale; a field does once the positions move
+    if(evaluated != n) {
+        evaluateField(set);
+    }
+    if(settings.integrator == Integrator::SemiImplicitEuler) {
+        parallelChunks(n, BODY_GRAIN, [&](size_t begin, size_t end) {
+            kick(set, dt, begin, end);
+            drift(set, dt, begin, end);
+        });
+        evaluated = field ? 0 : n;
+    } else {
+        parallelChunks(n, BODY_GRAIN, [&](size_t begin, size_t end) {
+            kick(set, 0.5 * dt, begin, end);
+            drift(set, dt, begin, end);
+        });
+    }
+}
+
+void PhysicsWorld::integrateRotation() {
+    size_t n = bodies.size();
+    const double dt = settings.timeStep;
+    const bool torques = bodies.hasTorques();
+    parallelChunks(n, BODY_GRAIN, [&](size_t begin, size_t end) {
+        double* wx = bodies.angularVelocity.x.data();
+        double* wy = bodies.angularVelocity.y.data();
+        double* wz = bodies.angularVelocity.z.data();
+        if(torques) {
+            for(size_t i{begin}; i < end; i++) {
+                double h = bodies.inverseInertia[i] * dt;
+                wx[i] += bodies.torque.x[i] * h;
+                wy[i] += bodies.torque.y[i] * h;
+                wz[i] += bodies.torque.z[i] * h;
+            }
+        }
+        double* qw = bodies.qw.data();
+        double* qx = bodies.qx.data();
+        double* qy = bodies.qy.data();
+        double* qz = bodies.qz.data();
+        const double h = 0.5 * dt;
+        for(size_t i{begin}; i < end; i++) {
+            // q += dt/2 * (0, w) * q
+            double w = qw[i], x = qx[i], y = qy[i], z = qz[i];
+            double nw = w - h * (wx[i] * x + wy[i] * y + wz[i] * z);
+            double nx = x + h * (wx[i] * w + wy[i] * z - wz[i] * y);
+            double ny = y + h * (wy[i] * w + wz[i] * x - wx[i] * z);
+            double nz = z + h * (wz[i] * w + wx[i] * y - wy[i] * x);
+            double inverse = 1.0 / std::sqrt(nw * nw + nx * nx + ny * ny + nz * nz);
+            qw[i] = nw * inverse;
+            qx[i] = nx * inverse;
+            qy[i] = ny * inverse;
+            qz[i] = nz * inverse;
+        }
+    });
+}
+
+// Set and index within it of a body in the shared contact index space
+static std::pair<ParticleSet*, size_t> locate(ParticleSet& particles, RigidBodySet& bodies, uint32_t index) {
+    return index < particles.size() ? std::make_pair(&particles, size_t(index)) : std::make_pair(&bodies.linear, index - particles.size());
+}
+
+void PhysicsWorld::solveIsland(size_t island) {
+    const std::vector<uint32_t>& packed = islands.packedBodies();
+    const size_t firstBody = islands.bodyStart(island), lastBody = islands.bodyStart(island + 1);
+    for(size_t p{firstBody}; p < lastBody; p++) {
+        auto [set, i] = locate(particles, bodies, packed[p]);
+        solverBodies[p] = SolverBody{set->position.get(i), set->velocity.get(i), set->inverseMass[i], set->radius[i]};
+    }
+
+    const uint32_t* first = islands.pairsBegin(island);
+    const uint32_t* last = islands.pairsEnd(island);
+    for(const uint32_t* k = first; k != last; k++) {
+        ContactState& state = contactStates[*k];
+        state.a = islands.packedIndex(contacts[*k].first);
+        state.b = islands.packedIndex(contacts[*k].second);
+        const SolverBody& a = solverBodies[state.a];
+        const SolverBody& b = solverBodies[state.b];
+        Vec3D offset = b.position - a.position;
+        double distance = offset.magnitude();
+        state.normal = distance > 0 ? offset * (1.0 / distance) : Vec3D(0, 1, 0);
+        state.normalMass = 1.0 / (a.inverseMass + b.inverseMass);
+        double approach = -((b.velocity - a.velocity) * state.normal);
+        double e = approach < settings.restingSpeed ? 0.0 : settings.restitution;
+        state.target = std::max(e * approach, 0.0);
+        state.impulse = 0;
+    }
+
+    // Sequential impulses: each contact corrects its own separation speed given the others so far
+    for(size_t pass{}; pass < settings.contactIterations; pass++) {
+        for(const uint32_t* k = first; k != last; k++) {
+            ContactState& state = contactStates[*k];
+            SolverBody& a = solverBodies[state.a];
+            SolverBody& b = solverBodies[state.b];
+            double separation = (b.velocity - a.velocity) * state.normal;
+            double total = std::max(state.impulse + state.normalMass * (state.target - separation), 0.0);
+            Vec3D impulse = state.normal * (total - state.impulse);
+            state.impulse = total;
+            a.velocity -= impulse * a.inverseMass;
+            b.velocity += impulse * b.inverseMass;
+        }
+    }
+
+    for(size_t pass{}; pass < settings.contactIterations; pass++) {
+        for(const uint32_t* k = first; k != last; k++) {
+            const ContactState& state = contactStates[*k];
+            SolverBody& a = solverBodies[state.a];
+            SolverBody& b = solverBodies[state.b];
+            Vec3D offset = b.position - a.position;
+            double distance = offset.magnitude();
+            double depth = a.radius + b.radius - distance;
+            if(depth <= 0) {
+                continue;
+            }
+            Vec3D normal = distance > 0 ? offset * (1.0 / distance) : state.normal;
+            double shareA = a.inverseMass / (a.inverseMass + b.inverseMass);
+            a.position -= normal * (depth * shareA);
+            b.position += normal * (depth * (1.0 - shareA));
+        }
+    }
+
+    for(size_t p{firstBody}; p < lastBody; p++) {
+        auto [set, i] = locate(particles, bodies, packed[p]);
+        set->position.set(i, solverBodies[p].position);
+        set->velocity.set(i, solverBodies[p].velocity);
+    }
+}
+
+void PhysicsWorld::collideBodies() {
+    candidatePairs = 0;
+    contacts.clear();
+    islands.build(0, contacts);
+    const size_t particleCount = particles.size();
+    if(settings.broadphase == BroadphaseKind::None || particleCount + bodies.size() < 2) {
+        return;
+    }
+    // Particles and rigid bodies share one index space, particles first
+    const Vec3DBatch* position = &particles.position;
+    const std::vector<double>* radius = &particles.radius;
+    if(particleCount == 0) {
+        position = &bodies.linear.position;
+        radius = &bodies.linear.radius;
+    } else if(bodies.size() > 0) {
+        const ParticleSet& rigid = bodies.linear;
+        contactPosition.resize(particleCount + rigid.size());
+        contactRadius.resize(particleCount + rigid.size());
+        std::copy(particles.position.x.begin(), particles.position.x.end(), contactPosition.x.begin());
+        std::copy(particles.position.y.begin(), particles.position.y.end(), contactPosition.y.begin());
+        std::copy(particles.position.z.begin(), particles.position.z.end(), contactPosition.z.begin());
+        std::copy(particles.radius.begin(), particles.radius.end(), contactRadius.begin());
+        std::copy(rigid.position.x.begin(), rigid.position.x.end(), contactPosition.x.begin() + particleCount);
+        std::copy(rigid.position.y.begin(), rigid.position.y.end(), contactPosition.y.begin() + particleCount);
+        std::copy(rigid.position.z.begin(), rigid.position.z.end(), contactPosition.z.begin() + particleCount);
+        std::copy(rigid.radius.begin(), rigid.radius.end(), contactRadius.begin() + particleCount);
+        position = &contactPosition;
+        radius = &contactRadius;
+    }
+    const PairBatches* batches;
+    if(settings.broadphase == BroadphaseKind::UniformGrid) {
+        grid.update(*position, *radius);
+        batches = &grid.batches();
+    } else {
+        sweep.update(*position, *radius);
+        batches = &sweep.batches();
+    }
+
+    for(const auto& batch : *batches) {
+        candidatePairs += batch.size();
+    }
+
+    // Narrowphase per batch, then the touching pairs in batch order
+    touching.resize(batches->size());
+    parallelChunks(batches->size(), 1, [&](size_t firstBatch, size_t lastBatch) {
+        for(size_t k{firstBatch}; k < lastBatch; k++) {
+            touching[k].clear();
+            for(const CandidatePair& pair : (*batches)[k]) {
+                Vec3D offset = position->get(pair.second) - position->get(pair.first);
+                double reach = (*radius)[pair.first] + (*radius)[pair.second];
+                if(offset * offset < reach * reach * CONTACT_MARGIN) {
+                    touching[k].push_back(pair);
+                }
+            }
+        }
+    });
+    contacts.clear();
+    for(const auto& batch : touching) {
+        contacts.insert(contacts.end(), batch.begin(), batch.end());
+    }
+    islands.build(position->size(), contacts);
+    contactStates.resize(contacts.size());
+    solverBodies.resize(islands.packedBodies().size());
+
+    // Runs of whole islands of about CONTACT_SLICE contacts; the order is largest first, so big
+    // islands come out alone and early
+    const std::vector<uint32_t>& order = islands.order();
+    islandSlices.assign(1, 0);
+    size_t sliceContacts = 0;
+    for(size_t k{}; k < order.size(); k++) {
+        sliceContacts += islands.pairCount(order[k]);
+        if(sliceContacts >= CONTACT_SLICE || k + 1 == order.size()) {
+            islandSlices.push_back(uint32_t(k + 1));
+            sliceContacts = 0;
+        }
+    }
+    parallelChunks(islandSlices.size() - 1, 1, [&](size_t firstSlice, size_t lastSlice) {
+        for(size_t slice{firstSlice}; slice < lastSlice; slice++) {
+            for(size_t k{islandSlices[slice]}; k < islandSlices[slice + 1]; k++) {
+                solveIsland(order[k]);
+            }
+        }
+    });
+}
+
+void PhysicsWorld::collideBounds(ParticleSet& set, RigidBodySet* rigid) {
+    const Vec3D lo = settings.boundsMin, hi = settings.boundsMax;
+    bool bounded = false;
+    for(size_t axis{}; axis < 3; axis++) {
+        bounded = bounded || std::isfinite(lo.vec[axis]) || std::isfinite(hi.vec[axis]);
+    }
+    if(!bounded) {
+        return;
+    }
+    parallelChunks(set.size(), BODY_GRAIN, [&](size_t begin, size_t end) {
+        const double* x = set.position.x.data();
+        const double* y = set.position.y.data();
+        const double* z = set.position.z.data();
+        for(size_t i{begin}; i < end; i++) {
+            double r = set.radius[i];
+            if(x[i] - r >= lo.x() && x[i] + r <= hi.x() && y[i] - r >= lo.y() && y[i] + r <= hi.y() &&
+               z[i] - r >= lo.z() && z[i] + r <= hi.z()) {
+                continue;
+            }
+            Vec3D p = set.position.get(i);
+            Vec3D v = set.velocity.get(i);
+            Vec3D w = rigid ? rigid->angularVelocity.get(i) : Vec3D();
+            for(size_t axis{}; axis < 3; axis++) {
+                for(double side : {-1.0, 1.0}) {
+                    double limit = side < 0 ? lo.vec[axis] + r : hi.vec[axis] - r;
+                    if(side < 0 ? p.vec[axis] >= limit : p.vec[axis] <= limit) {
+                        continue;
+                    }
+                    p.vec[axis] = limit;
+                    Vec3D normal;
+                    normal.vec[axis] = -side;
+                    double approach = -(v * normal);
+                    if(approach <= 0) {
+                        continue;
+                    }
+                    double e = approach < settings.restingSpeed ? 0.0 : settings.restitution;
+                    // Mirror the normal component, then keep the restitution fraction of it
+                    v = v.reflect(normal) * e + (v - v.proj(normal)) * (1.0 - e);
+                    if(!rigid) {
+                        continue;
+                    }
+                    // Coulomb friction at the contact point, capped by the normal impulse
+                    double inverseMass = set.inverseMass[i];
+                    double inverseInertia = rigid->inverseInertia[i];
+                    double normalImpulse = (1.0 + e) * approach / inverseMass;
+                    Vec3D arm = normal * -r;
+                    Vec3D contact = v + w.cross(arm);
+                    Vec3D slip = contact - contact.proj(normal);
+                    double speed = slip.magnitude();
+                    if(speed > 1e-12) {
+                        double impulse = std::min(speed / (inverseMass + r * r * inverseInertia), settings.friction * normalImpulse);
+                        Vec3D j = slip * (-impulse / speed);
+                        v += j * inverseMass;
+                        w += arm.cross(j) * inverseInertia;
+                    }
+                }
+            }
+            set.position.set(i, p);
+            set.velocity.set(i, v);
+            if(rigid) {
+                rigid->angularVelocity.set(i, w);
+            }
+        }
+    });
+}
+
+void PhysicsWorld::step() {
+    if(!field && settings.gravity != appliedGravity) {
+        appliedGravity = settings.gravity;
+        particlesEvaluated = 0;
+        bodiesEvaluated = 0;
+    }
+    integrate(particles, particlesEvaluated);
+    integrate(bodies.linear, bodiesEvaluated);
+    integrateRotation();
+    collideBodies();
+    collideBounds(particles, nullptr);
+    collideBounds(bodies.linear, &bodies);
+
+    if(settings.integrator == Integrator::VelocityVerlet) {
+        // Second half kick with the field at the new positions, which the next step reuses
+        const double h = 0.5 * settings.timeStep;
+        auto finish = [&](ParticleSet& set, size_t& evaluated) {
+            if(set.size() == 0) {
+                return;
+            }
+            if(field || evaluated != set.size()) {
+                evaluateField(set);
+            }
+            parallelChunks(set.size(), BODY_GRAIN, [&](size_t begin, size_t end) {
+                kick(set, h, begin, end);
+            });
+            evaluated = set.size();
+        };
+        finish(particles, particlesEvaluated);
+        finish(bodies.linear, bodiesEvaluated);
+    }
+
+    particles.clearForces();
+    bodies.linear.clearForces();
+    bodies.clearTorques();
+    steps++;
+}
+
+size_t PhysicsWorld::advance(double elapsed) {
+    accumulator += elapsed;
+    size_t taken = 0;
+    while(accumulator >= settings.timeStep && taken < settings.maxSubSteps) {
+        step();
+        accumulator -= settings.timeStep;
+        taken++;
+    }
+    if(accumulator >= settings.timeStep) {
+        accumulator = std::fmod(accumulator, settings.timeStep);
+    }
+    return taken;
+}
+
+double PhysicsWorld::kineticEnergy() const {
+    double energy = 0;
+    for(const ParticleSet* set : {&particles, &bodies.linear}) {
+        for(size_t i{}; i < set->size(); i++) {
+            energy += 0.5 * (set->velocity.get(i) * set->velocity.get(i)) / set->inverseMass[i];
+        }
+    }
+    for(size_t i{}; i < bodies.size(); i++) {
+        Vec3D w = bodies.angularVelocity.get(i);
+        energy += 0.5 * (w * w) / bodies.inverseInertia[i];
+    }
+    return energy;
+}
@@ -0,0 +1,142 @@
+#ifndef PHYSICSWORLD_HPP
+#define PHYSICSWORLD_HPP
+
+#include "bodies.hpp"
+#include "broadphase.hpp"
+#include "islands.hpp"
+#include <functional>
+#include <limits>
+
+/*
+Fixed-timestep simulation of particles and rigid spheres.
+
+step() always advances by settings.timeStep, so results do not depend on the frame rate;
+advance(elapsed) runs as many fixed steps as the elapsed wall time covers and keeps the
+remainder for the next call (interpolationAlpha() tells a renderer how far it is into the next step).
+
+Integrators:
+- SemiImplicitEuler: v += a dt, then x += v dt with the new v. First order, one field evaluation.
+- VelocityVerlet: half kick, drift, new field, half kick. Second order and symplectic, so energy
+  in conservative fields oscillates instead of drifting; exact for constant gravity.
+Rotation always uses semi-implicit Euler on the quaternion, renormalised every step.
+
+The acceleration field maps positions to accelerations (uniform gravity when none is set) and is
+evaluated for particles and rigid bodies separately; NBodySolver (nbody.hpp) is a field for
+mutual gravity or electrostatics. Forces and torques applied between steps are
+held constant over the next step and then cleared.
+
+Bodies collide with the axis-aligned world bounds: the normal velocity is flipped with
+Vec3D::reflect and scaled by the restitution, and contacts slower than restingSpeed are treated as
+inelastic so resting bodies settle instead of jittering. Rigid bodies also get Coulomb friction at
+the contact point, which is what turns sliding into rolling.
+
+Spheres collide with each other through the broadphase chosen in the settings. Candidate pairs
+that really touch become contacts, and the contacts are split into islands (islands.hpp) of bodies
+that touch each other. Each island is solved on its own by sequential impulses: contactIterations
+passes over its contacts, each applying the impulse along the normal that brings the approach
+speed to its target (the restitution fraction of the speed on arrival, 0 below restingSpeed),
+keeping the total impulse per contact pushing and never pulling. Momentum is conserved and there is
+no friction between bodies. The same number of passes then pushes overlapping pairs apart in
+proportion to their inverse masses.
+
+Islands share no bodies, so they are spread over the thread pool in slices of similar contact
+counts, largest first. Within an island the contacts are visited in the broadphase's batch order,
+so a step gives bit-identical results on any thread count.
+*/
+enum class Integrator {
+    SemiImplicitEuler,
+    VelocityVerlet
+};
+
+using AccelerationField = std::function<void(const Vec3DBatch& position, Vec3DBatch& acceleration)>;
+
+struct WorldSettings {
+public:
+    double timeStep = 1.0 / 120.0;
+    Integrator integrator = Integrator::SemiImplicitEuler;
+    Vec3D gravity = Vec3D(0, -9.81, 0);
+    // Unbounded unless set
+    Vec3D boundsMin = Vec3D(-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity());
+    Vec3D boundsMax = Vec3D(std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity());
+    double restitution = 0.5;
+    double friction = 0.4;
+    double restingSpeed = 0.2;
+    BroadphaseKind broadphase = BroadphaseKind::UniformGrid;
+    // Velocity and position passes over each island's contacts per step; more passes carry impulses
+    // further through stacks
+    size_t contactIterations = 4;
+    // advance() drops time beyond this many steps per call rather than falling further behind
+    size_t maxSubSteps = 8;
+};
+
+struct PhysicsWorld {
+public:
+    WorldSettings settings;
+    ParticleSet particles;
+    RigidBodySet bodies;
+
+    PhysicsWorld() = default;
+    explicit PhysicsWorld(const WorldSettings& _settings);
+
+    // Replaces uniform gravity
+    void setAccelerationField(AccelerationField field);
+
+    void step();
+    // Returns the number of steps taken
+    size_t advance(double elapsed);
+    double interpolationAlpha() const { return accumulator / settings.timeStep; }
+
+    size_t stepCount() const { return steps; }
+    double time() const { return double(steps) * settings.timeStep; }
+    double kineticEnergy() const;
+    // Broadphase candidates found in the last step
+    size_t candidatePairCount() const { return candidatePairs; }
+    // Touching pairs and the islands they formed in the last step
+    size_t contactCount() const { return contacts.size(); }
+    size_t islandCount() const { return islands.size(); }
+
+private:
+    AccelerationField field;
+    double accumulator = 0;
+    size_t steps = 0;
+    // Accelerations stored with the bodies match their positions; adding bodies invalidates them
+    size_t particlesEvaluated = 0;
+    size_t bodiesEvaluated = 0;
+    Vec3D appliedGravity;
+    UniformGrid grid;
+    SweepAndPrune sweep;
+    // Particles followed by rigid bodies, when there are both
+    Vec3DBatch contactPosition;
+    std::vector<double> contactRadius;
+    size_t candidatePairs = 0;
+    // Touching pairs, per broadphase batch and then in batch order, with their solver state
+    PairBatches touching;
+    std::vector<CandidatePair> contacts;
+    struct ContactState {
+    public:
+        // Places of the two bodies among the packed island bodies
+        uint32_t a, b;
+        Vec3D normal;
+        double normalMass, target, impulse;
+    };
+    std::vector<ContactState> contactStates;
+    // Copies of the island bodies, gathered island by island so each solve works on a compact block
+    struct SolverBody {
+    public:
+        Vec3D position, velocity;
+        double inverseMass, radius;
+    };
+    std::vector<SolverBody> solverBodies;
+    ContactIslands islands;
+    // Boundaries of the runs of islands, in islands.order(), handed to one task each
+    std::vector<uint32_t> islandSlices;
+
+    void evaluateField(ParticleSet& set);
+    void integrate(ParticleSet& set, size_t& evaluated);
+    void integrateRotation();
+    void collideBodies();
+    void solveIsland(size_t island);
+    void collideBounds(ParticleSet& set, RigidBodySet* rigid);
+};
+
+#endif
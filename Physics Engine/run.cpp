@@ -0,0 +1,171 @@
+#include "nbody.hpp"
+#include "physicsWorld.hpp"
+#include "threadPool.hpp"
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+/*
+Headless physics run: fills a box with particles and rigid spheres, steps it at the fixed
+timestep and reports throughput, without creating a window.
+
+    physicsRun --particles=1000000 --bodies=10000 --steps=200 --integrator=verlet --broadphase=sweep --threads=8
+
+With --nbody the particles attract each other instead of falling, summed by the Barnes-Hut tree
+or directly, and no rigid bodies are added. The run ends by timing one tree evaluation against the
+direct sum on a sample of particles and reporting the error:
+
+    physicsRun --nbody=tree --theta=0.5 --particles=1000000 --steps=10 --broadphase=none
+*/
+
+struct RunOptions {
+public:
+    size_t particles = 1000000;
+    size_t bodies = 10000;
+    size_t steps = 200;
+    size_t threads = 0;  // 0 keeps the thread pool default
+    Integrator integrator = Integrator::SemiImplicitEuler;
+    BroadphaseKind broadphase = BroadphaseKind::UniformGrid;
+    bool nbody = false;
+    NBodyMethod nbodyMethod = NBodyMethod::BarnesHut;
+    double theta = 0.5;
+
+    static RunOptions parse(int argc, char** argv) {
+        RunOptions options;
+        for(int i{1}; i < argc; i++) {
+            std::string arg = argv[i];
+            size_t equals = arg.find('=');
+            std::string key = arg.substr(0, equals);
+            std::string value = equals == std::string::npos ? "" : arg.substr(equals + 1);
+            if(key == "--particles") {
+                options.particles = std::stoul(value);
+            } else if(key == "--bodies") {
+                options.bodies = std::stoul(value);
+            } else if(key == "--steps") {
+                options.steps = std::stoul(value);
+            } else if(key == "--threads") {
+                options.threads = std::stoul(value);
+            } else if(key == "--integrator" && (value == "euler" || value == "verlet")) {
+                options.integrator = value == "euler" ? Integrator::SemiImplicitEuler : Integrator::VelocityVerlet;
+            } else if(key == "--broadphase" && (value == "grid" || value == "sweep" || value == "none")) {
+                options.broadphase = value == "grid" ? BroadphaseKind::UniformGrid
+                                     : value == "sweep" ? BroadphaseKind::SweepAndPrune
+                                                        : BroadphaseKind::None;
+            } else if(key == "--nbody" && (value == "tree" || value == "direct")) {
+                options.nbody = true;
+                options.nbodyMethod = value == "tree" ? NBodyMethod::BarnesHut : NBodyMethod::Direct;
+            } else if(key == "--theta") {
+                options.theta = std::stod(value);
+            } else {
+                throw std::invalid_argument("Unknown option " + arg + "\nOptions: --particles=N --bodies=N --steps=N "
+                                            "--integrator=euler|verlet --broadphase=grid|sweep|none --threads=N "
+                                            "--nbody=tree|direct --theta=X");
+            }
+        }
+        return options;
+    }
+};
+
+int main(int argc, char** argv) {
+    RunOptions options;
+    try {
+        options = RunOptions::parse(argc, argv);
+    } catch(const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+    if(options.threads > 0) {
+        ThreadPool::setGlobalThreadCount(options.threads);
+    }
+    if(options.nbody) {
+        options.bodies = 0;
+    }
+
+    // Box sized for roughly one body per unit cube
+    double half = 0.5 * std::cbrt(double(options.particles + options.bodies)) + 1.0;
+    WorldSettings settings;
+    settings.integrator = options.integrator;
+    settings.broadphase = options.broadphase;
+    settings.boundsMin = Vec3D(-half, -half, -half);
+    settings.boundsMax = Vec3D(half, half, half);
+    PhysicsWorld world(settings);
+
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<double> place(-half + 0.5, half - 0.5);
+    std::uniform_real_distribution<double> speed(-2.0, 2.0);
+    world.particles.reserve(options.particles);
+    for(size_t i{}; i < options.particles; i++) {
+        world.particles.add(Vec3D(place(rng), place(rng), place(rng)), Vec3D(speed(rng), speed(rng), speed(rng)), 1.0, 0.1);
+    }
+    world.bodies.reserve(options.bodies);
+    for(size_t i{}; i < options.bodies; i++) {
+        world.bodies.add(Vec3D(place(rng), place(rng), place(rng)), Vec3D(speed(rng), speed(rng), speed(rng)), 2.0, 0.25,
+                         Vec3D(speed(rng), speed(rng), speed(rng)));
+    }
+
+    // Unit masses, with G chosen so the cloud collapses over a few simulated seconds
+    NBodySolver solver;
+    if(options.nbody) {
+        solver.settings.method = options.nbodyMethod;
+        solver.settings.theta = options.theta;
+        solver.settings.softening = 0.1;
+        solver.settings.coupling = half * half * half / double(std::max<size_t>(options.particles, 1));
+        solver.strength.assign(options.particles, 1.0);
+        world.setAccelerationField(std::ref(solver));
+    }
+
+    double energyBefore = world.kineticEnergy();
+    auto start = std::chrono::steady_clock::now();
+    for(size_t s{}; s < options.steps; s++) {
+        world.step();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t total = options.particles + options.bodies;
+    std::cout << options.particles << " particles, " << options.bodies << " rigid bodies, "
+              << (options.integrator == Integrator::VelocityVerlet ? "velocity Verlet" : "semi-implicit Euler")
+              << ", " << (options.broadphase == BroadphaseKind::UniformGrid     ? "uniform grid"
+                          : options.broadphase == BroadphaseKind::SweepAndPrune ? "sweep and prune"
+                                                                                : "no body contacts")
+              << ", " << ThreadPool::global().threadCount() << " threads" << std::endl;
+    std::cout << options.steps << " steps in " << seconds << " s: " << double(options.steps) / seconds << " steps/s, "
+              << double(total) * double(options.steps) / seconds * 1e-6 << " M body-steps/s" << std::endl;
+    std::cout << "Kinetic energy " << energyBefore << " -> " << world.kineticEnergy() << " after "
+              << world.time() << " simulated seconds, " << world.candidatePairCount() << " candidate pairs, "
+              << world.contactCount() << " contacts in " << world.islandCount() << " islands in the last step" << std::endl;
+
+    if(options.nbody && options.particles > 0) {
+        std::vector<size_t> sample;
+        const size_t count = std::min<size_t>(256, options.particles);
+        for(size_t k{}; k < count; k++) {
+            sample.push_back(k * (options.particles / count));
+        }
+        Vec3DBatch acceleration, reference;
+        start = std::chrono::steady_clock::now();
+        solver(world.particles.position, acceleration);
+        double fieldSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        start = std::chrono::steady_clock::now();
+        solver.direct(world.particles.position, sample, reference);
+        double directSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() *
+                               double(options.particles) / double(count);
+        double error = 0, norm = 0;
+        for(size_t k{}; k < count; k++) {
+            Vec3D d = acceleration.get(sample[k]) - reference.get(k);
+            error += d * d;
+            norm += reference.get(k) * reference.get(k);
+        }
+        if(options.nbodyMethod == NBodyMethod::BarnesHut) {
+            std::cout << "Barnes-Hut, theta " << options.theta << ": " << fieldSeconds << " s per field evaluation, "
+                      << solver.interactionsPerBody() << " interactions per particle";
+        } else {
+            std::cout << "Direct sum: " << fieldSeconds << " s per field evaluation";
+        }
+        std::cout << "; direct sum about " << directSeconds << " s, relative error " << std::sqrt(error / norm) << " rms over "
+                  << count << " particles" << std::endl;
+    }
+    return 0;
+}
@@ -1,10 +1,17 @@
-#include "../Math Algorithms/3DVector.hpp"
-#include "../Math Algorithms/matrix.hpp"
-#include "../cameras/target.hpp"
+#include "3DVector.hpp"
+#include "fixedMatrix.hpp"
+#include "target.hpp"
 #define GLFW_INCLUDE_NONE
 #define GL_SILENCE_DEPRECATION
 #include <GLFW/glfw3.h>
+#ifdef __APPLE__
 #include <OpenGL/gl3.h>
+#else
+// Mesa and the vendor drivers export the 3.3 core entry points directly
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+#endif
 #include <cstdio>
 #include <stdexcept>
 #include <vector>
@@ -130,21 +137,21 @@ struct GridData {
     GLuint VAO, VBO;
     int vertexCount;
 };
-GridData createTrueGrid(double size = 10.0, int divisions = 10){
-    std::vector<double> vertices;
+GridData createTrueGrid(float size = 10.0f, int divisions = 10){
+    std::vector<float> vertices;
     //(x,y,z,r,g,b)
     //we need to draw the endpoints (a -> b)
     GridData grid;
-    double halfSize = (size / 2.0);
-    double step = size / (divisions * 2.0);  //-halfSize + step * x
+    float halfSize = (size / 2.0f);
+    float step = size / (divisions * 2.0f);  //-halfSize + step * x
     for(int x = 0; x <= (divisions * 2); x++){
         for(int y = 0; y <= (divisions * 2); y++){
             bool axis = (x == divisions && y == divisions);
-            double xcord = -halfSize + (step * x);
-            double ycord = -halfSize + (step * y);
-            double r = axis ? 1.0f : 0.15f;
-            double g = axis ? 1.0f : 0.15f;
-            double b = axis ? 1.0f : 0.15f;
+            float xcord = -halfSize + (step * x);
+            float ycord = -halfSize + (step * y);
+            float r = axis ? 1.0f : 0.15f;
+            float g = axis ? 1.0f : 0.15f;
+            float b = axis ? 1.0f : 0.15f;
             vertices.push_back(xcord); vertices.push_back(ycord); vertices.push_back(-halfSize);
             vertices.push_back(r); vertices.push_back(g); vertices.push_back(b);
             vertices.push_back(xcord); vertices.push_back(ycord); vertices.push_back(halfSize);
@@ -156,11 +163,11 @@ GridData createTrueGrid(double size = 10.0, int divisions = 10){
 
         for(int z = 0; z <= (divisions * 2); z++){
             bool axis = (x == divisions && z == divisions);
-            double xcord = -halfSize + (step * x);
-            double zcord = -halfSize + (step * z);
-            double r = axis ? 1.0f : 0.15f;
-            double g = axis ? 1.0f : 0.15f;
-            double b = axis ? 1.0f : 0.15f;
+            float xcord = -halfSize + (step * x);
+            float zcord = -halfSize + (step * z);
+            float r = axis ? 1.0f : 0.15f;
+            float g = axis ? 1.0f : 0.15f;
+            float b = axis ? 1.0f : 0.15f;
             vertices.push_back(xcord); vertices.push_back(-halfSize); vertices.push_back(zcord);
             vertices.push_back(r); vertices.push_back(g); vertices.push_back(b);
             vertices.push_back(xcord); vertices.push_back(halfSize); vertices.push_back(zcord);
@@ -173,11 +180,11 @@ GridData createTrueGrid(double size = 10.0, int divisions = 10){
 
         for(int z = 0; z <= (divisions * 2); z++){
             bool axis = (y == divisions && z == divisions);
-            double ycord = -halfSize + (step * y);
-            double zcord = -halfSize + (step * z);
-            double r = axis ? 1.0f : 0.15f;
-            double g = axis ? 1.0f : 0.15f;
-            double b = axis ? 1.0f : 0.15f;
+            float ycord = -halfSize + (step * y);
+            float zcord = -halfSize + (step * z);
+            float r = axis ? 1.0f : 0.15f;
+            float g = axis ? 1.0f : 0.15f;
+            float b = axis ? 1.0f : 0.15f;
             vertices.push_back(-halfSize); vertices.push_back(ycord); vertices.push_back(zcord);
             vertices.push_back(r); vertices.push_back(g); vertices.push_back(b);
             vertices.push_back(halfSize); vertices.push_back(ycord); vertices.push_back(zcord);
@@ -191,28 +198,28 @@ GridData createTrueGrid(double size = 10.0, int divisions = 10){
     glGenBuffers(1, &grid.VBO);
     glBindVertexArray(grid.VAO);
     glBindBuffer(GL_ARRAY_BUFFER, grid.VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(double), vertices.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_DOUBLE, GL_FALSE, 6 * sizeof(double), (void*)0);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_DOUBLE, GL_FALSE, 6 * sizeof(double), (void*)(3 * sizeof(double)));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
     glBindVertexArray(0);
     return grid;
 }
 
 /* Plan: Move along X axis create Z max lines. Then Move along y Axis create Z max lines.  */
-GridData createGrid(double size = 10.0, int divisions = 10) {
-    std::vector<double> vertices;
-    double step = size / (divisions * 2.0);
-    double halfSize = size / 2.0;
+GridData createGrid(float size = 10.0f, int divisions = 10) {
+    std::vector<float> vertices;
+    float step = size / (divisions * 2.0f);
+    float halfSize = size / 2.0f;
     for (int i = 0; i <= (divisions * 2); i++) {
         //go along the x and y axis creating vertical lines
-        double x = -halfSize + i * step;
-        double y = -halfSize + i * step;
+        float x = -halfSize + i * step;
+        float y = -halfSize + i * step;
 
-        double r = (i == divisions) ? 1.0f : 0.15f;
-        double g = (i == divisions) ? 1.0f : 0.15f;
-        double b = (i == divisions) ? 1.0f : 0.15f;
+        float r = (i == divisions) ? 1.0f : 0.15f;
+        float g = (i == divisions) ? 1.0f : 0.15f;
+        float b = (i == divisions) ? 1.0f : 0.15f;
 
         vertices.push_back(x); vertices.push_back(0.0f); vertices.push_back(-halfSize);
         vertices.push_back(r); vertices.push_back(g); vertices.push_back(b);
@@ -227,11 +234,11 @@ GridData createGrid(double size = 10.0, int divisions = 10) {
 
     for(int i = 0; i <=  (divisions * 2); i++){
         //go up and down z axis creating x and y straight lines on axis. so y axis gets y lines and x axis gets other one
-        double z = -halfSize + i * step;
+        float z = -halfSize + i * step;
 
-        double r = (i == divisions) ? 1.0f : 0.15f;
-        double g = (i == divisions) ? 1.0f : 0.15f;
-        double b = (i == divisions) ? 1.0f : 0.15f;
+        float r = (i == divisions) ? 1.0f : 0.15f;
+        float g = (i == divisions) ? 1.0f : 0.15f;
+        float b = (i == divisions) ? 1.0f : 0.15f;
 
         vertices.push_back(0.0f); vertices.push_back(-halfSize); vertices.push_back(z);
         vertices.push_back(r); vertices.push_back(g); vertices.push_back(b);
@@ -251,51 +258,27 @@ GridData createGrid(double size = 10.0, int divisions = 10) {
     glGenBuffers(1, &grid.VBO);
     glBindVertexArray(grid.VAO);
     glBindBuffer(GL_ARRAY_BUFFER, grid.VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(double), vertices.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_DOUBLE, GL_FALSE, 6 * sizeof(double), (void*)0);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_DOUBLE, GL_FALSE, 6 * sizeof(double), (void*)(3 * sizeof(double)));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
     glBindVertexArray(0);
     return grid;
 }
 
-Matrix createPerspectiveMatrix(double fov, double aspect, double near, double far) {
-    Matrix proj(4, 4);
-    double tanHalfFov = tan(fov / 2.0f);
-    proj.append(0, 0, 1.0f / (aspect * tanHalfFov));
-    proj.append(0, 1, 0.0f);
-    proj.append(0, 2, 0.0f);
-    proj.append(0, 3, 0.0f);
-    proj.append(1, 0, 0.0f);
-    proj.append(1, 1, 1.0f / tanHalfFov);
-    proj.append(1, 2, 0.0f);
-    proj.append(1, 3, 0.0f);
-    proj.append(2, 0, 0.0f);
-    proj.append(2, 1, 0.0f);
-    proj.append(2, 2, -(far + near) / (far - near));
-    proj.append(2, 3, -(2.0f * far * near) / (far - near));
-    proj.append(3, 0, 0.0f);
-    proj.append(3, 1, 0.0f);
-    proj.append(3, 2, -1.0f);
-    proj.append(3, 3, 0.0f);
-    return proj;
+Mat4f createPerspectiveMatrix(float fov, float aspect, float near, float far) {
+    return Mat4f::perspective(fov, aspect, near, far);
 }
 
-void setMatrixUniform(GLuint program, const char* name, const Matrix& mat) {
+//Mat4f is already column-major floats, so it goes to GL as is
+void setMatrixUniform(GLuint program, const char* name, const Mat4f& mat) {
     GLint location = glGetUniformLocation(program, name);
     if (location == -1) {
         fprintf(stderr, "Warning: uniform '%s' not found\n", name);
         return;
     }
-    float data[16];
-    for (int col = 0; col < 4; ++col) {
-        for (int row = 0; row < 4; ++row) {
-            data[col * 4 + row] = static_cast<float>(mat.get(row, col));
-        }
-    }
-    
-    glUniformMatrix4fv(location, 1, GL_FALSE, data);
+    glUniformMatrix4fv(location, 1, GL_FALSE, mat.ptr());
 }
 
 static void error_callback(int error, const char* description) {
@@ -340,7 +323,7 @@ int main() {
     std::cout<<"Would you like a true grid or a nice looking one enter 1 for true grid 0 for nice grid"<<std::endl;
     bool trueGrid;
     std::cin>>trueGrid;
-    GridData grid = (trueGrid ? createTrueGrid(10.0, 4) : createGrid(10.0, 4));
+    GridData grid = (trueGrid ? createTrueGrid(10.0f, 4) : createGrid(10.0f, 4));
     TargetCamera cam(
         {0, 0, 0},
         Radius{10.0},
@@ -354,14 +337,14 @@ int main() {
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window,  scroll_callback);
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-    Matrix projection = createPerspectiveMatrix((45.0f * (M_PI / 180.0)), 800.0f / 600.0f, 0.1f, 100.0f);
+    Mat4f projection = createPerspectiveMatrix(static_cast<float>(45.0 * (M_PI / 180.0)), 800.0f / 600.0f, 0.1f, 100.0f);
 
     while (!glfwWindowShouldClose(window)) {
         glfwPollEvents();
         glClearColor(0.4f, 0.4f, 0.4f, 0.4f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         Vec3D target = cam.Position + cam.front;
-        Matrix view = Matrix::lookAt(cam.Position, target, cam.up);
+        Mat4f view = Mat4f::lookAt(cam.Position, target, cam.up);
         glUseProgram(shaderProgram);
         setMatrixUniform(shaderProgram, "view", view);
         setMatrixUniform(shaderProgram, "projection", projection);
@@ -0,0 +1,253 @@
+#include "benchmark.hpp"
+#include "cpuFeatures.hpp"
+#include "threadPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#if QUANT_X86_DISPATCH
+#include <x86intrin.h>
+#endif
+
+namespace bench {
+
+static constexpr size_t MAX_ITERATIONS = 1000000000;
+
+static uint64_t readCycles() {
+#if QUANT_X86_DISPATCH
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static int64_t readNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool State::keepRunning() {
+    if(!started) {
+        started = true;
+        startNanoseconds = readNanoseconds();
+        startCycles = readCycles();
+    }
+    if(completed < iterations) {
+        completed++;
+        return true;
+    }
+    cycles = readCycles() - startCycles;
+    seconds = double(readNanoseconds() - startNanoseconds) * 1e-9;
+    return false;
+}
+
+Options Options::parse(int argc, char** argv) {
+    Options options;
+    for(int i{1}; i < argc; i++) {
+        std::string arg = argv[i];
+        size_t equals = arg.find('=');
+        std::string key = arg.substr(0, equals);
+        std::string value = equals == std::string::npos ? "" : arg.substr(equals + 1);
+        if(key == "--min-time") {
+            options.minTime = std::stod(value);
+        } else if(key == "--max-size") {
+            options.maxSize = std::stoul(value);
+        } else if(key == "--filter") {
+            options.filter = value;
+        } else if(key == "--json") {
+            options.jsonPath = value;
+        } else if(key == "--baseline") {
+            options.baselinePath = value;
+        } else if(key == "--threshold") {
+            options.threshold = std::stod(value);
+        } else {
+            throw std::invalid_argument("Unknown option " + arg + "\nOptions: --min-time=SECONDS --max-size=N --filter=TEXT "
+                                        "--json=OUT.json --baseline=SAVED.json --threshold=0.10");
+        }
+    }
+    return options;
+}
+
+void Runner::add(const std::string& name, Function function, const std::vector<size_t>& sizes) {
+    for(size_t size : sizes) {
+        if(size <= options.maxSize) {
+            entries.push_back({name + "/" + std::to_string(size), function, size});
+        }
+    }
+}
+
+Result Runner::measure(const Entry& entry) const {
+    size_t iterations = 1;
+    while(true) {
+        State state(entry.size, iterations);
+        entry.function(state);
+        if(state.completed != iterations || state.started == false) {
+            throw std::logic_error(entry.name + " did not run its keepRunning() loop to the end");
+        }
+        if(state.seconds >= options.minTime || iterations >= MAX_ITERATIONS) {
+            double perIteration = state.seconds / double(iterations);
+            Result result{entry.name, iterations, perIteration * 1e9, 0, 0};
+            if(state.flops > 0 && perIteration > 0) {
+                result.gflops = state.flops / perIteration * 1e-9;
+            }
+            if(state.bytes > 0 && state.cycles > 0) {
+                result.bytesPerCycle = state.bytes * double(iterations) / double(state.cycles);
+            }
+            return result;
+        }
+        // Aim a little past the minimum so the next run is usually the last one
+        double multiplier = state.seconds > 0 ? options.minTime * 1.4 / state.seconds : 10.0;
+        multiplier = std::min(multiplier, 10.0);
+        iterations = std::min(MAX_ITERATIONS, std::max(iterations + 1, size_t(double(iterations) * multiplier)));
+    }
+}
+
+static std::string formatTime(double nanoseconds) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(nanoseconds < 10 ? 2 : 1);
+    if(nanoseconds < 1e4) {
+        out << nanoseconds << " ns";
+    } else if(nanoseconds < 1e7) {
+        out << nanoseconds * 1e-3 << " us";
+    } else if(nanoseconds < 1e10) {
+        out << nanoseconds * 1e-6 << " ms";
+    } else {
+        out << nanoseconds * 1e-9 << " s";
+    }
+    return out.str();
+}
+
+int Runner::run() {
+    std::vector<Result> baseline;
+    if(!options.baselinePath.empty()) {
+        baseline = readJson(options.baselinePath);
+    }
+
+    std::cout << "SIMD level: " << simdLevelName(activeSimdLevel())
+              << ", threads: " << ThreadPool::global().threadCount() << std::endl;
+    std::cout << std::left << std::setw(36) << "Benchmark" << std::right << std::setw(14) << "Time"
+              << std::setw(12) << "Iterations" << std::setw(11) << "GFLOP/s" << std::setw(10) << "B/cycle" << std::endl;
+    std::cout << std::string(83, '-') << std::endl;
+
+    std::vector<Result> results;
+    for(const Entry& entry : entries) {
+        if(entry.name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+        Result result = measure(entry);
+        std::cout << std::left << std::setw(36) << result.name << std::right << std::setw(14) << formatTime(result.nanoseconds)
+                  << std::setw(12) << result.iterations << std::fixed << std::setprecision(2)
+                  << std::setw(11) << result.gflops << std::setw(10) << result.bytesPerCycle << std::endl;
+        results.push_back(result);
+    }
+
+    if(!options.jsonPath.empty()) {
+        writeJson(options.jsonPath, results);
+        std::cout << "Results written to " << options.jsonPath << std::endl;
+    }
+    if(!options.baselinePath.empty()) {
+        size_t regressions = compare(baseline, results, options.threshold);
+        return regressions ? 1 : 0;
+    }
+    return 0;
+}
+
+void writeJson(const std::string& path, const std::vector<Result>& results) {
+    std::ofstream out(path);
+    if(!out) {
+        throw std::runtime_error("Cannot open " + path + " for writing");
+    }
+    std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    out << std::setprecision(10);
+    out << "{\n  \"context\": {\n";
+    out << "    \"date\": \"" << date << "\",\n";
+    out << "    \"simd\": \"" << simdLevelName(activeSimdLevel()) << "\",\n";
+    out << "    \"threads\": " << ThreadPool::global().threadCount() << "\n";
+    out << "  },\n  \"benchmarks\": [\n";
+    for(size_t i{}; i < results.size(); i++) {
+        const Result& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+            << ", \"real_time\": " << r.nanoseconds << ", \"time_unit\": \"ns\", \"gflops\": " << r.gflops
+            << ", \"bytes_per_cycle\": " << r.bytesPerCycle << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+static double numberField(const std::string& object, const std::string& key) {
+    size_t at = object.find("\"" + key + "\"");
+    if(at == std::string::npos) {
+        return 0;
+    }
+    at = object.find(':', at);
+    return std::strtod(object.c_str() + at + 1, nullptr);
+}
+
+std::vector<Result> readJson(const std::string& path) {
+    std::ifstream in(path);
+    if(!in) {
+        throw std::runtime_error("Cannot open baseline " + path);
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string text = buffer.str();
+
+    std::vector<Result> results;
+    size_t at = text.find("\"benchmarks\"");
+    if(at == std::string::npos) {
+        throw std::runtime_error(path + " has no benchmarks array");
+    }
+    while((at = text.find('{', at)) != std::string::npos) {
+        size_t end = text.find('}', at);
+        if(end == std::string::npos) {
+            throw std::runtime_error(path + " ends inside a benchmark entry");
+        }
+        std::string object = text.substr(at, end - at);
+        size_t name = object.find("\"name\"");
+        size_t open = name == std::string::npos ? name : object.find('"', object.find(':', name) + 1);
+        size_t close = open == std::string::npos ? open : object.find('"', open + 1);
+        if(close == std::string::npos) {
+            throw std::runtime_error(path + " has a benchmark entry without a name");
+        }
+        results.push_back({object.substr(open + 1, close - open - 1), size_t(numberField(object, "iterations")),
+                           numberField(object, "real_time"), numberField(object, "gflops"), numberField(object, "bytes_per_cycle")});
+        at = end;
+    }
+    return results;
+}
+
+size_t compare(const std::vector<Result>& baseline, const std::vector<Result>& current, double threshold) {
+    std::cout << std::endl << std::left << std::setw(36) << "Comparison" << std::right << std::setw(14) << "Baseline"
+              << std::setw(14) << "Current" << std::setw(10) << "Change" << std::endl;
+    std::cout << std::string(83, '-') << std::endl;
+    size_t regressions = 0;
+    for(const Result& now : current) {
+        auto old = std::find_if(baseline.begin(), baseline.end(), [&](const Result& r) { return r.name == now.name; });
+        if(old == baseline.end() || old->nanoseconds <= 0) {
+            continue;
+        }
+        double change = now.nanoseconds / old->nanoseconds - 1.0;
+        std::cout << std::left << std::setw(36) << now.name << std::right << std::setw(14) << formatTime(old->nanoseconds)
+                  << std::setw(14) << formatTime(now.nanoseconds) << std::setw(9) << std::showpos << std::fixed
+                  << std::setprecision(1) << change * 100 << "%" << std::noshowpos;
+        if(change > threshold) {
+            std::cout << "  REGRESSION";
+            regressions++;
+        } else if(change < -threshold) {
+            std::cout << "  faster";
+        }
+        std::cout << std::endl;
+    }
+    std::cout << regressions << " regression" << (regressions == 1 ? "" : "s") << " beyond "
+              << threshold * 100 << "% against " << baseline.size() << " baseline entries" << std::endl;
+    return regressions;
+}
+
+} // namespace bench
@@ -0,0 +1,121 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+Minimal benchmark harness in the style of Google Benchmark, with no dependencies.
+
+A benchmark is a function taking a State. Setup goes before the loop and only the loop is timed:
+
+    void matrixAdd(bench::State& state) {
+        Matrix A(state.size, state.size), B(state.size, state.size);
+        while(state.keepRunning()) {
+            Matrix C = A + B;
+            bench::doNotOptimize(C);
+        }
+        state.setFlops(...);
+        state.setBytes(...);
+    }
+
+The runner grows the iteration count until a run lasts at least the minimum time and reports
+that run. Flops and bytes are per iteration; the report turns them into GFLOP/s and bytes per
+cycle, where cycles are time stamp counter ticks (the nominal clock, not the boosted one).
+
+Results can be written as JSON and compared against a saved baseline: a benchmark whose time
+grew by more than the threshold is flagged as a regression and the run exits non-zero.
+*/
+namespace bench {
+
+struct State {
+public:
+    size_t size;
+
+    explicit State(size_t _size, size_t _iterations) : size(_size), iterations(_iterations) {}
+
+    // true once per iteration; starts the clock on the first call and stops it after the last
+    bool keepRunning();
+
+    void setFlops(double perIteration) { flops = perIteration; }
+    void setBytes(double perIteration) { bytes = perIteration; }
+
+private:
+    friend class Runner;
+    size_t iterations;
+    size_t completed = 0;
+    bool started = false;
+    double seconds = 0;
+    uint64_t cycles = 0;
+    double flops = 0;
+    double bytes = 0;
+    uint64_t startCycles = 0;
+    int64_t startNanoseconds = 0;
+};
+
+using Function = std::function<void(State&)>;
+
+struct Result {
+public:
+    std::string name;
+    size_t iterations;
+    double nanoseconds;        // per iteration
+    double gflops;             // 0 when the benchmark did not report flops
+    double bytesPerCycle;      // 0 when it did not report bytes
+};
+
+struct Options {
+public:
+    double minTime = 0.2;
+    size_t maxSize = 4096;
+    std::string filter;        // run only names containing this
+    std::string jsonPath;      // write results here when not empty
+    std::string baselinePath;  // compare against this saved run when not empty
+    double threshold = 0.10;   // relative slowdown counted as a regression
+
+    // Parses --min-time=, --max-size=, --filter=, --json=, --baseline= and --threshold=.
+    // Throws std::invalid_argument on anything else.
+    static Options parse(int argc, char** argv);
+};
+
+class Runner {
+public:
+    explicit Runner(Options _options) : options(std::move(_options)) {}
+
+    // Registers name/size for every size up to options.maxSize
+    void add(const std::string& name, Function function, const std::vector<size_t>& sizes);
+
+    // Runs everything, prints the table and handles --json and --baseline.
+    // Returns the process exit code: 1 if the baseline comparison found regressions.
+    int run();
+
+private:
+    struct Entry {
+        std::string name;
+        Function function;
+        size_t size;
+    };
+    Options options;
+    std::vector<Entry> entries;
+
+    Result measure(const Entry& entry) const;
+};
+
+void writeJson(const std::string& path, const std::vector<Result>& results);
+// Reads what writeJson wrote; only name and time are needed for comparisons
+std::vector<Result> readJson(const std::string& path);
+// Prints one line per benchmark present in both runs, returns the number of regressions
+size_t compare(const std::vector<Result>& baseline, const std::vector<Result>& current, double threshold);
+
+// Keeps the compiler from discarding a result or hoisting work out of the timed loop
+template<typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+} // namespace bench
+
+#endif
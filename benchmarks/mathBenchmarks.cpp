@@ -0,0 +1,196 @@
+#include "benchmark.hpp"
+#include "3DVector.hpp"
+#include "matrix.hpp"
+#include "luFactorization.hpp"
+#include <iostream>
+#include <random>
+
+/*
+Micro and macro benchmarks for Vec3D and the dense Matrix routines.
+
+    mathBenchmarks --filter=GEMM --json=gemm.json
+    mathBenchmarks --baseline=gemm.json --threshold=0.05
+
+Flops are the textbook counts (2n^3 for GEMM, 2n^3/3 for LU); bytes are the compulsory traffic of
+reading every input and writing every output once, so bytes per cycle is a lower bound on what
+the memory system actually moved.
+*/
+
+static const std::vector<size_t> MATRIX_SIZES = {4, 16, 64, 256, 1024, 4096};
+// From L1 resident to L2 resident; capped by --max-size like the matrix sizes
+static const std::vector<size_t> VECTOR_COUNTS = {64, 512, 4096};
+
+template<typename Real>
+static BasicMatrix<Real> randomMatrix(size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    BasicMatrix<Real> mat(n, n);
+    for(Real& value : mat.data) {
+        value = Real(dist(rng));
+    }
+    // Diagonally dominant so the factorizations never meet a singular matrix
+    for(size_t i{}; i < n; i++) {
+        mat.unchecked(i, i) += Real(n);
+    }
+    return mat;
+}
+
+static std::vector<Vec3D> randomVectors(size_t count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<Vec3D> vectors(count);
+    for(Vec3D& v : vectors) {
+        v = Vec3D(dist(rng), dist(rng), dist(rng));
+    }
+    return vectors;
+}
+
+static void vecAdd(bench::State& state) {
+    std::vector<Vec3D> a = randomVectors(state.size, 1), b = randomVectors(state.size, 2), c(state.size);
+    while(state.keepRunning()) {
+        for(size_t i{}; i < state.size; i++) {
+            c[i] = a[i] + b[i];
+        }
+        bench::doNotOptimize(c.data());
+    }
+    state.setFlops(3.0 * state.size);
+    state.setBytes(3.0 * sizeof(Vec3D) * state.size);
+}
+
+static void vecDot(bench::State& state) {
+    std::vector<Vec3D> a = randomVectors(state.size, 1), b = randomVectors(state.size, 2);
+    while(state.keepRunning()) {
+        double sum = 0;
+        for(size_t i{}; i < state.size; i++) {
+            sum += a[i] * b[i];
+        }
+        bench::doNotOptimize(sum);
+    }
+    state.setFlops(6.0 * state.size);
+    state.setBytes(2.0 * sizeof(Vec3D) * state.size);
+}
+
+static void vecCross(bench::State& state) {
+    std::vector<Vec3D> a = randomVectors(state.size, 1), b = randomVectors(state.size, 2), c(state.size);
+    while(state.keepRunning()) {
+        for(size_t i{}; i < state.size; i++) {
+            c[i] = a[i].cross(b[i]);
+        }
+        bench::doNotOptimize(c.data());
+    }
+    state.setFlops(9.0 * state.size);
+    state.setBytes(3.0 * sizeof(Vec3D) * state.size);
+}
+
+static void vecNormal(bench::State& state) {
+    std::vector<Vec3D> a = randomVectors(state.size, 1), c(state.size);
+    while(state.keepRunning()) {
+        for(size_t i{}; i < state.size; i++) {
+            c[i] = a[i].normal();
+        }
+        bench::doNotOptimize(c.data());
+    }
+    // 5 for the squared length, sqrt, reciprocal and 3 scales
+    state.setFlops(10.0 * state.size);
+    state.setBytes(2.0 * sizeof(Vec3D) * state.size);
+}
+
+static void matrixAdd(bench::State& state) {
+    size_t n = state.size;
+    Matrix A = randomMatrix<double>(n, 1), B = randomMatrix<double>(n, 2), C(n, n);
+    while(state.keepRunning()) {
+        C = A + B;
+        bench::doNotOptimize(C.data.data());
+    }
+    state.setFlops(double(n) * n);
+    state.setBytes(3.0 * sizeof(double) * n * n);
+}
+
+static void matrixScale(bench::State& state) {
+    size_t n = state.size;
+    Matrix A = randomMatrix<double>(n, 1), C(n, n);
+    while(state.keepRunning()) {
+        C = A * 2.5;
+        bench::doNotOptimize(C.data.data());
+    }
+    state.setFlops(double(n) * n);
+    state.setBytes(2.0 * sizeof(double) * n * n);
+}
+
+template<typename Real>
+static void matrixGemm(bench::State& state) {
+    size_t n = state.size;
+    BasicMatrix<Real> A = randomMatrix<Real>(n, 1), B = randomMatrix<Real>(n, 2);
+    while(state.keepRunning()) {
+        BasicMatrix<Real> C = A * B;
+        bench::doNotOptimize(C.data.data());
+    }
+    state.setFlops(2.0 * n * n * n);
+    state.setBytes(3.0 * sizeof(Real) * n * n);
+}
+
+static void matrixTranspose(bench::State& state) {
+    size_t n = state.size;
+    Matrix A = randomMatrix<double>(n, 1);
+    while(state.keepRunning()) {
+        Matrix T = A.T();
+        bench::doNotOptimize(T.data.data());
+    }
+    state.setBytes(2.0 * sizeof(double) * n * n);
+}
+
+static void matrixLU(bench::State& state) {
+    size_t n = state.size;
+    Matrix A = randomMatrix<double>(n, 1);
+    while(state.keepRunning()) {
+        LUFactorization lu(A);
+        bench::doNotOptimize(lu.LU.data.data());
+    }
+    state.setFlops(2.0 / 3.0 * n * n * n);
+    state.setBytes(2.0 * sizeof(double) * n * n);
+}
+
+static void matrixDet(bench::State& state) {
+    size_t n = state.size;
+    Matrix A = randomMatrix<double>(n, 1);
+    while(state.keepRunning()) {
+        double det = A.det();
+        bench::doNotOptimize(det);
+    }
+    state.setFlops(2.0 / 3.0 * n * n * n);
+    state.setBytes(sizeof(double) * double(n) * n);
+}
+
+static void matrixInv(bench::State& state) {
+    size_t n = state.size;
+    Matrix A = randomMatrix<double>(n, 1);
+    while(state.keepRunning()) {
+        Matrix inverse = A.inv();
+        bench::doNotOptimize(inverse.data.data());
+    }
+    // LU plus n forward and back substitutions
+    state.setFlops(2.0 * n * n * n);
+    state.setBytes(2.0 * sizeof(double) * n * n);
+}
+
+int main(int argc, char** argv) {
+    try {
+        bench::Runner runner(bench::Options::parse(argc, argv));
+        runner.add("Vec3D/Add", vecAdd, VECTOR_COUNTS);
+        runner.add("Vec3D/Dot", vecDot, VECTOR_COUNTS);
+        runner.add("Vec3D/Cross", vecCross, VECTOR_COUNTS);
+        runner.add("Vec3D/Normal", vecNormal, VECTOR_COUNTS);
+        runner.add("Matrix/Add", matrixAdd, MATRIX_SIZES);
+        runner.add("Matrix/Scale", matrixScale, MATRIX_SIZES);
+        runner.add("Matrix/Transpose", matrixTranspose, MATRIX_SIZES);
+        runner.add("Matrix/GEMM", matrixGemm<double>, MATRIX_SIZES);
+        runner.add("MatrixF/GEMM", matrixGemm<float>, MATRIX_SIZES);
+        runner.add("Matrix/LU", matrixLU, MATRIX_SIZES);
+        runner.add("Matrix/Det", matrixDet, MATRIX_SIZES);
+        runner.add("Matrix/Inv", matrixInv, MATRIX_SIZES);
+        return runner.run();
+    } catch(const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+}
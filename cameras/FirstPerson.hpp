@@ -1,6 +1,6 @@
 #ifndef FIRSTPERSON_HPP
 #define FIRSTPERSON_HPP
-#include "../Math Algorithms/3DVector.hpp"
+#include "3DVector.hpp"
 #include <GLFW/glfw3.h>
 
 //using GLFW 1st POV Camera:
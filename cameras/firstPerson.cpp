@@ -1,4 +1,4 @@
-#include "../cameras/firstPerson.hpp"
+#include "FirstPerson.hpp"
 
 FirstPersonCamera::FirstPersonCamera(Vec3D _position, Yaw _yaw, Pitch _pitch, Roll _roll, Speed _speed, Sens _sens) : Position(_position), yaw(_yaw), pitch(_pitch), roll(_roll), speed(_speed), sens(_sens) {
     updateCamera();
@@ -1,4 +1,4 @@
-#include "../cameras/target.hpp"
+#include "target.hpp"
 
 TargetCamera::TargetCamera(Vec3D _target, Radius _radius, Theta _theta, Phi _phi, Speed _speed, Sens _sens): target(_target), radius(_radius), theta(_theta), phi(_phi), speed(_speed), sens(_sens){
     updateCamera();
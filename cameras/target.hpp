@@ -1,7 +1,7 @@
 #ifndef TARGET_HPP
 #define TARGET_HPP
 
-#include "../Math Algorithms/3DVector.hpp"
+#include "3DVector.hpp"
 #include <vector>
 #include <cmath>
 
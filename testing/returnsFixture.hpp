@@ -0,0 +1,31 @@
+#ifndef RETURNSFIXTURE_HPP
+#define RETURNSFIXTURE_HPP
+
+#include "matrix.hpp"
+#include <random>
+#include <vector>
+
+/*
+Shared test fixture: a panel of asset returns driven by a common market factor, so the covariance
+is well conditioned but not diagonal. The same seed always gives the same panel.
+*/
+inline Matrix makeReturns(size_t observations, size_t assets, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> noise(0.0, 0.02);
+    std::uniform_real_distribution<double> drift(0.0001, 0.001), beta(0.5, 1.5);
+    std::vector<double> mu(assets), b(assets);
+    for(size_t i{}; i < assets; i++) {
+        mu[i] = drift(rng);
+        b[i] = beta(rng);
+    }
+    Matrix R(observations, assets);
+    for(size_t t{}; t < observations; t++) {
+        double market = noise(rng);
+        for(size_t i{}; i < assets; i++) {
+            R(t, i) = mu[i] + b[i] * market + noise(rng);
+        }
+    }
+    return R;
+}
+
+#endif
@@ -0,0 +1,296 @@
+#include "bvh.hpp"
+#include "cpuFeatures.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+static int failures = 0;
+
+static void expect(bool ok, const std::string& what) {
+    if(!ok) {
+        std::cout << "FAIL: " << what << std::endl;
+        failures++;
+    }
+}
+
+struct Scene {
+public:
+    std::vector<Vec3D> start, end;
+    std::vector<double> radius;
+
+    void add(BVH& bvh, const Vec3D& a, const Vec3D& b, double r) {
+        start.push_back(a);
+        end.push_back(b);
+        radius.push_back(r);
+        bvh.addSegment(a, b, r);
+    }
+};
+
+// Closest approach between a ray (or a point, with a zero direction) and a segment, by ternary
+// search over the segment: for each segment point the best ray parameter is a clamped projection,
+// and the resulting gap is convex along the segment
+static std::pair<double, double> approach(const Vec3D& origin, const Vec3D& direction, const Vec3D& a, const Vec3D& b) {
+    auto at = [&](double u, double& t) {
+        Vec3D p = a + (b - a) * u;
+        double dd = direction * direction;
+        t = dd > 0 ? std::max(0.0, ((p - origin) * direction) / dd) : 0.0;
+        return (origin + direction * t - p).magnitude();
+    };
+    double lo = 0, hi = 1, t;
+    for(size_t i{}; i < 100; i++) {
+        double m1 = lo + (hi - lo) / 3, m2 = hi - (hi - lo) / 3;
+        if(at(m1, t) < at(m2, t)) {
+            hi = m2;
+        } else {
+            lo = m1;
+        }
+    }
+    double gap = at(0.5 * (lo + hi), t);
+    return {gap, t};
+}
+
+static BVHHit castAll(const Scene& scene, const Vec3D& origin, const Vec3D& direction, double& margin) {
+    BVHHit best;
+    margin = INFINITY;
+    for(size_t i{}; i < scene.start.size(); i++) {
+        auto [gap, t] = approach(origin, direction, scene.start[i], scene.end[i]);
+        margin = std::min(margin, std::fabs(gap - scene.radius[i]));
+        if(gap <= scene.radius[i] && t < best.distance) {
+            best = BVHHit{i, t};
+        }
+    }
+    return best;
+}
+
+static BVHHit nearestAll(const Scene& scene, const Vec3D& point) {
+    BVHHit best;
+    for(size_t i{}; i < scene.start.size(); i++) {
+        double distance = std::max(approach(point, Vec3D(), scene.start[i], scene.end[i]).first - scene.radius[i], 0.0);
+        if(distance < best.distance) {
+            best = BVHHit{i, distance};
+        }
+    }
+    return best;
+}
+
+// Same hit, allowing for a tie in distance or a ray that grazes a surface within rounding
+static bool sameHit(const BVHHit& got, const BVHHit& want, double margin) {
+    if(got.hit() != want.hit()) {
+        return margin < 1e-9;
+    }
+    return !got.hit() || got.primitive == want.primitive || std::fabs(got.distance - want.distance) < 1e-9;
+}
+
+static void randomScene(size_t count, std::mt19937& rng, BVH& bvh, Scene& scene) {
+    std::uniform_real_distribution<double> place(-10, 10), step(-1, 1);
+    for(size_t i{}; i < count; i++) {
+        Vec3D a(place(rng), place(rng), place(rng));
+        if(i % 2 == 0) {
+            scene.add(bvh, a, a, 0.25);
+        } else {
+            scene.add(bvh, a, a + Vec3D(step(rng), step(rng), step(rng)), 0.1);
+        }
+    }
+}
+
+int main() {
+    std::mt19937 rng(23);
+    std::uniform_real_distribution<double> place(-12, 12), unit(-1, 1);
+
+    BVH bvh;
+    Scene scene;
+    randomScene(2000, rng, bvh, scene);
+    bvh.build();
+    expect(bvh.nodeCount() > 0 && bvh.nodeCount() < 2 * bvh.size(), "node count " + std::to_string(bvh.nodeCount()));
+
+    const size_t rayCount = 400;
+    Vec3DBatch origins, directions;
+    for(size_t i{}; i < rayCount; i++) {
+        origins.push_back(Vec3D(place(rng), place(rng), place(rng)));
+        // Some rays run along an axis, which exercises the parallel slab case
+        Vec3D d = i % 10 == 0 ? Vec3D(0, 0, i % 20 == 0 ? 1 : -1) : Vec3D(unit(rng), unit(rng), unit(rng));
+        directions.push_back(d);
+    }
+
+    // Single rays, and packets on every instruction set, agree with the brute-force scene
+    std::vector<BVHHit> expected(rayCount);
+    std::vector<double> margins(rayCount);
+    size_t hits = 0;
+    for(size_t i{}; i < rayCount; i++) {
+        expected[i] = castAll(scene, origins.get(i), directions.get(i), margins[i]);
+        hits += expected[i].hit();
+        BVHHit got = bvh.intersect(origins.get(i), directions.get(i));
+        expect(sameHit(got, expected[i], margins[i]), "single ray " + std::to_string(i));
+    }
+    expect(hits > rayCount / 10, "too few rays hit anything to be a useful test");
+    for(SimdLevel level : {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        setSimdLevel(level);
+        std::vector<BVHHit> packet;
+        bvh.intersect(origins, directions, packet);
+        size_t wrong = 0;
+        for(size_t i{}; i < rayCount; i++) {
+            wrong += !sameHit(packet[i], expected[i], margins[i]);
+        }
+        expect(wrong == 0, std::string("packet rays with ") + simdLevelName(activeSimdLevel()) + ": " + std::to_string(wrong) + " wrong");
+    }
+    setSimdLevel(detectSimdLevel());
+
+    // A limited ray stops short of hits beyond its reach
+    {
+        BVHHit far = bvh.intersect(origins.get(0), directions.get(0));
+        if(far.hit()) {
+            BVHHit near = bvh.intersect(origins.get(0), directions.get(0), 0.5 * far.distance);
+            expect(!near.hit() || near.distance < 0.5 * far.distance, "max distance");
+        }
+    }
+
+    // Nearest neighbour against the brute force, for single and batched queries
+    Vec3DBatch points;
+    for(size_t i{}; i < 300; i++) {
+        points.push_back(Vec3D(place(rng), place(rng), place(rng)));
+    }
+    std::vector<BVHHit> nearest;
+    bvh.nearest(points, nearest);
+    for(size_t i{}; i < points.size(); i++) {
+        BVHHit want = nearestAll(scene, points.get(i));
+        BVHHit got = bvh.nearest(points.get(i));
+        expect(std::fabs(got.distance - want.distance) < 1e-9 && got.primitive == nearest[i].primitive, "nearest " + std::to_string(i));
+    }
+    expect(!bvh.nearest(Vec3D(100, 100, 100), 1.0).hit(), "nearest beyond max distance");
+
+    // Moving every primitive and refitting keeps the queries exact
+    std::uniform_real_distribution<double> jitter(-0.5, 0.5);
+    for(size_t i{}; i < scene.start.size(); i++) {
+        Vec3D shift(jitter(rng), jitter(rng), jitter(rng));
+        scene.start[i] += shift;
+        scene.end[i] += shift;
+        bvh.setSegment(i, scene.start[i], scene.end[i]);
+    }
+    bvh.refit();
+    {
+        std::vector<BVHHit> packet;
+        bvh.intersect(origins, directions, packet);
+        size_t wrong = 0;
+        for(size_t i{}; i < rayCount; i++) {
+            double margin;
+            BVHHit want = castAll(scene, origins.get(i), directions.get(i), margin);
+            wrong += !sameHit(packet[i], want, margin);
+        }
+        expect(wrong == 0, "rays after refit: " + std::to_string(wrong) + " wrong");
+        for(size_t i{}; i < 100; i++) {
+            expect(std::fabs(bvh.nearest(points.get(i)).distance - nearestAll(scene, points.get(i)).distance) < 1e-9, "nearest after refit");
+        }
+    }
+
+    // Line of sight, capsule semantics and misuse
+    {
+        BVH wall;
+        wall.addSegment(Vec3D(0, -5, 0), Vec3D(0, 5, 0), 0.25);
+        wall.addPoint(Vec3D(10, 0, 0), 1.0);
+        wall.build();
+        expect(wall.occluded(Vec3D(-3, 0, 0), Vec3D(3, 0, 0)) && !wall.occluded(Vec3D(-3, 0, 0), Vec3D(-1, 0, 0)), "occluded");
+        expect(!wall.occluded(Vec3D(-3, 6, 0), Vec3D(3, 6, 0)), "clear line of sight past the segment end");
+        BVHHit pick = wall.intersect(Vec3D(-3, 2, 0.2), Vec3D(1, 0, 0));
+        expect(pick.primitive == 0 && std::fabs(pick.distance - 3) < 1e-12, "picking a segment reports the closest approach");
+        pick = wall.intersect(Vec3D(5, 0.5, 0), Vec3D(2, 0, 0));
+        expect(pick.primitive == 1 && std::fabs(pick.distance - 2.5) < 1e-12, "picking a point");
+        expect(wall.nearest(Vec3D(0, 7, 0)).primitive == 0 && std::fabs(wall.nearest(Vec3D(0, 7, 0)).distance - 1.75) < 1e-12, "nearest segment end");
+
+        BVH empty;
+        empty.build();
+        expect(!empty.intersect(Vec3D(), Vec3D(1, 0, 0)).hit() && !empty.nearest(Vec3D()).hit(), "empty tree");
+        try {
+            wall.addPoint(Vec3D(), 0.1);
+            wall.intersect(Vec3D(), Vec3D(1, 0, 0));
+            expect(false, "query before rebuild accepted");
+        } catch(const std::logic_error&) {
+        }
+        try {
+            wall.build();
+            wall.intersect(Vec3D(), Vec3D());
+            expect(false, "zero direction accepted");
+        } catch(const std::invalid_argument&) {
+        }
+        // A zero lane in a batch is refused like a single zero ray, instead of tracing NaN distances
+        Vec3DBatch batchOrigins, batchDirections;
+        std::vector<BVHHit> batchHits;
+        for(size_t i{}; i < 20; i++) {
+            batchOrigins.push_back(Vec3D(-3, 0, 0));
+            batchDirections.push_back(i == 13 ? Vec3D() : Vec3D(1, 0, 0));
+        }
+        try {
+            wall.intersect(batchOrigins, batchDirections, batchHits);
+            expect(false, "zero direction accepted in a batch");
+        } catch(const std::invalid_argument&) {
+        }
+    }
+
+    // Points bunched geometrically toward the origin drive the builder to its depth limit; the oversized
+    // leaf it ends in still answers exactly
+    {
+        BVH deep;
+        Scene bunched;
+        for(size_t i{}; i < 300; i++) {
+            Vec3D p(std::ldexp(1.0, -int(i)), 0, 0);
+            bunched.add(deep, p, p, 0);
+        }
+        deep.build();
+        for(double x : {1e-30, 3e-10, 0.2, 0.7}) {
+            BVHHit want = nearestAll(bunched, Vec3D(x, 1e-3, 0));
+            BVHHit got = deep.nearest(Vec3D(x, 1e-3, 0));
+            expect(std::fabs(got.distance - want.distance) < 1e-12, "nearest in a depth-limited tree at " + std::to_string(x));
+        }
+        for(double y : {0.0, 1e-3}) {
+            double margin;
+            BVHHit want = castAll(bunched, Vec3D(-1, y, 0), Vec3D(1, 0, 0), margin);
+            expect(sameHit(deep.intersect(Vec3D(-1, y, 0), Vec3D(1, 0, 0)), want, margin), "ray into a depth-limited tree");
+        }
+    }
+
+    // Build time and ray throughput
+    for(size_t count : {100000, 1000000}) {
+        BVH big;
+        std::uniform_real_distribution<double> wide(-100, 100);
+        for(size_t i{}; i < count; i++) {
+            Vec3D a(wide(rng), wide(rng), wide(rng));
+            big.addSegment(a, a + Vec3D(unit(rng), unit(rng), unit(rng)), 0.05);
+        }
+        auto start = std::chrono::steady_clock::now();
+        big.build();
+        double buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        start = std::chrono::steady_clock::now();
+        big.refit();
+        double refitSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // A 512 x 512 camera looking into the scene
+        const size_t side = 512;
+        Vec3DBatch cameraOrigins, cameraDirections;
+        for(size_t y{}; y < side; y++) {
+            for(size_t x{}; x < side; x++) {
+                cameraOrigins.push_back(Vec3D(0, 0, -150));
+                cameraDirections.push_back(Vec3D((double(x) / side - 0.5), (double(y) / side - 0.5), 1.0));
+            }
+        }
+        std::vector<BVHHit> image;
+        start = std::chrono::steady_clock::now();
+        big.intersect(cameraOrigins, cameraDirections, image);
+        double packetSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        start = std::chrono::steady_clock::now();
+        // Every fourth pixel one ray at a time, for comparison
+        size_t mismatched = 0;
+        for(size_t i{}; i < image.size(); i += 4) {
+            BVHHit single = big.intersect(cameraOrigins.get(i), cameraDirections.get(i));
+            mismatched += single.primitive != image[i].primitive && std::fabs(single.distance - image[i].distance) > 1e-9;
+        }
+        double singleSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        expect(mismatched == 0, "camera packets differ from single rays");
+        double rays = double(image.size());
+        std::cout << count << " segments: build " << buildSeconds * 1e3 << " ms, refit " << refitSeconds * 1e3 << " ms, "
+                  << big.nodeCount() << " nodes; camera rays " << rays / packetSeconds * 1e-6 << " M/s in packets ("
+                  << simdLevelName(activeSimdLevel()) << "), " << rays / 4 / singleSeconds * 1e-6 << " M/s one at a time" << std::endl;
+    }
+
+    std::cout << (failures ? "BVH tests failed" : "BVH tests passed") << std::endl;
+    return failures ? 1 : 0;
+}
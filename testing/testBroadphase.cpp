@@ -0,0 +1,164 @@
+#include "broadphase.hpp"
+#include "threadPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+static int failures = 0;
+
+static void expect(bool ok, const std::string& what) {
+    if(!ok) {
+        std::cout << "FAIL: " << what << std::endl;
+        failures++;
+    }
+}
+
+static std::vector<std::pair<uint32_t, uint32_t>> flatten(const PairBatches& batches) {
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    for(const auto& batch : batches) {
+        for(const CandidatePair& pair : batch) {
+            pairs.push_back({pair.first, pair.second});
+        }
+    }
+    return pairs;
+}
+
+static std::vector<std::pair<uint32_t, uint32_t>> sorted(std::vector<std::pair<uint32_t, uint32_t>> pairs) {
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+}
+
+static std::vector<std::pair<uint32_t, uint32_t>> allPairs(const Vec3DBatch& position, const std::vector<double>& radius) {
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    for(size_t i{}; i < position.size(); i++) {
+        for(size_t j{i + 1}; j < position.size(); j++) {
+            double reach = radius[i] + radius[j];
+            if(std::fabs(position.x[i] - position.x[j]) <= reach && std::fabs(position.y[i] - position.y[j]) <= reach &&
+               std::fabs(position.z[i] - position.z[j]) <= reach) {
+                pairs.push_back({uint32_t(i), uint32_t(j)});
+            }
+        }
+    }
+    return pairs;
+}
+
+static void randomSpheres(size_t n, double extent, double maxRadius, std::mt19937& rng, Vec3DBatch& position, std::vector<double>& radius) {
+    std::uniform_real_distribution<double> place(-extent, extent);
+    std::uniform_real_distribution<double> size(0.1 * maxRadius, maxRadius);
+    position = Vec3DBatch(n);
+    radius.resize(n);
+    for(size_t i{}; i < n; i++) {
+        position.set(i, Vec3D(place(rng), place(rng), place(rng)));
+        radius[i] = size(rng);
+    }
+}
+
+int main() {
+    std::mt19937 rng(22);
+    Vec3DBatch position;
+    std::vector<double> radius;
+
+    // Both broadphases find exactly the overlapping boxes, each pair once
+    for(double maxRadius : {0.2, 1.0, 3.0}) {
+        randomSpheres(3000, 20.0, maxRadius, rng, position, radius);
+        auto expected = allPairs(position, radius);
+        UniformGrid grid;
+        SweepAndPrune sweep;
+        grid.update(position, radius);
+        sweep.update(position, radius);
+        auto gridPairs = sorted(flatten(grid.batches()));
+        auto sweepPairs = sorted(flatten(sweep.batches()));
+        std::string label = " with radius up to " + std::to_string(maxRadius);
+        expect(gridPairs == expected, "grid pairs" + label + ": " + std::to_string(gridPairs.size()) + " vs " + std::to_string(expected.size()));
+        expect(sweepPairs == expected, "sweep pairs" + label + ": " + std::to_string(sweepPairs.size()) + " vs " + std::to_string(expected.size()));
+        expect(grid.pairCount() == expected.size() && sweep.pairCount() == expected.size(), "pair counts" + label);
+
+        // Small moves take the insertion sort path; large ones fall back to a full sort
+        for(double jitter : {0.05, 30.0}) {
+            std::uniform_real_distribution<double> move(-jitter, jitter);
+            for(size_t i{}; i < position.size(); i++) {
+                position.set(i, position.get(i) + Vec3D(move(rng), move(rng), move(rng)));
+            }
+            expected = allPairs(position, radius);
+            grid.update(position, radius);
+            sweep.update(position, radius);
+            expect(sorted(flatten(grid.batches())) == expected, "grid after moving by " + std::to_string(jitter) + label);
+            expect(sorted(flatten(sweep.batches())) == expected, "sweep after moving by " + std::to_string(jitter) + label);
+        }
+    }
+
+    // A coarser grid than needed still finds the same pairs, and indices are ordered within a pair
+    {
+        randomSpheres(2000, 10.0, 0.5, rng, position, radius);
+        UniformGrid grid;
+        grid.cellSize = 4.0;
+        grid.update(position, radius);
+        auto pairs = flatten(grid.batches());
+        expect(sorted(pairs) == allPairs(position, radius), "coarse grid pairs");
+        expect(std::all_of(pairs.begin(), pairs.end(), [](const auto& pair) { return pair.first < pair.second; }), "pairs ordered");
+    }
+
+    // Degenerate inputs
+    {
+        UniformGrid grid;
+        SweepAndPrune sweep;
+        Vec3DBatch none;
+        std::vector<double> noRadius;
+        grid.update(none, noRadius);
+        sweep.update(none, noRadius);
+        expect(grid.pairCount() == 0 && sweep.pairCount() == 0, "empty input");
+        Vec3DBatch stacked(std::vector<Vec3D>(50, Vec3D(1, 2, 3)));
+        std::vector<double> same(50, 0.5);
+        grid.update(stacked, same);
+        sweep.update(stacked, same);
+        expect(grid.pairCount() == 50 * 49 / 2 && sweep.pairCount() == 50 * 49 / 2, "coincident spheres");
+        try {
+            grid.update(stacked, noRadius);
+            expect(false, "radius count mismatch accepted");
+        } catch(const std::invalid_argument&) {
+        }
+    }
+
+    // Batches are identical on any thread count
+    {
+        randomSpheres(100000, 40.0, 0.3, rng, position, radius);
+        UniformGrid grid;
+        SweepAndPrune sweep;
+        ThreadPool::setGlobalThreadCount(1);
+        grid.update(position, radius);
+        sweep.update(position, radius);
+        auto gridSerial = flatten(grid.batches());
+        auto sweepSerial = flatten(sweep.batches());
+        ThreadPool::setGlobalThreadCount(4);
+        grid.update(position, radius);
+        sweep.update(position, radius);
+        expect(flatten(grid.batches()) == gridSerial, "grid batches depend on thread count");
+        expect(flatten(sweep.batches()) == sweepSerial, "sweep batches depend on thread count");
+        ThreadPool::setGlobalThreadCount(ThreadPool::defaultThreadCount());
+    }
+
+    // Per-sphere cost should stay flat as the count grows at constant density
+    for(size_t n : {10000, 100000, 1000000}) {
+        randomSpheres(n, 0.5 * std::cbrt(double(n)), 0.25, rng, position, radius);
+        UniformGrid grid;
+        SweepAndPrune sweep;
+        auto start = std::chrono::steady_clock::now();
+        grid.update(position, radius);
+        double gridSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << n << " spheres, " << grid.pairCount() << " pairs: grid " << gridSeconds * 1e9 / double(n) << " ns/sphere";
+        // A single sweep axis through a uniform cube sees n^(2/3) neighbours per sphere, so stop early
+        if(n <= 100000) {
+            start = std::chrono::steady_clock::now();
+            sweep.update(position, radius);
+            double sweepSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            expect(grid.pairCount() == sweep.pairCount(), "grid and sweep disagree at " + std::to_string(n));
+            std::cout << ", sweep " << sweepSeconds * 1e9 / double(n) << " ns/sphere";
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << (failures ? "Broadphase tests failed" : "Broadphase tests passed") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,158 @@
+#include "csvReader.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <unistd.h>
+
+static void writeFile(const std::string& path, const std::string& text) {
+    std::ofstream out(path, std::ios::binary);
+    out << text;
+}
+
+// A fresh file in the temporary directory, so concurrent runs never share one
+static std::string temporaryPath() {
+    std::string path = (std::filesystem::temp_directory_path() / "testCsvReaderXXXXXX").string();
+    int fd = mkstemp(path.data());
+    if(fd < 0) {
+        throw std::runtime_error("Cannot create a temporary file");
+    }
+    close(fd);
+    return path;
+}
+
+int main() {
+    int failures = 0;
+    const std::string path = temporaryPath();
+
+    writeFile(path,
+        "date,\"AAA\",BBB,CCC\r\n"
+        "2024-01-02,100,50.5,1.0e1\r\n"
+        "2024-01-03,101,,10.5\r\n"
+        "\r\n"
+        "2024-01-04,NA,52,11\r\n"
+        "2024-01-05,103.25,53,  12  ");
+
+    CsvOptions prices;
+    prices.logReturns = false;
+    CsvPanel raw = loadCsvPanel(path, prices);
+    if(raw.assets.size() != 3 || raw.assets[0] != "AAA" || raw.values.rows != 4 || raw.missingFields != 2) {
+        std::cout << "FAIL: shape " << raw.values.rows << " x " << raw.values.columns << ", missing " << raw.missingFields << std::endl;
+        failures++;
+    } else if(raw.values(1, 1) != 50.5 || raw.values(2, 0) != 101 || raw.values(3, 0) != 103.25 || raw.values(3, 2) != 12) {
+        std::cout << "FAIL: forward fill or parsing" << std::endl;
+        failures++;
+    }
+
+    CsvPanel returns = loadCsvPanel(path);
+    if(returns.values.rows != 3 || std::fabs(returns.values(0, 2) - std::log(1.05)) > 1e-15 || returns.values(1, 0) != 0.0) {
+        std::cout << "FAIL: log returns" << std::endl;
+        failures++;
+    }
+
+    CsvOptions drop;
+    drop.missing = MissingValues::DropRow;
+    CsvPanel dropped = loadCsvPanel(path, drop);
+    if(dropped.values.rows != 1 || std::fabs(dropped.values(0, 0) - std::log(103.25 / 100)) > 1e-15) {
+        std::cout << "FAIL: drop rows" << std::endl;
+        failures++;
+    }
+
+    CsvOptions strict;
+    strict.missing = MissingValues::Throw;
+    try {
+        loadCsvPanel(path, strict);
+        std::cout << "FAIL: missing values accepted under Throw" << std::endl;
+        failures++;
+    } catch(const std::runtime_error&) {}
+
+    writeFile(path, "d,A,B\n1,2,3\n2,4\n");
+    try {
+        loadCsvPanel(path);
+        std::cout << "FAIL: short row accepted" << std::endl;
+        failures++;
+    } catch(const std::runtime_error&) {}
+
+    // Quoted fields may hold the delimiter, in the header and in the rows
+    writeFile(path,
+        "\"date, local\",\"Fund \"\"A\"\", Class 1\",B\n"
+        "\"Jan 2, 2024\",\"1.5\",2\n"
+        "\"Jan 3, 2024\",1.75,\"\"\n");
+    CsvPanel quoted = loadCsvPanel(path, prices);
+    if(quoted.assets.size() != 2 || quoted.assets[0] != "Fund \"A\", Class 1" || quoted.assets[1] != "B" || quoted.values.rows != 2
+       || quoted.values(0, 0) != 1.5 || quoted.values(1, 0) != 1.75 || quoted.values(1, 1) != 2 || quoted.missingFields != 1) {
+        std::cout << "FAIL: quoted fields" << std::endl;
+        failures++;
+    }
+    for(const char* broken : {"d,\"A,B\n1,2\n", "d,A\n\"1,2\n3,4\n", "d,A\n1,\"2"}) {
+        writeFile(path, broken);
+        try {
+            loadCsvPanel(path);
+            std::cout << "FAIL: unterminated quote accepted in " << broken << std::endl;
+            failures++;
+        } catch(const std::runtime_error&) {}
+    }
+
+    // Fast path and fallback agree with strtod on awkward numbers
+    std::mt19937_64 rng(5);
+    std::string text = "i,x\n";
+    std::vector<std::string> literals = {"0.1", "-0.0", "1e-30", "123456789012345678901234", "4.9e-324", "0.30000000000000004", "9007199254740993"};
+    std::uniform_real_distribution<double> uniform(-1e6, 1e6);
+    char buffer[64];
+    for(size_t i{}; i < 2000; i++) {
+        std::snprintf(buffer, sizeof(buffer), "%.*g", int(1 + i % 17), uniform(rng));
+        literals.push_back(buffer);
+    }
+    for(size_t i{}; i < literals.size(); i++) {
+        text += std::to_string(i) + "," + literals[i] + "\n";
+    }
+    writeFile(path, text);
+    CsvPanel numbers = loadCsvPanel(path, prices);
+    for(size_t i{}; i < literals.size(); i++) {
+        if(numbers.values(i, 0) != std::strtod(literals[i].c_str(), nullptr)) {
+            std::cout << "FAIL: " << literals[i] << " parsed as " << numbers.values(i, 0) << std::endl;
+            failures++;
+            break;
+        }
+    }
+
+    // Throughput on a panel large enough to span several chunks
+    const size_t T = 100000, N = 50;
+    std::string big = "date";
+    for(size_t j{}; j < N; j++) {
+        big += ",S" + std::to_string(j);
+    }
+    big += "\n";
+    std::vector<double> level(N, 100.0);
+    std::normal_distribution<double> shock(0.0, 0.01);
+    for(size_t t{}; t < T; t++) {
+        big += std::to_string(20000101 + t);
+        for(size_t j{}; j < N; j++) {
+            level[j] *= std::exp(shock(rng));
+            std::snprintf(buffer, sizeof(buffer), ",%.4f", level[j]);
+            big += buffer;
+        }
+        big += "\n";
+    }
+    writeFile(path, big);
+    auto start = std::chrono::steady_clock::now();
+    CsvPanel panel = loadCsvPanel(path);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if(panel.values.rows != T - 1 || panel.values.columns != N) {
+        std::cout << "FAIL: large panel shape" << std::endl;
+        failures++;
+    }
+    std::cout << "Loaded " << big.size() / 1e6 << " MB in " << seconds * 1e3 << " ms ("
+              << big.size() / 1e6 / seconds << " MB/s)" << std::endl;
+    std::remove(path.c_str());
+
+    if(failures == 0) {
+        std::cout << "All CSV reader tests passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,209 @@
+#include "matrix.hpp"
+#include "cholesky.hpp"
+#include "cpuFeatures.hpp"
+#include "qrFactorization.hpp"
+#include "symmetricEigen.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+static double maxAbs(const Matrix& mat) {
+    double m = 0;
+    for(double v : mat.data) {
+        m = std::max(m, std::fabs(v));
+    }
+    return m;
+}
+
+static Matrix identity(size_t n) {
+    Matrix I(n, n);
+    for(size_t i{}; i < n; i++) {
+        I(i, i) = 1.0;
+    }
+    return I;
+}
+
+static Matrix randomMatrix(size_t rows, size_t cols, std::mt19937& rng) {
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    Matrix A(rows, cols);
+    for(double& v : A.data) {
+        v = dist(rng);
+    }
+    return A;
+}
+
+// X^T X / rows + shift * I is well conditioned and positive definite
+static Matrix randomSPD(size_t n, std::mt19937& rng) {
+    Matrix X = randomMatrix(n + 10, n, rng);
+    Matrix A = X.view().T() * X;
+    for(size_t i{}; i < n; i++) {
+        A(i, i) += double(n);
+    }
+    return A;
+}
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    int failures = 0;
+    std::mt19937 rng(11);
+
+    // Cholesky across block boundaries, in place and from a view
+    for(size_t n : {1, 3, 63, 64, 65, 130, 300}) {
+        Matrix A = randomSPD(n, rng);
+        CholeskyFactorization chol(A);
+        double err = maxAbs(chol.L * chol.L.view().T() - A) / double(n);
+        for(size_t i{}; i < n; i++) {
+            for(size_t j{i + 1}; j < n; j++) {
+                if(chol.L(i, j) != 0.0) {
+                    err = 1.0;
+                }
+            }
+        }
+        Matrix B = randomMatrix(n, 5, rng);
+        double residual = maxAbs(A * chol.solve(B) - B);
+        CholeskyFactorization inPlace{Matrix(A)};
+        if(err > 1e-12 || residual > 1e-10 || maxAbs(inPlace.L - chol.L) != 0.0) {
+            std::cout << "FAIL: cholesky n=" << n << " err " << err << " residual " << residual << std::endl;
+            failures++;
+        }
+    }
+    Matrix indefinite = identity(70);
+    indefinite(69, 69) = -1.0;
+    try {
+        CholeskyFactorization bad(indefinite);
+        std::cout << "FAIL: indefinite matrix accepted by Cholesky" << std::endl;
+        failures++;
+    } catch(const std::runtime_error&) {
+    }
+
+    // QR: orthonormal Q, QR = A, least squares agrees with the normal equations
+    for(auto [rows, cols] : {std::pair<size_t, size_t>{4, 4}, {50, 3}, {100, 31}, {97, 33}, {300, 120}}) {
+        Matrix A = randomMatrix(rows, cols, rng);
+        QRFactorization qr(A);
+        Matrix Q = qr.Q();
+        Matrix R = qr.R();
+        double orthogonality = maxAbs(Q.view().T() * Q - identity(cols));
+        double reconstruction = maxAbs(Q * R - A);
+        bool upper = true;
+        for(size_t i{}; i < cols; i++) {
+            for(size_t j{}; j < i; j++) {
+                upper = upper && R(i, j) == 0.0;
+            }
+        }
+        Matrix B = randomMatrix(rows, 2, rng);
+        Matrix X = qr.solve(B);
+        Matrix normal = CholeskyFactorization(A.view().T() * A).solve(A.view().T() * B);
+        double lsq = maxAbs(X - normal);
+        std::vector<double> b(rows);
+        for(size_t i{}; i < rows; i++) {
+            b[i] = B(i, 0);
+        }
+        std::vector<double> x = qr.solve(b);
+        double vectorErr = 0;
+        for(size_t i{}; i < cols; i++) {
+            vectorErr = std::max(vectorErr, std::fabs(x[i] - X(i, 0)));
+        }
+        if(orthogonality > 1e-12 || reconstruction > 1e-12 || !upper || lsq > 1e-9 || vectorErr > 1e-12) {
+            std::cout << "FAIL: qr " << rows << "x" << cols << " orthogonality " << orthogonality
+                      << " reconstruction " << reconstruction << " least squares " << lsq << std::endl;
+            failures++;
+        }
+    }
+    Matrix collinear = randomMatrix(20, 3, rng);
+    for(size_t i{}; i < 20; i++) {
+        collinear(i, 2) = collinear(i, 0) - 2.0 * collinear(i, 1);
+    }
+    try {
+        QRFactorization(collinear).solve(std::vector<double>(20, 1.0));
+        std::cout << "FAIL: rank deficient least squares did not throw" << std::endl;
+        failures++;
+    } catch(const std::runtime_error&) {
+    }
+    try {
+        QRFactorization wide(Matrix(2, 3));
+        std::cout << "FAIL: QR accepted a wide matrix" << std::endl;
+        failures++;
+    } catch(const std::invalid_argument&) {
+    }
+
+    // Symmetric eigen: A V = V diag(values), orthonormal V, ascending values
+    Matrix known(3, 3);
+    known(0, 0) = 2; known(0, 1) = -1;
+    known(1, 0) = -1; known(1, 1) = 2; known(1, 2) = -1;
+    known(2, 1) = -1; known(2, 2) = 2;
+    SymmetricEigen small(known);
+    double expected[3] = {2 - std::sqrt(2.0), 2.0, 2 + std::sqrt(2.0)};
+    for(size_t i{}; i < 3; i++) {
+        if(std::fabs(small.values[i] - expected[i]) > 1e-12) {
+            std::cout << "FAIL: eigenvalue " << i << " is " << small.values[i] << " expected " << expected[i] << std::endl;
+            failures++;
+        }
+    }
+    for(size_t n : {1, 2, 3, 10, 65, 200}) {
+        Matrix X = randomMatrix(n, n, rng);
+        Matrix A = X + X.view().T();
+        SymmetricEigen eig(A);
+        Matrix scaled = eig.vectors;
+        for(size_t i{}; i < n; i++) {
+            for(size_t j{}; j < n; j++) {
+                scaled(i, j) *= eig.values[j];
+            }
+        }
+        double residual = maxAbs(A * eig.vectors - scaled);
+        double orthogonality = maxAbs(eig.vectors.view().T() * eig.vectors - identity(n));
+        double reconstruction = maxAbs(eig.reconstruct([](double v) { return v; }) - A);
+        bool sorted = std::is_sorted(eig.values.begin(), eig.values.end());
+        SymmetricEigen valuesOnly(A, false);
+        double valueErr = 0;
+        for(size_t i{}; i < n; i++) {
+            valueErr = std::max(valueErr, std::fabs(valuesOnly.values[i] - eig.values[i]));
+        }
+        if(residual > 1e-10 || orthogonality > 1e-12 || reconstruction > 1e-10 || !sorted || valueErr > 1e-12) {
+            std::cout << "FAIL: eigen n=" << n << " residual " << residual << " orthogonality " << orthogonality
+                      << " reconstruction " << reconstruction << " values " << valueErr << std::endl;
+            failures++;
+        }
+    }
+
+    // The scalar kernels give the same decomposition as the dispatched ones
+    {
+        Matrix X = randomMatrix(90, 90, rng);
+        Matrix A = X + X.view().T();
+        SymmetricEigen wide(A);
+        SimdLevel level = activeSimdLevel();
+        setSimdLevel(SimdLevel::Scalar);
+        SymmetricEigen scalar(A);
+        setSimdLevel(level);
+        double valueErr = 0;
+        for(size_t i{}; i < 90; i++) {
+            valueErr = std::max(valueErr, std::fabs(wide.values[i] - scalar.values[i]));
+        }
+        double residual = maxAbs(scalar.reconstruct([](double v) { return v; }) - A);
+        if(valueErr > 1e-11 || residual > 1e-10) {
+            std::cout << "FAIL: scalar eigen kernels, values " << valueErr << " residual " << residual << std::endl;
+            failures++;
+        }
+    }
+
+    const size_t n = 1000;
+    Matrix A = randomSPD(n, rng);
+    auto start = std::chrono::steady_clock::now();
+    CholeskyFactorization chol(A);
+    double cholSeconds = seconds(start);
+    start = std::chrono::steady_clock::now();
+    QRFactorization qr(A);
+    double qrSeconds = seconds(start);
+    start = std::chrono::steady_clock::now();
+    SymmetricEigen eig(A);
+    double eigSeconds = seconds(start);
+    std::cout << n << "x" << n << " cholesky " << cholSeconds * 1e3 << " ms, qr " << qrSeconds * 1e3
+              << " ms, eigen " << eigSeconds * 1e3 << " ms" << std::endl;
+
+    std::cout << (failures ? "Decomposition tests failed" : "Decomposition tests passed") << std::endl;
+    return failures ? 1 : 0;
+}
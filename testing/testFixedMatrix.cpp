@@ -0,0 +1,83 @@
+#include "fixedMatrix.hpp"
+#include "matrix.hpp"
+#include <cmath>
+#include <iostream>
+#include <type_traits>
+
+constexpr Mat3d scaleMatrix() {
+    Mat3d m = Mat3d::identity();
+    m(0, 0) = 2.0;
+    m(1, 2) = 3.0;
+    return m;
+}
+
+// Products and inverses fold at compile time
+static_assert((scaleMatrix() * Mat3d::identity())(1, 2) == 3.0, "constexpr product");
+static_assert(scaleMatrix().det() == 2.0, "constexpr determinant");
+static_assert(scaleMatrix().inv()(0, 0) == 0.5, "constexpr inverse");
+static_assert(std::is_trivially_copyable<Mat4f>::value && sizeof(Mat4f) == 16 * sizeof(float), "Mat4f is a plain block of 16 floats");
+static_assert(alignof(Mat4f) >= 16, "Mat4f columns are SIMD aligned");
+
+int main() {
+    int failures = 0;
+
+    // Column-major storage: element (row, col) sits at data[col * 4 + row]
+    Mat4f layout;
+    layout(1, 3) = 7.0f;
+    if(layout.ptr()[3 * 4 + 1] != 7.0f) {
+        std::cout << "FAIL: storage is not column-major" << std::endl;
+        failures++;
+    }
+
+    // Matrix::lookAt leaves the side vector unnormalized, so compare with an up vector orthogonal to the view
+    Vec3D eye(3, 0, 5), focus(0, 0, 0), up(0, 1, 0);
+    Matrix reference = Matrix::lookAt(eye, focus, up);
+    Mat4d view = Mat4d::lookAt(eye, focus, up);
+    for(size_t row{}; row < 4; row++) {
+        for(size_t col{}; col < 4; col++) {
+            if(std::fabs(view(row, col) - reference.get(row, col)) > 1e-12) {
+                std::cout << "FAIL: lookAt differs at " << row << "," << col << std::endl;
+                failures++;
+            }
+        }
+    }
+
+    Mat4d product = view * view.inv();
+    Mat4d projection = Mat4d::perspective(M_PI / 4, 4.0 / 3.0, 0.1, 100.0);
+    Mat4d product2 = projection.inv() * projection;
+    for(size_t i{}; i < 16; i++) {
+        double expected = (i % 5 == 0) ? 1.0 : 0.0;
+        if(std::fabs(product.data[i] - expected) > 1e-12 || std::fabs(product2.data[i] - expected) > 1e-9) {
+            std::cout << "FAIL: inverse at flat index " << i << std::endl;
+            failures++;
+        }
+    }
+
+    Mat4d general;
+    for(size_t i{}; i < 16; i++) {
+        general.data[i] = std::sin(double(i) * 1.3) + (i % 5 == 0 ? 3.0 : 0.0);
+    }
+    Matrix dynamic(4, 4);
+    for(size_t row{}; row < 4; row++) {
+        for(size_t col{}; col < 4; col++) {
+            dynamic(row, col) = general(row, col);
+        }
+    }
+    if(std::fabs(general.det() - dynamic.det()) > 1e-10) {
+        std::cout << "FAIL: 4x4 determinant " << general.det() << " vs " << dynamic.det() << std::endl;
+        failures++;
+    }
+    Matrix dynamicInverse = dynamic.inv();
+    Mat4d fixedInverse = general.inv();
+    for(size_t row{}; row < 4; row++) {
+        for(size_t col{}; col < 4; col++) {
+            if(std::fabs(fixedInverse(row, col) - dynamicInverse(row, col)) > 1e-10) {
+                std::cout << "FAIL: 4x4 inverse at " << row << "," << col << std::endl;
+                failures++;
+            }
+        }
+    }
+
+    std::cout << (failures ? "FixedMatrix tests failed" : "FixedMatrix tests passed") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,115 @@
+#include "matrix.hpp"
+#include "gemm.hpp"
+#include "cpuFeatures.hpp"
+#include "threadPool.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+static Matrix randomMatrix(size_t rows, size_t columns, std::mt19937& rng) {
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    Matrix mat(rows, columns);
+    for(double& value : mat.data) {
+        value = dist(rng);
+    }
+    return mat;
+}
+
+static double maxError(const Matrix& a, const Matrix& b) {
+    double err = 0;
+    for(size_t i{}; i < a.data.size(); i++) {
+        err = std::max(err, std::fabs(a.data[i] - b.data[i]));
+    }
+    return err;
+}
+
+int main() {
+    std::mt19937 rng(42);
+    int failures = 0;
+    const SimdLevel levels[] = {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512};
+    const size_t sizes[][3] = {{1, 1, 1}, {3, 5, 7}, {17, 33, 9}, {64, 64, 64}, {130, 75, 300}, {257, 129, 513}};
+
+    for(SimdLevel level : levels) {
+        setSimdLevel(level);
+        for(const auto& s : sizes) {
+            Matrix A = randomMatrix(s[0], s[2], rng);
+            Matrix B = randomMatrix(s[2], s[1], rng);
+            Matrix fast = A * B;
+            Matrix ref(s[0], s[1]);
+            gemmNaive(s[0], s[1], s[2], 1.0, A.data.data(), s[2], 1, B.data.data(), s[1], 1, 0.0, ref.data.data(), s[1]);
+            double err = maxError(fast, ref);
+            if(err > 1e-9 * s[2]) {
+                std::cout << "FAIL " << simdLevelName(activeSimdLevel()) << " " << s[0] << "x" << s[2] << "*" << s[2] << "x" << s[1] << " err " << err << std::endl;
+                failures++;
+            }
+
+            // A^T * B through strides, accumulated into C with alpha/beta
+            Matrix At = randomMatrix(s[2], s[0], rng);
+            Matrix C = randomMatrix(s[0], s[1], rng);
+            Matrix Cref = C;
+            gemm(s[0], s[1], s[2], 0.5, At.data.data(), 1, s[0], B.data.data(), s[1], 1, 2.0, C.data.data(), s[1]);
+            gemmNaive(s[0], s[1], s[2], 0.5, At.data.data(), 1, s[0], B.data.data(), s[1], 1, 2.0, Cref.data.data(), s[1]);
+            err = maxError(C, Cref);
+            if(err > 1e-9 * s[2]) {
+                std::cout << "FAIL strided " << simdLevelName(activeSimdLevel()) << " err " << err << std::endl;
+                failures++;
+            }
+        }
+
+        // Bit-identical whatever the thread count, and whichever register tile a row falls in
+        Matrix A = randomMatrix(301, 257, rng);
+        Matrix B = randomMatrix(257, 203, rng);
+        Matrix C = randomMatrix(301, 203, rng);
+        Matrix one = C;
+        ThreadPool::setGlobalThreadCount(1);
+        gemm(0.7, A, B, 1.3, one);
+        for(size_t threads : {2, 4, 7}) {
+            ThreadPool::setGlobalThreadCount(threads);
+            Matrix many = C;
+            gemm(0.7, A, B, 1.3, many);
+            if(many.data != one.data) {
+                std::cout << "FAIL " << simdLevelName(activeSimdLevel()) << " GEMM differs between 1 and " << threads << " threads" << std::endl;
+                failures++;
+            }
+        }
+        ThreadPool::setGlobalThreadCount(ThreadPool::defaultThreadCount());
+        Matrix shifted(300, 203);
+        std::copy(C.data.begin() + 203, C.data.end(), shifted.data.begin());
+        gemm(300, 203, 257, 0.7, A.data.data() + 257, 257, 1, B.data.data(), 203, 1, 1.3, shifted.data.data(), 203);
+        if(!std::equal(shifted.data.begin(), shifted.data.end(), one.data.begin() + 203)) {
+            std::cout << "FAIL " << simdLevelName(activeSimdLevel()) << " GEMM rows depend on the tile boundaries" << std::endl;
+            failures++;
+        }
+
+        MatrixF Af(A), Bf(B), Cf(C);
+        MatrixF oneF = Cf;
+        ThreadPool::setGlobalThreadCount(1);
+        gemm(0.7f, Af, Bf, 1.3f, oneF);
+        ThreadPool::setGlobalThreadCount(4);
+        gemm(0.7f, Af, Bf, 1.3f, Cf);
+        ThreadPool::setGlobalThreadCount(ThreadPool::defaultThreadCount());
+        if(Cf.data != oneF.data) {
+            std::cout << "FAIL " << simdLevelName(activeSimdLevel()) << " float GEMM differs between 1 and 4 threads" << std::endl;
+            failures++;
+        }
+    }
+    setSimdLevel(detectSimdLevel());
+
+    const size_t n = 512;
+    Matrix A = randomMatrix(n, n, rng);
+    Matrix B = randomMatrix(n, n, rng);
+    Matrix ref(n, n);
+    auto start = std::chrono::steady_clock::now();
+    gemmNaive(n, n, n, 1.0, A.data.data(), n, 1, B.data.data(), n, 1, 0.0, ref.data.data(), n);
+    double naive = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    Matrix fast = A * B;
+    double blocked = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double flops = 2.0 * n * n * n;
+    std::cout << n << "x" << n << " GEMM (" << simdLevelName(activeSimdLevel()) << "): naive "
+              << flops / naive * 1e-9 << " GFLOP/s, blocked " << flops / blocked * 1e-9 << " GFLOP/s" << std::endl;
+
+    std::cout << (failures ? "GEMM tests failed" : "GEMM tests passed") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,149 @@
+#include "islands.hpp"
+#include "physicsWorld.hpp"
+#include "threadPool.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+static int failures = 0;
+
+static void expect(bool ok, const std::string& what) {
+    if(!ok) {
+        std::cout << "FAIL: " << what << std::endl;
+        failures++;
+    }
+}
+
+static bool identical(const Vec3DBatch& a, const Vec3DBatch& b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+// Spheres dropped from up to height into a box of the given half width, in clumps that settle into separate piles
+static PhysicsWorld pile(size_t count, double half, double height, std::mt19937& rng) {
+    WorldSettings settings;
+    settings.boundsMin = Vec3D(-half, 0, -half);
+    settings.boundsMax = Vec3D(half, 40, half);
+    PhysicsWorld world(settings);
+    std::uniform_real_distribution<double> clump(-half + 2, half - 2), spread(-1.5, 1.5), up(1, height), speed(-1, 1);
+    Vec3D centre;
+    for(size_t i{}; i < count; i++) {
+        if(i % 200 == 0) {
+            centre = Vec3D(clump(rng), 0, clump(rng));
+        }
+        Vec3D p = centre + Vec3D(spread(rng), up(rng), spread(rng));
+        if(i % 3 == 0) {
+            world.bodies.add(p, Vec3D(speed(rng), 0, speed(rng)), 2.0, 0.3, Vec3D(0, speed(rng), 0));
+        } else {
+            world.particles.add(p, Vec3D(speed(rng), 0, speed(rng)), 1.0, 0.25);
+        }
+    }
+    return world;
+}
+
+int main() {
+    std::mt19937 rng(25);
+
+    // Union-find groups bodies joined through each other, numbered by first pair and listed largest first
+    {
+        ContactIslands islands;
+        std::vector<CandidatePair> pairs = {{5, 6}, {0, 1}, {2, 3}, {1, 2}, {7, 8}, {3, 4}, {6, 9}};
+        islands.build(11, pairs);
+        expect(islands.size() == 3, "island count " + std::to_string(islands.size()));
+        std::vector<uint32_t> first(islands.pairsBegin(0), islands.pairsEnd(0)), second(islands.pairsBegin(1), islands.pairsEnd(1));
+        expect(first == std::vector<uint32_t>{0, 6} && second == std::vector<uint32_t>{1, 2, 3, 5},
+               "islands keep their pairs in order");
+        expect(islands.order() == std::vector<uint32_t>{1, 0, 2}, "islands ordered largest first, then by number");
+        expect(islands.packedBodies() == std::vector<uint32_t>{5, 6, 9, 0, 1, 2, 3, 4, 7, 8} && islands.bodyStart(1) == 3 &&
+                   islands.bodyStart(3) == 10 && islands.packedIndex(2) == 5,
+               "island bodies packed in order of appearance");
+
+        islands.build(11, {});
+        expect(islands.size() == 0 && islands.order().empty(), "no pairs, no islands");
+        try {
+            islands.build(4, pairs);
+            expect(false, "pair beyond the bodies accepted");
+        } catch(const std::out_of_range&) {
+        }
+    }
+
+    // Separate clusters in contact make one island each; a lone sphere makes none
+    {
+        WorldSettings settings;
+        settings.gravity = Vec3D();
+        PhysicsWorld world(settings);
+        for(size_t cluster{}; cluster < 3; cluster++) {
+            for(size_t i{}; i < 4; i++) {
+                world.particles.add(Vec3D(10.0 * double(cluster) + 0.9 * double(i), 0, 0), Vec3D(), 1.0, 0.5);
+            }
+        }
+        world.bodies.add(Vec3D(0, 10, 0), Vec3D(), 1.0, 0.5);
+        world.bodies.add(Vec3D(3.5, 0, 0), Vec3D(), 1.0, 0.5);
+        world.step();
+        expect(world.islandCount() == 3 && world.contactCount() == 10,
+               "islands " + std::to_string(world.islandCount()) + ", contacts " + std::to_string(world.contactCount()));
+    }
+
+    // A resting stack: the impulses pass the weight down the column so nothing sinks or bounces
+    {
+        WorldSettings settings;
+        settings.boundsMin = Vec3D(-5, 0, -5);
+        settings.boundsMax = Vec3D(5, 20, 5);
+        settings.contactIterations = 10;
+        PhysicsWorld world(settings);
+        for(size_t i{}; i < 6; i++) {
+            world.particles.add(Vec3D(0, 0.5 + double(i), 0), Vec3D(), 1.0, 0.5);
+        }
+        for(size_t s{}; s < 600; s++) {
+            world.step();
+        }
+        double top = world.particles.position.y[5], fastest = 0;
+        for(size_t i{}; i < 6; i++) {
+            fastest = std::max(fastest, world.particles.velocity.get(i).magnitude());
+        }
+        expect(top > 5.4 && top < 5.5001 && fastest < 0.2 && world.islandCount() == 1,
+               "stack top at " + std::to_string(top) + ", fastest " + std::to_string(fastest));
+    }
+
+    // Bit-identical piles whatever the thread count
+    {
+        std::mt19937 first(5), second(5);
+        PhysicsWorld one = pile(3000, 12, 30, first), many = pile(3000, 12, 30, second);
+        size_t largest = 0;
+        for(size_t s{}; s < 400; s++) {
+            ThreadPool::setGlobalThreadCount(1);
+            one.step();
+            ThreadPool::setGlobalThreadCount(s % 2 == 0 ? 4 : 7);
+            many.step();
+            largest = std::max(largest, many.islandCount());
+        }
+        ThreadPool::setGlobalThreadCount(ThreadPool::defaultThreadCount());
+        expect(identical(one.particles.position, many.particles.position) && identical(one.particles.velocity, many.particles.velocity) &&
+                   identical(one.bodies.linear.position, many.bodies.linear.position) &&
+                   identical(one.bodies.angularVelocity, many.bodies.angularVelocity),
+               "thread count changes the simulation");
+        expect(one.contactCount() == many.contactCount() && one.islandCount() == many.islandCount() && largest > 1,
+               "contacts " + std::to_string(many.contactCount()) + ", islands " + std::to_string(many.islandCount()));
+    }
+
+    // Throughput on many small islands
+    {
+        const size_t n = 50000;
+        PhysicsWorld world = pile(n, 30, 8, rng);
+        for(size_t s{}; s < 120; s++) {
+            world.step();
+        }
+        const size_t steps = 20;
+        auto start = std::chrono::steady_clock::now();
+        for(size_t s{}; s < steps; s++) {
+            world.step();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / double(steps);
+        expect(world.contactCount() > n / 2, "settled piles have too few contacts to be a useful test");
+        std::cout << n << " bodies in piles: " << world.contactCount() << " contacts in " << world.islandCount() << " islands, "
+                  << seconds * 1e3 << " ms per step (" << ThreadPool::global().threadCount() << " threads)" << std::endl;
+    }
+
+    std::cout << (failures ? "Island tests failed" : "Island tests passed") << std::endl;
+    return failures ? 1 : 0;
+}
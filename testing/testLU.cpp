@@ -0,0 +1,171 @@
+#include "matrix.hpp"
+#include "luFactorization.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+static double maxAbs(const Matrix& mat) {
+    double m = 0;
+    for(double v : mat.data) {
+        m = std::max(m, std::fabs(v));
+    }
+    return m;
+}
+
+static Matrix identity(size_t n) {
+    Matrix I(n, n);
+    for(size_t i{}; i < n; i++) {
+        I(i, i) = 1.0;
+    }
+    return I;
+}
+
+int main() {
+    int failures = 0;
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+    // Zero leading pivot: the unpivoted LU_Decomposition rejects this, partial pivoting does not
+    Matrix P(3, 3);
+    P(0, 1) = 2; P(0, 2) = 1;
+    P(1, 0) = 1; P(1, 1) = 1; P(1, 2) = 1;
+    P(2, 0) = 3; P(2, 2) = 4;
+    LUFactorization lu(P);
+    double expected = 0 * (4 - 0) - 2 * (4 - 3) + 1 * (0 - 3);
+    if(std::fabs(lu.det() - expected) > 1e-12 || std::fabs(P.det() - expected) > 1e-12) {
+        std::cout << "FAIL: det " << lu.det() << " expected " << expected << std::endl;
+        failures++;
+    }
+    std::vector<double> x = lu.solve({3, 3, 7});
+    std::vector<double> b = {3, 3, 7};
+    for(size_t i{}; i < 3; i++) {
+        double r = 0;
+        for(size_t j{}; j < 3; j++) {
+            r += P(i, j) * x[j];
+        }
+        if(std::fabs(r - b[i]) > 1e-12) {
+            std::cout << "FAIL: solve residual " << r - b[i] << std::endl;
+            failures++;
+        }
+    }
+
+    // Small cases against the cofactor definition
+    Matrix small(2, 2);
+    small(0, 0) = 4; small(0, 1) = 7; small(1, 0) = 2; small(1, 1) = 6;
+    Matrix adj = small.adj();
+    if(std::fabs(adj(0, 0) - 6) > 1e-12 || std::fabs(adj(0, 1) + 7) > 1e-12 ||
+       std::fabs(adj(1, 0) + 2) > 1e-12 || std::fabs(adj(1, 1) - 4) > 1e-12) {
+        std::cout << "FAIL: adjugate" << std::endl;
+        adj.print();
+        failures++;
+    }
+
+    Matrix singular(3, 3);
+    for(size_t i{}; i < 9; i++) {
+        singular.data[i] = double(i + 1);
+    }
+    if(singular.det() != 0.0 || !LUFactorization(singular).singular) {
+        std::cout << "FAIL: singular matrix not detected" << std::endl;
+        failures++;
+    }
+    try {
+        singular.inv();
+        std::cout << "FAIL: inverting a singular matrix did not throw" << std::endl;
+        failures++;
+    } catch(const std::runtime_error&) {
+    }
+
+    // Badly scaled diagonals are regular: pivots are judged against their own row and column, not the largest entry
+    {
+        Matrix wide(2, 2);
+        wide(0, 0) = 1e20;
+        wide(1, 1) = 1;
+        LUFactorization scaled(wide);
+        std::vector<double> y = scaled.solve({1e20, 1});
+        if(scaled.singular || wide.det() != 1e20 || std::fabs(y[0] - 1) > 1e-15 || std::fabs(y[1] - 1) > 1e-15) {
+            std::cout << "FAIL: diag(1e20, 1) det " << wide.det() << std::endl;
+            failures++;
+        }
+        Matrix inverse = wide.inv();
+        if(inverse(0, 0) != 1e-20 || inverse(1, 1) != 1) {
+            std::cout << "FAIL: inverse of diag(1e20, 1)" << std::endl;
+            failures++;
+        }
+        Matrix spread(3, 3);
+        spread(0, 0) = 1e10;
+        spread(1, 1) = 1e-6;
+        spread(2, 2) = 1;
+        if(std::fabs(spread.det() - 1e4) > 1e4 * 1e-15) {
+            std::cout << "FAIL: diag(1e10, 1e-6, 1) det " << spread.det() << std::endl;
+            failures++;
+        }
+    }
+
+    for(size_t n : {1, 5, 63, 64, 65, 200}) {
+        Matrix A(n, n);
+        for(double& v : A.data) {
+            v = dist(rng);
+        }
+        LUFactorization f(A);
+        double err = maxAbs(A * f.inverse() - identity(n));
+        Matrix B(n, 7);
+        for(double& v : B.data) {
+            v = dist(rng);
+        }
+        double residual = maxAbs(A * f.solve(B) - B);
+        if(err > 1e-8 || residual > 1e-8) {
+            std::cout << "FAIL: n=" << n << " inverse err " << err << " solve residual " << residual << std::endl;
+            failures++;
+        }
+    }
+
+    // Several right hand sides go through blocked substitution; each column must match solving it alone,
+    // including across the edges of the 64-row blocks
+    for(size_t n : {63, 64, 65, 128, 129, 300}) {
+        Matrix A(n, n);
+        for(double& v : A.data) {
+            v = dist(rng);
+        }
+        LUFactorization f(A);
+        for(size_t m : {2, 65}) {
+            Matrix B(n, m);
+            for(double& v : B.data) {
+                v = dist(rng);
+            }
+            Matrix X = f.solve(B);
+            double worst = 0, scale = 0;
+            for(size_t c{}; c < m; c++) {
+                std::vector<double> b(n);
+                for(size_t i{}; i < n; i++) {
+                    b[i] = B(i, c);
+                }
+                std::vector<double> x = f.solve(b);
+                for(size_t i{}; i < n; i++) {
+                    worst = std::max(worst, std::fabs(X(i, c) - x[i]));
+                    scale = std::max(scale, std::fabs(x[i]));
+                }
+            }
+            double residual = maxAbs(A * X - B);
+            if(worst > 1e-11 * scale || residual > 1e-8) {
+                std::cout << "FAIL: blocked solve n=" << n << " m=" << m << " differs by " << worst << ", residual " << residual
+                          << std::endl;
+                failures++;
+            }
+        }
+    }
+
+    const size_t n = 500;
+    Matrix A(n, n);
+    for(double& v : A.data) {
+        v = dist(rng);
+    }
+    auto start = std::chrono::steady_clock::now();
+    Matrix inverse = A.inv();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << n << "x" << n << " inverse in " << seconds * 1e3 << " ms, residual "
+              << maxAbs(A * inverse - identity(n)) << std::endl;
+
+    std::cout << (failures ? "LU tests failed" : "LU tests passed") << std::endl;
+    return failures ? 1 : 0;
+}
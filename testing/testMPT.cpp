@@ -0,0 +1,120 @@
+#include "ModernPortfolioTheory.hpp"
+#include "returnsFixture.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+static double sum(const std::vector<double>& v) {
+    double s = 0;
+    for(double x : v) {
+        s += x;
+    }
+    return s;
+}
+
+int main() {
+    int failures = 0;
+
+    // Two uncorrelated assets: minimum variance weights are proportional to 1 / variance
+    Matrix cov2(2, 2);
+    cov2(0, 0) = 0.04; cov2(1, 1) = 0.01;
+    ModernPortfolioTheory small({0.10, 0.05}, cov2, 0.01);
+    Portfolio mv = small.minimumVariance();
+    if(std::fabs(mv.weights[0] - 0.2) > 1e-12 || std::fabs(mv.weights[1] - 0.8) > 1e-12) {
+        std::cout << "FAIL: two asset minimum variance " << mv.weights[0] << " " << mv.weights[1] << std::endl;
+        failures++;
+    }
+
+    Matrix R = makeReturns(500, 40, 11);
+    ModernPortfolioTheory mpt(R, 0.0001);
+
+    // Covariance against the textbook double loop
+    std::vector<double> mean = ModernPortfolioTheory::sampleMean(R);
+    double covError = 0;
+    for(size_t i{}; i < 40; i++) {
+        for(size_t j{}; j < 40; j++) {
+            double s = 0;
+            for(size_t t{}; t < 500; t++) {
+                s += (R(t, i) - mean[i]) * (R(t, j) - mean[j]);
+            }
+            covError = std::max(covError, std::fabs(s / 499 - mpt.covariance(i, j)));
+        }
+    }
+    if(covError > 1e-14) {
+        std::cout << "FAIL: sample covariance error " << covError << std::endl;
+        failures++;
+    }
+
+    Portfolio minVar = mpt.minimumVariance();
+    Portfolio tangent = mpt.tangency();
+    if(std::fabs(sum(minVar.weights) - 1) > 1e-10 || std::fabs(sum(tangent.weights) - 1) > 1e-10) {
+        std::cout << "FAIL: weights do not sum to one" << std::endl;
+        failures++;
+    }
+    if(std::fabs(mpt.portfolioVariance(minVar.weights) - minVar.volatility * minVar.volatility) > 1e-12) {
+        std::cout << "FAIL: closed form variance disagrees with w' Sigma w" << std::endl;
+        failures++;
+    }
+
+    std::vector<Portfolio> frontier = mpt.efficientFrontier(50);
+    double bestSharpe = -1e300;
+    for(const Portfolio& p : frontier) {
+        if(p.volatility < minVar.volatility - 1e-12) {
+            std::cout << "FAIL: frontier point below minimum variance" << std::endl;
+            failures++;
+            break;
+        }
+        double direct = std::sqrt(mpt.portfolioVariance(p.weights));
+        if(std::fabs(direct - p.volatility) > 1e-10) {
+            std::cout << "FAIL: frontier volatility " << p.volatility << " vs " << direct << std::endl;
+            failures++;
+            break;
+        }
+        bestSharpe = std::max(bestSharpe, p.sharpe);
+    }
+    if(bestSharpe > tangent.sharpe + 1e-12) {
+        std::cout << "FAIL: frontier Sharpe " << bestSharpe << " beats tangency " << tangent.sharpe << std::endl;
+        failures++;
+    }
+    Portfolio target = mpt.targetReturn(tangent.expectedReturn);
+    if(std::fabs(target.volatility - tangent.volatility) > 1e-12) {
+        std::cout << "FAIL: tangency is not on the frontier" << std::endl;
+        failures++;
+    }
+
+    // No assets, or a covariance of the wrong size, is rejected up front
+    {
+        const char* cases[] = {"empty returns", "empty means", "mismatched covariance"};
+        for(size_t c{}; c < 3; c++) {
+            try {
+                if(c == 0) {
+                    ModernPortfolioTheory none(Matrix(10, 0));
+                } else if(c == 1) {
+                    ModernPortfolioTheory none(std::vector<double>{}, Matrix(0, 0));
+                } else {
+                    ModernPortfolioTheory none(std::vector<double>{0.01, 0.02}, Matrix(3, 3));
+                }
+                std::cout << "FAIL: " << cases[c] << " accepted" << std::endl;
+                failures++;
+            } catch(const std::invalid_argument&) {
+            }
+        }
+    }
+
+    Matrix large = makeReturns(1500, 1000, 5);
+    auto start = std::chrono::steady_clock::now();
+    ModernPortfolioTheory big(large);
+    auto built = std::chrono::steady_clock::now();
+    std::vector<Portfolio> bigFrontier = big.efficientFrontier(200);
+    auto traced = std::chrono::steady_clock::now();
+    std::cout << "1000 assets: covariance + factorization "
+              << std::chrono::duration<double, std::milli>(built - start).count() << " ms, 200 point frontier "
+              << std::chrono::duration<double, std::milli>(traced - built).count() << " ms" << std::endl;
+
+    if(failures == 0) {
+        std::cout << "All MPT tests passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -1,4 +1,4 @@
-#include "../Math Algorithms/matrix.hpp"
+#include "matrix.hpp"
 #include <iostream>
 
 int main() {
@@ -0,0 +1,100 @@
+#include "matrix.hpp"
+#include <cfloat>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    if(void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+// Matrix storage comes through the aligned overloads
+void* operator new(size_t size, std::align_val_t alignment) {
+    allocations++;
+    size_t a = size_t(alignment);
+    if(void* p = std::aligned_alloc(a, (size + a - 1) / a * a)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+static Matrix filled(size_t rows, size_t columns, double start) {
+    Matrix mat(rows, columns);
+    for(size_t i{}; i < mat.data.size(); i++) {
+        mat.data[i] = start + double(i);
+    }
+    return mat;
+}
+
+int main() {
+    int failures = 0;
+    Matrix A = filled(3, 4, 1.0);
+    Matrix B = filled(3, 4, 10.0);
+    Matrix C = filled(3, 4, -5.0);
+
+    Matrix D = A + B * 2.0 - C;
+    for(size_t i{}; i < D.data.size(); i++) {
+        if(D.data[i] != A.data[i] + 2.0 * B.data[i] - C.data[i]) {
+            std::cout << "FAIL: fused expression at " << i << std::endl;
+            failures++;
+        }
+    }
+
+    // Reassigning into an existing matrix of the right shape is one pass and no allocation
+    allocations = 0;
+    D = 0.5 * (A - C) + B;
+    if(allocations != 0) {
+        std::cout << "FAIL: expression assignment allocated " << allocations << " times" << std::endl;
+        failures++;
+    }
+    if(D.get(2, 3) != 0.5 * (A.get(2, 3) - C.get(2, 3)) + B.get(2, 3)) {
+        std::cout << "FAIL: scaled difference" << std::endl;
+        failures++;
+    }
+
+    // Operands may alias the destination
+    Matrix E = A;
+    E = B + E * 3.0;
+    E -= A + A;
+    if(E.get(1, 1) != B.get(1, 1) + A.get(1, 1)) {
+        std::cout << "FAIL: aliased assignment" << std::endl;
+        failures++;
+    }
+
+    // Expression results still offer the Matrix API
+    Matrix square = filled(2, 2, 1.0);
+    if((square + square).det() != 4.0 * square.det() || (A + B).T().rows != 4 || (A - B).get(0, 0) != -9.0) {
+        std::cout << "FAIL: forwarded Matrix methods" << std::endl;
+        failures++;
+    }
+    Matrix product = (A + B) * (A - C).T();
+    if(product.rows != 3 || product.columns != 3) {
+        std::cout << "FAIL: expression product shape" << std::endl;
+        failures++;
+    }
+
+    try {
+        Matrix bad = A + filled(4, 3, 0.0);
+        std::cout << "FAIL: mismatched dimensions accepted" << std::endl;
+        failures++;
+    } catch(const std::invalid_argument&) {
+    }
+    try {
+        Matrix huge = filled(1, 1, DBL_MAX / 2) * -4.0;
+        std::cout << "FAIL: overflow not detected" << std::endl;
+        failures++;
+    } catch(const std::overflow_error&) {
+    }
+
+    std::cout << (failures ? "Matrix expression tests failed" : "Matrix expression tests passed") << std::endl;
+    return failures ? 1 : 0;
+}
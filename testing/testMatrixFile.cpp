@@ -0,0 +1,115 @@
+#include "matrixFile.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+
+int main() {
+    int failures = 0;
+    const std::string path = "/tmp/testMatrixFile.qmat";
+
+    Matrix A(37, 13);
+    for(size_t i{}; i < A.rows; i++) {
+        for(size_t j{}; j < A.columns; j++) {
+            A(i, j) = std::sin(double(i * 31 + j)) * 1e3;
+        }
+    }
+    writeMatrixFile(path, A);
+    {
+        MappedMatrix view(path);
+        if(view.rows != A.rows || view.columns != A.columns || view.dtype != MatrixDType::Float64) {
+            std::cout << "FAIL: header round trip" << std::endl;
+            failures++;
+        }
+        if(reinterpret_cast<uintptr_t>(view.doubles()) % MATRIX_FILE_ALIGNMENT != 0) {
+            std::cout << "FAIL: element block is not aligned" << std::endl;
+            failures++;
+        }
+        if(view(36, 12) != A(36, 12) || readMatrixFile(path).data != A.data) {
+            std::cout << "FAIL: float64 values changed on the round trip" << std::endl;
+            failures++;
+        }
+    }
+
+    writeMatrixFile(path, A, MatrixDType::Float32);
+    Matrix narrow = readMatrixFile(path);
+    double error = 0;
+    for(size_t i{}; i < A.data.size(); i++) {
+        error = std::max(error, std::fabs(narrow.data[i] - A.data[i]) / std::max(1.0, std::fabs(A.data[i])));
+    }
+    if(error > 1e-6) {
+        std::cout << "FAIL: float32 round trip error " << error << std::endl;
+        failures++;
+    }
+
+    // Streaming writer: rows arrive in pieces, the header learns the row count at close
+    {
+        MatrixFileWriter writer(path, A.columns);
+        writer.appendRow(&A.unchecked(0, 0));
+        Matrix rest(A.rows - 1, A.columns);
+        std::copy(A.data.begin() + A.columns, A.data.end(), rest.data.begin());
+        writer.appendRows(rest);
+    }
+    if(readMatrixFile(path).data != A.data) {
+        std::cout << "FAIL: streamed file differs" << std::endl;
+        failures++;
+    }
+
+    std::FILE* junk = std::fopen(path.c_str(), "wb");
+    std::fputs("definitely not a matrix file, but long enough to hold a header.....", junk);
+    std::fclose(junk);
+    try {
+        MappedMatrix bad(path);
+        std::cout << "FAIL: garbage file accepted" << std::endl;
+        failures++;
+    } catch(const std::invalid_argument&) {}
+
+    // A corrupt header pointing the elements off their alignment is rejected rather than read through a misaligned pointer
+    writeMatrixFile(path, A);
+    {
+        std::FILE* patch = std::fopen(path.c_str(), "r+b");
+        uint64_t offset = MATRIX_FILE_ALIGNMENT + 4;
+        std::fseek(patch, long(offsetof(MatrixFileHeader, dataOffset)), SEEK_SET);
+        std::fwrite(&offset, sizeof(offset), 1, patch);
+        // Room for the shifted elements, so the size check alone would pass
+        std::fseek(patch, 0, SEEK_END);
+        std::fwrite(&offset, sizeof(offset), 1, patch);
+        std::fclose(patch);
+    }
+    try {
+        MappedMatrix bad(path);
+        std::cout << "FAIL: misaligned element block accepted" << std::endl;
+        failures++;
+    } catch(const std::invalid_argument& e) {
+        if(std::string(e.what()).find("misaligned") == std::string::npos) {
+            std::cout << "FAIL: misaligned file rejected for the wrong reason: " << e.what() << std::endl;
+            failures++;
+        }
+    }
+
+    // Opening is independent of size: a 200 MB panel maps as fast as a small one
+    {
+        MatrixFileWriter writer(path, 1000);
+        Matrix block(1000, 1000);
+        for(size_t b{}; b < 25; b++) {
+            block(0, 0) = double(b);
+            writer.appendRows(block);
+        }
+    }
+    auto start = std::chrono::steady_clock::now();
+    MappedMatrix big(path);
+    double openMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if(big.rows != 25000 || big(24000, 0) != 24.0) {
+        std::cout << "FAIL: large streamed file" << std::endl;
+        failures++;
+    }
+    std::cout << "Mapped " << big.rows << " x " << big.columns << " in " << openMs << " ms" << std::endl;
+    std::remove(path.c_str());
+
+    if(failures == 0) {
+        std::cout << "All matrix file tests passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+#include "matrix.hpp"
+#include "gemm.hpp"
+#include "luFactorization.hpp"
+#include <cmath>
+#include <iostream>
+#include <random>
+
+static double maxDifference(const Matrix& a, const Matrix& b) {
+    double m = 0;
+    for(size_t i{}; i < a.data.size(); i++) {
+        m = std::max(m, std::fabs(a.data[i] - b.data[i]));
+    }
+    return m;
+}
+
+int main() {
+    int failures = 0;
+    std::mt19937 rng(29);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+    Matrix A(40, 30);
+    for(double& v : A.data) {
+        v = dist(rng);
+    }
+
+    // Block, row, column and transpose all alias the parent storage
+    ConstMatrixView block = A.block(5, 7, 10, 12);
+    if(&block(0, 0) != &A(5, 7) || &block.T()(3, 2) != &A(7, 10) || &A.view().col(4)(9, 0) != &A(9, 4)) {
+        std::cout << "FAIL: views do not alias the matrix" << std::endl;
+        failures++;
+    }
+    if(block.row(2).columns != 12 || block.col(2).rows != 10 || block.contiguous() || !A.view().contiguous()) {
+        std::cout << "FAIL: view shapes" << std::endl;
+        failures++;
+    }
+
+    // Materializing a block matches element-by-element extraction
+    Matrix copied = block;
+    Matrix expected(10, 12);
+    for(size_t i{}; i < 10; i++) {
+        for(size_t j{}; j < 12; j++) {
+            expected(i, j) = A(5 + i, 7 + j);
+        }
+    }
+    if(maxDifference(copied, expected) != 0.0) {
+        std::cout << "FAIL: block copy" << std::endl;
+        failures++;
+    }
+
+    // Products of views: A^T A on the transposed view against the copying path
+    Matrix gram = A.view().T() * A;
+    Matrix reference = A.T() * A;
+    if(maxDifference(gram, reference) > 1e-13) {
+        std::cout << "FAIL: product through a transposed view " << maxDifference(gram, reference) << std::endl;
+        failures++;
+    }
+    Matrix blockProduct = block * A.block(0, 0, 12, 5);
+    Matrix blockReference = expected * Matrix(A.block(0, 0, 12, 5));
+    if(maxDifference(blockProduct, blockReference) > 1e-13) {
+        std::cout << "FAIL: product of blocks" << std::endl;
+        failures++;
+    }
+
+    // gemm into a window of a bigger matrix and into a transposed window
+    Matrix C(50, 50);
+    gemm(1.0, block, A.block(0, 0, 12, 5), 0.0, C.block(3, 4, 10, 5));
+    gemm(1.0, block, A.block(0, 0, 12, 5), 0.0, C.block(20, 20, 5, 10).T());
+    double windowError = 0;
+    for(size_t i{}; i < 10; i++) {
+        for(size_t j{}; j < 5; j++) {
+            windowError = std::max(windowError, std::fabs(C(3 + i, 4 + j) - blockReference(i, j)));
+            windowError = std::max(windowError, std::fabs(C(20 + j, 20 + i) - blockReference(i, j)));
+        }
+    }
+    if(windowError > 1e-13 || C(2, 4) != 0.0 || C(13, 4) != 0.0) {
+        std::cout << "FAIL: gemm into views " << windowError << std::endl;
+        failures++;
+    }
+
+    // Writing through a view only touches the window
+    Matrix D(6, 6);
+    D.block(1, 1, 2, 3) = expected.block(0, 0, 2, 3) * 2.0;
+    D.view().col(5).fill(7.0);
+    if(D(1, 1) != 2.0 * expected(0, 0) || D(2, 3) != 2.0 * expected(1, 2) || D(0, 0) != 0.0 || D(3, 5) != 7.0) {
+        std::cout << "FAIL: assignment through a view" << std::endl;
+        failures++;
+    }
+
+    // Assigning a view of the destination to it reads the old contents, whether or not the shape changes
+    {
+        Matrix C(2, 3);
+        for(size_t i{}; i < 6; i++) {
+            C.data[i] = double(i + 1);
+        }
+        Matrix expected = C.T();
+        C = C.view().T();
+        if(C.rows != 3 || C.columns != 2 || maxDifference(C, expected) != 0) {
+            std::cout << "FAIL: C = C.view().T()" << std::endl;
+            failures++;
+        }
+        Matrix S = A.block(0, 0, 6, 6);
+        Matrix flipped = Matrix(S.view().T()) + S * 2.0;
+        S = S.view().T() + S * 2.0;
+        if(maxDifference(S, flipped) != 0) {
+            std::cout << "FAIL: square transpose of the destination in an expression" << std::endl;
+            failures++;
+        }
+        Matrix R = A.block(0, 0, 4, 5);
+        Matrix shifted = R.block(1, 1, 3, 4);
+        R = R.block(1, 1, 3, 4);
+        if(R.rows != 3 || R.columns != 4 || maxDifference(R, shifted) != 0) {
+            std::cout << "FAIL: block of the destination" << std::endl;
+            failures++;
+        }
+    }
+
+    // LU straight from a sub-block: the leading 20 x 20 of A, factored without slicing it out first
+    ConstMatrixView leading = A.block(0, 0, 20, 20);
+    LUFactorization lu(leading);
+    Matrix identity = Matrix(leading) * lu.inverse();
+    double identityError = 0;
+    for(size_t i{}; i < 20; i++) {
+        for(size_t j{}; j < 20; j++) {
+            identityError = std::max(identityError, std::fabs(identity(i, j) - (i == j ? 1.0 : 0.0)));
+        }
+    }
+    if(identityError > 1e-10) {
+        std::cout << "FAIL: LU on a view " << identityError << std::endl;
+        failures++;
+    }
+
+    if(failures == 0) {
+        std::cout << "All matrix view tests passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
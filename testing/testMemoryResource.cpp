@@ -0,0 +1,124 @@
+#include "matrix.hpp"
+#include "memoryResource.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+// Every global heap entry point counts, aligned or not
+static size_t heapCalls = 0;
+
+void* operator new(size_t size) {
+    heapCalls++;
+    if(void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void* operator new(size_t size, std::align_val_t alignment) {
+    heapCalls++;
+    size_t a = size_t(alignment);
+    if(void* p = std::aligned_alloc(a, (size + a - 1) / a * a)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+static Matrix filled(size_t n, double seed) {
+    Matrix mat(n, n);
+    for(size_t i{}; i < n; i++) {
+        for(size_t j{}; j < n; j++) {
+            mat(i, j) = (i == j ? double(n) : 0.0) + std::sin(seed + double(i * n + j));
+        }
+    }
+    return mat;
+}
+
+// One iteration of a typical per-tick pipeline: products, a fused expression, a transpose, det and inverse
+static double pipeline(const Matrix& A, const Matrix& B) {
+    Matrix C = A * B;
+    Matrix D = C + A * 2.0 - B;
+    Matrix E = D.T() * D;
+    Matrix F = E.inv();
+    return D.det() + F(0, 0);
+}
+
+int main() {
+    int failures = 0;
+    const size_t n = 48;
+    Matrix A = filled(n, 1.0);
+    Matrix B = filled(n, 2.0);
+    double expected = pipeline(A, B);
+
+    if(reinterpret_cast<uintptr_t>(A.data.data()) % MATRIX_ALIGNMENT != 0) {
+        std::cout << "FAIL: matrix storage is not " << MATRIX_ALIGNMENT << "-byte aligned" << std::endl;
+        failures++;
+    }
+
+    // Pool: after the first iteration warms the size classes, the loop never reaches the global heap
+    {
+        PoolResource pool;
+        MatrixResourceScope scope(&pool);
+        pipeline(A, B);
+        size_t before = heapCalls;
+        double result = 0;
+        for(int iteration{}; iteration < 100; iteration++) {
+            result = pipeline(A, B);
+        }
+        if(heapCalls != before || result != expected) {
+            std::cout << "FAIL: pooled pipeline made " << heapCalls - before << " heap calls" << std::endl;
+            failures++;
+        }
+    }
+
+    // Arena: reset between iterations, results copied out survive the reset
+    Matrix kept(n, n);
+    {
+        ArenaResource arena;
+        MatrixResourceScope scope(&arena);
+        pipeline(A, B);
+        arena.reset();
+        size_t before = heapCalls;
+        for(int iteration{}; iteration < 100; iteration++) {
+            Matrix dirty(n, n, MatrixInit::Uninitialized);
+            for(double& v : dirty.data) {
+                v = 123.0;
+            }
+            arena.reset();
+            // Same arena bytes as dirty: the default constructor must still hand back zeros
+            Matrix clean(n, n);
+            for(double v : clean.data) {
+                if(v != 0.0) {
+                    std::cout << "FAIL: zero-initialized matrix reused dirty memory" << std::endl;
+                    failures++;
+                    break;
+                }
+            }
+            pipeline(A, B);
+            arena.reset();
+        }
+        if(heapCalls != before) {
+            std::cout << "FAIL: arena pipeline made " << heapCalls - before << " heap calls" << std::endl;
+            failures++;
+        }
+        kept = A * B;
+        arena.reset();
+    }
+    Matrix reference = A * B;
+    if(kept.data != reference.data) {
+        std::cout << "FAIL: result assigned out of an arena scope was lost" << std::endl;
+        failures++;
+    }
+    if(currentMatrixResource() != std::pmr::new_delete_resource()) {
+        std::cout << "FAIL: scope did not restore the heap resource" << std::endl;
+        failures++;
+    }
+
+    if(failures == 0) {
+        std::cout << "Memory resource tests passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+#include "matrix.hpp"
+#include "gemm.hpp"
+#include "cpuFeatures.hpp"
+#include "luFactorization.hpp"
+#include "mixedPrecision.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <type_traits>
+
+template<typename Real>
+static BasicMatrix<Real> randomMatrix(size_t rows, size_t columns, std::mt19937& rng) {
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    BasicMatrix<Real> mat(rows, columns);
+    for(Real& value : mat.data) {
+        value = Real(dist(rng));
+    }
+    return mat;
+}
+
+template<typename L, typename R>
+static double maxError(const L& a, const R& b) {
+    double err = 0;
+    for(size_t i{}; i < a.data.size(); i++) {
+        err = std::max(err, std::fabs(double(a.data[i]) - double(b.data[i])));
+    }
+    return err;
+}
+
+// Diagonally dominant, so cond(A) stays small and float refinement converges
+static Matrix wellConditioned(size_t n, std::mt19937& rng) {
+    Matrix A = randomMatrix<double>(n, n, rng);
+    for(size_t i{}; i < n; i++) {
+        A(i, i) += double(n);
+    }
+    return A;
+}
+
+int main() {
+    std::mt19937 rng(18);
+    int failures = 0;
+
+    // Float matrices go through the same expression templates and products
+    MatrixF Af = randomMatrix<float>(4, 3, rng);
+    MatrixF Bf = randomMatrix<float>(3, 5, rng);
+    MatrixF sum = Af + Af * 2.0;
+    MatrixF product = Af * Bf;
+    MatrixF transposed = Af.T();
+    if(maxError(sum, Matrix(Matrix(Af) * 3.0)) > 1e-6 || transposed.rows != 3 || transposed(2, 1) != Af(1, 2)) {
+        std::cout << "FAIL: float expressions" << std::endl;
+        failures++;
+    }
+    if(maxError(product, Matrix(Matrix(Af) * Matrix(Bf))) > 1e-5) {
+        std::cout << "FAIL: float product" << std::endl;
+        failures++;
+    }
+
+    // All-float expressions compute and evaluate in float; one double leaf makes the node double
+    {
+        MatrixF square = randomMatrix<float>(3, 3, rng);
+        for(size_t i{}; i < 3; i++) {
+            square(i, i) += 4.0f;
+        }
+        Matrix wide = randomMatrix<double>(3, 3, rng);
+        static_assert(std::is_same<decltype((square + square * 2.0).coeff(0)), float>::value, "float expression computes in double");
+        static_assert(std::is_same<decltype((square + square.view().T()).eval()), MatrixF>::value, "float expression evaluates to double");
+        static_assert(std::is_same<decltype((square - square).inv()), MatrixF>::value && std::is_same<decltype((square + square).T()), MatrixF>::value &&
+                          std::is_same<decltype((square + square).adj()), MatrixF>::value && std::is_same<decltype((square + square).cof()), MatrixF>::value,
+                      "float expression helpers return double");
+        static_assert(std::is_same<decltype((square + wide).coeff(0)), double>::value && std::is_same<decltype((square * 2.0 + wide).eval()), Matrix>::value,
+                      "mixed expression is not double");
+        MatrixF inverse = (square + square).inv();
+        double identityError = 0;
+        MatrixF check = (square + square) * inverse;
+        for(size_t i{}; i < 3; i++) {
+            for(size_t j{}; j < 3; j++) {
+                identityError = std::max(identityError, std::fabs(double(check(i, j)) - (i == j ? 1.0 : 0.0)));
+            }
+        }
+        if(identityError > 1e-5) {
+            std::cout << "FAIL: float expression inverse " << identityError << std::endl;
+            failures++;
+        }
+    }
+
+    const SimdLevel levels[] = {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512};
+    const size_t sizes[][3] = {{1, 1, 1}, {3, 5, 7}, {17, 33, 9}, {64, 64, 64}, {130, 75, 600}, {257, 129, 513}};
+    for(SimdLevel level : levels) {
+        setSimdLevel(level);
+        for(const auto& s : sizes) {
+            MatrixF A = randomMatrix<float>(s[0], s[2], rng);
+            MatrixF B = randomMatrix<float>(s[2], s[1], rng);
+            MatrixF C = randomMatrix<float>(s[0], s[1], rng);
+            MatrixF Cref = C;
+            gemm(s[0], s[1], s[2], 0.5f, A.data.data(), s[2], 1, B.data.data(), s[1], 1, 2.0f, C.data.data(), s[1]);
+            gemmNaive(s[0], s[1], s[2], 0.5f, A.data.data(), s[2], 1, B.data.data(), s[1], 1, 2.0f, Cref.data.data(), s[1]);
+            double err = maxError(C, Cref);
+            if(err > 1e-5 * s[2]) {
+                std::cout << "FAIL float " << simdLevelName(activeSimdLevel()) << " " << s[0] << "x" << s[2] << "*" << s[2] << "x" << s[1] << " err " << err << std::endl;
+                failures++;
+            }
+        }
+    }
+    setSimdLevel(detectSimdLevel());
+
+    for(size_t n : {1, 7, 64, 65, 200}) {
+        MatrixF A(wellConditioned(n, rng));
+        MatrixF B = randomMatrix<float>(n, 3, rng);
+        LUFactorizationF lu(A);
+        double residual = maxError(MatrixF(A * lu.solve(B)), B);
+        if(residual > 1e-4) {
+            std::cout << "FAIL: float LU n=" << n << " residual " << residual << std::endl;
+            failures++;
+        }
+    }
+
+    // Refinement recovers double accuracy in a handful of steps
+    for(size_t n : {1, 10, 100, 300}) {
+        Matrix A = wellConditioned(n, rng);
+        Matrix B = randomMatrix<double>(n, 4, rng);
+        MixedPrecisionSolver solver(A);
+        RefinedSolution result = solver.solve(B);
+        double difference = maxError(result.X, LUFactorization(A).solve(B));
+        if(result.usedDoublePrecision || result.iterations > 5 || result.backwardError > std::numeric_limits<double>::epsilon() * std::sqrt(double(n)) || difference > 1e-13) {
+            std::cout << "FAIL: refinement n=" << n << " iterations " << result.iterations << " backward error "
+                      << result.backwardError << " difference " << difference << std::endl;
+            failures++;
+        }
+        std::vector<double> b(n, 1.0);
+        RefinedSolution single = solver.solve(b);
+        if(single.X.rows != n || single.X.columns != 1 || single.usedDoublePrecision) {
+            std::cout << "FAIL: vector solve n=" << n << std::endl;
+            failures++;
+        }
+    }
+
+    // Widely spread scales are not singular for either factorization
+    {
+        Matrix wide(2, 2);
+        wide(0, 0) = 1e20;
+        wide(1, 1) = 1;
+        RefinedSolution scaled = MixedPrecisionSolver(wide).solve(std::vector<double>{1e20, 1});
+        if(std::fabs(scaled.X(0, 0) - 1) > 1e-15 || std::fabs(scaled.X(1, 0) - 1) > 1e-15) {
+            std::cout << "FAIL: diag(1e20, 1) solve" << std::endl;
+            failures++;
+        }
+    }
+
+    // Hilbert matrix, cond ~ 1e13: beyond what float refinement can fix
+    const size_t h = 10;
+    Matrix hilbert(h, h);
+    for(size_t i{}; i < h; i++) {
+        for(size_t j{}; j < h; j++) {
+            hilbert(i, j) = 1.0 / double(i + j + 1);
+        }
+    }
+    RefinedSolution hard = MixedPrecisionSolver(hilbert).solve(std::vector<double>(h, 1.0));
+    if(!hard.usedDoublePrecision || hard.backwardError > 1e-14) {
+        std::cout << "FAIL: ill-conditioned fallback, double " << hard.usedDoublePrecision << " backward error " << hard.backwardError << std::endl;
+        failures++;
+    }
+
+    // Entries past FLT_MAX never go through float
+    Matrix huge = wellConditioned(5, rng) * 1e300;
+    MixedPrecisionSolver hugeSolver(huge);
+    RefinedSolution wide = hugeSolver.solve(std::vector<double>(5, 1e300));
+    if(hugeSolver.lowPrecisionUsable() || !wide.usedDoublePrecision || wide.iterations != 0 || wide.backwardError > 1e-15) {
+        std::cout << "FAIL: out of float range fallback" << std::endl;
+        failures++;
+    }
+
+    // Entries below FLT_MIN would turn into float denormals or zeros, in the matrix or the right-hand side
+    Matrix tiny = wellConditioned(5, rng) * 1e-40;
+    MixedPrecisionSolver tinySolver(tiny);
+    RefinedSolution small = tinySolver.solve(std::vector<double>(5, 1e-40));
+    if(tinySolver.lowPrecisionUsable() || !small.usedDoublePrecision || small.iterations != 0 || small.backwardError > 1e-15) {
+        std::cout << "FAIL: underflowing matrix fallback" << std::endl;
+        failures++;
+    }
+    MixedPrecisionSolver plainSolver(wellConditioned(5, rng));
+    std::vector<double> faint(5, 1.0);
+    faint[2] = 1e-45;
+    RefinedSolution mixed = plainSolver.solve(faint);
+    if(!plainSolver.lowPrecisionUsable() || !mixed.usedDoublePrecision || mixed.iterations != 0 || mixed.backwardError > 1e-15) {
+        std::cout << "FAIL: underflowing right-hand side fallback" << std::endl;
+        failures++;
+    }
+
+    try {
+        MixedPrecisionSolver(Matrix(3, 4));
+        std::cout << "FAIL: non-square matrix accepted" << std::endl;
+        failures++;
+    } catch(const std::invalid_argument&) {
+    }
+
+    const size_t n = 1000;
+    Matrix A = wellConditioned(n, rng);
+    Matrix B = randomMatrix<double>(n, 1, rng);
+    auto start = std::chrono::steady_clock::now();
+    Matrix reference = LUFactorization(A).solve(B);
+    double doubleSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    RefinedSolution refined = MixedPrecisionSolver(A).solve(B);
+    double mixedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << n << "x" << n << " solve: double LU " << doubleSeconds * 1e3 << " ms, mixed " << mixedSeconds * 1e3
+              << " ms (" << refined.iterations << " refinement steps, backward error " << refined.backwardError << ")" << std::endl;
+
+    std::cout << (failures ? "Mixed precision tests failed" : "Mixed precision tests passed") << std::endl;
+    return failures ? 1 : 0;
+}
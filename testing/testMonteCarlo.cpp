@@ -0,0 +1,90 @@
+#include "monteCarlo.hpp"
+#include "returnsFixture.hpp"
+#include "threadPool.hpp"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+static bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+int main() {
+    int failures = 0;
+
+    ModernPortfolioTheory model(makeReturns(400, 20, 9), 0.0001);
+
+    // L * L^T reproduces the covariance
+    CholeskyFactorization chol(model.covariance);
+    Matrix rebuilt = chol.L * chol.L.T();
+    double error = 0;
+    for(size_t i{}; i < rebuilt.data.size(); i++) {
+        error = std::max(error, std::fabs(rebuilt.data[i] - model.covariance.data[i]));
+    }
+    if(error > 1e-15) {
+        std::cout << "FAIL: Cholesky reconstruction error " << error << std::endl;
+        failures++;
+    }
+    Matrix indefinite(2, 2);
+    indefinite(0, 0) = 1; indefinite(0, 1) = 2; indefinite(1, 0) = 2; indefinite(1, 1) = 1;
+    try {
+        CholeskyFactorization bad(indefinite);
+        std::cout << "FAIL: indefinite matrix accepted" << std::endl;
+        failures++;
+    } catch(const std::runtime_error&) {}
+
+    PortfolioMonteCarlo simulation(model);
+    MonteCarloConfig config;
+    config.portfolios = 20000;
+    config.seed = 7;
+
+    std::atomic<size_t> reported{0};
+    ThreadPool::setGlobalThreadCount(1);
+    MonteCarloSummary serial = simulation.run(config, [&](const MonteCarloBatch& batch) { reported += batch.count; });
+    ThreadPool::setGlobalThreadCount(4);
+    MonteCarloSummary parallel = simulation.run(config);
+    ThreadPool::setGlobalThreadCount(ThreadPool::defaultThreadCount());
+
+    if(reported != config.portfolios) {
+        std::cout << "FAIL: batches reported " << reported << " of " << config.portfolios << " portfolios" << std::endl;
+        failures++;
+    }
+    if(!sameBits(serial.meanSharpe, parallel.meanSharpe) || !sameBits(serial.meanReturn, parallel.meanReturn)
+       || serial.bestSharpeIndex != parallel.bestSharpeIndex || serial.minimumVolatilityIndex != parallel.minimumVolatilityIndex) {
+        std::cout << "FAIL: results depend on the thread count" << std::endl;
+        failures++;
+    }
+
+    double total = 0;
+    for(double w : serial.bestSharpe.weights) {
+        total += w;
+        if(w < 0) {
+            std::cout << "FAIL: negative weight in a long-only sample" << std::endl;
+            failures++;
+            break;
+        }
+    }
+    if(std::fabs(total - 1) > 1e-12) {
+        std::cout << "FAIL: sampled weights sum to " << total << std::endl;
+        failures++;
+    }
+    if(serial.bestSharpe.sharpe < serial.meanSharpe || serial.minimumVolatility.volatility > serial.meanVolatility) {
+        std::cout << "FAIL: winners are worse than the average sample" << std::endl;
+        failures++;
+    }
+
+    config.portfolios = 1000000;
+    auto start = std::chrono::steady_clock::now();
+    MonteCarloSummary big = simulation.run(config);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "1M portfolios x 252 periods x 20 assets: " << seconds << " s, best Sharpe " << big.bestSharpe.sharpe
+              << ", minimum volatility " << big.minimumVolatility.volatility << std::endl;
+
+    if(failures == 0) {
+        std::cout << "All Monte Carlo tests passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
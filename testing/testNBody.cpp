@@ -0,0 +1,220 @@
+#include "cpuFeatures.hpp"
+#include "nbody.hpp"
+#include "physicsWorld.hpp"
+#include "threadPool.hpp"
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <random>
+
+static int failures = 0;
+
+static void expect(bool ok, const std::string& what) {
+    if(!ok) {
+        std::cout << "FAIL: " << what << std::endl;
+        failures++;
+    }
+}
+
+// Plummer sphere of unit scale radius, a centrally concentrated cluster
+static Vec3DBatch plummer(size_t count, std::mt19937& rng) {
+    std::uniform_real_distribution<double> unit(0, 1), side(-1, 1);
+    Vec3DBatch position;
+    position.reserve(count);
+    for(size_t i{}; i < count; i++) {
+        double r = 1.0 / std::sqrt(std::pow(0.001 + 0.998 * unit(rng), -2.0 / 3.0) - 1.0);
+        Vec3D direction;
+        do {
+            direction = Vec3D(side(rng), side(rng), side(rng));
+        } while(direction * direction > 1 || direction * direction < 1e-6);
+        position.push_back(direction * (r / direction.magnitude()));
+    }
+    return position;
+}
+
+// Root mean square and largest |a - b|, both relative to the root mean square of |b|
+static std::pair<double, double> relativeError(const Vec3DBatch& a, const Vec3DBatch& b) {
+    double error = 0, norm = 0, worst = 0;
+    for(size_t i{}; i < a.size(); i++) {
+        Vec3D d = a.get(i) - b.get(i);
+        error += d * d;
+        norm += b.get(i) * b.get(i);
+        worst = std::max(worst, d * d);
+    }
+    return {std::sqrt(error / norm), std::sqrt(worst * double(a.size()) / norm)};
+}
+
+static bool identical(const Vec3DBatch& a, const Vec3DBatch& b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+int main() {
+    std::mt19937 rng(24);
+
+    // Two bodies, gravity and like charges, against Newton and Coulomb
+    {
+        Vec3DBatch position, acceleration;
+        position.push_back(Vec3D(0, 0, 0));
+        position.push_back(Vec3D(2, 0, 0));
+        for(NBodyMethod method : {NBodyMethod::Direct, NBodyMethod::BarnesHut}) {
+            NBodySolver gravity;
+            gravity.settings.method = method;
+            gravity.settings.coupling = 0.5;
+            gravity.settings.softening = 0;
+            gravity.strength = {3.0, 1.0};
+            gravity(position, acceleration);
+            expect(std::fabs(acceleration.x[0] - 0.5 * 1.0 / 4) < 1e-15 && std::fabs(acceleration.x[1] + 0.5 * 3.0 / 4) < 1e-15 &&
+                       acceleration.y[0] == 0 && acceleration.z[1] == 0,
+                   "two-body gravity");
+
+            // Charges 2 and 1 on masses 1 and 4
+            NBodySolver coulomb;
+            coulomb.settings.method = method;
+            coulomb.settings.coupling = -1.0;
+            coulomb.settings.softening = 0;
+            coulomb.strength = {2.0, 1.0};
+            coulomb.response = {2.0 / 1.0, 1.0 / 4.0};
+            coulomb(position, acceleration);
+            expect(std::fabs(acceleration.x[0] + 2.0 * 1.0 / 4) < 1e-15 && std::fabs(acceleration.x[1] - 0.25 * 2.0 / 4) < 1e-15,
+                   "like charges repel");
+        }
+    }
+
+    // A cluster against the direct sum: theta 0 opens every cell, larger theta trades accuracy for speed
+    Vec3DBatch cluster = plummer(20000, rng);
+    NBodySolver solver;
+    solver.strength.assign(cluster.size(), 1.0 / double(cluster.size()));
+    solver.settings.softening = 0.01;
+    Vec3DBatch reference, approximate;
+    solver.settings.method = NBodyMethod::Direct;
+    solver(cluster, reference);
+    solver.settings.method = NBodyMethod::BarnesHut;
+    solver.settings.theta = 0;
+    solver(cluster, approximate);
+    expect(relativeError(approximate, reference).second < 1e-12, "theta 0 matches the direct sum");
+    double previous = 0;
+    for(double theta : {0.3, 0.5, 0.8}) {
+        solver.settings.theta = theta;
+        solver(cluster, approximate);
+        auto [rms, worst] = relativeError(approximate, reference);
+        expect(rms > previous && rms < 0.01 * theta * theta, "theta " + std::to_string(theta) + " error " + std::to_string(rms));
+        expect(worst < 0.1 * theta, "theta " + std::to_string(theta) + " worst error " + std::to_string(worst));
+        previous = rms;
+        std::cout << "theta " << theta << ": relative error rms " << rms << ", worst " << worst << ", "
+                  << solver.interactionsPerBody() << " interactions per body, " << solver.cellCount() << " cells" << std::endl;
+    }
+
+    // The sampled direct sum agrees with the full one
+    {
+        std::vector<size_t> targets = {0, 17, 19999};
+        Vec3DBatch sampled;
+        solver.direct(cluster, targets, sampled);
+        for(size_t k{}; k < targets.size(); k++) {
+            expect((sampled.get(k) - reference.get(targets[k])).magnitude() < 1e-15 * reference.get(targets[k]).magnitude() + 1e-300,
+                   "sampled direct sum");
+        }
+    }
+
+    // Same forces whatever the thread count, and to rounding whatever the instruction set
+    {
+        solver.settings.theta = 0.5;
+        Vec3DBatch first, second;
+        ThreadPool::setGlobalThreadCount(1);
+        solver(cluster, first);
+        ThreadPool::setGlobalThreadCount(4);
+        solver(cluster, second);
+        ThreadPool::setGlobalThreadCount(ThreadPool::defaultThreadCount());
+        expect(identical(first, second), "thread count changes the forces");
+        for(SimdLevel level : {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512}) {
+            setSimdLevel(level);
+            solver(cluster, second);
+            expect(relativeError(second, first).second < 1e-12, std::string("forces with ") + simdLevelName(activeSimdLevel()));
+        }
+        setSimdLevel(detectSimdLevel());
+    }
+
+    // Coincident bodies without softening stay finite, and a lone body feels nothing
+    {
+        Vec3DBatch position, acceleration;
+        for(size_t i{}; i < 40; i++) {
+            position.push_back(Vec3D(1, 1, 1));
+        }
+        position.push_back(Vec3D(3, 1, 1));
+        NBodySolver stacked;
+        stacked.settings.softening = 0;
+        stacked.strength.assign(position.size(), 1.0);
+        stacked(position, acceleration);
+        expect(std::fabs(acceleration.x[0] - 0.25) < 1e-12 && std::fabs(acceleration.x[40] + 10) < 1e-12, "coincident bodies");
+        Vec3DBatch lone;
+        lone.push_back(Vec3D(5, 5, 5));
+        stacked.strength = {1.0};
+        stacked(lone, acceleration);
+        expect(acceleration.get(0) == Vec3D(), "lone body");
+        try {
+            stacked(position, acceleration);
+            expect(false, "missing strengths accepted");
+        } catch(const std::invalid_argument&) {
+        }
+    }
+
+    // As the world's field: a circular binary keeps its separation over an orbit
+    {
+        WorldSettings settings;
+        settings.integrator = Integrator::VelocityVerlet;
+        settings.timeStep = 1e-3;
+        PhysicsWorld world(settings);
+        NBodySolver binary;
+        binary.settings.softening = 0;
+        binary.strength = {1.0, 1.0};
+        world.setAccelerationField(std::ref(binary));
+        // Separation 1 and total mass 2: each moves at sqrt(2) / 2 around the centre, period pi * sqrt(2)
+        double v = std::sqrt(2.0) / 2;
+        world.particles.add(Vec3D(-0.5, 0, 0), Vec3D(0, -v, 0), 1.0, 0.01);
+        world.particles.add(Vec3D(0.5, 0, 0), Vec3D(0, v, 0), 1.0, 0.01);
+        double worst = 0;
+        const size_t steps = size_t(M_PI * std::sqrt(2.0) / settings.timeStep);
+        for(size_t s{}; s < steps; s++) {
+            world.step();
+            worst = std::max(worst, std::fabs((world.particles.position.get(1) - world.particles.position.get(0)).magnitude() - 1));
+        }
+        expect(worst < 1e-5, "binary separation drifted by " + std::to_string(worst));
+        expect((world.particles.position.get(1) - Vec3D(0.5, 0, 0)).magnitude() < 1e-3, "binary returns after one period");
+    }
+
+    // A million bodies: time per evaluation and error on a sample against the direct sum
+    {
+        const size_t n = 1000000;
+        Vec3DBatch big = plummer(n, rng);
+        NBodySolver million;
+        million.strength.assign(n, 1.0 / double(n));
+        million.settings.softening = 0.01;
+        std::vector<size_t> targets;
+        for(size_t i{}; i < 500; i++) {
+            targets.push_back(i * (n / 500));
+        }
+        Vec3DBatch sampled;
+        auto start = std::chrono::steady_clock::now();
+        million.direct(big, targets, sampled);
+        double directSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * double(n) / 500;
+        for(double theta : {0.5, 0.8}) {
+            million.settings.theta = theta;
+            Vec3DBatch acceleration, atTargets;
+            start = std::chrono::steady_clock::now();
+            million(big, acceleration);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            for(size_t i : targets) {
+                atTargets.push_back(acceleration.get(i));
+            }
+            auto [rms, worst] = relativeError(atTargets, sampled);
+            expect(rms < 0.01 * theta * theta, "1M bodies error " + std::to_string(rms));
+            std::cout << n << " bodies, theta " << theta << ": " << seconds << " s per evaluation, "
+                      << million.interactionsPerBody() << " interactions per body, relative error rms " << rms << ", worst "
+                      << worst << "; direct sum would take " << directSeconds << " s (" << ThreadPool::global().threadCount()
+                      << " threads, " << simdLevelName(activeSimdLevel()) << ")" << std::endl;
+        }
+    }
+
+    std::cout << (failures ? "N-body tests failed" : "N-body tests passed") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,249 @@
+#include "physicsWorld.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+static int failures = 0;
+
+static void expect(bool ok, const std::string& what) {
+    if(!ok) {
+        std::cout << "FAIL: " << what << std::endl;
+        failures++;
+    }
+}
+
+static WorldSettings unbounded(Integrator integrator, double dt) {
+    WorldSettings settings;
+    settings.integrator = integrator;
+    settings.timeStep = dt;
+    return settings;
+}
+
+int main() {
+    const double g = 9.81;
+
+    // Constant gravity: Verlet is exact, semi-implicit Euler is off by g t dt / 2
+    for(Integrator integrator : {Integrator::SemiImplicitEuler, Integrator::VelocityVerlet}) {
+        PhysicsWorld world(unbounded(integrator, 1.0 / 120.0));
+        world.particles.add(Vec3D(0, 100, 0), Vec3D(1, 5, 0), 1.0, 0.1);
+        for(size_t s{}; s < 120; s++) {
+            world.step();
+        }
+        double t = world.time();
+        double exact = 100 + 5 * t - 0.5 * g * t * t;
+        double expected = integrator == Integrator::VelocityVerlet ? exact : exact - 0.5 * g * t * world.settings.timeStep;
+        Vec3D p = world.particles.position.get(0);
+        expect(std::fabs(p.y() - expected) < 1e-9 && std::fabs(p.x() - t) < 1e-9, "free fall y " + std::to_string(p.y()) + " expected " + std::to_string(expected));
+    }
+
+    // Harmonic oscillator a = -x: both integrators are symplectic, Verlet is second order
+    double worstEnergy[2] = {};
+    for(Integrator integrator : {Integrator::SemiImplicitEuler, Integrator::VelocityVerlet}) {
+        PhysicsWorld world(unbounded(integrator, 0.01));
+        world.setAccelerationField([](const Vec3DBatch& position, Vec3DBatch& acceleration) {
+            Vec3DBatch::scale(position, -1.0, acceleration);
+        });
+        world.particles.add(Vec3D(1, 0, 0), Vec3D(0, 0, 0), 1.0, 0.1);
+        double worst = 0;
+        for(size_t s{}; s < 10000; s++) {
+            world.step();
+            double x = world.particles.position.x[0], v = world.particles.velocity.x[0];
+            worst = std::max(worst, std::fabs(0.5 * (x * x + v * v) - 0.5));
+        }
+        worstEnergy[integrator == Integrator::VelocityVerlet] = worst / 0.5;
+        if(integrator == Integrator::VelocityVerlet) {
+            expect(std::fabs(world.particles.position.x[0] - std::cos(world.time())) < 1e-2, "Verlet oscillator phase");
+        }
+    }
+    expect(worstEnergy[1] < 1e-4 && worstEnergy[1] < worstEnergy[0] / 10,
+           "oscillator energy error Euler " + std::to_string(worstEnergy[0]) + " Verlet " + std::to_string(worstEnergy[1]));
+
+    // Elastic bounce returns to the drop height; restitution 0.5 halves the rebound speed
+    {
+        WorldSettings settings;
+        settings.timeStep = 1e-4;
+        settings.integrator = Integrator::VelocityVerlet;
+        settings.boundsMin = Vec3D(-10, 0, -10);
+        settings.boundsMax = Vec3D(10, 20, 10);
+        settings.restitution = 1.0;
+        settings.restingSpeed = 0.0;
+        PhysicsWorld world(settings);
+        world.particles.add(Vec3D(0, 5, 0), Vec3D(), 1.0, 0.5);
+        double peak = 0;
+        bool bounced = false;
+        for(size_t s{}; s < 25000; s++) {
+            world.step();
+            double vy = world.particles.velocity.y[0];
+            bounced = bounced || vy > 0;
+            if(bounced) {
+                peak = std::max(peak, world.particles.position.y[0]);
+            }
+        }
+        expect(bounced && std::fabs(peak - 5.0) < 0.01, "elastic bounce peak " + std::to_string(peak));
+
+        world.settings.restitution = 0.5;
+        world.particles.position.set(0, Vec3D(0, 5, 0));
+        world.particles.velocity.set(0, Vec3D());
+        double before = 0, after = 0;
+        for(size_t s{}; s < 20000 && after == 0; s++) {
+            double vy = world.particles.velocity.y[0];
+            world.step();
+            if(vy < 0 && world.particles.velocity.y[0] > 0) {
+                before = -vy;
+                after = world.particles.velocity.y[0];
+            }
+        }
+        expect(std::fabs(after / before - 0.5) < 0.01, "restitution 0.5 rebound ratio " + std::to_string(after / before));
+    }
+
+    // An inelastic drop settles on the floor instead of jittering
+    {
+        WorldSettings settings;
+        settings.boundsMin = Vec3D(-10, 0, -10);
+        settings.boundsMax = Vec3D(10, 20, 10);
+        PhysicsWorld world(settings);
+        world.particles.add(Vec3D(0, 3, 0), Vec3D(), 1.0, 0.5);
+        for(size_t s{}; s < 1200; s++) {
+            world.step();
+        }
+        expect(std::fabs(world.particles.position.y[0] - 0.5) < 1e-3 && world.particles.velocity.get(0).magnitude() < 0.1,
+               "resting particle at y " + std::to_string(world.particles.position.y[0]));
+    }
+
+    // A sliding solid sphere ends up rolling at 5/7 of its initial speed
+    {
+        WorldSettings settings;
+        settings.boundsMin = Vec3D(-1000, 0, -10);
+        settings.boundsMax = Vec3D(1000, 20, 10);
+        PhysicsWorld world(settings);
+        world.bodies.add(Vec3D(0, 0.5, 0), Vec3D(4, 0, 0), 1.0, 0.5);
+        for(size_t s{}; s < 480; s++) {
+            world.step();
+        }
+        double v = world.bodies.linear.velocity.x[0];
+        double spin = world.bodies.angularVelocity.z[0];
+        expect(std::fabs(v - 4.0 * 5.0 / 7.0) < 0.05 && std::fabs(spin * 0.5 + v) < 0.05,
+               "rolling v " + std::to_string(v) + " spin " + std::to_string(spin));
+    }
+
+    // Free rotation about z by a quarter turn takes x to y, and the quaternion stays unit length
+    {
+        WorldSettings settings = unbounded(Integrator::SemiImplicitEuler, 1e-4);
+        settings.gravity = Vec3D();
+        PhysicsWorld world(settings);
+        world.bodies.add(Vec3D(), Vec3D(), 1.0, 1.0, Vec3D(0, 0, 1));
+        size_t steps = size_t(std::round(M_PI / 2 / settings.timeStep));
+        for(size_t s{}; s < steps; s++) {
+            world.step();
+        }
+        Vec3D turned = world.bodies.toWorld(0, Vec3D(1, 0, 0));
+        double norm = std::sqrt(world.bodies.qw[0] * world.bodies.qw[0] + world.bodies.qx[0] * world.bodies.qx[0] +
+                                world.bodies.qy[0] * world.bodies.qy[0] + world.bodies.qz[0] * world.bodies.qz[0]);
+        expect((turned - Vec3D(0, 1, 0)).magnitude() < 1e-3 && std::fabs(norm - 1) < 1e-12, "quarter turn");
+
+        // An off-centre force spins the body by r x F
+        world.bodies.angularVelocity.set(0, Vec3D());
+        world.bodies.applyForceAt(0, Vec3D(0, 1, 0), Vec3D(1, 0, 0));
+        world.step();
+        double expected = settings.timeStep * world.bodies.inverseInertia[0];
+        expect(std::fabs(world.bodies.angularVelocity.z[0] - expected) < 1e-12 && !world.bodies.hasTorques(), "force at a point");
+    }
+
+    // Fixed timestep accumulator
+    {
+        WorldSettings settings = unbounded(Integrator::SemiImplicitEuler, 0.01);
+        PhysicsWorld world(settings);
+        size_t taken = world.advance(0.055);
+        expect(taken == 5 && std::fabs(world.interpolationAlpha() - 0.5) < 1e-9, "advance takes whole steps");
+        taken = world.advance(1.0);
+        expect(taken == settings.maxSubSteps && world.interpolationAlpha() < 1.0, "advance caps sub-steps");
+    }
+
+    // Head-on elastic collision of equal spheres swaps their velocities; unequal masses keep momentum
+    for(BroadphaseKind broadphase : {BroadphaseKind::UniformGrid, BroadphaseKind::SweepAndPrune}) {
+        WorldSettings settings = unbounded(Integrator::SemiImplicitEuler, 1e-3);
+        settings.gravity = Vec3D();
+        settings.restitution = 1.0;
+        settings.broadphase = broadphase;
+        PhysicsWorld world(settings);
+        world.particles.add(Vec3D(-1, 0, 0), Vec3D(2, 0, 0), 1.0, 0.5);
+        world.particles.add(Vec3D(1, 0, 0), Vec3D(-1, 0, 0), 1.0, 0.5);
+        for(size_t s{}; s < 1000; s++) {
+            world.step();
+        }
+        expect(std::fabs(world.particles.velocity.x[0] + 1) < 1e-12 && std::fabs(world.particles.velocity.x[1] - 2) < 1e-12,
+               "equal spheres swap velocities");
+
+        world.settings.restitution = 0.5;
+        world.bodies.add(Vec3D(10, 0, 0), Vec3D(3, 0.5, 0), 1.0, 0.5);
+        world.bodies.add(Vec3D(12, 0.3, 0), Vec3D(-1, 0, 0), 3.0, 0.7);
+        Vec3D before = world.bodies.linear.velocity.get(0) * 1.0 + world.bodies.linear.velocity.get(1) * 3.0;
+        double energyBefore = world.kineticEnergy();
+        for(size_t s{}; s < 1000; s++) {
+            world.step();
+        }
+        Vec3D after = world.bodies.linear.velocity.get(0) * 1.0 + world.bodies.linear.velocity.get(1) * 3.0;
+        expect((after - before).magnitude() < 1e-12 && world.kineticEnergy() < energyBefore && world.candidatePairCount() == 0,
+               "inelastic collision momentum");
+    }
+
+    // A heap of frictionless spheres dropped into a box piles up without sinking into each other
+    {
+        WorldSettings settings;
+        settings.boundsMin = Vec3D(-3, 0, -3);
+        settings.boundsMax = Vec3D(3, 20, 3);
+        PhysicsWorld world(settings);
+        std::mt19937 heapRng(7);
+        std::uniform_real_distribution<double> across(-2.7, 2.7), up(1, 19);
+        for(size_t i{}; i < 300; i++) {
+            world.particles.add(Vec3D(across(heapRng), up(heapRng), across(heapRng)), Vec3D(), 1.0, 0.25);
+        }
+        for(size_t s{}; s < 1200; s++) {
+            world.step();
+        }
+        double deepest = 0, total = 0;
+        for(size_t i{}; i < 300; i++) {
+            for(size_t j{i + 1}; j < 300; j++) {
+                double gap = (world.particles.position.get(i) - world.particles.position.get(j)).magnitude() - 0.5;
+                deepest = std::min(deepest, gap);
+                total += std::min(gap, 0.0);
+            }
+        }
+        // Without contacts the heap would collapse into the floor layer, overlapping by hundreds of units in total
+        expect(deepest > -0.1 && total > -5, "settled heap overlap " + std::to_string(deepest) + ", total " + std::to_string(total));
+    }
+
+    try {
+        PhysicsWorld world;
+        world.particles.add(Vec3D(), Vec3D(), 0.0, 1.0);
+        expect(false, "zero mass accepted");
+    } catch(const std::invalid_argument&) {
+    }
+
+    const size_t n = 1000000;
+    WorldSettings settings;
+    settings.boundsMin = Vec3D(-50, -50, -50);
+    settings.boundsMax = Vec3D(50, 50, 50);
+    PhysicsWorld world(settings);
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<double> place(-49, 49);
+    world.particles.reserve(n);
+    for(size_t i{}; i < n; i++) {
+        world.particles.add(Vec3D(place(rng), place(rng), place(rng)), Vec3D(place(rng), 0, place(rng)), 1.0, 0.1);
+    }
+    for(BroadphaseKind broadphase : {BroadphaseKind::None, BroadphaseKind::UniformGrid}) {
+        world.settings.broadphase = broadphase;
+        const size_t steps = broadphase == BroadphaseKind::None ? 20 : 5;
+        auto start = std::chrono::steady_clock::now();
+        for(size_t s{}; s < steps; s++) {
+            world.step();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << n << " particles" << (broadphase == BroadphaseKind::None ? ", no contacts: " : ", grid contacts: ")
+                  << double(steps) / seconds << " steps/s" << std::endl;
+    }
+
+    std::cout << (failures ? "Physics tests failed" : "Physics tests passed") << std::endl;
+    return failures ? 1 : 0;
+}
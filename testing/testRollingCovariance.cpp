@@ -0,0 +1,146 @@
+#include "rollingCovariance.hpp"
+#include "luFactorization.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+// Sample covariance of rows [first, first + length) computed from scratch
+static Matrix directCovariance(const Matrix& panel, size_t first, size_t length) {
+    size_t d = panel.columns;
+    std::vector<double> mean(d, 0.0);
+    for(size_t t{first}; t < first + length; t++) {
+        for(size_t i{}; i < d; i++) {
+            mean[i] += panel(t, i) / double(length);
+        }
+    }
+    Matrix cov(d, d);
+    for(size_t t{first}; t < first + length; t++) {
+        for(size_t i{}; i < d; i++) {
+            for(size_t j{}; j < d; j++) {
+                cov(i, j) += (panel(t, i) - mean[i]) * (panel(t, j) - mean[j]) / double(length - 1);
+            }
+        }
+    }
+    return cov;
+}
+
+static double maxDifference(const Matrix& a, const Matrix& b) {
+    double m = 0;
+    for(size_t i{}; i < a.data.size(); i++) {
+        m = std::max(m, std::fabs(a.data[i] - b.data[i]));
+    }
+    return m;
+}
+
+int main() {
+    int failures = 0;
+    std::mt19937 rng(23);
+    std::normal_distribution<double> normal(0.0, 0.01);
+
+    const size_t D = 8, W = 250, T = 2000;
+    Matrix panel(T, D);
+    for(size_t t{}; t < T; t++) {
+        double market = normal(rng);
+        for(size_t i{}; i < D; i++) {
+            panel(t, i) = 0.0005 + (0.5 + 0.1 * i) * market + normal(rng);
+        }
+    }
+
+    RollingCovariance rolling(D, W, true);
+    for(size_t t{}; t < T; t++) {
+        rolling.push(&panel.unchecked(t, 0));
+        if(t == 100 || t == W - 1 || t == T - 1) {
+            size_t length = std::min(t + 1, W);
+            Matrix expected = directCovariance(panel, t + 1 - length, length);
+            const Matrix& view = rolling.covariance();
+            double error = maxDifference(view, expected);
+            if(error > 1e-15) {
+                std::cout << "FAIL: rolling covariance at tick " << t << " off by " << error << std::endl;
+                failures++;
+            }
+            if(&view != &rolling.covariance()) {
+                std::cout << "FAIL: covariance view moved between calls" << std::endl;
+                failures++;
+            }
+        }
+    }
+    if(!rolling.full() || rolling.count() != W) {
+        std::cout << "FAIL: window did not saturate" << std::endl;
+        failures++;
+    }
+
+    // The tracked factor solves the same system LU does on the recomputed matrix
+    std::vector<double> b(D, 1.0);
+    std::vector<double> tracked = rolling.solve(b);
+    std::vector<double> reference = LUFactorization(directCovariance(panel, T - W, W)).solve(b);
+    double solveError = 0, scale = 0;
+    for(size_t i{}; i < D; i++) {
+        solveError = std::max(solveError, std::fabs(tracked[i] - reference[i]));
+        scale = std::max(scale, std::fabs(reference[i]));
+    }
+    if(solveError > 1e-8 * scale) {
+        std::cout << "FAIL: tracked Cholesky solve error " << solveError << " relative to " << scale << std::endl;
+        failures++;
+    }
+
+    const Matrix& corr = rolling.correlation();
+    const Matrix& cov = rolling.covariance();
+    double corrError = std::fabs(corr(0, 1) - cov(0, 1) / std::sqrt(cov(0, 0) * cov(1, 1)));
+    if(corrError > 1e-14 || std::fabs(corr(3, 3) - 1.0) > 1e-14) {
+        std::cout << "FAIL: correlation " << corrError << std::endl;
+        failures++;
+    }
+
+    Matrix beforeRecompute = rolling.covariance();
+    rolling.recompute();
+    if(maxDifference(beforeRecompute, rolling.covariance()) > 1e-15) {
+        std::cout << "FAIL: recompute disagrees with the incremental state" << std::endl;
+        failures++;
+    }
+
+    // Per tick cost against rebuilding the window for a realistic book
+    const size_t N = 200;
+    Matrix wide(W + 500, N);
+    for(double& v : wide.data) {
+        v = normal(rng);
+    }
+    RollingCovariance live(N, W);
+    for(size_t t{}; t < W; t++) {
+        live.push(&wide.unchecked(t, 0));
+    }
+    auto start = std::chrono::steady_clock::now();
+    for(size_t t{W}; t < W + 500; t++) {
+        live.push(&wide.unchecked(t, 0));
+        live.covariance();
+    }
+    double perTick = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / 500;
+    start = std::chrono::steady_clock::now();
+    live.recompute();
+    live.covariance();
+    double full = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    std::cout << N << " assets, window " << W << ": " << perTick << " us per tick vs " << full << " us full rebuild" << std::endl;
+
+    // Recomputing an empty window leaves zero means, and later pushes start from a clean state
+    {
+        RollingCovariance empty(3, 5);
+        empty.recompute();
+        std::vector<double> first = {1.0, 2.0, 3.0}, second = {3.0, 6.0, 5.0};
+        bool finite = true;
+        for(double m : empty.mean()) {
+            finite = finite && m == 0.0;
+        }
+        empty.push(first);
+        empty.push(second);
+        const Matrix& cov = empty.covariance();
+        if(!finite || empty.mean()[0] != 2.0 || empty.mean()[1] != 4.0 || std::fabs(cov(1, 2) - 4.0) > 1e-12) {
+            std::cout << "FAIL: recompute on an empty window" << std::endl;
+            failures++;
+        }
+    }
+
+    if(failures == 0) {
+        std::cout << "All rolling covariance tests passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,201 @@
+#include "matrix.hpp"
+#include "sparseMatrix.hpp"
+#include "sparseCholesky.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+static double maxAbs(const Matrix& mat) {
+    double m = 0;
+    for(double v : mat.data) {
+        m = std::max(m, std::fabs(v));
+    }
+    return m;
+}
+
+static double maxDiff(const std::vector<double>& a, const std::vector<double>& b) {
+    double m = 0;
+    for(size_t i{}; i < a.size(); i++) {
+        m = std::max(m, std::fabs(a[i] - b[i]));
+    }
+    return m;
+}
+
+// 5-point Laplacian on a side x side grid plus a small shift, symmetric positive definite
+static SparseMatrix gridLaplacian(size_t side, bool lowerOnly) {
+    std::vector<SparseEntry> entries;
+    for(size_t r{}; r < side; r++) {
+        for(size_t c{}; c < side; c++) {
+            size_t i = r * side + c;
+            entries.push_back({i, i, 4.01});
+            if(c > 0) entries.push_back({i, i - 1, -1.0});
+            if(r > 0) entries.push_back({i, i - side, -1.0});
+            if(!lowerOnly && c + 1 < side) entries.push_back({i, i + 1, -1.0});
+            if(!lowerOnly && r + 1 < side) entries.push_back({i, i + side, -1.0});
+        }
+    }
+    return SparseMatrix::fromEntries(side * side, side * side, entries);
+}
+
+int main() {
+    int failures = 0;
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+    // Dense round trip with about 10% fill
+    Matrix dense(40, 30);
+    for(double& v : dense.data) {
+        v = dist(rng) > 0.8 ? dist(rng) : 0.0;
+    }
+    SparseMatrix S(dense);
+    if(maxAbs(S.toDense() - dense) != 0.0 || S.get(3, 4) != dense(3, 4)) {
+        std::cout << "FAIL: dense round trip" << std::endl;
+        failures++;
+    }
+    if(maxAbs(S.transpose().toDense() - dense.T()) != 0.0) {
+        std::cout << "FAIL: transpose" << std::endl;
+        failures++;
+    }
+    SparseMatrix strided(dense.view().T());
+    if(maxAbs(strided.toDense() - dense.T()) != 0.0) {
+        std::cout << "FAIL: construction from a transposed view" << std::endl;
+        failures++;
+    }
+
+    // Duplicate entries are summed regardless of order
+    SparseMatrix summed = SparseMatrix::fromEntries(2, 3, {{1, 2, 1.5}, {0, 0, 1.0}, {1, 2, 2.5}, {0, 1, -1.0}});
+    if(summed.nonZeros() != 3 || summed.get(1, 2) != 4.0 || summed.get(1, 0) != 0.0) {
+        std::cout << "FAIL: fromEntries" << std::endl;
+        failures++;
+    }
+    try {
+        SparseMatrix::fromEntries(2, 2, {{2, 0, 1.0}});
+        std::cout << "FAIL: out of range entry accepted" << std::endl;
+        failures++;
+    } catch(const std::out_of_range&) {
+    }
+
+    // SpMV and SpMM against the dense products
+    std::vector<double> x(30);
+    for(double& v : x) {
+        v = dist(rng);
+    }
+    std::vector<double> expected(40, 0.0);
+    for(size_t i{}; i < 40; i++) {
+        for(size_t j{}; j < 30; j++) {
+            expected[i] += dense(i, j) * x[j];
+        }
+    }
+    if(maxDiff(S * x, expected) > 1e-14) {
+        std::cout << "FAIL: SpMV" << std::endl;
+        failures++;
+    }
+    Matrix B(30, 7);
+    for(double& v : B.data) {
+        v = dist(rng);
+    }
+    if(maxAbs(S * B - dense * B) > 1e-13 || maxAbs(S * B.view().T().T() - dense * B) > 1e-13) {
+        std::cout << "FAIL: SpMM" << std::endl;
+        failures++;
+    }
+
+    // Sparse Cholesky on a grid Laplacian, lower triangle only and full storage agree with dense
+    SparseMatrix lower = gridLaplacian(12, true);
+    SparseMatrix full = gridLaplacian(12, false);
+    std::vector<double> b(144);
+    for(double& v : b) {
+        v = dist(rng);
+    }
+    Matrix denseFull = full.toDense();
+    for(SparseOrdering ordering : {SparseOrdering::Natural, SparseOrdering::MinimumDegree}) {
+        SparseCholesky fromLower(lower, ordering);
+        SparseCholesky fromFull(full, ordering);
+        std::vector<double> solution = fromLower.solve(b);
+        double residual = maxDiff(full * solution, b);
+        if(residual > 1e-12 || maxDiff(fromFull.solve(b), solution) > 1e-14) {
+            std::cout << "FAIL: sparse Cholesky residual " << residual << std::endl;
+            failures++;
+        }
+        Matrix rhs(144, 3);
+        for(double& v : rhs.data) {
+            v = dist(rng);
+        }
+        if(maxAbs(denseFull * fromLower.solve(rhs) - rhs) > 1e-12) {
+            std::cout << "FAIL: sparse Cholesky multiple right hand sides" << std::endl;
+            failures++;
+        }
+    }
+
+    // Arrow matrix: a dense first row and column fill L completely in the natural order,
+    // minimum degree eliminates the hub last and keeps L as sparse as A
+    const size_t arrowSize = 400;
+    std::vector<SparseEntry> arrow;
+    for(size_t i{}; i < arrowSize; i++) {
+        arrow.push_back({i, i, double(arrowSize)});
+        if(i > 0) {
+            arrow.push_back({i, 0, 1.0});
+        }
+    }
+    SparseMatrix arrowMatrix = SparseMatrix::fromEntries(arrowSize, arrowSize, arrow);
+    SparseCholesky natural(arrowMatrix, SparseOrdering::Natural);
+    SparseCholesky ordered(arrowMatrix);
+    if(natural.nonZeros() != arrowSize * (arrowSize + 1) / 2 || ordered.nonZeros() != 2 * arrowSize - 1) {
+        std::cout << "FAIL: arrow fill natural " << natural.nonZeros() << " minimum degree " << ordered.nonZeros() << std::endl;
+        failures++;
+    }
+
+    SparseMatrix indefinite = SparseMatrix::fromEntries(3, 3, {{0, 0, 1.0}, {1, 1, -1.0}, {2, 2, 1.0}});
+    try {
+        SparseCholesky bad(indefinite);
+        std::cout << "FAIL: indefinite matrix accepted" << std::endl;
+        failures++;
+    } catch(const std::runtime_error&) {
+    }
+
+    // 10k unknowns, a system that would take 800 MB dense
+    SparseMatrix large = gridLaplacian(100, true);
+    auto start = std::chrono::steady_clock::now();
+    SparseCholesky naturalLarge(large, SparseOrdering::Natural);
+    double naturalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    SparseCholesky orderedLarge(large);
+    double orderedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::vector<double> rhs(large.rows, 1.0);
+    double residual = maxDiff(gridLaplacian(100, false) * orderedLarge.solve(rhs), rhs);
+    if(residual > 1e-10 || orderedLarge.nonZeros() >= naturalLarge.nonZeros()) {
+        std::cout << "FAIL: 10k grid residual " << residual << std::endl;
+        failures++;
+    }
+    std::cout << "10k grid: natural nnz(L) " << naturalLarge.nonZeros() << " in " << naturalSeconds * 1e3
+              << " ms, minimum degree nnz(L) " << orderedLarge.nonZeros() << " in " << orderedSeconds * 1e3 << " ms" << std::endl;
+
+    // 90k unknowns: the quotient graph keeps the ordering near the size of A where explicit cliques
+    // would grow with the fill
+    const size_t side = 300;
+    SparseMatrix huge = gridLaplacian(side, true);
+    start = std::chrono::steady_clock::now();
+    std::vector<size_t> hugeOrder = minimumDegreeOrdering(huge);
+    double orderSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::vector<bool> placed(huge.rows, false);
+    bool permutation = hugeOrder.size() == huge.rows;
+    for(size_t v : hugeOrder) {
+        permutation = permutation && v < huge.rows && !placed[v];
+        if(permutation) {
+            placed[v] = true;
+        }
+    }
+    SparseCholesky hugeFactor(huge);
+    std::vector<double> ones(huge.rows, 1.0);
+    double hugeResidual = maxDiff(gridLaplacian(side, false) * hugeFactor.solve(ones), ones);
+    if(!permutation || hugeResidual > 1e-10 || hugeFactor.nonZeros() > 36 * huge.rows) {
+        std::cout << "FAIL: 90k grid order of " << hugeOrder.size() << ", residual " << hugeResidual << ", nnz(L) " << hugeFactor.nonZeros()
+                  << std::endl;
+        failures++;
+    }
+    std::cout << "90k grid: minimum degree order in " << orderSeconds * 1e3 << " ms, nnz(L) " << hugeFactor.nonZeros() << std::endl;
+
+    std::cout << (failures ? "Sparse tests failed" : "Sparse tests passed") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,156 @@
+#include "mean.hpp"
+#include <cmath>
+#include <iostream>
+#include <random>
+
+static bool close(double a, double b, double tolerance) {
+    return std::fabs(a - b) <= tolerance * std::max(1.0, std::fabs(b));
+}
+
+int main() {
+    int failures = 0;
+    std::mt19937 rng(17);
+    std::gamma_distribution<double> skewed(2.0, 1.5);
+
+    // Large offset: the naive sum of squares loses every digit here, Welford does not
+    const size_t N = 100000;
+    std::vector<double> data(N);
+    for(double& v : data) {
+        v = 1e8 + skewed(rng);
+    }
+    double mean = 0;
+    for(double v : data) {
+        mean += v;
+    }
+    mean /= N;
+    double m2 = 0, m3 = 0, m4 = 0;
+    for(double v : data) {
+        double d = v - mean;
+        m2 += d * d;
+        m3 += d * d * d;
+        m4 += d * d * d * d;
+    }
+    double variance = m2 / (N - 1);
+    double skew = std::sqrt(double(N)) * m3 / std::pow(m2, 1.5);
+    double kurt = N * m4 / (m2 * m2) - 3.0;
+
+    RunningMoments ticks;
+    for(double v : data) {
+        ticks.add(v);
+    }
+    RunningMoments shards[4];
+    for(size_t s{}; s < 4; s++) {
+        shards[s].add(data.data() + s * N / 4, N / 4);
+    }
+    RunningMoments merged = shards[0];
+    for(size_t s{1}; s < 4; s++) {
+        merged.merge(shards[s]);
+    }
+    for(const RunningMoments* m : {&ticks, &merged}) {
+        if(!close(m->mean, mean, 1e-14) || !close(m->variance(), variance, 1e-8)
+           || !close(m->skewness(), skew, 1e-6) || !close(m->kurtosis(), kurt, 1e-6)) {
+            std::cout << "FAIL: moments " << m->mean << " " << m->variance() << " " << m->skewness() << " " << m->kurtosis()
+                      << " expected " << mean << " " << variance << " " << skew << " " << kurt << std::endl;
+            failures++;
+        }
+    }
+
+    KahanSum kahan;
+    double naive = 0;
+    for(size_t i{}; i < 1000000; i++) {
+        kahan.add(0.1);
+        naive += 0.1;
+    }
+    kahan.add(1e100);
+    kahan.add(1.0);
+    kahan.add(-1e100);
+    if(std::fabs(kahan.value() - 100001.0) > 1e-9) {
+        std::cout << "FAIL: compensated sum " << kahan.value() << " naive " << naive << std::endl;
+        failures++;
+    }
+
+    // Chunk means are compensated: a naive sum drops every 1 against 1e16, leaving a mean of 0
+    std::vector<double> spiky(1002, 1.0);
+    spiky.front() = 1e16;
+    spiky.back() = -1e16;
+    RunningMoments spikyMoments;
+    spikyMoments.add(spiky.data(), spiky.size());
+    Matrix spikyPanel(spiky.size(), 2);
+    for(size_t t{}; t < spiky.size(); t++) {
+        spikyPanel(t, 0) = spiky[t];
+        spikyPanel(t, 1) = -spiky[t];
+    }
+    RunningCovariance spikyCovariance(2);
+    spikyCovariance.add(spikyPanel);
+    double spikyMean = 1000.0 / 1002.0;
+    if(!close(spikyMoments.mean, spikyMean, 1e-15) || !close(spikyCovariance.mean[0], spikyMean, 1e-15)
+       || !close(spikyCovariance.mean[1], -spikyMean, 1e-15)) {
+        std::cout << "FAIL: chunk means " << spikyMoments.mean << " " << spikyCovariance.mean[0] << " " << spikyCovariance.mean[1]
+                  << " expected " << spikyMean << std::endl;
+        failures++;
+    }
+
+    // Covariance: per tick, per chunk and merged shards against the direct formula
+    const size_t T = 3000, D = 12;
+    std::normal_distribution<double> normal(0.0, 1.0);
+    Matrix panel(T, D);
+    for(size_t t{}; t < T; t++) {
+        double common = normal(rng);
+        for(size_t i{}; i < D; i++) {
+            panel(t, i) = 50.0 + 0.5 * common + normal(rng) * (1.0 + i * 0.1);
+        }
+    }
+    std::vector<double> means(D, 0.0);
+    for(size_t t{}; t < T; t++) {
+        for(size_t i{}; i < D; i++) {
+            means[i] += panel(t, i) / T;
+        }
+    }
+    Matrix expected(D, D);
+    for(size_t i{}; i < D; i++) {
+        for(size_t j{}; j < D; j++) {
+            double s = 0;
+            for(size_t t{}; t < T; t++) {
+                s += (panel(t, i) - means[i]) * (panel(t, j) - means[j]);
+            }
+            expected(i, j) = s / (T - 1);
+        }
+    }
+
+    RunningCovariance perTick(D), perChunk(D), left(D), right(D);
+    for(size_t t{}; t < T; t++) {
+        perTick.add(&panel.unchecked(t, 0));
+        (t < T / 3 ? left : right).add(&panel.unchecked(t, 0));
+    }
+    for(size_t start{}; start < T; start += 700) {
+        size_t rows = std::min<size_t>(700, T - start);
+        Matrix chunk(rows, D);
+        std::copy(&panel.unchecked(start, 0), &panel.unchecked(start, 0) + rows * D, chunk.data.begin());
+        perChunk.add(chunk);
+    }
+    left.merge(right);
+    for(const RunningCovariance* c : {&perTick, &perChunk, &left}) {
+        Matrix cov = c->covariance();
+        double error = 0;
+        for(size_t i{}; i < D * D; i++) {
+            error = std::max(error, std::fabs(cov.data[i] - expected.data[i]));
+        }
+        if(error > 1e-11 || c->count != T) {
+            std::cout << "FAIL: streaming covariance error " << error << std::endl;
+            failures++;
+        }
+    }
+    Matrix corr = perChunk.correlation();
+    for(size_t i{}; i < D; i++) {
+        if(std::fabs(corr(i, i) - 1.0) > 1e-12) {
+            std::cout << "FAIL: correlation diagonal " << corr(i, i) << std::endl;
+            failures++;
+            break;
+        }
+    }
+
+    if(failures == 0) {
+        std::cout << "All streaming statistics tests passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+#include "matrix.hpp"
+#include "threadPool.hpp"
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+int main() {
+    int failures = 0;
+
+    for(size_t threads : {1, 2, 4, 7}) {
+        ThreadPool pool(threads);
+        std::vector<int> hits(100000, 0);
+        pool.parallelFor(0, hits.size(), 64, [&](size_t begin, size_t end) {
+            for(size_t i{begin}; i < end; i++) {
+                hits[i]++;
+                // Nested loops run inline on the same thread
+                pool.parallelFor(0, 4, 1, [&](size_t, size_t) {
+                    if(threads > 1 && !ThreadPool::insideParallelRegion()) {
+                        hits[i] = -100;
+                    }
+                });
+            }
+        });
+        for(int h : hits) {
+            if(h != 1) {
+                std::cout << "FAIL: index visited " << h << " times with " << threads << " threads" << std::endl;
+                failures++;
+                break;
+            }
+        }
+
+        bool caught = false;
+        try {
+            pool.parallelFor(0, 1000, 1, [](size_t, size_t end) {
+                if(end > 500) {
+                    throw std::runtime_error("boom");
+                }
+            });
+        } catch(const std::runtime_error&) {
+            caught = true;
+        }
+        if(!caught) {
+            std::cout << "FAIL: exception was not propagated with " << threads << " threads" << std::endl;
+            failures++;
+        }
+    }
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    Matrix A(300, 200), B(200, 250), S(300, 200);
+    for(double& v : A.data) v = dist(rng);
+    for(double& v : B.data) v = dist(rng);
+    for(double& v : S.data) v = dist(rng);
+
+    ThreadPool::setGlobalThreadCount(1);
+    Matrix serialProduct = A * B;
+    Matrix serialSum = A + S;
+    Matrix serialT = A.T();
+    ThreadPool::setGlobalThreadCount(4);
+    Matrix parallelProduct = A * B;
+    Matrix parallelSum = A + S;
+    Matrix parallelT = A.T();
+
+    double err = 0;
+    for(size_t i{}; i < serialProduct.data.size(); i++) {
+        err = std::max(err, std::fabs(serialProduct.data[i] - parallelProduct.data[i]));
+    }
+    if(err > 1e-12 || serialSum.data != parallelSum.data || serialT.data != parallelT.data) {
+        std::cout << "FAIL: parallel kernels differ from serial, GEMM err " << err << std::endl;
+        failures++;
+    }
+
+    std::cout << (failures ? "Thread pool tests failed" : "Thread pool tests passed") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -1,4 +1,4 @@
-#include "../Math Algorithms/3DVector.hpp"
+#include "3DVector.hpp"
 #include <iostream>
 
 int main(){
@@ -0,0 +1,106 @@
+#include "vec3DBatch.hpp"
+#include "cpuFeatures.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+static int failures = 0;
+
+static void expectNear(const Vec3D& got, const Vec3D& want, const char* what, SimdLevel level) {
+    if((got - want).magnitude() > 1e-12 * (1.0 + want.magnitude())) {
+        std::cout << "FAIL: " << what << " (" << simdLevelName(level) << ")" << std::endl;
+        failures++;
+    }
+}
+
+static void expectNear(double got, double want, const char* what, SimdLevel level) {
+    if(std::fabs(got - want) > 1e-12 * (1.0 + std::fabs(want))) {
+        std::cout << "FAIL: " << what << " (" << simdLevelName(level) << ")" << std::endl;
+        failures++;
+    }
+}
+
+int main() {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> dist(-10.0, 10.0);
+    const size_t n = 37;  // not a multiple of any register width, so every tail path runs
+    std::vector<Vec3D> as, bs;
+    for(size_t i{}; i < n; i++) {
+        as.emplace_back(dist(rng), dist(rng), dist(rng));
+        bs.emplace_back(dist(rng), dist(rng), dist(rng));
+    }
+    Vec3DBatch A(as), B(bs), out;
+    std::vector<double> scalars;
+    Vec3D wall(0.0, 2.0, 0.0);
+
+    for(SimdLevel level : {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        setSimdLevel(level);
+        level = activeSimdLevel();
+
+        Vec3DBatch::add(A, B, out);
+        for(size_t i{}; i < n; i++) expectNear(out.get(i), as[i] + bs[i], "add", level);
+        Vec3DBatch::sub(A, B, out);
+        for(size_t i{}; i < n; i++) expectNear(out.get(i), as[i] - bs[i], "sub", level);
+        Vec3DBatch::scale(A, 1.5, out);
+        for(size_t i{}; i < n; i++) expectNear(out.get(i), as[i] * 1.5, "scale", level);
+        Vec3DBatch::addScaled(A, B, 0.25, out);
+        for(size_t i{}; i < n; i++) expectNear(out.get(i), as[i] + bs[i] * 0.25, "addScaled", level);
+        Vec3DBatch::dot(A, B, scalars);
+        for(size_t i{}; i < n; i++) expectNear(scalars[i], as[i] * bs[i], "dot", level);
+        Vec3DBatch::magnitude(A, scalars);
+        for(size_t i{}; i < n; i++) expectNear(scalars[i], as[i].magnitude(), "magnitude", level);
+        Vec3DBatch::normal(A, out);
+        for(size_t i{}; i < n; i++) expectNear(out.get(i), as[i].normal(), "normal", level);
+        Vec3DBatch::cross(A, B, out);
+        for(size_t i{}; i < n; i++) expectNear(out.get(i), as[i].cross(bs[i]), "cross", level);
+        Vec3DBatch::proj(A, B, out);
+        for(size_t i{}; i < n; i++) expectNear(out.get(i), as[i].proj(bs[i]), "proj", level);
+        Vec3DBatch::reflect(A, B, out);
+        for(size_t i{}; i < n; i++) expectNear(out.get(i), as[i].reflect(bs[i]), "reflect", level);
+        Vec3DBatch::reflect(A, wall, out);
+        for(size_t i{}; i < n; i++) expectNear(out.get(i), as[i].reflect(wall), "reflect against one normal", level);
+        Vec3DBatch::angleBetween(A, B, scalars);
+        for(size_t i{}; i < n; i++) expectNear(scalars[i], as[i].angleBetween(bs[i]), "angleBetween", level);
+
+        // In place: the output is also the input
+        Vec3DBatch C = A;
+        Vec3DBatch::cross(C, B, C);
+        for(size_t i{}; i < n; i++) expectNear(C.get(i), as[i].cross(bs[i]), "in-place cross", level);
+
+        Vec3DBatch withZero = A;
+        withZero.set(n - 1, Vec3D());
+        try {
+            Vec3DBatch::normal(withZero, out);
+            std::cout << "FAIL: zero vector normalized (" << simdLevelName(level) << ")" << std::endl;
+            failures++;
+        } catch(const std::runtime_error&) {
+        }
+    }
+    setSimdLevel(detectSimdLevel());
+
+    if(A.toVectors() != as) {
+        std::cout << "FAIL: gather/scatter round trip" << std::endl;
+        failures++;
+    }
+
+    const size_t big = 1 << 20;
+    std::vector<Vec3D> cloud(big);
+    for(Vec3D& v : cloud) {
+        v = Vec3D(dist(rng), dist(rng), dist(rng));
+    }
+    Vec3DBatch points(cloud), normals(big);
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i{}; i < big; i++) {
+        cloud[i] = cloud[i].normal();
+    }
+    double aos = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    Vec3DBatch::normal(points, normals);
+    double soa = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "normalize 2^20 vectors: Vec3D " << aos * 1e3 << " ms, Vec3DBatch ("
+              << simdLevelName(activeSimdLevel()) << ") " << soa * 1e3 << " ms" << std::endl;
+
+    std::cout << (failures ? "Vec3DBatch tests failed" : "Vec3DBatch tests passed") << std::endl;
+    return failures ? 1 : 0;
+}